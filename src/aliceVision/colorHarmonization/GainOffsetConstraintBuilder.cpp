@@ -66,7 +66,6 @@ void Encode_histo_relation(
   //--
 
   size_t rowPos = 0;
-  double incrementPourcentile = 1./(double) nbQuantile;
 
   for (size_t i = 0; i < Nrelative; ++i)
   {
@@ -75,45 +74,10 @@ void Encode_histo_relation(
 
     const relativeColorHistogramEdge & edge = *iter;
 
-    //-- compute the two cumulated and normalized histogram
-
-    const std::vector< size_t > & vec_histoI = edge.histoI;
-    const std::vector< size_t > & vec_histoJ = edge.histoJ;
-
-    const size_t nBuckets = vec_histoI.size();
-
-    // Normalize histogram
-    std::vector<double> ndf_I(nBuckets), ndf_J(nBuckets);
-    histogram::normalizeHisto(vec_histoI, ndf_I);
-    histogram::normalizeHisto(vec_histoJ, ndf_J);
-
-    // Compute cumulative distribution functions (cdf)
-    std::vector<double> cdf_I(nBuckets), cdf_J(nBuckets);
-    histogram::cdf(ndf_I, cdf_I);
-    histogram::cdf(ndf_J, cdf_J);
-
-    double currentPourcentile = 5./100.;
-
     //-- Compute pourcentile and their positions
     std::vector<double> vec_pourcentilePositionI, vec_pourcentilePositionJ;
-    vec_pourcentilePositionI.reserve(1.0/incrementPourcentile);
-    vec_pourcentilePositionJ.reserve(1.0/incrementPourcentile);
-
-    std::vector<double>::const_iterator cdf_I_IterBegin = cdf_I.begin();
-    std::vector<double>::const_iterator cdf_J_IterBegin = cdf_J.begin();
-    while( currentPourcentile < 1.0)
-    {
-      std::vector<double>::const_iterator iterFI = std::lower_bound(cdf_I.begin(), cdf_I.end(), currentPourcentile);
-      const size_t positionI = std::distance(cdf_I_IterBegin, iterFI);
-
-      std::vector<double>::const_iterator iterFJ = std::lower_bound(cdf_J.begin(), cdf_J.end(), currentPourcentile);
-      const size_t positionJ = std::distance(cdf_J_IterBegin, iterFJ);
-
-      vec_pourcentilePositionI.push_back(positionI);
-      vec_pourcentilePositionJ.push_back(positionJ);
-
-      currentPourcentile += incrementPourcentile;
-    }
+    histogram::quantilePositions(edge.histoI, vec_pourcentilePositionI);
+    histogram::quantilePositions(edge.histoJ, vec_pourcentilePositionJ);
 
     //-- Add the constraints:
     // pos * ga + offa - pos * gb - offb <= gamma
@@ -56,6 +56,30 @@ inline void cdf(const std::vector<T> & vec_df, std::vector<T> & vec_cdf)
       vec_cdf[i] = vec_cdf[i] + vec_cdf[i-1];
 }
 
+// Compute the positions of the 5%, 15%, ..., 95% quantiles of a histogram
+template<typename T>
+inline void quantilePositions(const std::vector<T> & vec_histo, std::vector<double> & vec_positions)
+{
+  const std::size_t nbQuantile = 10;
+  const double incrementPourcentile = 1./(double) nbQuantile;
+
+  // Normalize histogram and compute the cumulative distribution function (cdf)
+  std::vector<double> ndf, vec_cdf;
+  normalizeHisto(vec_histo, ndf);
+  cdf(ndf, vec_cdf);
+
+  vec_positions.clear();
+  vec_positions.reserve(nbQuantile);
+
+  double currentPourcentile = 5./100.;
+  while(currentPourcentile < 1.0)
+  {
+    const std::vector<double>::const_iterator iterF = std::lower_bound(vec_cdf.begin(), vec_cdf.end(), currentPourcentile);
+    vec_positions.push_back(std::distance(vec_cdf.cbegin(), iterF));
+    currentPourcentile += incrementPourcentile;
+  }
+}
+
 };
 
 // Implementation of the formula (1) of [1] with 10 quantiles.
@@ -0,0 +1,142 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "GainOffsetSolverIRLS.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <Eigen/SparseCholesky>
+
+#include <algorithm>
+#include <cmath>
+
+namespace aliceVision {
+namespace lInfinity {
+
+bool solveGainOffsetIRLS(std::size_t nImage,
+                         const std::vector<relativeColorHistogramEdge> & vec_relativeHistograms,
+                         const std::vector<std::size_t> & vec_indexToFix,
+                         std::vector<double> & vec_solution,
+                         std::size_t maxIterations)
+{
+  // residuals below this value (in gray levels) get the same weight
+  const double minResidual = 0.1;
+  // weak prior toward {gain = 1, offset = 0}, keeps the system definite on poorly constrained images
+  const double priorWeight = 1e-6;
+
+  // unknown index of each {gain, offset} variable, -1 if fixed
+  std::vector<int> unknownIndexes(2 * nImage, 0);
+  for(const std::size_t index : vec_indexToFix)
+  {
+    unknownIndexes[2 * index] = -1;
+    unknownIndexes[2 * index + 1] = -1;
+  }
+
+  int nbUnknowns = 0;
+  for(int& unknownIndex : unknownIndexes)
+  {
+    if(unknownIndex == 0)
+      unknownIndex = nbUnknowns++;
+  }
+
+  // value of a variable with its fixed value: gain = 1, offset = 0
+  const auto fixedValue = [](std::size_t var) { return (var % 2 == 0) ? 1.0 : 0.0; };
+
+  // one row per quantile of each edge: pos_I * g_I + off_I - pos_J * g_J - off_J = 0
+  std::vector<Eigen::Triplet<double> > triplets;
+  std::vector<double> rhs;
+  triplets.reserve(vec_relativeHistograms.size() * 10 * 4);
+  rhs.reserve(vec_relativeHistograms.size() * 10);
+
+  for(const relativeColorHistogramEdge & edge : vec_relativeHistograms)
+  {
+    std::vector<double> vec_positionI, vec_positionJ;
+    histogram::quantilePositions(edge.histoI, vec_positionI);
+    histogram::quantilePositions(edge.histoJ, vec_positionJ);
+
+    for(std::size_t k = 0; k < vec_positionI.size(); ++k)
+    {
+      const int row = static_cast<int>(rhs.size());
+      const std::size_t vars[4] = {2 * edge.I, 2 * edge.I + 1, 2 * edge.J, 2 * edge.J + 1};
+      const double coeffs[4] = {vec_positionI[k], 1.0, -vec_positionJ[k], -1.0};
+
+      double b = 0.0;
+      for(int v = 0; v < 4; ++v)
+      {
+        const int unknownIndex = unknownIndexes[vars[v]];
+        if(unknownIndex < 0)
+          b -= coeffs[v] * fixedValue(vars[v]);
+        else
+          triplets.emplace_back(row, unknownIndex, coeffs[v]);
+      }
+      rhs.push_back(b);
+    }
+  }
+
+  vec_solution.assign(2 * nImage + 1, 0.0);
+  for(std::size_t var = 0; var < 2 * nImage; ++var)
+    vec_solution[var] = fixedValue(var);
+
+  if(nbUnknowns == 0 || rhs.empty())
+    return true;
+
+  sMat A(static_cast<int>(rhs.size()), nbUnknowns);
+  A.setFromTriplets(triplets.begin(), triplets.end());
+  const Vec b = Eigen::Map<const Vec>(rhs.data(), rhs.size());
+
+  Vec prior(nbUnknowns);
+  for(std::size_t var = 0; var < unknownIndexes.size(); ++var)
+  {
+    if(unknownIndexes[var] >= 0)
+      prior(unknownIndexes[var]) = fixedValue(var);
+  }
+
+  sMat identity(nbUnknowns, nbUnknowns);
+  identity.setIdentity();
+
+  Vec x = prior;
+  Vec weights = Vec::Ones(b.size());
+  Eigen::SimplicialLDLT<sMat> solver;
+
+  for(std::size_t iteration = 0; iteration < maxIterations; ++iteration)
+  {
+    const sMat AtW = A.transpose() * weights.asDiagonal();
+    const sMat normalMatrix = AtW * A + priorWeight * identity;
+
+    if(iteration == 0)
+      solver.analyzePattern(normalMatrix);
+    solver.factorize(normalMatrix);
+
+    if(solver.info() != Eigen::Success)
+    {
+      ALICEVISION_LOG_WARNING("Color harmonization: cannot solve the gain/offset system.");
+      return false;
+    }
+
+    const Vec xNew = solver.solve(AtW * b + priorWeight * prior);
+    const double change = (xNew - x).cwiseAbs().maxCoeff();
+    x = xNew;
+
+    if(change < 1e-6)
+      break;
+
+    // L1 weights
+    const Vec residuals = A * x - b;
+    for(int i = 0; i < residuals.size(); ++i)
+      weights(i) = 1.0 / std::max(std::abs(residuals(i)), minResidual);
+  }
+
+  for(std::size_t var = 0; var < unknownIndexes.size(); ++var)
+  {
+    if(unknownIndexes[var] >= 0)
+      vec_solution[var] = x(unknownIndexes[var]);
+  }
+  vec_solution.back() = (A * x - b).cwiseAbs().maxCoeff();
+
+  return true;
+}
+
+} // namespace lInfinity
+} // namespace aliceVision
@@ -0,0 +1,39 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/colorHarmonization/GainOffsetConstraintBuilder.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace lInfinity {
+
+/**
+ * @brief Solve the gain and offset of each image from the pairwise histograms
+ * with an iteratively reweighted least squares (robust L1 fit of the quantile relations).
+ *
+ * Same relations as Encode_histo_relation: pos_I * g_I + off_I = pos_J * g_J + off_J
+ * for each quantile of each edge. The normal equations are sparse (one block per edge),
+ * so it scales to large graphs where the L-infinity linear program becomes too slow.
+ *
+ * @param[in] nImage The number of images, edge indexes are in [0, nImage[
+ * @param[in] vec_relativeHistograms The pairwise histograms
+ * @param[in] vec_indexToFix The images with a fixed gain (1.0) and offset (0.0)
+ * @param[out] vec_solution {gain, offset} per image followed by the L-infinity fitting error,
+ *             same layout as the linear program solution
+ * @param[in] maxIterations The maximum number of reweighting iterations
+ * @return false if the linear system cannot be solved
+ */
+bool solveGainOffsetIRLS(std::size_t nImage,
+                         const std::vector<relativeColorHistogramEdge> & vec_relativeHistograms,
+                         const std::vector<std::size_t> & vec_indexToFix,
+                         std::vector<double> & vec_solution,
+                         std::size_t maxIterations = 20);
+
+} // namespace lInfinity
+} // namespace aliceVision
@@ -13,6 +13,7 @@
 
 //ColorHarmonization solver
 #include <aliceVision/colorHarmonization/GainOffsetConstraintBuilder.hpp>
+#include <aliceVision/colorHarmonization/GainOffsetSolverIRLS.hpp>
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/config.hpp>
 
@@ -104,6 +105,71 @@ BOOST_AUTO_TEST_CASE(ColorHarmonisation_Simple_offset) {
   BOOST_CHECK_SMALL(0.-gamma, 1e-2);  // Alignment must be perfect
 }
 
+BOOST_AUTO_TEST_CASE(ColorHarmonisation_Simple_offset_IRLS) {
+
+  Histogram< double > histo( 0, 256, 255);
+  for (std::size_t i=0; i < 6000; i++)
+  {
+    histo.Add(normal_distribution(127, 10)());
+  }
+
+  const size_t OFFET_VALUE = 20;
+  std::vector<std::size_t> vec_reference = histo.GetHist();
+  std::vector<std::size_t> vec_shifted = vec_reference;
+  rotate(vec_shifted.begin(), vec_shifted.begin() + OFFET_VALUE, vec_shifted.end());
+
+  std::vector<relativeColorHistogramEdge > vec_relativeHistograms;
+  vec_relativeHistograms.push_back(relativeColorHistogramEdge(0,1, vec_reference, vec_shifted));
+  //-- First image will be considered as reference and don't move
+  std::vector<std::size_t> vec_indexToFix(1,0);
+
+  std::vector<double> vec_solution;
+  BOOST_CHECK(solveGainOffsetIRLS(2, vec_relativeHistograms, vec_indexToFix, vec_solution));
+  BOOST_REQUIRE_EQUAL(vec_solution.size(), 2 * 2 + 1);
+
+  BOOST_CHECK_SMALL(1.-vec_solution[0], 1e-2);
+  BOOST_CHECK_SMALL(0.-vec_solution[1], 1e-2);
+  BOOST_CHECK_SMALL(1.-vec_solution[2], 1e-2);
+  BOOST_CHECK_SMALL(OFFET_VALUE-vec_solution[3], 1e-2);
+  BOOST_CHECK_SMALL(0.-vec_solution[4], 1e-2);  // Alignment must be perfect
+}
+
+BOOST_AUTO_TEST_CASE(ColorHarmonisation_Offset_gain_IRLS) {
+
+  Histogram< double > histo_ref( 0, 256, 255);
+  Histogram< double > histo_offset_gain( 0, 256, 255);
+  const double GAIN = 3.0;
+  const double OFFSET = 160;
+  for (std::size_t i=0; i < 10000; i++)
+  {
+    double val = normal_distribution(127, 10)();
+    histo_ref.Add(val);
+    histo_offset_gain.Add( (val-127) * GAIN + OFFSET);
+  }
+  std::vector<std::size_t> vec_reference = histo_ref.GetHist();
+  std::vector<std::size_t> vec_shifted = histo_offset_gain.GetHist();
+
+  std::vector<relativeColorHistogramEdge > vec_relativeHistograms;
+  vec_relativeHistograms.push_back(relativeColorHistogramEdge(0,1, vec_reference, vec_shifted));
+  vec_relativeHistograms.push_back(relativeColorHistogramEdge(1,2, vec_shifted, vec_reference));
+  vec_relativeHistograms.push_back(relativeColorHistogramEdge(0,2, vec_reference, vec_reference));
+  //-- First image will be considered as reference and don't move
+  std::vector<size_t> vec_indexToFix(1,0);
+
+  std::vector<double> vec_solution;
+  BOOST_CHECK(solveGainOffsetIRLS(3, vec_relativeHistograms, vec_indexToFix, vec_solution));
+  BOOST_REQUIRE_EQUAL(vec_solution.size(), 3 * 2 + 1);
+
+  // same expected solution as the linear program, up to the quantization error
+  BOOST_CHECK_SMALL(1.-vec_solution[0], 1e-2);
+  BOOST_CHECK_SMALL(0.-vec_solution[1], 1e-2);
+  BOOST_CHECK_SMALL((1./GAIN)-vec_solution[2], 1e-1);
+  BOOST_CHECK_SMALL((127-OFFSET/GAIN)-vec_solution[3], 2.); // +/- quantization error (2 gray levels)
+  BOOST_CHECK_SMALL(1.-vec_solution[4], 1e-2);
+  BOOST_CHECK_SMALL(0.-vec_solution[5], 1e-1);
+  BOOST_CHECK(vec_solution[6] < 2.0);
+}
+
 BOOST_AUTO_TEST_CASE(ColorHarmonisation_Offset_gain) {
 
   Histogram< double > histo_ref( 0, 256, 255);
@@ -14,6 +14,9 @@
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/imageAlgo.hpp>
 
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
 #include <iostream>
 
 namespace aliceVision {
@@ -44,45 +47,57 @@ void DepthSimMap::add11(DepthSimMap* depthSimMap)
         throw std::runtime_error("Error DepthSimMap: You can only add to scale1-step1 map.");
     }
 
-    int k = (depthSimMap->step * depthSimMap->scale) / 2;
+    const int stepScale = depthSimMap->step * depthSimMap->scale;
+
+    int k = stepScale / 2;
     int k1 = k;
-    if((depthSimMap->step * depthSimMap->scale) % 2 == 0)
+    if(stepScale % 2 == 0)
         k -= 1;
 
-    for(int i = 0; i < depthSimMap->dsm->size(); i++)
+    // each input cell covers its own block of stepScale x stepScale pixels,
+    // so input rows can be processed independently
+    #pragma omp parallel for
+    for(int yi = 0; yi < depthSimMap->h; ++yi)
     {
-        int x = (i % depthSimMap->w) * depthSimMap->step * depthSimMap->scale;
-        int y = (i / depthSimMap->w) * depthSimMap->step * depthSimMap->scale;
-        DepthSim depthSim = (*depthSimMap->dsm)[i];
+        const int y = yi * stepScale;
+        const int yFrom = std::max(0, y - k);
+        const int yTo = std::min(h - 1, y + k1);
+
+        if(yFrom > yTo)
+            continue;
 
-        if(depthSim.depth > -1.0f)
+        for(int xi = 0; xi < depthSimMap->w; ++xi)
         {
+            const DepthSim& depthSim = (*depthSimMap->dsm)[yi * depthSimMap->w + xi];
+
+            if(depthSim.depth <= -1.0f)
+                continue;
+
+            const int x = xi * stepScale;
+            const int xFrom = std::max(0, x - k);
+            const int xTo = std::min(w - 1, x + k1);
+
+            if(xFrom > xTo)
+                continue;
 
             bool isBest = true;
-            for(int yp = y - k; yp <= y + k1; yp++)
+            for(int yp = yFrom; yp <= yTo && isBest; ++yp)
             {
-                for(int xp = x - k; xp <= x + k1; xp++)
+                const DepthSim* row = &(*dsm)[yp * w];
+                for(int xp = xFrom; xp <= xTo; ++xp)
                 {
-                    if((xp >= 0) && (xp < w) && (yp >= 0) && (yp < h) && // check image borders
-                       (depthSim.sim > (*dsm)[yp * w + xp].sim))
+                    if(depthSim.sim > row[xp].sim)
                     {
                         isBest = false;
+                        break;
                     }
                 }
             }
 
             if(isBest)
             {
-                for(int yp = y - k; yp <= y + k1; yp++)
-                {
-                    for(int xp = x - k; xp <= x + k1; xp++)
-                    {
-                        if((xp >= 0) && (xp < w) && (yp >= 0) && (yp < h))
-                        {
-                            (*dsm)[yp * w + xp] = depthSim;
-                        }
-                    }
-                }
+                for(int yp = yFrom; yp <= yTo; ++yp)
+                    std::fill(&(*dsm)[yp * w + xFrom], &(*dsm)[yp * w + xTo] + 1, depthSim);
             }
         }
     }
@@ -95,10 +110,11 @@ void DepthSimMap::add(DepthSimMap* depthSimMap)
         throw std::runtime_error("Error DepthSimMap: You can only add to the same scale and step map.");
     }
 
+    #pragma omp parallel for
     for(int i = 0; i < dsm->size(); i++)
     {
-        DepthSim depthSim1 = (*dsm)[i];
-        DepthSim depthSim2 = (*depthSimMap->dsm)[i];
+        const DepthSim& depthSim1 = (*dsm)[i];
+        const DepthSim& depthSim2 = (*depthSimMap->dsm)[i];
 
         if((depthSim2.depth > -1.0f) && (depthSim2.sim < depthSim1.sim))
         {
@@ -111,12 +127,15 @@ Point2d DepthSimMap::getMaxMinDepth() const
 {
     float maxDepth = -1.0f;
     float minDepth = std::numeric_limits<float>::max();
+
+    #pragma omp parallel for reduction(max: maxDepth) reduction(min: minDepth)
     for(int j = 0; j < w * h; j++)
     {
-        if((*dsm)[j].depth > -1.0f)
+        const float depth = (*dsm)[j].depth;
+        if(depth > -1.0f)
         {
-            maxDepth = std::max(maxDepth, (*dsm)[j].depth);
-            minDepth = std::min(minDepth, (*dsm)[j].depth);
+            maxDepth = std::max(maxDepth, depth);
+            minDepth = std::min(minDepth, depth);
         }
     }
     return Point2d(maxDepth, minDepth);
@@ -126,40 +145,76 @@ Point2d DepthSimMap::getMaxMinSim() const
 {
     float maxSim = -1.0f;
     float minSim = std::numeric_limits<float>::max();
+
+    #pragma omp parallel for reduction(max: maxSim) reduction(min: minSim)
     for(int j = 0; j < w * h; j++)
     {
-        if((*dsm)[j].sim > -1.0f)
+        const float sim = (*dsm)[j].sim;
+        if(sim > -1.0f)
         {
-            maxSim = std::max(maxSim, (*dsm)[j].sim);
-            minSim = std::min(minSim, (*dsm)[j].sim);
+            maxSim = std::max(maxSim, sim);
+            minSim = std::min(minSim, sim);
         }
     }
     return Point2d(maxSim, minSim);
 }
 
-float DepthSimMap::getPercentileDepth(float perc)
+float DepthSimMap::getPercentileDepth(float perc) const
 {
+    // use at most ~50000 samples
+    const int sampleStep = std::max(1, (w * h) / 50000);
 
-    int step = std::max(1, (w * h) / 50000);
-    int n = (w * h) / std::max(1, (step - 1));
-    StaticVector<float>* depths = new StaticVector<float>();
-    depths->reserve(n);
+    std::vector<float> depths;
+    depths.reserve((w * h) / sampleStep + 1);
 
-    for(int j = 0; j < w * h; j += step)
+    for(int j = 0; j < w * h; j += sampleStep)
     {
         if((*dsm)[j].depth > -1.0f)
         {
-            depths->push_back((*dsm)[j].depth);
+            depths.push_back((*dsm)[j].depth);
         }
     }
 
-    qsort(&(*depths)[0], depths->size(), sizeof(float), qSortCompareFloatAsc);
+    if(depths.empty())
+        return -1.0f;
 
-    float out = (*depths)[(float)((float)depths->size() * perc)];
+    // only the requested element needs to be in its sorted position
+    const std::size_t index = std::min(depths.size() - 1, static_cast<std::size_t>(static_cast<float>(depths.size()) * perc));
+    std::nth_element(depths.begin(), depths.begin() + index, depths.end());
+
+    return depths[index];
+}
+
+void DepthSimMap::getStep1(float* out, int outWidth, int outHeight, int xFrom, int partW, bool transposed, bool useSim) const
+{
+    // each internal cell is repeated over step x step output pixels
+    const int xEnd = std::min(xFrom + partW, w * step);
+    const int yEnd = std::min(outHeight, h * step);
 
-    delete depths;
+    #pragma omp parallel for
+    for(int yp = 0; yp < yEnd; ++yp)
+    {
+        const DepthSim* row = &(*dsm)[(yp / step) * w];
 
-    return out;
+        if(transposed)
+        {
+            for(int xp = xFrom; xp < xEnd; ++xp)
+                out[(xp - xFrom) * outHeight + yp] = useSim ? row[xp / step].sim : row[xp / step].depth;
+        }
+        else
+        {
+            float* outRow = out + yp * outWidth;
+            int xp = xFrom;
+            while(xp < xEnd)
+            {
+                const DepthSim& depthSim = row[xp / step];
+                const float value = useSim ? depthSim.sim : depthSim.depth;
+                const int runEnd = std::min(xEnd, (xp / step + 1) * step);
+                std::fill(outRow + (xp - xFrom), outRow + (runEnd - xFrom), value);
+                xp = runEnd;
+            }
+        }
+    }
 }
 
 /**
@@ -169,98 +224,55 @@ float DepthSimMap::getPercentileDepth(float perc)
 StaticVector<float>* DepthSimMap::getDepthMapStep1()
 {
 	// Size of our input image (with scale applied)
-    int wdm = mp->getWidth(rc) / scale;
-    int hdm = mp->getHeight(rc) / scale;
+    const int wdm = mp->getWidth(rc) / scale;
+    const int hdm = mp->getHeight(rc) / scale;
 
 	// Create a depth map at the size of our input image
     StaticVector<float>* depthMap = new StaticVector<float>();
-    depthMap->reserve(wdm * hdm);
     depthMap->resize_with(wdm * hdm, -1.0f);
 
-    for(int i = 0; i < wdm * hdm; i++)
-    {
-        int x = (i % wdm) / step;
-        int y = (i / wdm) / step;
-        if((x < w) && (y < h))
-        {
-			// dsm size: (width, height) / (scale*step)
-            float depth = (*dsm)[y * w + x].depth;
-			// depthMap size: (width, height) / scale
-            (*depthMap)[i] = depth;
-        }
-    }
+    // dsm size: (width, height) / (scale*step)
+    // depthMap size: (width, height) / scale
+    getStep1(depthMap->getDataWritable().data(), wdm, hdm, 0, wdm, false, false);
 
     return depthMap;
 }
 
 StaticVector<float>* DepthSimMap::getSimMapStep1()
 {
-    int wdm = mp->getWidth(rc) / scale;
-    int hdm = mp->getHeight(rc) / scale;
+    const int wdm = mp->getWidth(rc) / scale;
+    const int hdm = mp->getHeight(rc) / scale;
 
     StaticVector<float>* simMap = new StaticVector<float>();
-    simMap->reserve(wdm * hdm);
     simMap->resize_with(wdm * hdm, -1.0f);
-    for(int i = 0; i < wdm * hdm; i++)
-    {
-        int x = (i % wdm) / step;
-        int y = (i / wdm) / step;
-        if((x < w) && (y < h))
-        {
-            float sim = (*dsm)[y * w + x].sim;
-            (*simMap)[i] = sim;
-        }
-    }
+
+    getStep1(simMap->getDataWritable().data(), wdm, hdm, 0, wdm, false, true);
 
     return simMap;
 }
 
 StaticVector<float>* DepthSimMap::getDepthMapStep1XPart(int xFrom, int partW)
 {
-    int wdm = mp->getWidth(rc) / scale;
-    int hdm = mp->getHeight(rc) / scale;
+    const int wdm = mp->getWidth(rc) / scale;
+    const int hdm = mp->getHeight(rc) / scale;
 
     StaticVector<float>* depthMap = new StaticVector<float>();
-    depthMap->reserve(wdm * hdm);
     depthMap->resize_with(wdm * hdm, -1.0f);
-    for(int yp = 0; yp < hdm; yp++)
-    {
-        for(int xp = xFrom; xp < xFrom + partW; xp++)
-        {
-            int x = xp / step;
-            int y = yp / step;
-            if((x < w) && (y < h))
-            {
-                float depth = (*dsm)[y * w + x].depth;
-                (*depthMap)[yp * partW + (xp - xFrom)] = depth;
-            }
-        }
-    }
+
+    getStep1(depthMap->getDataWritable().data(), partW, hdm, xFrom, partW, false, false);
 
     return depthMap;
 }
 
 StaticVector<float>* DepthSimMap::getSimMapStep1XPart(int xFrom, int partW)
 {
-    int wdm = mp->getWidth(rc) / scale;
-    int hdm = mp->getHeight(rc) / scale;
+    const int wdm = mp->getWidth(rc) / scale;
+    const int hdm = mp->getHeight(rc) / scale;
 
     StaticVector<float>* simMap = new StaticVector<float>();
-    simMap->reserve(wdm * hdm);
     simMap->resize_with(wdm * hdm, -1.0f);
-    for(int yp = 0; yp < hdm; yp++)
-    {
-        for(int xp = xFrom; xp < xFrom + partW; xp++)
-        {
-            int x = xp / step;
-            int y = yp / step;
-            if((x < w) && (y < h))
-            {
-                float sim = (*dsm)[y * w + x].sim;
-                (*simMap)[yp * partW + (xp - xFrom)] = sim;
-            }
-        }
-    }
+
+    getStep1(simMap->getDataWritable().data(), partW, hdm, xFrom, partW, false, true);
 
     return simMap;
 }
@@ -269,6 +281,7 @@ void DepthSimMap::initJustFromDepthMapT(StaticVector<float>* depthMapT, float de
 {
     int hdm = mp->getHeight(rc) / scale;
 
+    #pragma omp parallel for
     for(int i = 0; i < dsm->size(); i++)
     {
         int x = (i % w) * step;
@@ -285,6 +298,7 @@ void DepthSimMap::initJustFromDepthMap(StaticVector<float>* depthMap, float defa
 {
     int wdm = mp->getWidth(rc) / scale;
 
+    #pragma omp parallel for
     for(int i = 0; i < dsm->size(); i++)
     {
         int x = (i % w) * step;
@@ -303,6 +317,7 @@ void DepthSimMap::initFromDepthMapTAndSimMapT(StaticVector<float>* depthMapT, St
     int wdm = mp->getWidth(rc) / depthSimMapsScale;
     int hdm = mp->getHeight(rc) / depthSimMapsScale;
 
+    #pragma omp parallel for
     for(int i = 0; i < dsm->size(); i++)
     {
         int x = (((i % w) * step) * scale) / depthSimMapsScale;
@@ -317,22 +332,13 @@ void DepthSimMap::initFromDepthMapTAndSimMapT(StaticVector<float>* depthMapT, St
 
 StaticVector<float>* DepthSimMap::getDepthMapTStep1()
 {
-    int wdm = mp->getWidth(rc) / scale;
-    int hdm = mp->getHeight(rc) / scale;
+    const int wdm = mp->getWidth(rc) / scale;
+    const int hdm = mp->getHeight(rc) / scale;
 
     StaticVector<float>* depthMap = new StaticVector<float>();
-    depthMap->reserve(wdm * hdm);
     depthMap->resize_with(wdm * hdm, -1.0f);
-    for(int i = 0; i < wdm * hdm; i++)
-    {
-        int x = (i / hdm) / step;
-        int y = (i % hdm) / step;
-        if((x < w) && (y < h))
-        {
-            float depth = (*dsm)[y * w + x].depth;
-            (*depthMap)[i] = depth;
-        }
-    }
+
+    getStep1(depthMap->getDataWritable().data(), wdm, hdm, 0, wdm, true, false);
 
     return depthMap;
 }
@@ -340,10 +346,12 @@ StaticVector<float>* DepthSimMap::getDepthMapTStep1()
 StaticVector<float>* DepthSimMap::getDepthMap()
 {
     StaticVector<float>* depthMap = new StaticVector<float>();
-    depthMap->reserve(dsm->size());
+    depthMap->resize(dsm->size());
+
+    #pragma omp parallel for
     for(int i = 0; i < dsm->size(); i++)
     {
-        depthMap->push_back((*dsm)[i].depth);
+        (*depthMap)[i] = (*dsm)[i].depth;
     }
     return depthMap;
 }
@@ -371,6 +379,7 @@ void DepthSimMap::saveToImage(std::string filename, float simThr)
                 ALICEVISION_LOG_DEBUG("saveToImage: max : " << maxMinSim.x << ", min: " << maxMinSim.y);
         }
 
+        #pragma omp parallel for
         for(int y = 0; y < h; y++)
         {
             for(int x = 0; x < w; x++)
@@ -446,6 +455,7 @@ void DepthSimMap::saveRefine(int rc, std::string depthMapFileName, std::string s
     std::vector<float> depthMap(size);
     std::vector<float> simMap(size);
 
+    #pragma omp parallel for
     for(int i = 0; i < dsm->size(); ++i)
     {
         depthMap.at(i) = (*dsm)[i].depth;
@@ -71,7 +71,7 @@ public:
     Point2d getMaxMinDepth() const;
     Point2d getMaxMinSim() const;
 
-    float getPercentileDepth(float perc);
+    float getPercentileDepth(float perc) const;
     StaticVector<float>* getDepthMapStep1();
     StaticVector<float>* getDepthMapTStep1();
     StaticVector<float>* getSimMapStep1();
@@ -87,6 +87,19 @@ public:
 
     float getCellSmoothStep(int rc, const int cellId);
     float getCellSmoothStep(int rc, const Pixel& cell);
+
+private:
+    /**
+     * @brief Upsample the depth or sim values to step 1 (with scale applied)
+     * @param[out] out output buffer of size outWidth * outHeight, pixels out of the internal map are not written
+     * @param[in] outWidth output row size
+     * @param[in] outHeight output number of rows
+     * @param[in] xFrom first output column in the step 1 map
+     * @param[in] partW number of output columns
+     * @param[in] transposed true to write a column major output buffer
+     * @param[in] useSim true to output the sim values instead of the depth values
+     */
+    void getStep1(float* out, int outWidth, int outHeight, int xFrom, int partW, bool transposed, bool useSim) const;
 };
 
 } // namespace depthMap
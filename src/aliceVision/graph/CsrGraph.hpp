@@ -0,0 +1,439 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/graph/Triplet.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace graph {
+
+/**
+ * @brief Compact undirected graph stored in Compressed Sparse Row layout.
+ *
+ * Nodes are the sorted unique ids found in the input, remapped to dense indices in [0, nbNodes()).
+ * Self-loops and duplicated edges (i,j) / (j,i) are removed at construction.
+ * Each undirected edge has a dense index in [0, nbEdges()) and appears twice in the adjacency array.
+ */
+class CsrGraph
+{
+public:
+  CsrGraph() = default;
+
+  /**
+   * @brief Build the graph from a list of pairs, nodes are the pairs extremities
+   * @param[in] pairs iterable container of std::pair<IndexT, IndexT>
+   */
+  template <typename IterablePairs>
+  explicit CsrGraph(const IterablePairs& pairs)
+  {
+    std::vector<IndexT> nodes;
+    nodes.reserve(2 * pairs.size());
+    for(const auto& pair : pairs)
+    {
+      nodes.push_back(pair.first);
+      nodes.push_back(pair.second);
+    }
+    build(std::move(nodes), PairVec(pairs.begin(), pairs.end()));
+  }
+
+  /**
+   * @brief Build the graph from a list of nodes and a list of pairs
+   * @param[in] nodes iterable container of node ids
+   * @param[in] pairs iterable container of std::pair<IndexT, IndexT>, pairs with unknown nodes are ignored
+   */
+  template <typename IterableNodes, typename IterablePairs>
+  CsrGraph(const IterableNodes& nodes, const IterablePairs& pairs)
+  {
+    build(std::vector<IndexT>(nodes.begin(), nodes.end()), PairVec(pairs.begin(), pairs.end()));
+  }
+
+  inline std::size_t nbNodes() const { return _nodeIds.size(); }
+  inline std::size_t nbEdges() const { return _edges.size(); }
+
+  /// Original id of a dense node index
+  inline IndexT nodeId(std::size_t node) const { return _nodeIds[node]; }
+
+  /// Dense node index of an original id, UndefinedIndexT if the id is not in the graph
+  inline IndexT nodeIndex(IndexT id) const
+  {
+    const auto it = std::lower_bound(_nodeIds.begin(), _nodeIds.end(), id);
+    return (it != _nodeIds.end() && *it == id) ? static_cast<IndexT>(it - _nodeIds.begin()) : UndefinedIndexT;
+  }
+
+  /// Dense node indexes (first < second) of an edge
+  inline const Pair& edge(std::size_t e) const { return _edges[e]; }
+
+  inline std::size_t degree(std::size_t node) const { return _offsets[node + 1] - _offsets[node]; }
+
+  /// Sorted neighbors of a node: [neighborsBegin, neighborsEnd)
+  inline const IndexT* neighborsBegin(std::size_t node) const { return _adjacency.data() + _offsets[node]; }
+  inline const IndexT* neighborsEnd(std::size_t node) const { return _adjacency.data() + _offsets[node + 1]; }
+
+  /// Edge indexes matching [neighborsBegin, neighborsEnd)
+  inline const IndexT* neighborEdgesBegin(std::size_t node) const { return _adjacencyEdge.data() + _offsets[node]; }
+
+  /**
+   * @brief Label the connected components of the graph (lock-free parallel union-find).
+   * @param[out] labels component label per dense node, labels are sorted by decreasing component size
+   * @param[in] removedEdges optional per-edge flags, flagged edges are ignored
+   * @return the number of connected components
+   */
+  std::size_t connectedComponents(std::vector<IndexT>& labels, const std::vector<bool>& removedEdges = {}) const
+  {
+    const std::size_t nNodes = nbNodes();
+    std::vector<std::atomic<IndexT>> parent(nNodes);
+
+    #pragma omp parallel for
+    for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nNodes); ++i)
+      parent[i].store(static_cast<IndexT>(i), std::memory_order_relaxed);
+
+    #pragma omp parallel for
+    for(std::ptrdiff_t e = 0; e < static_cast<std::ptrdiff_t>(nbEdges()); ++e)
+    {
+      if(!removedEdges.empty() && removedEdges[e])
+        continue;
+      unite(parent, _edges[e].first, _edges[e].second);
+    }
+
+    labels.resize(nNodes);
+
+    #pragma omp parallel for
+    for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nNodes); ++i)
+      labels[i] = findRoot(parent, static_cast<IndexT>(i));
+
+    // relabel roots by decreasing component size (ties broken by smallest node index)
+    std::vector<std::size_t> rootSize(nNodes, 0);
+    for(std::size_t i = 0; i < nNodes; ++i)
+      ++rootSize[labels[i]];
+
+    std::vector<IndexT> roots;
+    for(std::size_t i = 0; i < nNodes; ++i)
+      if(labels[i] == i)
+        roots.push_back(static_cast<IndexT>(i));
+
+    std::stable_sort(roots.begin(), roots.end(), [&](IndexT a, IndexT b){ return rootSize[a] > rootSize[b]; });
+
+    std::vector<IndexT> rootLabel(nNodes, UndefinedIndexT);
+    for(std::size_t c = 0; c < roots.size(); ++c)
+      rootLabel[roots[c]] = static_cast<IndexT>(c);
+
+    #pragma omp parallel for
+    for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nNodes); ++i)
+      labels[i] = rootLabel[labels[i]];
+
+    return roots.size();
+  }
+
+  /**
+   * @brief Find the bridges of the graph (edges whose removal increases the number of connected components).
+   * Iterative Tarjan low-link traversal.
+   * @return per-edge flags, true if the edge is a bridge
+   */
+  std::vector<bool> bridges() const
+  {
+    const std::size_t nNodes = nbNodes();
+    std::vector<bool> isBridge(nbEdges(), false);
+    std::vector<IndexT> order(nNodes, UndefinedIndexT);
+    std::vector<IndexT> low(nNodes, 0);
+
+    struct Frame
+    {
+      IndexT node;
+      IndexT parentEdge;
+      std::size_t next;
+    };
+    std::vector<Frame> stack;
+    IndexT counter = 0;
+
+    for(std::size_t start = 0; start < nNodes; ++start)
+    {
+      if(order[start] != UndefinedIndexT)
+        continue;
+
+      order[start] = low[start] = counter++;
+      stack.push_back({static_cast<IndexT>(start), UndefinedIndexT, _offsets[start]});
+
+      while(!stack.empty())
+      {
+        Frame& frame = stack.back();
+        const IndexT u = frame.node;
+
+        if(frame.next < _offsets[u + 1])
+        {
+          const IndexT v = _adjacency[frame.next];
+          const IndexT e = _adjacencyEdge[frame.next];
+          ++frame.next;
+
+          if(e == frame.parentEdge)
+            continue;
+
+          if(order[v] == UndefinedIndexT)
+          {
+            order[v] = low[v] = counter++;
+            stack.push_back({v, e, _offsets[v]});
+          }
+          else
+          {
+            low[u] = std::min(low[u], order[v]);
+          }
+        }
+        else
+        {
+          const IndexT parentEdge = frame.parentEdge;
+          stack.pop_back();
+
+          if(!stack.empty())
+          {
+            const IndexT p = stack.back().node;
+            low[p] = std::min(low[p], low[u]);
+            if(low[u] > order[p])
+              isBridge[parentEdge] = true;
+          }
+        }
+      }
+    }
+    return isBridge;
+  }
+
+  /**
+   * @brief Get the original ids of the nodes that belong to the largest connected component
+   * @param[in] removedEdges optional per-edge flags, flagged edges are ignored
+   */
+  std::set<IndexT> largestConnectedComponent(const std::vector<bool>& removedEdges = {}) const
+  {
+    std::set<IndexT> nodes;
+    std::vector<IndexT> labels;
+
+    if(connectedComponents(labels, removedEdges) == 0)
+      return nodes;
+
+    for(std::size_t i = 0; i < nbNodes(); ++i)
+      if(labels[i] == 0)
+        nodes.insert(nodes.end(), _nodeIds[i]);
+
+    return nodes;
+  }
+
+  /**
+   * @brief List all the triangles of the graph (parallel degree-ordered forward algorithm)
+   * @return triplets of original node ids (i < j < k), sorted in lexicographic order
+   */
+  std::vector<Triplet> triplets() const
+  {
+    const std::size_t nNodes = nbNodes();
+
+    // orient each edge from lower to higher (degree, index) rank
+    const auto rankLess = [this](IndexT a, IndexT b)
+    {
+      return degree(a) < degree(b) || (degree(a) == degree(b) && a < b);
+    };
+
+    std::vector<std::size_t> forwardOffsets(nNodes + 1, 0);
+    for(const Pair& e : _edges)
+      ++forwardOffsets[(rankLess(e.first, e.second) ? e.first : e.second) + 1];
+    for(std::size_t i = 0; i < nNodes; ++i)
+      forwardOffsets[i + 1] += forwardOffsets[i];
+
+    std::vector<IndexT> forward(_edges.size());
+    {
+      std::vector<std::size_t> cursor(forwardOffsets.begin(), forwardOffsets.end() - 1);
+      for(const Pair& e : _edges)
+      {
+        if(rankLess(e.first, e.second))
+          forward[cursor[e.first]++] = e.second;
+        else
+          forward[cursor[e.second]++] = e.first;
+      }
+    }
+
+    std::vector<std::vector<Triplet>> tripletsPerThread(omp_get_max_threads());
+
+    #pragma omp parallel
+    {
+      std::vector<bool> marked(nNodes, false);
+      std::vector<Triplet>& localTriplets = tripletsPerThread[omp_get_thread_num()];
+
+      #pragma omp for schedule(dynamic)
+      for(std::ptrdiff_t u = 0; u < static_cast<std::ptrdiff_t>(nNodes); ++u)
+      {
+        for(std::size_t a = forwardOffsets[u]; a < forwardOffsets[u + 1]; ++a)
+          marked[forward[a]] = true;
+
+        for(std::size_t a = forwardOffsets[u]; a < forwardOffsets[u + 1]; ++a)
+        {
+          const IndexT v = forward[a];
+          for(std::size_t b = forwardOffsets[v]; b < forwardOffsets[v + 1]; ++b)
+          {
+            const IndexT w = forward[b];
+            if(!marked[w])
+              continue;
+
+            IndexT triplet[3] = {_nodeIds[u], _nodeIds[v], _nodeIds[w]};
+            std::sort(&triplet[0], &triplet[3]);
+            localTriplets.emplace_back(triplet[0], triplet[1], triplet[2]);
+          }
+        }
+
+        for(std::size_t a = forwardOffsets[u]; a < forwardOffsets[u + 1]; ++a)
+          marked[forward[a]] = false;
+      }
+    }
+
+    std::vector<Triplet> triplets;
+    for(const auto& localTriplets : tripletsPerThread)
+      triplets.insert(triplets.end(), localTriplets.begin(), localTriplets.end());
+
+    std::sort(triplets.begin(), triplets.end(), [](const Triplet& a, const Triplet& b)
+    {
+      return std::tie(a.i, a.j, a.k) < std::tie(b.i, b.j, b.k);
+    });
+    return triplets;
+  }
+
+private:
+
+  void build(std::vector<IndexT>&& nodes, PairVec&& pairs)
+  {
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    _nodeIds = std::move(nodes);
+
+    const std::size_t nNodes = _nodeIds.size();
+
+    // remap pairs to dense indexes, (first < second), invalid pairs are marked with UndefinedIndexT
+    #pragma omp parallel for
+    for(std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(pairs.size()); ++p)
+    {
+      Pair& pair = pairs[p];
+      const IndexT i = nodeIndex(pair.first);
+      const IndexT j = nodeIndex(pair.second);
+
+      if(i == UndefinedIndexT || j == UndefinedIndexT || i == j)
+        pair = Pair(UndefinedIndexT, UndefinedIndexT);
+      else
+        pair = Pair(std::min(i, j), std::max(i, j));
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    if(!pairs.empty() && pairs.back().first == UndefinedIndexT)
+      pairs.pop_back();
+    _edges = std::move(pairs);
+
+    // count degrees
+    std::vector<std::atomic<std::size_t>> cursor(nNodes);
+    for(auto& c : cursor)
+      c.store(0, std::memory_order_relaxed);
+
+    #pragma omp parallel for
+    for(std::ptrdiff_t e = 0; e < static_cast<std::ptrdiff_t>(_edges.size()); ++e)
+    {
+      cursor[_edges[e].first].fetch_add(1, std::memory_order_relaxed);
+      cursor[_edges[e].second].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    _offsets.assign(nNodes + 1, 0);
+    for(std::size_t i = 0; i < nNodes; ++i)
+    {
+      _offsets[i + 1] = _offsets[i] + cursor[i].load(std::memory_order_relaxed);
+      cursor[i].store(_offsets[i], std::memory_order_relaxed);
+    }
+
+    // fill adjacency
+    _adjacency.resize(2 * _edges.size());
+    _adjacencyEdge.resize(2 * _edges.size());
+
+    #pragma omp parallel for
+    for(std::ptrdiff_t e = 0; e < static_cast<std::ptrdiff_t>(_edges.size()); ++e)
+    {
+      const Pair& edge = _edges[e];
+      const std::size_t slotFirst = cursor[edge.first].fetch_add(1, std::memory_order_relaxed);
+      const std::size_t slotSecond = cursor[edge.second].fetch_add(1, std::memory_order_relaxed);
+      _adjacency[slotFirst] = edge.second;
+      _adjacencyEdge[slotFirst] = static_cast<IndexT>(e);
+      _adjacency[slotSecond] = edge.first;
+      _adjacencyEdge[slotSecond] = static_cast<IndexT>(e);
+    }
+
+    // sort each adjacency list to get a deterministic layout
+    #pragma omp parallel for schedule(dynamic)
+    for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nNodes); ++i)
+    {
+      const std::size_t begin = _offsets[i];
+      const std::size_t end = _offsets[i + 1];
+      std::vector<std::pair<IndexT, IndexT>> slots(end - begin);
+      for(std::size_t s = begin; s < end; ++s)
+        slots[s - begin] = std::make_pair(_adjacency[s], _adjacencyEdge[s]);
+      std::sort(slots.begin(), slots.end());
+      for(std::size_t s = begin; s < end; ++s)
+      {
+        _adjacency[s] = slots[s - begin].first;
+        _adjacencyEdge[s] = slots[s - begin].second;
+      }
+    }
+  }
+
+  static IndexT findRoot(std::vector<std::atomic<IndexT>>& parent, IndexT x)
+  {
+    while(true)
+    {
+      IndexT p = parent[x].load(std::memory_order_relaxed);
+      if(p == x)
+        return x;
+      const IndexT gp = parent[p].load(std::memory_order_relaxed);
+      if(p != gp)
+        parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed); // path halving
+      x = gp;
+    }
+  }
+
+  static void unite(std::vector<std::atomic<IndexT>>& parent, IndexT a, IndexT b)
+  {
+    while(true)
+    {
+      a = findRoot(parent, a);
+      b = findRoot(parent, b);
+      if(a == b)
+        return;
+      // always link the larger root under the smaller one to avoid cycles
+      if(a < b)
+        std::swap(a, b);
+      IndexT expected = a;
+      if(parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+        return;
+    }
+  }
+
+  /// sorted original node ids
+  std::vector<IndexT> _nodeIds;
+  /// adjacency offsets per node (nbNodes + 1)
+  std::vector<std::size_t> _offsets;
+  /// neighbor node per adjacency slot
+  std::vector<IndexT> _adjacency;
+  /// edge index per adjacency slot
+  std::vector<IndexT> _adjacencyEdge;
+  /// undirected edges (first < second)
+  PairVec _edges;
+};
+
+/// Return triplets contained in the graph build from IterablePairs
+template <typename IterablePairs>
+inline std::vector<graph::Triplet> tripletListing(const IterablePairs& pairs)
+{
+  return CsrGraph(pairs).triplets();
+}
+
+} // namespace graph
+} // namespace aliceVision
@@ -11,6 +11,7 @@
 #include <aliceVision/types.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/graph/graph.hpp>
+#include <aliceVision/graph/CsrGraph.hpp>
 
 #include <set>
 
@@ -44,90 +45,40 @@ std::set<IndexT> CleanGraph_KeepLargestBiEdge_Nodes(
   const EdgesInterface_T & edges,
   const std::string & _sOutDirectory = "")
 {
-  std::set<IndexT> largestBiEdgeCC;
-
   // Create a graph from pairwise correspondences:
   // - remove not biedge connected component,
   // - keep the largest connected component.
 
-  typedef lemon::ListGraph Graph;
-  graph::indexedGraph putativeGraph(edges);
+  const CsrGraph putativeGraph(edges);
 
   // Remove not bi-edge connected edges
-  typedef Graph::EdgeMap<bool> EdgeMapAlias;
-  EdgeMapAlias cutMap(putativeGraph.g);
-
-  if (lemon::biEdgeConnectedCutEdges(putativeGraph.g, cutMap) > 0)
-  {
-    // Some edges must be removed because they don't follow the biEdge condition.
-    typedef Graph::EdgeIt EdgeIterator;
-    EdgeIterator itEdge(putativeGraph.g);
-    for (EdgeMapAlias::MapIt it(cutMap); it!=lemon::INVALID; ++it, ++itEdge)
-    {
-      if (*it)
-        putativeGraph.g.erase(itEdge); // remove the not bi-edge element
-    }
-  }
+  const std::vector<bool> cutEdges = putativeGraph.bridges();
 
   // Graph is bi-edge connected, but still many connected components can exist
   // Keep only the largest one
-  const int connectedComponentCount = lemon::countConnectedComponents(putativeGraph.g);
+  std::vector<aliceVision::IndexT> labels;
+  const std::size_t connectedComponentCount = putativeGraph.connectedComponents(labels, cutEdges);
   ALICEVISION_LOG_DEBUG("CleanGraph_KeepLargestBiEdge_Nodes():: => connected Component: "
     << connectedComponentCount);
-  if (connectedComponentCount >= 1)
+
+  std::set<IndexT> largestBiEdgeCC;
+  std::size_t nbEdges = 0;
+
+  for(std::size_t i = 0; i < putativeGraph.nbNodes(); ++i)
+  {
+    if(labels[i] == 0)
+      largestBiEdgeCC.insert(largestBiEdgeCC.end(), putativeGraph.nodeId(i));
+  }
+
+  for(std::size_t e = 0; e < putativeGraph.nbEdges(); ++e)
   {
-    // Keep only the largest connected component
-    // - list all CC size
-    // - if the largest one is meet, keep all the edges that belong to this node
-
-    const std::map<IndexT, std::set<Graph::Node> > map_subgraphs = exportGraphToMapSubgraphs<Graph,IndexT>(putativeGraph.g);
-    size_t count = std::numeric_limits<size_t>::min();
-    typename std::map<IndexT, std::set<Graph::Node> >::const_iterator iterLargestCC = map_subgraphs.end();
-    for(typename std::map<IndexT, std::set<Graph::Node> >::const_iterator iter = map_subgraphs.begin();
-        iter != map_subgraphs.end(); ++iter)
-    {
-      if (iter->second.size() > count)  {
-        count = iter->second.size();
-        iterLargestCC = iter;
-      }
-      ALICEVISION_LOG_DEBUG("Connected component of size: " << iter->second.size());
-    }
-
-    //-- Keep only the nodes that are in the largest CC
-    for(typename std::map<IndexT, std::set<lemon::ListGraph::Node> >::const_iterator iter = map_subgraphs.begin();
-        iter != map_subgraphs.end(); ++iter)
-    {
-      if (iter == iterLargestCC)
-      {
-        // list all nodes that belong to the current CC and update the Node Ids list
-        const std::set<lemon::ListGraph::Node> & ccSet = iter->second;
-        for (std::set<lemon::ListGraph::Node>::const_iterator iter2 = ccSet.begin();
-          iter2 != ccSet.end(); ++iter2)
-        {
-          const IndexT Id = (*putativeGraph.map_nodeMapIndex)[*iter2];
-          largestBiEdgeCC.insert(Id);
-        }
-      }
-      else
-      {
-        // remove the edges from the graph
-        const std::set<lemon::ListGraph::Node> & ccSet = iter->second;
-        for (std::set<lemon::ListGraph::Node>::const_iterator iter2 = ccSet.begin();
-          iter2 != ccSet.end(); ++iter2)
-        {
-          typedef Graph::OutArcIt OutArcIt;
-          for (OutArcIt e(putativeGraph.g, *iter2); e!=lemon::INVALID; ++e)
-          {
-            putativeGraph.g.erase(e);
-          }
-        }
-      }
-    }
+    if(!cutEdges[e] && labels[putativeGraph.edge(e).first] == 0)
+      ++nbEdges;
   }
 
   ALICEVISION_LOG_DEBUG(
-    "Cardinal of nodes: " << lemon::countNodes(putativeGraph.g) << "\n" <<
-    "Cardinal of edges: " << lemon::countEdges(putativeGraph.g)
+    "Cardinal of nodes: " << largestBiEdgeCC.size() << "\n" <<
+    "Cardinal of edges: " << nbEdges
     );
 
   return largestBiEdgeCC;
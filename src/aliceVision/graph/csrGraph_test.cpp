@@ -0,0 +1,136 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/graph/graph.hpp"
+
+#include <iostream>
+#include <vector>
+
+#define BOOST_TEST_MODULE csrGraph
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::graph;
+
+BOOST_AUTO_TEST_CASE(CsrGraph_Empty)
+{
+  const CsrGraph graph{PairSet()};
+
+  BOOST_CHECK_EQUAL(0, graph.nbNodes());
+  BOOST_CHECK_EQUAL(0, graph.nbEdges());
+
+  std::vector<IndexT> labels;
+  BOOST_CHECK_EQUAL(0, graph.connectedComponents(labels));
+  BOOST_CHECK(graph.triplets().empty());
+}
+
+BOOST_AUTO_TEST_CASE(CsrGraph_Construction)
+{
+  // duplicated edges and self-loops are removed
+  const PairVec pairs = {{10, 20}, {20, 10}, {20, 30}, {30, 30}, {30, 10}};
+  const CsrGraph graph(pairs);
+
+  BOOST_CHECK_EQUAL(3, graph.nbNodes());
+  BOOST_CHECK_EQUAL(3, graph.nbEdges());
+  BOOST_CHECK_EQUAL(10, graph.nodeId(0));
+  BOOST_CHECK_EQUAL(2, graph.nodeIndex(30));
+  BOOST_CHECK_EQUAL(UndefinedIndexT, graph.nodeIndex(40));
+
+  for(std::size_t i = 0; i < graph.nbNodes(); ++i)
+    BOOST_CHECK_EQUAL(2, graph.degree(i));
+
+  // isolated nodes are kept when nodes are given explicitly
+  const std::set<IndexT> nodes = {10, 20, 30, 40};
+  const CsrGraph graphWithNodes(nodes, pairs);
+
+  BOOST_CHECK_EQUAL(4, graphWithNodes.nbNodes());
+  BOOST_CHECK_EQUAL(0, graphWithNodes.degree(graphWithNodes.nodeIndex(40)));
+}
+
+/// Connected components sorted by decreasing size
+// a
+//
+// b-c
+//
+// d-g
+// | |
+// e-f
+//
+// h-i-j-k
+//   |/
+//   l
+BOOST_AUTO_TEST_CASE(CsrGraph_ConnectedComponents)
+{
+  const std::set<IndexT> nodes = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+  const PairSet pairs = {{1, 2},
+                         {3, 4}, {4, 5}, {5, 6}, {6, 3},
+                         {7, 8}, {8, 9}, {9, 10}, {8, 11}, {9, 11}};
+  const CsrGraph graph(nodes, pairs);
+
+  std::vector<IndexT> labels;
+  BOOST_CHECK_EQUAL(4, graph.connectedComponents(labels));
+
+  std::vector<std::size_t> sizes(4, 0);
+  for(IndexT label : labels)
+    ++sizes.at(label);
+
+  BOOST_CHECK_EQUAL(5, sizes[0]);
+  BOOST_CHECK_EQUAL(4, sizes[1]);
+  BOOST_CHECK_EQUAL(2, sizes[2]);
+  BOOST_CHECK_EQUAL(1, sizes[3]);
+
+  const std::set<IndexT> largestCC = graph.largestConnectedComponent();
+  BOOST_CHECK(largestCC == std::set<IndexT>({7, 8, 9, 10, 11}));
+}
+
+BOOST_AUTO_TEST_CASE(CsrGraph_Bridges)
+{
+  // a-b-c
+  //   |/
+  //   d-e
+  const PairSet pairs = {{0, 1}, {1, 2}, {1, 3}, {2, 3}, {3, 4}};
+  const CsrGraph graph(pairs);
+
+  const std::vector<bool> bridges = graph.bridges();
+  std::set<Pair> bridgeEdges;
+  for(std::size_t e = 0; e < graph.nbEdges(); ++e)
+    if(bridges[e])
+      bridgeEdges.insert(graph.edge(e));
+
+  BOOST_CHECK(bridgeEdges == std::set<Pair>({{0, 1}, {3, 4}}));
+
+  // largest bi-edge connected component
+  BOOST_CHECK(graph.largestConnectedComponent(bridges) == std::set<IndexT>({1, 2, 3}));
+  BOOST_CHECK((CleanGraph_KeepLargestBiEdge_Nodes<PairSet, IndexT>(pairs) == std::set<IndexT>({1, 2, 3})));
+}
+
+BOOST_AUTO_TEST_CASE(CsrGraph_Triplets)
+{
+  // a__b
+  // |\/|
+  // |/\|
+  // c--d
+  const PairSet pairs = {{0, 1}, {0, 2}, {0, 3}, {2, 3}, {1, 3}, {2, 1}};
+  const std::vector<Triplet> triplets = tripletListing(pairs);
+
+  BOOST_CHECK_EQUAL(4, triplets.size());
+  BOOST_CHECK(triplets[0] == Triplet(0, 1, 2));
+  BOOST_CHECK(triplets[1] == Triplet(0, 1, 3));
+  BOOST_CHECK(triplets[2] == Triplet(0, 2, 3));
+  BOOST_CHECK(triplets[3] == Triplet(1, 2, 3));
+
+  // a_b__c
+  //    |/
+  //    d
+  const PairSet pairs2 = {{10, 11}, {11, 12}, {11, 13}, {12, 13}};
+  const std::vector<Triplet> triplets2 = tripletListing(pairs2);
+
+  BOOST_CHECK_EQUAL(1, triplets2.size());
+  BOOST_CHECK_EQUAL(11, triplets2[0].i);
+  BOOST_CHECK_EQUAL(12, triplets2[0].j);
+  BOOST_CHECK_EQUAL(13, triplets2[0].k);
+}
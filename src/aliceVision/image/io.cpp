@@ -325,7 +325,8 @@ void writeImage(const std::string& path,
                 int nchannels,
                 const Image<T>& image,
                 EImageColorSpace imageColorSpace,
-                const oiio::ParamValueList& metadata = oiio::ParamValueList())
+                const oiio::ParamValueList& metadata = oiio::ParamValueList(),
+                bool mipmaps = false)
 {
   const fs::path bPath = fs::path(path);
   const std::string extension = bPath.extension().string();
@@ -360,6 +361,25 @@ void writeImage(const std::string& path,
     outBuf = &colorspaceBuf;
   }
 
+  if(mipmaps && isEXR)
+  {
+    // write a tiled EXR with all the resolution levels
+    oiio::ImageSpec configSpec;
+    configSpec.format = oiio::TypeDesc::HALF;                     // use half instead of float
+    configSpec.attribute("maketx:filtername", "blackman-harris"); // downsampling filter for the resolution levels
+    configSpec.attribute("compression", "piz");
+
+    if(!oiio::ImageBufAlgo::make_texture(oiio::ImageBufAlgo::MakeTxTexture, *outBuf, tmpPath, configSpec))
+      throw std::runtime_error("Can't write output image file '" + path + "'.");
+
+    // rename temporay filename
+    fs::rename(tmpPath, path);
+    return;
+  }
+
+  if(mipmaps)
+    ALICEVISION_LOG_WARNING("Cannot save resolution levels in image file '" << path << "', only supported for '.exr' file type.");
+
   oiio::ImageBuf formatBuf;  // buffer for image format modification
   if(isEXR)
   {
@@ -435,5 +455,10 @@ void writeImage(const std::string& path, const Image<RGBColor>& image, EImageCol
   writeImage(path, oiio::TypeDesc::UINT8, 3, image, imageColorSpace, metadata);
 }
 
+void writeImageWithMipmaps(const std::string& path, const Image<RGBfColor>& image, EImageColorSpace imageColorSpace, const oiio::ParamValueList& metadata)
+{
+  writeImage(path, oiio::TypeDesc::FLOAT, 3, image, imageColorSpace, metadata, true);
+}
+
 }  // namespace image
 }  // namespace aliceVision
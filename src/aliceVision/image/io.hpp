@@ -154,5 +154,14 @@ void writeImage(const std::string& path, const Image<RGBAColor>& image, EImageCo
 void writeImage(const std::string& path, const Image<RGBfColor>& image, EImageColorSpace imageColorSpace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
 void writeImage(const std::string& path, const Image<RGBColor>& image, EImageColorSpace imageColorSpace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
 
+/**
+ * @brief write an image with a given path and buffer, with all its resolution levels (mipmaps)
+ *        The resolution levels are only written for EXR files (tiled half float, piz compression),
+ *        other file types are written as with writeImage.
+ * @param[in] path The given path to the image
+ * @param[in] image The output image buffer
+ */
+void writeImageWithMipmaps(const std::string& path, const Image<RGBfColor>& image, EImageColorSpace imageColorSpace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
+
 }  // namespace image
 }  // namespace aliceVision
@@ -11,6 +11,7 @@
 #include <aliceVision/rig/ResidualError.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
@@ -20,6 +21,8 @@
 #include <boost/accumulators/statistics/max.hpp>
 #include <boost/accumulators/statistics/sum.hpp>
 
+#include <algorithm>
+
 namespace aliceVision{
 namespace localization{
 
@@ -243,9 +246,9 @@ bool refineSequence(std::vector<LocalizationResult> & vec_localizationResult,
   {
     auto &landmarks = tinyScene.structure;
     auto iter = landmarks.begin();
-    auto endIter = landmarks.end();
 
-    for(; iter != endIter;)
+    // erase moves the last landmark to the erased position: the end must be read at each iteration
+    while(iter != landmarks.end())
     {
       if(iter->second.observations.size() < minPointVisibility)
       {
@@ -344,136 +347,29 @@ bool refineRigPose(const std::vector<geometry::Pose3 > &vec_subPoses,
 {
   const std::size_t numCameras = vec_localizationResults.size();
   assert(vec_subPoses.size() == numCameras - 1);
-  
-  ceres::Problem problem;
-  
-  const aliceVision::Mat3 & R = rigPose.rotation();
-  const aliceVision::Vec3 & t = rigPose.translation();
 
-  double mainPose[6];
-  ceres::RotationMatrixToAngleAxis((const double*)R.data(), mainPose);
-
-  mainPose[3] = t(0);
-  mainPose[4] = t(1);
-  mainPose[5] = t(2);
-  problem.AddParameterBlock(mainPose, 6);
-
-
-  // Set a LossFunction to be less penalized by false measurements
-  //  - set it to NULL if you don't want use a lossFunction.
-  ceres::LossFunction * p_LossFunction = nullptr;//new ceres::HuberLoss(Square(4.0));
-  // todo: make the LOSS function and the parameter an option
+  std::vector<Mat> pts2d(numCameras);
+  std::vector<Mat> pts3d(numCameras);
+  std::vector<std::vector<std::size_t> > inliers(numCameras);
+  std::vector<camera::PinholeRadialK3 > vec_queryIntrinsics;
+  vec_queryIntrinsics.reserve(numCameras);
 
-  // For all visibility add reprojections errors:
   for(std::size_t iLocalizer = 0; iLocalizer < numCameras; ++iLocalizer)
   {
     const localization::LocalizationResult & localizationResult = vec_localizationResults[iLocalizer];
+    vec_queryIntrinsics.push_back(localizationResult.getIntrinsics());
 
     if(!localizationResult.isValid())
     {
       ALICEVISION_LOG_DEBUG("Skipping camera " << iLocalizer << " as it has not been localized");
       continue;
     }
-    // Get the inliers 3D points
-    const Mat & points3D = localizationResult.getPt3D();
-    // Get their image locations (also referred as observations)
-    const Mat & points2D = localizationResult.getPt2D();
-
-    // Add a residual block for all inliers
-    for(const IndexT iPoint : localizationResult.getInliers())
-    {
-      assert(iPoint < points2D.cols());
-      assert(iPoint < points3D.cols());
-      
-      // Each Residual block takes a point and a camera as input and outputs a 2
-      // dimensional residual. Internally, the cost function stores the observations
-      // and the 3D point and compares the reprojection against the observation.
-      ceres::CostFunction* cost_function;
-
-      // Vector-2 residual, pose of the rig parameterized by 6 parameters
-      //                  + relative pose of the secondary camera parameterized by 6 parameters
-      
-      geometry::Pose3 subPose;
-      // if it is not the main camera (whose subpose is the identity)
-      if(iLocalizer != 0)
-      {
-        subPose = vec_subPoses[iLocalizer - 1];
-      }
-
-      cost_function = new ceres::AutoDiffCostFunction<rig::ResidualErrorSecondaryCameraFixedRelativeFunctor, 2, 6>(
-              new rig::ResidualErrorSecondaryCameraFixedRelativeFunctor(localizationResult.getIntrinsics(),
-                                                                   points2D.col(iPoint),
-                                                                   points3D.col(iPoint),
-                                                                   subPose));
-
-      if(cost_function)
-      {
-        problem.AddResidualBlock(cost_function,
-                                 p_LossFunction,
-                                 mainPose);
-      }
-      else
-      {
-        ALICEVISION_CERR("Fail in adding residual block for the " << iLocalizer 
-                << " camera while adding point id " << iPoint);
-      }
-    }
-  }
-
-  // Configure a BA engine and run it
-  // todo: Set the most appropriate options
-  aliceVision::sfm::BundleAdjustmentCeres::CeresOptions aliceVision_options; // Set all
-  // the options field in our owm struct - unnecessary dependancy to aliceVision here
-  
-  ceres::Solver::Options options;
-  
-  options.preconditioner_type = aliceVision_options.preconditionerType;
-  options.linear_solver_type = aliceVision_options.linearSolverType;
-  options.sparse_linear_algebra_library_type = aliceVision_options.sparseLinearAlgebraLibraryType;
-  options.minimizer_progress_to_stdout = aliceVision_options.verbose;
-  options.logging_type = ceres::SILENT;
-  options.num_threads = 1;//aliceVision_options._nbThreads;
-#if CERES_VERSION_MAJOR < 2
-  options.num_linear_solver_threads = 1;//aliceVision_options._nbThreads;
-#endif
-  
-  // Solve BA
-  ceres::Solver::Summary summary;
-  ceres::Solve(options, &problem, &summary);
-  
-  if (aliceVision_options.summary)
-    ALICEVISION_LOG_DEBUG(summary.FullReport());
-
-  // If no error, get back refined parameters
-  if (!summary.IsSolutionUsable())
-  {
-    if (aliceVision_options.verbose)
-      ALICEVISION_CERR("Bundle Adjustment failed.");
-    return false;
-  }
-
-  if(aliceVision_options.verbose)
-  {
-    // Display statistics about the minimization
-    ALICEVISION_LOG_DEBUG("Bundle Adjustment statistics (approximated RMSE");
-    ALICEVISION_LOG_DEBUG(" #localizers: " << vec_localizationResults.size());
-    ALICEVISION_LOG_DEBUG(" #residuals: " << summary.num_residuals);
-    ALICEVISION_LOG_DEBUG(" Initial RMSE: " << std::sqrt(summary.initial_cost / summary.num_residuals));
-    ALICEVISION_LOG_DEBUG(" Final RMSE: " << std::sqrt(summary.final_cost / summary.num_residuals));
+    pts2d[iLocalizer] = localizationResult.getPt2D();
+    pts3d[iLocalizer] = localizationResult.getPt3D();
+    inliers[iLocalizer] = localizationResult.getInliers();
   }
 
-  // update the rigPose 
-  aliceVision::Mat3 R_refined;
-  ceres::AngleAxisToRotationMatrix(mainPose, R_refined.data());
-  aliceVision::Vec3 t_refined(mainPose[3], mainPose[4], mainPose[5]);
-  // Push the optimized pose
-  rigPose = geometry::Pose3(R_refined, -R_refined.transpose() * t_refined);
-
-//  displayRelativePoseReprojection(geometry::Pose3(aliceVision::Mat3::Identity(), aliceVision::Vec3::Zero()), 0);
-
-  // @todo do we want to update pose inside the LocalizationResults 
-
-  return true;
+  return refineRigPose(pts2d, pts3d, inliers, vec_queryIntrinsics, vec_subPoses, rigPose);
 }
 
 bool refineRigPose(const std::vector<Mat> &pts2d,
@@ -488,137 +384,189 @@ bool refineRigPose(const std::vector<Mat> &pts2d,
   assert(vec_queryIntrinsics.size() == numCameras);
   assert(inliers.size() == numCameras);
   assert(vec_subPoses.size() == numCameras - 1);
-  
+
+  // a sequence of a single frame, with a fixed rig calibration
+  std::vector<geometry::Pose3 > subPoses = vec_subPoses;
+  std::vector<geometry::Pose3 > rigPoses(1, rigPose);
+
+  if(!refineRigPoses({pts2d}, {pts3d}, {inliers}, vec_queryIntrinsics, subPoses, rigPoses, false))
+    return false;
+
+  rigPose = rigPoses.front();
+  return true;
+}
+
+bool refineRigPoses(const std::vector<std::vector<Mat> > &pts2d,
+                    const std::vector<std::vector<Mat> > &pts3d,
+                    const std::vector<std::vector<std::vector<std::size_t> > > &inliers,
+                    const std::vector<camera::PinholeRadialK3 > &vec_queryIntrinsics,
+                    std::vector<geometry::Pose3 > &vec_subPoses,
+                    std::vector<geometry::Pose3 > &vec_rigPoses,
+                    bool refineSubPoses)
+{
+  const std::size_t numFrames = vec_rigPoses.size();
+  const std::size_t numCameras = vec_queryIntrinsics.size();
+  assert(pts2d.size() == numFrames);
+  assert(pts3d.size() == numFrames);
+  assert(inliers.size() == numFrames);
+  assert(vec_subPoses.size() == numCameras - 1);
+
   ceres::Problem problem;
-  
-  const aliceVision::Mat3 & R = rigPose.rotation();
-  const aliceVision::Vec3 & t = rigPose.translation();
 
-  double mainPose[6];
-  ceres::RotationMatrixToAngleAxis((const double*)R.data(), mainPose);
+  // parameter blocks [angle axis; translation] of the rig poses and of the sub-poses
+  const auto poseToBlock = [](const geometry::Pose3& pose, double* block)
+  {
+    const aliceVision::Mat3 R = pose.rotation();
+    ceres::RotationMatrixToAngleAxis((const double*)R.data(), block);
+    const aliceVision::Vec3 t = pose.translation();
+    block[3] = t(0);
+    block[4] = t(1);
+    block[5] = t(2);
+  };
+
+  const auto blockToPose = [](const double* block) -> geometry::Pose3
+  {
+    aliceVision::Mat3 R_refined;
+    ceres::AngleAxisToRotationMatrix(block, R_refined.data());
+    const aliceVision::Vec3 t_refined(block[3], block[4], block[5]);
+    return geometry::Pose3(R_refined, -R_refined.transpose() * t_refined);
+  };
+
+  std::vector<double> vMainPoses(6 * numFrames);
+  std::vector<double> vRelativePoses(6 * vec_subPoses.size());
 
-  mainPose[3] = t(0);
-  mainPose[4] = t(1);
-  mainPose[5] = t(2);
-  problem.AddParameterBlock(mainPose, 6);
+  for(std::size_t iRelativePose = 0; iRelativePose < vec_subPoses.size(); ++iRelativePose)
+    poseToBlock(vec_subPoses[iRelativePose], &vRelativePoses[6 * iRelativePose]);
 
+  // the rig poses only share the sub-poses: eliminate them first in the Schur complement
+  ceres::ParameterBlockOrdering linearSolverOrdering;
 
   // Set a LossFunction to be less penalized by false measurements
   //  - set it to NULL if you don't want use a lossFunction.
-  ceres::LossFunction * p_LossFunction = nullptr;//new ceres::HuberLoss(Square(4.0));
-  // todo: make the LOSS function and the parameter an option
+  ceres::LossFunction * p_LossFunction = nullptr;
+
+  std::vector<bool> isFrameRefined(numFrames, false);
 
-  // For all visibility add reprojections errors:
-  for(size_t cam = 0; cam < numCameras; ++cam)
+  for(std::size_t frame = 0; frame < numFrames; ++frame)
   {
+    assert(pts2d[frame].size() == numCameras);
+    assert(pts3d[frame].size() == numCameras);
+    assert(inliers[frame].size() == numCameras);
 
-    // Get the inliers 3D points
-    const Mat & points3D = pts3d[cam];
-    assert(points3D.rows() == 3);
-    // Get their image locations (also referred as observations)
-    const Mat & points2D = pts2d[cam];
-    assert(points2D.rows() == 2);
+    double* mainPose = &vMainPoses[6 * frame];
+    poseToBlock(vec_rigPoses[frame], mainPose);
 
-    if(inliers[cam].empty())
-    {
-      ALICEVISION_LOG_DEBUG("Skipping cam " << cam << " as it has no inliers");
-      continue;
-    }
-    // Add a residual block for all inliers
-    for(const IndexT iPoint : inliers[cam])
+    for(std::size_t cam = 0; cam < numCameras; ++cam)
     {
-      assert(iPoint < points2D.cols());
-      assert(iPoint < points3D.cols());
-      
-      // Each Residual block takes a point and a camera as input and outputs a 2
-      // dimensional residual. Internally, the cost function stores the observations
-      // and the 3D point and compares the reprojection against the observation.
-      ceres::CostFunction* cost_function;
+      // Get the inliers 3D points
+      const Mat & points3D = pts3d[frame][cam];
+      // Get their image locations (also referred as observations)
+      const Mat & points2D = pts2d[frame][cam];
 
-      // Vector-2 residual, pose of the rig parameterized by 6 parameters
-      //                  + relative pose of the secondary camera parameterized by 6 parameters
-      
-      geometry::Pose3 subPose;
-      // if it is not the main camera (whose subpose is the identity)
-      if(cam != 0)
+      for(const IndexT iPoint : inliers[frame][cam])
       {
-        subPose = vec_subPoses[cam - 1];
-      }
+        assert(iPoint < points2D.cols());
+        assert(iPoint < points3D.cols());
 
-      cost_function = new ceres::AutoDiffCostFunction<rig::ResidualErrorSecondaryCameraFixedRelativeFunctor, 2, 6>(
-              new rig::ResidualErrorSecondaryCameraFixedRelativeFunctor(vec_queryIntrinsics[cam],
-                                                                   points2D.col(iPoint),
-                                                                   points3D.col(iPoint),
-                                                                   subPose));
+        if(cam == 0)
+        {
+          // Vector-2 residual, pose of the rig parameterized by 6 parameters
+          ceres::CostFunction* cost_function = new ceres::AutoDiffCostFunction<rig::ResidualErrorMainCameraFunctor, 2, 6>(
+                new rig::ResidualErrorMainCameraFunctor(vec_queryIntrinsics[cam], points2D.col(iPoint), points3D.col(iPoint)));
 
-      if(cost_function)
-      {
-        problem.AddResidualBlock(cost_function,
-                                 p_LossFunction,
-                                 mainPose);
-      }
-      else
-      {
-        ALICEVISION_CERR("Fail in adding residual block for the " << cam 
-                << " camera while adding point id " << iPoint);
+          problem.AddResidualBlock(cost_function, p_LossFunction, mainPose);
+        }
+        else
+        {
+          // Vector-2 residual, pose of the rig parameterized by 6 parameters
+          //                  + relative pose of the secondary camera parameterized by 6 parameters
+          ceres::CostFunction* cost_function = new ceres::AutoDiffCostFunction<rig::ResidualErrorSecondaryCameraFunctor, 2, 6, 6>(
+                new rig::ResidualErrorSecondaryCameraFunctor(vec_queryIntrinsics[cam], points2D.col(iPoint), points3D.col(iPoint)));
+
+          problem.AddResidualBlock(cost_function, p_LossFunction, mainPose, &vRelativePoses[6 * (cam - 1)]);
+        }
+        isFrameRefined[frame] = true;
       }
     }
+
+    if(isFrameRefined[frame])
+      linearSolverOrdering.AddElementToGroup(mainPose, 0);
+    else
+      ALICEVISION_LOG_DEBUG("Skipping frame " << frame << " as it has no inliers");
+  }
+
+  for(std::size_t iRelativePose = 0; iRelativePose < vec_subPoses.size(); ++iRelativePose)
+  {
+    double* relativePose = &vRelativePoses[6 * iRelativePose];
+    if(!problem.HasParameterBlock(relativePose))
+      continue;
+
+    linearSolverOrdering.AddElementToGroup(relativePose, 1);
+    if(!refineSubPoses)
+      problem.SetParameterBlockConstant(relativePose);
+  }
+
+  if(problem.NumResidualBlocks() == 0)
+  {
+    ALICEVISION_LOG_DEBUG("No inliers to refine the rig poses.");
+    return false;
   }
 
   // Configure a BA engine and run it
-  // todo: Set the most appropriate options
-  aliceVision::sfm::BundleAdjustmentCeres::CeresOptions aliceVision_options; // Set all
-  // the options field in our owm struct - unnecessary dependancy to aliceVision here
-  
+  // a single frame (see refineRigPose) is a small dense problem, solved in one thread
+  const bool isSequence = (numFrames > 1);
+  aliceVision::sfm::BundleAdjustmentCeres::CeresOptions aliceVision_options(false, isSequence);
+  if(isSequence)
+    aliceVision_options.setSparseBA();
+
   ceres::Solver::Options options;
-  
+
   options.preconditioner_type = aliceVision_options.preconditionerType;
   options.linear_solver_type = aliceVision_options.linearSolverType;
   options.sparse_linear_algebra_library_type = aliceVision_options.sparseLinearAlgebraLibraryType;
-  options.minimizer_progress_to_stdout = true;
-  //options.logging_type = ceres::SILENT;
-  options.num_threads = 1;//aliceVision_options._nbThreads;
+  options.minimizer_progress_to_stdout = aliceVision_options.verbose;
+  options.logging_type = ceres::SILENT;
+  options.num_threads = aliceVision_options.nbThreads;
 #if CERES_VERSION_MAJOR < 2
-  options.num_linear_solver_threads = 1;//aliceVision_options._nbThreads;
+  options.num_linear_solver_threads = aliceVision_options.nbThreads;
 #endif
-  
+  options.linear_solver_ordering.reset(new ceres::ParameterBlockOrdering(linearSolverOrdering));
+
   // Solve BA
   ceres::Solver::Summary summary;
   ceres::Solve(options, &problem, &summary);
-  
+
   if (aliceVision_options.summary)
     ALICEVISION_LOG_DEBUG(summary.FullReport());
 
   // If no error, get back refined parameters
   if (!summary.IsSolutionUsable())
   {
-    if (aliceVision_options.verbose)
-      ALICEVISION_LOG_DEBUG("Bundle Adjustment failed.");
+    ALICEVISION_LOG_DEBUG("Bundle Adjustment failed.");
     return false;
   }
 
-  if(aliceVision_options.verbose)
+  ALICEVISION_LOG_DEBUG(
+          "Bundle Adjustment statistics (approximated RMSE):\n"
+          " #frames: " << numFrames << "\n"
+          " #cameras: " << numCameras << "\n"
+          " #residuals: " << summary.num_residuals << "\n"
+          " Initial RMSE: " << std::sqrt(summary.initial_cost / summary.num_residuals) << "\n"
+          " Final RMSE: " << std::sqrt(summary.final_cost / summary.num_residuals)
+         );
+
+  // update the rig poses and the rig calibration
+  for(std::size_t frame = 0; frame < numFrames; ++frame)
   {
-    // Display statistics about the minimization
-    ALICEVISION_LOG_DEBUG(
-            "Bundle Adjustment statistics (approximated RMSE):\n"
-            " #cameras: " << numCameras << "\n"
-            " #residuals: " << summary.num_residuals << "\n"
-            " Initial RMSE: " << std::sqrt(summary.initial_cost / summary.num_residuals) << "\n"
-            " Final RMSE: " << std::sqrt(summary.final_cost / summary.num_residuals)
-           );
+    if(isFrameRefined[frame])
+      vec_rigPoses[frame] = blockToPose(&vMainPoses[6 * frame]);
   }
 
-  // update the rigPose 
-  aliceVision::Mat3 R_refined;
-  ceres::AngleAxisToRotationMatrix(mainPose, R_refined.data());
-  aliceVision::Vec3 t_refined(mainPose[3], mainPose[4], mainPose[5]);
-  // Push the optimized pose
-  rigPose = geometry::Pose3(R_refined, -R_refined.transpose() * t_refined);
-
-//  displayRelativePoseReprojection(geometry::Pose3(aliceVision::Mat3::Identity(), aliceVision::Vec3::Zero()), 0);
-
-  // @todo do we want to update pose inside the LocalizationResults 
+  if(refineSubPoses)
+  {
+    for(std::size_t iRelativePose = 0; iRelativePose < vec_subPoses.size(); ++iRelativePose)
+      vec_subPoses[iRelativePose] = blockToPose(&vRelativePoses[6 * iRelativePose]);
+  }
 
   return true;
 }
@@ -739,12 +687,20 @@ std::pair<double, bool> computeInliers(const std::vector<Mat> &vec_pts2d,
     auto &currInliers = vec_newInliers[camID];
     const auto &oldInliers = vec_inliers[camID];
     currInliers.reserve(numPts);
+
+    // flag the previous inliers instead of searching them for each point
+    std::vector<bool> wasInlier(numPts, false);
+    for(const std::size_t i : oldInliers)
+    {
+      assert(i < numPts);
+      assert(!wasInlier[i]);
+      wasInlier[i] = true;
+    }
     
     for(std::size_t i = 0; i < numPts; ++i)
     {
       // check whether the current point was an inlier
-      const auto occ = std::count(oldInliers.begin(), oldInliers.end(), i);
-      assert(occ == 0 || occ == 1);
+      const int occ = wasInlier[i] ? 1 : 0;
       
       if(sqrErrors(i) < squareThreshold)
       {
@@ -836,6 +792,43 @@ bool iterativeRefineRigPose(const std::vector<Mat> &pts2d,
   return true;
 }
 
+std::size_t iterativeRefineRigPoses(const std::vector<std::vector<Mat> > &pts2d,
+                                    const std::vector<std::vector<Mat> > &pts3d,
+                                    const std::vector<camera::PinholeRadialK3 > &vec_queryIntrinsics,
+                                    const std::vector<geometry::Pose3 > &vec_subPoses,
+                                    double maxReprojectionError,
+                                    std::size_t minNumPoints,
+                                    std::vector<std::vector<std::vector<std::size_t> > > &inliers,
+                                    std::vector<geometry::Pose3 > &vec_rigPoses,
+                                    std::vector<bool> &isRefined,
+                                    std::size_t maxIterationNumber)
+{
+  const std::size_t numFrames = vec_rigPoses.size();
+  assert(pts2d.size() == numFrames);
+  assert(pts3d.size() == numFrames);
+  assert(inliers.size() == numFrames);
+
+  // frames are independent: each one has its own small problem
+  std::vector<char> refined(numFrames, 0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t frame = 0; frame < static_cast<std::ptrdiff_t>(numFrames); ++frame)
+  {
+    refined[frame] = iterativeRefineRigPose(pts2d[frame],
+                                            pts3d[frame],
+                                            vec_queryIntrinsics,
+                                            vec_subPoses,
+                                            maxReprojectionError,
+                                            minNumPoints,
+                                            inliers[frame],
+                                            vec_rigPoses[frame],
+                                            maxIterationNumber);
+  }
+
+  isRefined.assign(refined.begin(), refined.end());
+  return std::count(refined.begin(), refined.end(), 1);
+}
+
 
 } //namespace localization
 } //namespace aliceVision
@@ -83,6 +83,7 @@ bool refineRigPose(const std::vector<geometry::Pose3 > &vec_subPoses,
  * @param[in,out] rigPose rigPose The current rig pose and the refined rig pose if the bundle
  * adjustment succeeds.
  * @return true if the bundle adjustment succeeds.
+ * @see refineRigPoses, this is the single frame case.
  */
 bool refineRigPose(const std::vector<Mat> &pts2d,
                    const std::vector<Mat> &pts3d,
@@ -91,6 +92,33 @@ bool refineRigPose(const std::vector<Mat> &pts2d,
                    const std::vector<geometry::Pose3 > &vec_subPoses,
                    geometry::Pose3 &rigPose);
 
+/**
+ * @brief refine the poses of a camera rig of N cameras along a sequence of frames with a
+ * single bundle adjustment. Each frame has its own rig pose while the rig calibration is
+ * shared by all the frames. The rig poses are eliminated first (Schur complement); a
+ * sequence of several frames is solved with the sparse solver and multiple threads.
+ *
+ * @param[in] pts2d For each frame, a vector of N 2xM matrices containing the image points
+ * of the 2D-3D associations.
+ * @param[in] pts3d For each frame, a vector of N 3xM matrices containing the 3D points
+ * of the 2D-3D associations.
+ * @param[in] inliers For each frame, a vector of N vectors, each containing the inliers
+ * for the 2D-3D associations.
+ * @param[in] vec_queryIntrinsics A vector of N intrinsics, one for each camera of the rig.
+ * @param[in,out] vec_subPoses The rig calibration (N-1 poses), refined if \p refineSubPoses is true.
+ * @param[in,out] vec_rigPoses The rig pose of each frame, refined if the bundle adjustment
+ * succeeds. The pose of a frame without any inlier is left untouched.
+ * @param[in] refineSubPoses Whether to refine the rig calibration as well.
+ * @return true if the bundle adjustment succeeds.
+ */
+bool refineRigPoses(const std::vector<std::vector<Mat> > &pts2d,
+                    const std::vector<std::vector<Mat> > &pts3d,
+                    const std::vector<std::vector<std::vector<std::size_t> > > &inliers,
+                    const std::vector<camera::PinholeRadialK3 > &vec_queryIntrinsics,
+                    std::vector<geometry::Pose3 > &vec_subPoses,
+                    std::vector<geometry::Pose3 > &vec_rigPoses,
+                    bool refineSubPoses = false);
+
 /**
  * 
  * @param pts2d
@@ -114,6 +142,32 @@ bool iterativeRefineRigPose(const std::vector<Mat> &pts2d,
                             geometry::Pose3 &rigPose,
                             std::size_t maxIterationNumber = 10);
 
+/**
+ * @brief iterativeRefineRigPose for each frame of a sequence, the frames are processed in parallel.
+ *
+ * @param[in] pts2d For each frame, the N image points matrices of the 2D-3D associations.
+ * @param[in] pts3d For each frame, the N 3D points matrices of the 2D-3D associations.
+ * @param[in] vec_queryIntrinsics A vector of N intrinsics, one for each camera of the rig.
+ * @param[in] vec_subPoses The rig calibration.
+ * @param[in] maxReprojectionError The maximum reprojection error to select the inliers.
+ * @param[in] minNumPoints The minimum number of inliers of a frame.
+ * @param[in,out] inliers For each frame, the N inliers vectors.
+ * @param[in,out] vec_rigPoses The rig pose of each frame.
+ * @param[out] isRefined For each frame, whether the refinement succeeded.
+ * @param[in] maxIterationNumber The maximum number of iterations per frame.
+ * @return the number of refined frames.
+ */
+std::size_t iterativeRefineRigPoses(const std::vector<std::vector<Mat> > &pts2d,
+                                    const std::vector<std::vector<Mat> > &pts3d,
+                                    const std::vector<camera::PinholeRadialK3 > &vec_queryIntrinsics,
+                                    const std::vector<geometry::Pose3 > &vec_subPoses,
+                                    double maxReprojectionError,
+                                    std::size_t minNumPoints,
+                                    std::vector<std::vector<std::vector<std::size_t> > > &inliers,
+                                    std::vector<geometry::Pose3 > &vec_rigPoses,
+                                    std::vector<bool> &isRefined,
+                                    std::size_t maxIterationNumber = 10);
+
 std::pair<double, bool> computeInliers(const std::vector<Mat> &vec_pts2d,
                                        const std::vector<Mat> &vec_pts3d,
                                        const std::vector<camera::PinholeRadialK3 > &vec_queryIntrinsics,
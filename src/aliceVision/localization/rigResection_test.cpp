@@ -409,6 +409,101 @@ BOOST_AUTO_TEST_CASE(rigResection_simpleWithNoiseNoOutliers)
   }
 }
 
+BOOST_AUTO_TEST_CASE(rigResection_refineRigPosesSequence)
+{
+  const std::size_t numCameras = 3;
+  const std::size_t numPoints = 50;
+  const std::size_t numFrames = 20;
+  const double threshold = 1e-3;
+
+  // rig calibration shared by all the frames
+  std::vector<camera::PinholeRadialK3 > vec_queryIntrinsics(numCameras, camera::PinholeRadialK3(640, 480, 500, 320, 240));
+  std::vector<geometry::Pose3 > vec_subPoses;
+  for(std::size_t cam = 1; cam < numCameras; ++cam)
+    vec_subPoses.push_back(generateRandomPose(Vec3::Constant(M_PI/10), 1.5));
+
+  std::vector<geometry::Pose3 > vec_rigPosesGT;
+  std::vector<geometry::Pose3 > vec_rigPoses;
+  std::vector<std::vector<Mat> > vec_pts3d(numFrames);
+  std::vector<std::vector<Mat> > vec_pts2d(numFrames);
+  std::vector<std::vector<std::vector<std::size_t> > > inliers(numFrames);
+
+  for(std::size_t frame = 0; frame < numFrames; ++frame)
+  {
+    const geometry::Pose3 rigPoseGT = generateRandomPose(Vec3::Constant(M_PI/10), 5);
+    const Mat3X pointsGT = generateRandomPoints(numPoints, 0, M_PI/3, 50, 10);
+    const Mat3X points = rigPoseGT(pointsGT);
+
+    for(std::size_t cam = 0; cam < numCameras; ++cam)
+    {
+      const Mat3X localPts = (cam != 0) ? Mat3X(vec_subPoses[cam-1](points)) : points;
+
+      std::vector<Vec3> pts3d;
+      std::vector<Vec2> pts2d;
+      for(std::size_t i = 0; i < numPoints; ++i)
+      {
+        if(localPts(2,i) > 0)
+        {
+          pts3d.push_back(pointsGT.col(i));
+          pts2d.push_back(vec_queryIntrinsics[cam].project(geometry::Pose3(), localPts.col(i)));
+        }
+      }
+
+      Mat matPts3d(3, pts3d.size());
+      Mat matPts2d(2, pts2d.size());
+      inliers[frame].emplace_back();
+      for(std::size_t i = 0; i < pts3d.size(); ++i)
+      {
+        matPts3d.col(i) = pts3d[i];
+        matPts2d.col(i) = pts2d[i];
+        inliers[frame].back().push_back(i);
+      }
+      vec_pts3d[frame].push_back(matPts3d);
+      vec_pts2d[frame].push_back(matPts2d);
+    }
+
+    vec_rigPosesGT.push_back(rigPoseGT);
+    // start from a perturbed pose
+    vec_rigPoses.push_back(geometry::Pose3(generateRotation(0.01, -0.01, 0.02), Vec3(0.05, 0.02, -0.05)) * rigPoseGT);
+  }
+
+  BOOST_CHECK(localization::refineRigPoses(vec_pts2d,
+                                           vec_pts3d,
+                                           inliers,
+                                           vec_queryIntrinsics,
+                                           vec_subPoses,
+                                           vec_rigPoses));
+
+  for(std::size_t frame = 0; frame < numFrames; ++frame)
+  {
+    const auto poseDiff = vec_rigPoses[frame]*vec_rigPosesGT[frame].inverse();
+    BOOST_CHECK_SMALL((poseDiff.rotation() - Mat3::Identity()).norm(), threshold);
+    BOOST_CHECK_SMALL(poseDiff.center().norm(), threshold);
+  }
+
+  // the per frame iterative refinement keeps the poses and all the inliers
+  std::vector<bool> isRefined;
+  BOOST_CHECK_EQUAL(localization::iterativeRefineRigPoses(vec_pts2d,
+                                                          vec_pts3d,
+                                                          vec_queryIntrinsics,
+                                                          vec_subPoses,
+                                                          1.0,
+                                                          10,
+                                                          inliers,
+                                                          vec_rigPoses,
+                                                          isRefined), numFrames);
+
+  for(std::size_t frame = 0; frame < numFrames; ++frame)
+  {
+    BOOST_CHECK(isRefined[frame]);
+    for(std::size_t cam = 0; cam < numCameras; ++cam)
+      BOOST_CHECK_EQUAL(inliers[frame][cam].size(), vec_pts2d[frame][cam].cols());
+
+    const auto poseDiff = vec_rigPoses[frame]*vec_rigPosesGT[frame].inverse();
+    BOOST_CHECK_SMALL(poseDiff.center().norm(), threshold);
+  }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(rigResection_simpleNoNoiseWithOutliers)
 {
@@ -326,6 +326,19 @@ unsigned int pix_to_bucket(const Vec2i &x, int W, int H);
  */
 bool line_to_endPoints(const Vec3& line, int W, int H, Vec2& x0, Vec2& x1);
 
+/**
+ * @brief Get the positions of the regions, undistorted if a valid camera is provided
+ * @param[in] cam Optional camera (in order to undistord feature positions, can be NULL)
+ * @param[in] regions regions (point features & corresponding descriptors)
+ * @param[out] points 2xN matrix of positions
+ */
+inline void getUndistortedRegionPositions(const camera::IntrinsicBase* cam, const feature::Regions& regions, Mat2X& points)
+{
+  points.resize(2, regions.RegionCount());
+  for(std::size_t i = 0; i < regions.RegionCount(); ++i)
+    points.col(i) = (cam && cam->isValid()) ? cam->get_ud_pixel(regions.GetRegionPosition(i)) : regions.GetRegionPosition(i);
+}
+
 /**
  * @brief Guided Matching (features + descriptors with distance ratio):
  *        Cluster correspondences per epipolar line (faster than exhaustive search).
@@ -343,9 +356,9 @@ bool line_to_endPoints(const Vec3& line, int W, int H, Vec2& x0, Vec2& x1);
  *
  * @param[in] FMat The fundamental matrix
  * @param[in] epipole2 Epipole2 (camera center1 in image plane2; must not be normalized)
- * @param[in] camL Optional camera (in order to undistord on the fly feature positions, can be NULL)
+ * @param[in] lPoints left regions positions (2xN, already undistorted)
  * @param[in] lRegions regions (point features & corresponding descriptors)
- * @param[in] camR Optional camera (in order to undistord on the fly feature positions, can be NULL)
+ * @param[in] rPoints right regions positions (2xN, already undistorted)
  * @param[in] rRegions regions (point features & corresponding descriptors)
  * @param[in] widthR
  * @param[in] heightR
@@ -356,9 +369,9 @@ bool line_to_endPoints(const Vec3& line, int W, int H, Vec2& x0, Vec2& x1);
 template<typename ErrorT>
 void guidedMatchingFundamentalFast(const Mat3& FMat,
                                    const Vec3& epipole2,
-                                   const camera::IntrinsicBase* camL,
+                                   const Mat2X& lPoints,
                                    const feature::Regions& lRegions,
-                                   const camera::IntrinsicBase* camR,
+                                   const Mat2X& rPoints,
                                    const feature::Regions& rRegions,
                                    const int widthR,
                                    const int heightR,
@@ -395,8 +408,7 @@ void guidedMatchingFundamentalFast(const Mat3& FMat,
   for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
   {
     // Compute epipolar line
-    const Vec2 l_pt = (camL && camL->isValid()) ? camL->get_ud_pixel(lRegions.GetRegionPosition(i)) : lRegions.GetRegionPosition(i);
-    const Vec3 line = F * Vec3(l_pt(0), l_pt(1), 1.);
+    const Vec3 line = F * lPoints.col(i).homogeneous();
     // If the epipolar line exists in Right image
     Vec2 x0, x1;
     if(line_to_endPoints(line, widthR, heightR, x0, x1))
@@ -416,7 +428,7 @@ void guidedMatchingFundamentalFast(const Mat3& FMat,
     // - compute the range of possible bucket by computing
     //    the epipolar line gauge limitation introduced by the tolerated pixel error
 
-    const Vec2 xR = (camR && camR->isValid()) ? camR->get_ud_pixel(rRegions.GetRegionPosition(j)) : rRegions.GetRegionPosition(j);
+    const auto xR = rPoints.col(j);
     const Vec3 l2 = ep2.cross(Vec3(xR(0), xR(1), 1.));
     const Vec2 n = l2.head<2>() * (sqrt(errorTh) / l2.head<2>().norm());
 
@@ -463,5 +475,53 @@ void guidedMatchingFundamentalFast(const Mat3& FMat,
   }
 }
 
+/**
+ * @brief Guided Matching (features + descriptors with distance ratio):
+ *        Cluster correspondences per epipolar line (faster than exhaustive search).
+ *        Keep the best corresponding points for the given model under the
+ *        user specified distance ratio.
+ *        Can be seen as a variant of robustEstimation method [1].
+ *
+ * @note implementation done here use a pixel grid limited to image border.
+ *
+ * @ref [1] Rajvi Shah, Vanshika Shrivastava, and P J Narayanan
+ *          Geometry-aware Feature Matching for Structure from Motion Applications.
+ *          WACV 2015.
+ *
+ * @tparam ErrorT The metric to compute distance to the model
+ *
+ * @param[in] FMat The fundamental matrix
+ * @param[in] epipole2 Epipole2 (camera center1 in image plane2; must not be normalized)
+ * @param[in] camL Optional camera (in order to undistord on the fly feature positions, can be NULL)
+ * @param[in] lRegions regions (point features & corresponding descriptors)
+ * @param[in] camR Optional camera (in order to undistord on the fly feature positions, can be NULL)
+ * @param[in] rRegions regions (point features & corresponding descriptors)
+ * @param[in] widthR
+ * @param[in] heightR
+ * @param[in] errorTh Maximal authorized error threshold (consider it's a square threshold)
+ * @param[in] distRatio Maximal authorized distance ratio
+ * @param[out] vec_corresponding_index Ouput corresponding index
+ */
+template<typename ErrorT>
+void guidedMatchingFundamentalFast(const Mat3& FMat,
+                                   const Vec3& epipole2,
+                                   const camera::IntrinsicBase* camL,
+                                   const feature::Regions& lRegions,
+                                   const camera::IntrinsicBase* camR,
+                                   const feature::Regions& rRegions,
+                                   const int widthR,
+                                   const int heightR,
+                                   double errorTh,
+                                   double distRatio,
+                                   matching::IndMatches& vec_corresponding_index)
+{
+  Mat2X lPoints, rPoints;
+  getUndistortedRegionPositions(camL, lRegions, lPoints);
+  getUndistortedRegionPositions(camR, rRegions, rPoints);
+
+  guidedMatchingFundamentalFast<ErrorT>(FMat, epipole2, lPoints, lRegions, rPoints, rRegions,
+                                        widthR, heightR, errorTh, distRatio, vec_corresponding_index);
+}
+
 }
 }
@@ -8,9 +8,13 @@
 #include "pairBuilder.hpp"
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/algorithm/string.hpp>
 
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <set>
 #include <iostream>
 #include <fstream>
@@ -18,6 +22,90 @@
 
 namespace aliceVision {
 
+namespace {
+
+/// binary pair list header: magic, version, number of groups, number of pairs
+const char pairsBinaryMagic[8] = {'A', 'V', 'P', 'A', 'I', 'R', 'S', '\0'};
+const std::uint32_t pairsBinaryVersion = 1;
+
+inline std::uint64_t pairToKey(const Pair& pair)
+{
+  return (static_cast<std::uint64_t>(pair.first) << 32) | pair.second;
+}
+
+inline Pair keyToPair(std::uint64_t key)
+{
+  return Pair(static_cast<IndexT>(key >> 32), static_cast<IndexT>(key & 0xffffffff));
+}
+
+/**
+ * @brief LSD radix sort on 8-bit digits.
+ * Each pass counts and scatters contiguous chunks of the keys in parallel, in order, so the passes are stable.
+ * The passes on a digit shared by all the keys are skipped.
+ */
+void radixSort(std::vector<std::uint64_t>& keys)
+{
+  const std::size_t nbBuckets = 256;
+  const std::size_t nbKeys = keys.size();
+  const std::ptrdiff_t nbChunks = std::max<std::ptrdiff_t>(1, std::min<std::ptrdiff_t>(omp_get_max_threads(), nbKeys / 65536));
+
+  std::vector<std::uint64_t> buffer(nbKeys);
+  std::vector<std::size_t> histograms(nbChunks * nbBuckets);
+
+  for(int shift = 0; shift < 64; shift += 8)
+  {
+    std::fill(histograms.begin(), histograms.end(), 0);
+
+    #pragma omp parallel for schedule(static)
+    for(std::ptrdiff_t c = 0; c < nbChunks; ++c)
+    {
+      std::size_t* histogram = &histograms[c * nbBuckets];
+      for(std::size_t i = nbKeys * c / nbChunks, end = nbKeys * (c + 1) / nbChunks; i < end; ++i)
+        ++histogram[(keys[i] >> shift) & 0xff];
+    }
+
+    // bucket-major prefix sum: the chunk c writes bucket b after the chunks [0, c)
+    bool trivialPass = false;
+    std::size_t offset = 0;
+    for(std::size_t b = 0; b < nbBuckets && !trivialPass; ++b)
+    {
+      const std::size_t bucketBegin = offset;
+      for(std::ptrdiff_t c = 0; c < nbChunks; ++c)
+      {
+        const std::size_t count = histograms[c * nbBuckets + b];
+        histograms[c * nbBuckets + b] = offset;
+        offset += count;
+      }
+      trivialPass = (offset - bucketBegin == nbKeys);
+    }
+    if(trivialPass)
+      continue;
+
+    #pragma omp parallel for schedule(static)
+    for(std::ptrdiff_t c = 0; c < nbChunks; ++c)
+    {
+      std::size_t* cursor = &histograms[c * nbBuckets];
+      for(std::size_t i = nbKeys * c / nbChunks, end = nbKeys * (c + 1) / nbChunks; i < end; ++i)
+        buffer[cursor[(keys[i] >> shift) & 0xff]++] = keys[i];
+    }
+    keys.swap(buffer);
+  }
+}
+
+template <typename T>
+inline bool readValues(std::istream& in, T* values, std::size_t n)
+{
+  return bool(in.read(reinterpret_cast<char*>(values), n * sizeof(T)));
+}
+
+template <typename T>
+inline void writeValues(std::ostream& out, const T* values, std::size_t n)
+{
+  out.write(reinterpret_cast<const char*>(values), n * sizeof(T));
+}
+
+} // namespace
+
 /// Generate all the (I,J) pairs of the upper diagonal of the NxN matrix
 PairSet exhaustivePairs(const sfmData::Views& views, int rangeStart, int rangeSize)
 {
@@ -39,8 +127,9 @@ PairSet exhaustivePairs(const sfmData::Views& views, int rangeStart, int rangeSi
   {
     sfmData::Views::const_iterator itB = itA;
     std::advance(itB, 1);
+    // the views are not sorted by id
     for(; itB != views.end(); ++itB)
-      pairs.insert(std::make_pair(itA->first, itB->first));
+      pairs.insert(std::minmax(itA->first, itB->first));
   }
   return pairs;
 }
@@ -50,6 +139,17 @@ bool loadPairs(const std::string &sFileName,
                int rangeStart,
                int rangeSize)
 {
+  if(isPairsBinaryFile(sFileName))
+  {
+    PairVec pairVec;
+    if(!loadPairsBinary(sFileName, pairVec, rangeStart, rangeSize))
+      return false;
+    // the pairs of a binary file are sorted
+    for(const Pair& pair : pairVec)
+      pairs.insert(pairs.end(), pair);
+    return true;
+  }
+
   std::ifstream in(sFileName.c_str());
   if(!in.is_open())
   {
@@ -123,4 +223,166 @@ bool savePairs(const std::string &sFileName, const PairSet & pairs)
   return bOk;
 }
 
+void sortUniquePairs(PairVec & pairs)
+{
+  std::vector<std::uint64_t> keys(pairs.size());
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(pairs.size()); ++i)
+  {
+    const Pair& pair = pairs[i];
+    keys[i] = pairToKey(pair.first < pair.second ? pair : Pair(pair.second, pair.first));
+  }
+
+  radixSort(keys);
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  pairs.clear();
+  pairs.reserve(keys.size());
+  for(const std::uint64_t key : keys)
+  {
+    const Pair pair = keyToPair(key);
+    if(pair.first != pair.second)
+      pairs.push_back(pair);
+  }
+}
+
+bool savePairsBinary(const std::string &sFileName, const PairVec & pairs)
+{
+  assert(std::is_sorted(pairs.begin(), pairs.end()));
+
+  std::ofstream outStream(sFileName.c_str(), std::ios::binary);
+  if(!outStream.is_open())
+  {
+    ALICEVISION_LOG_WARNING("savePairsBinary: Impossible to open the output specified file: \"" << sFileName << "\".");
+    return false;
+  }
+
+  // group the pairs by first image
+  std::vector<IndexT> groupImages;
+  std::vector<std::uint64_t> groupOffsets;
+  std::vector<IndexT> secondImages;
+  secondImages.reserve(pairs.size());
+
+  for(const Pair& pair : pairs)
+  {
+    if(groupImages.empty() || groupImages.back() != pair.first)
+    {
+      groupImages.push_back(pair.first);
+      groupOffsets.push_back(secondImages.size());
+    }
+    secondImages.push_back(pair.second);
+  }
+  groupOffsets.push_back(secondImages.size());
+
+  const std::uint64_t nbGroups = groupImages.size();
+  const std::uint64_t nbPairs = secondImages.size();
+
+  writeValues(outStream, pairsBinaryMagic, sizeof(pairsBinaryMagic));
+  writeValues(outStream, &pairsBinaryVersion, 1);
+  writeValues(outStream, &nbGroups, 1);
+  writeValues(outStream, &nbPairs, 1);
+  writeValues(outStream, groupImages.data(), groupImages.size());
+  writeValues(outStream, groupOffsets.data(), groupOffsets.size());
+  writeValues(outStream, secondImages.data(), secondImages.size());
+
+  const bool bOk = !outStream.bad();
+  outStream.close();
+  return bOk;
+}
+
+bool loadPairsBinary(const std::string &sFileName,
+                     PairVec & pairs,
+                     int rangeStart,
+                     int rangeSize)
+{
+  std::ifstream in(sFileName.c_str(), std::ios::binary);
+  if(!in.is_open())
+  {
+    ALICEVISION_LOG_WARNING("loadPairsBinary: Impossible to read the specified file: \"" << sFileName << "\".");
+    return false;
+  }
+
+  char magic[sizeof(pairsBinaryMagic)];
+  std::uint32_t version = 0;
+  std::uint64_t nbGroups = 0;
+  std::uint64_t nbPairs = 0;
+
+  if(!readValues(in, magic, sizeof(magic)) ||
+     std::memcmp(magic, pairsBinaryMagic, sizeof(magic)) != 0 ||
+     !readValues(in, &version, 1) || version != pairsBinaryVersion ||
+     !readValues(in, &nbGroups, 1) ||
+     !readValues(in, &nbPairs, 1))
+  {
+    ALICEVISION_LOG_WARNING("loadPairsBinary: Invalid input file: \"" << sFileName << "\".");
+    return false;
+  }
+
+  // select the groups
+  std::uint64_t groupBegin = 0;
+  std::uint64_t groupEnd = nbGroups;
+  if(rangeStart != -1 && rangeSize != 0)
+  {
+    groupBegin = std::min<std::uint64_t>(rangeStart, nbGroups);
+    groupEnd = std::min<std::uint64_t>(groupBegin + rangeSize, nbGroups);
+  }
+  if(groupBegin == groupEnd)
+    return true;
+
+  const std::streamoff headerSize = sizeof(pairsBinaryMagic) + sizeof(version) + sizeof(nbGroups) + sizeof(nbPairs);
+  const std::streamoff groupImagesBegin = headerSize;
+  const std::streamoff groupOffsetsBegin = groupImagesBegin + nbGroups * sizeof(IndexT);
+  const std::streamoff secondImagesBegin = groupOffsetsBegin + (nbGroups + 1) * sizeof(std::uint64_t);
+
+  const std::size_t nbSelectedGroups = groupEnd - groupBegin;
+  std::vector<IndexT> groupImages(nbSelectedGroups);
+  std::vector<std::uint64_t> groupOffsets(nbSelectedGroups + 1);
+
+  // only read the selected range
+  bool valid = in.seekg(groupImagesBegin + groupBegin * sizeof(IndexT)) &&
+               readValues(in, groupImages.data(), groupImages.size()) &&
+               in.seekg(groupOffsetsBegin + groupBegin * sizeof(std::uint64_t)) &&
+               readValues(in, groupOffsets.data(), groupOffsets.size()) &&
+               std::is_sorted(groupOffsets.begin(), groupOffsets.end()) &&
+               groupOffsets.back() <= nbPairs;
+
+  std::vector<IndexT> secondImages;
+  if(valid)
+  {
+    secondImages.resize(groupOffsets.back() - groupOffsets.front());
+    valid = in.seekg(secondImagesBegin + groupOffsets.front() * sizeof(IndexT)) &&
+            readValues(in, secondImages.data(), secondImages.size());
+  }
+  if(!valid)
+  {
+    ALICEVISION_LOG_WARNING("loadPairsBinary: Invalid input file: \"" << sFileName << "\".");
+    return false;
+  }
+
+  pairs.reserve(pairs.size() + secondImages.size());
+  for(std::size_t g = 0; g < nbSelectedGroups; ++g)
+  {
+    for(std::uint64_t i = groupOffsets[g]; i < groupOffsets[g + 1]; ++i)
+    {
+      const IndexT J = secondImages[i - groupOffsets.front()];
+      if(groupImages[g] == J)
+      {
+        ALICEVISION_LOG_WARNING("loadPairsBinary: Invalid input file. Image " << J << " see itself. File: \"" << sFileName << "\".");
+        return false;
+      }
+      pairs.emplace_back(groupImages[g], J);
+    }
+  }
+  return true;
+}
+
+bool isPairsBinaryFile(const std::string &sFileName)
+{
+  std::ifstream in(sFileName.c_str(), std::ios::binary);
+  char magic[sizeof(pairsBinaryMagic)];
+  return in.is_open() &&
+         readValues(in, magic, sizeof(magic)) &&
+         std::memcmp(magic, pairsBinaryMagic, sizeof(magic)) == 0;
+}
+
 }; // namespace aliceVision
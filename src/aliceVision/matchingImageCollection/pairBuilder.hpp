@@ -19,6 +19,7 @@ PairSet exhaustivePairs(const sfmData::Views& views, int rangeStart=-1, int rang
 
 /// Load a set of PairSet from a file
 /// I J K L (pair that link I)
+/// Binary pair lists (see savePairsBinary) are also supported.
 bool loadPairs(
      const std::string &sFileName, // filename of the list file,
      PairSet & pairs,
@@ -30,4 +31,26 @@ bool loadPairs(
 /// I K
 bool savePairs(const std::string &sFileName, const PairSet & pairs);
 
+/// Order each pair (I < J), sort the pairs and remove the duplicates and the self pairs.
+/// Uses a parallel radix sort, for the pair lists of large datasets.
+void sortUniquePairs(PairVec & pairs);
+
+/// Save sorted and unique pairs (see sortUniquePairs) to a binary file.
+/// The pairs are grouped by first image, like the lines of the text format ("I J K L"),
+/// and the file stores the offset of each group so that a range of groups can be read
+/// without parsing the file (see loadPairsBinary).
+bool savePairsBinary(const std::string &sFileName, const PairVec & pairs);
+
+/// Load the pairs of a binary file (see savePairsBinary).
+/// The range selects groups of pairs, like the lines of the text format.
+/// The pairs are appended to the output vector.
+bool loadPairsBinary(
+     const std::string &sFileName,
+     PairVec & pairs,
+     int rangeStart=-1,
+     int rangeSize=0);
+
+/// Return true if the file is a binary pair list (see savePairsBinary)
+bool isPairsBinaryFile(const std::string &sFileName);
+
 }; // namespace aliceVision
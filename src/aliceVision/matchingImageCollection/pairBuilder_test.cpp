@@ -12,6 +12,7 @@
 #include <iostream>
 #include <algorithm>
 #include <memory>
+#include <random>
 
 #define BOOST_TEST_MODULE matchingImageCollectionPairBuilder
 
@@ -80,3 +81,52 @@ BOOST_AUTO_TEST_CASE(matchingImageCollection_IO)
   BOOST_CHECK( loadPairs("pairsT_IO.txt", loaded_Pairs));
   BOOST_CHECK( std::equal(loaded_Pairs.begin(), loaded_Pairs.end(), pairSetGTsorted.begin()) );
 }
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_sortUniquePairs)
+{
+  // large enough to be sorted in several chunks, with duplicates, reversed and self pairs
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_int_distribution<IndexT> distribution(0, 2000);
+
+  PairVec pairs;
+  PairSet pairSetGT;
+  for(int i = 0; i < 300000; ++i)
+  {
+    const IndexT I = (i % 7 == 0) ? distribution(randomNumberGenerator) * 2000000 : distribution(randomNumberGenerator);
+    const IndexT J = distribution(randomNumberGenerator);
+    pairs.emplace_back(I, J);
+    if(I != J)
+      pairSetGT.insert(std::make_pair(std::min(I, J), std::max(I, J)));
+  }
+
+  sortUniquePairs(pairs);
+  BOOST_CHECK( checkPairOrder(pairs) );
+  BOOST_CHECK_EQUAL( pairs.size(), pairSetGT.size());
+  BOOST_CHECK( std::equal(pairs.begin(), pairs.end(), pairSetGT.begin()) );
+}
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_binaryIO)
+{
+  PairVec pairs = {{0,1}, {0,2}, {0,5}, {1,2}, {3,4}, {3,5}};
+  BOOST_CHECK( savePairsBinary("pairsT_IO.bin", pairs));
+  BOOST_CHECK( isPairsBinaryFile("pairsT_IO.bin"));
+  BOOST_CHECK( !isPairsBinaryFile("pairsT_IO.txt"));
+
+  PairVec loadedPairs;
+  BOOST_CHECK( loadPairsBinary("pairsT_IO.bin", loadedPairs));
+  BOOST_CHECK( loadedPairs == pairs );
+
+  // the range selects groups of pairs sharing the same first image
+  loadedPairs.clear();
+  BOOST_CHECK( loadPairsBinary("pairsT_IO.bin", loadedPairs, 1, 2));
+  BOOST_CHECK( loadedPairs == PairVec({{1,2}, {3,4}, {3,5}}) );
+
+  loadedPairs.clear();
+  BOOST_CHECK( loadPairsBinary("pairsT_IO.bin", loadedPairs, 3, 1));
+  BOOST_CHECK( loadedPairs.empty() );
+
+  // loadPairs reads both formats
+  PairSet loadedPairSet;
+  BOOST_CHECK( loadPairs("pairsT_IO.bin", loadedPairSet, 0, 1));
+  BOOST_CHECK( loadedPairSet == PairSet({{0,1}, {0,2}, {0,5}}) );
+}
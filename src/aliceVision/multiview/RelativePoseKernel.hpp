@@ -11,6 +11,7 @@
 #include <aliceVision/robustEstimation/conditioning.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
 #include <aliceVision/robustEstimation/PointFittingRansacKernel.hpp>
+#include <aliceVision/multiview/essential.hpp>
 
 namespace aliceVision {
 namespace multiview {
@@ -138,10 +139,8 @@ public:
 
   void fit(const std::vector<std::size_t>& samples, std::vector<ModelT_>& models) const override
   {
-    const Mat x1 = ExtractColumns(_x1k, samples);
-    const Mat x2 = ExtractColumns(_x2k, samples);
-
-    KernelBase::KernelBase::_kernelSolver.solve(x1, x2, models);
+    // fit on the points in camera coordinates, without heap allocation for fixed-size solvers
+    KernelBase::KernelBase::fitSamples(_x1k, _x2k, samples, models);
   }
 
   double error(std::size_t sample, const ModelT_& model) const override
@@ -13,9 +13,9 @@ namespace aliceVision {
 namespace multiview {
 namespace relativePose {
 
-Vec o1(const Vec& a, const Vec& b)
+Vec20 o1(const Vec20& a, const Vec20& b)
 {
-  Vec res = Vec::Zero(20);
+  Vec20 res = Vec20::Zero();
 
   res(Pc::coef_xx) = a(Pc::coef_x) * b(Pc::coef_x);
   res(Pc::coef_xy) = a(Pc::coef_x) * b(Pc::coef_y)
@@ -37,9 +37,9 @@ Vec o1(const Vec& a, const Vec& b)
   return res;
 }
 
-Vec o2(const Vec& a, const Vec& b)
+Vec20 o2(const Vec20& a, const Vec20& b)
 {
-  Vec res(20);
+  Vec20 res;
 
   res(Pc::coef_xxx) = a(Pc::coef_xx) * b(Pc::coef_x);
   res(Pc::coef_xxy) = a(Pc::coef_xx) * b(Pc::coef_y)
@@ -87,8 +87,10 @@ Vec o2(const Vec& a, const Vec& b)
 
 /**
  * @brief Compute the nullspace of the linear constraints given by the matches.
+ *        Use template in order to support fixed or dynamic sized matrix.
  */
-Mat fivePointsNullspaceBasis(const Mat2X& x1, const Mat2X& x2)
+template<typename TMatX>
+Eigen::Matrix<double, 9, 4> computeNullspaceBasis(const TMatX& x1, const TMatX& x2)
 {
   Eigen::Matrix<double,9, 9> A;
   A.setZero();  // make A square until Eigen supports rectangular SVD.
@@ -97,16 +99,21 @@ Mat fivePointsNullspaceBasis(const Mat2X& x1, const Mat2X& x2)
   return svd.matrixV().topRightCorner<9,4>();
 }
 
+Eigen::Matrix<double, 9, 4> fivePointsNullspaceBasis(const Mat2X& x1, const Mat2X& x2)
+{
+  return computeNullspaceBasis(x1, x2);
+}
+
 /**
  * @brief Builds the polynomial constraint matrix M.
  */
-Mat fivePointsPolynomialConstraints(const Mat& EBasis)
+Eigen::Matrix<double, 10, 20> fivePointsPolynomialConstraints(const Eigen::Matrix<double, 9, 4>& EBasis)
 {
   // build the polynomial form of E (equation (8) in Stewenius et al. [1])
-  Vec E[3][3];
+  Vec20 E[3][3];
   for (int i = 0; i < 3; ++i) {
     for (int j = 0; j < 3; ++j) {
-      E[i][j] = Vec::Zero(20);
+      E[i][j] = Vec20::Zero();
       E[i][j](Pc::coef_x) = EBasis(3 * i + j, 0);
       E[i][j](Pc::coef_y) = EBasis(3 * i + j, 1);
       E[i][j](Pc::coef_z) = EBasis(3 * i + j, 2);
@@ -115,7 +122,7 @@ Mat fivePointsPolynomialConstraints(const Mat& EBasis)
   }
 
   // the constraint matrix.
-  Mat M(10, 20);
+  Eigen::Matrix<double, 10, 20> M;
   int mrow = 0;
 
   // determinant constraint det(E) = 0; equation (19) of Nister [2].
@@ -125,7 +132,7 @@ Mat fivePointsPolynomialConstraints(const Mat& EBasis)
 
   // cubic singular values constraint.
   // equation (20).
-  Vec EET[3][3];
+  Vec20 EET[3][3];
   for (int i = 0; i < 3; ++i) {    // since EET is symmetric, we only compute
     for (int j = 0; j < 3; ++j) {  // its upper triangular part.
       if (i <= j) {
@@ -139,8 +146,8 @@ Mat fivePointsPolynomialConstraints(const Mat& EBasis)
   }
 
   // equation (21).
-  Vec (&L)[3][3] = EET;
-  Vec trace  = 0.5 * (EET[0][0] + EET[1][1] + EET[2][2]);
+  Vec20 (&L)[3][3] = EET;
+  const Vec20 trace  = 0.5 * (EET[0][0] + EET[1][1] + EET[2][2]);
   for (int i = 0; i < 3; ++i) {
     L[i][i] -= trace;
   }
@@ -148,7 +155,7 @@ Mat fivePointsPolynomialConstraints(const Mat& EBasis)
   // equation (23).
   for (int i = 0; i < 3; ++i) {
     for (int j = 0; j < 3; ++j) {
-      Vec LEij = o2(L[i][0], E[0][j])
+      const Vec20 LEij = o2(L[i][0], E[0][j])
                + o2(L[i][1], E[1][j])
                + o2(L[i][2], E[2][j]);
       M.row(mrow++) = LEij;
@@ -158,15 +165,16 @@ Mat fivePointsPolynomialConstraints(const Mat& EBasis)
   return M;
 }
 
-void Essential5PSolver::solve(const Mat& x1, const Mat& x2, std::vector<robustEstimation::Mat3Model>& models) const
+/**
+ * @brief Computes the essential matrices from 5 correspondences.
+ *        Use template in order to support fixed or dynamic sized matrix.
+ * @return the number of models
+ */
+template<typename TMatX>
+std::size_t computeEssentialMatrices(const TMatX& x1, const TMatX& x2, Essential5PSolver::FixedModels& models)
 {
-  assert(2 == x1.rows());
-  assert(5 <= x1.cols());
-  assert(x1.rows() == x2.rows());
-  assert(x1.cols() == x2.cols());
-
   // step 1: Nullspace Extraction.
-  const Eigen::Matrix<double, 9, 4> EBasis = fivePointsNullspaceBasis(x1, x2);
+  const Eigen::Matrix<double, 9, 4> EBasis = computeNullspaceBasis(x1, x2);
 
   // step 2: Constraint Expansion.
   const Eigen::Matrix<double, 10, 20> EConstraints = fivePointsPolynomialConstraints(EBasis);
@@ -191,7 +199,7 @@ void Essential5PSolver::solve(const Mat& x1, const Mat& x2, std::vector<robustEs
   const auto& eigenvalues = eigensolver.eigenvalues();
 
   // build essential matrices for the real solutions.
-  models.reserve(10);
+  std::size_t nbModels = 0;
   for(int s = 0; s < 10; ++s)
   {
     // only consider real solutions.
@@ -200,8 +208,26 @@ void Essential5PSolver::solve(const Mat& x1, const Mat& x2, std::vector<robustEs
 
     Mat3 E;
     Eigen::Map<Vec9 >(E.data()) = EBasis * eigenvectors.col(s).tail<4>().real();
-    models.emplace_back(E.transpose());
+    models[nbModels++].setMatrix(E.transpose());
   }
+  return nbModels;
+}
+
+std::size_t Essential5PSolver::solve(const FixedX1& x1, const FixedX2& x2, FixedModels& models) const
+{
+  return computeEssentialMatrices(x1, x2, models);
+}
+
+void Essential5PSolver::solve(const Mat& x1, const Mat& x2, std::vector<robustEstimation::Mat3Model>& models) const
+{
+  assert(2 == x1.rows());
+  assert(5 <= x1.cols());
+  assert(x1.rows() == x2.rows());
+  assert(x1.cols() == x2.cols());
+
+  FixedModels fixedModels;
+  const std::size_t nbModels = computeEssentialMatrices(x1, x2, fixedModels);
+  models.insert(models.end(), fixedModels.begin(), fixedModels.begin() + nbModels);
 }
 
 }  // namespace relativePose
@@ -10,6 +10,8 @@
 
 #include <aliceVision/robustEstimation/ISolver.hpp>
 
+#include <array>
+
 namespace aliceVision {
 namespace multiview {
 namespace relativePose {
@@ -18,6 +20,11 @@ class Essential5PSolver : public robustEstimation::ISolver<robustEstimation::Mat
 {
 public:
 
+  /// fixed-size minimal sample and models buffer, see robustEstimation::IsFixedSizeSolver
+  using FixedX1 = Eigen::Matrix<double, 2, 5>;
+  using FixedX2 = Eigen::Matrix<double, 2, 5>;
+  using FixedModels = std::array<robustEstimation::Mat3Model, 10>;
+
   /**
    * @brief Return the minimum number of required samples
    * @return minimum number of required samples
@@ -44,6 +51,15 @@ public:
    */
    void solve(const Mat& x1, const Mat& x2, std::vector<robustEstimation::Mat3Model>& models) const override;
 
+   /**
+    * @brief Solve the problem on a fixed-size minimal sample, without heap allocation.
+    * @param[in] x1 Points in the first image. One per column.
+    * @param[in] x2 Corresponding points in the second image. One per column.
+    * @param[out] models The buffer of candidate solutions.
+    * @return The number of solutions written at the beginning of models.
+    */
+   std::size_t solve(const FixedX1& x1, const FixedX2& x2, FixedModels& models) const;
+
    /**
     * @brief Solve the problem.
     * @param[in]  x1  A 2xN matrix of column vectors.
@@ -97,21 +113,24 @@ enum polynomialCoefficient {
 
 using Pc = polynomialCoefficient;
 
+/// polynomial coefficients in the basis of monomials above
+using Vec20 = Eigen::Matrix<double, 20, 1>;
+
 /**
  * @brief Multiply two polynomials of degree 1.
  */
-Vec o1(const Vec& a, const Vec& b);
+Vec20 o1(const Vec20& a, const Vec20& b);
 
 
 /**
  * @brief Multiply a polynomial of degree 2, a, by a polynomial of degree 1, b.
  */
-Vec o2(const Vec& a, const Vec& b);
+Vec20 o2(const Vec20& a, const Vec20& b);
 
 /**
  * @brief Compute the nullspace of the linear constraints given by the matches.
  */
-Mat fivePointsNullspaceBasis(const Mat2X& x1, const Mat2X& x2);
+Eigen::Matrix<double, 9, 4> fivePointsNullspaceBasis(const Mat2X& x1, const Mat2X& x2);
 
 }  // namespace relativePose
 }  // namespace multiview
@@ -14,53 +14,18 @@ namespace aliceVision {
 namespace multiview {
 namespace relativePose {
 
-void Fundamental7PSolver::solve(const Mat& x1, const Mat& x2, std::vector<robustEstimation::Mat3Model>& models) const
+/**
+ * @brief Compute the fundamental matrices from the two dimensional nullspace of A
+ *        with the condition det(F) = 0.
+ * @param[in] f1 first nullspace vector
+ * @param[in] f2 second nullspace vector
+ * @param[out] models the models buffer
+ * @return the number of models
+ */
+std::size_t computeFundamentalFromNullspace(const Vec9& f1, const Vec9& f2, Fundamental7PSolver::FixedModels& models)
 {
-  assert(2 == x1.rows());
-  assert(7 <= x1.cols());
-  assert(x1.rows() == x2.rows());
-  assert(x1.cols() == x2.cols());
-
-  Vec9 f1, f2;
-
-  if(x1.cols() == 7)
-  {
-    // set up the homogeneous system Af = 0 from the equations x'T*F*x = 0.
-
-    // in the minimal solution use fixed sized matrix to let Eigen and the
-    // compiler doing the maximum of optimization.
-    Mat9 A = Mat::Zero(9,9);
-    encodeEpipolarEquation(x1, x2, &A);
-
-    // Eigen::FullPivLU<Mat9> luA(A);
-    // ALICEVISION_LOG_DEBUG("rank(A) = " << luA.rank());
-    // Eigen::JacobiSVD<Mat9> svdA(A);
-    // ALICEVISION_LOG_DEBUG("Its singular values are:\n" << svdA.singularValues());
-
-    // find the two F matrices in the nullspace of A.
-    Nullspace2(&A, &f1, &f2);
-
-    // @fixme here there is a potential error, we should check that the size of
-    // null(A) is 2. Otherwise we have a family of possible solutions for the
-    // fundamental matrix (ie infinite solution). This happens, e.g., when matching
-    // the image against itself or in other degenerate configurations of the camera,
-    // such as pure rotation or correspondences all on the same plane (cf HZ pg296 table 11.1)
-    // This is not critical for just matching images with geometric validation, 
-    // it becomes an issue if the estimated F has to be used for retrieving the 
-    // motion of the camera.
-  }
-  else
-  {
-    // set up the homogeneous system Af = 0 from the equations x'T*F*x = 0.
-    Mat A(x1.cols(), 9);
-    encodeEpipolarEquation(x1, x2, &A);
-
-    // find the two F matrices in the nullspace of A.
-    Nullspace2(&A, &f1, &f2);
-  }
-
-  Mat3 F1 = Map<RMat3>(f1.data());
-  Mat3 F2 = Map<RMat3>(f2.data());
+  Mat3 F1 = Map<const RMat3>(f1.data());
+  Mat3 F2 = Map<const RMat3>(f2.data());
 
   // use the condition det(F) = 0 to determine F.
   // in other words, solve: det(F1 + a*F2) = 0 for a.
@@ -90,7 +55,64 @@ void Fundamental7PSolver::solve(const Mat& x1, const Mat& x2, std::vector<robust
 
   // build the fundamental matrix for each solution.
   for(int kk = 0; kk < nbRoots; ++kk)
-    models.emplace_back(F1 + roots[kk] * F2);
+    models[kk].setMatrix(F1 + roots[kk] * F2);
+
+  return static_cast<std::size_t>(nbRoots);
+}
+
+std::size_t Fundamental7PSolver::solve(const FixedX1& x1, const FixedX2& x2, FixedModels& models) const
+{
+  // set up the homogeneous system Af = 0 from the equations x'T*F*x = 0.
+
+  // in the minimal solution use fixed sized matrix to let Eigen and the
+  // compiler doing the maximum of optimization.
+  Mat9 A = Mat9::Zero();
+  encodeEpipolarEquation(x1, x2, &A);
+
+  // find the two F matrices in the nullspace of A.
+  Vec9 f1, f2;
+  Nullspace2(&A, &f1, &f2);
+
+  // @fixme here there is a potential error, we should check that the size of
+  // null(A) is 2. Otherwise we have a family of possible solutions for the
+  // fundamental matrix (ie infinite solution). This happens, e.g., when matching
+  // the image against itself or in other degenerate configurations of the camera,
+  // such as pure rotation or correspondences all on the same plane (cf HZ pg296 table 11.1)
+  // This is not critical for just matching images with geometric validation, 
+  // it becomes an issue if the estimated F has to be used for retrieving the 
+  // motion of the camera.
+
+  return computeFundamentalFromNullspace(f1, f2, models);
+}
+
+void Fundamental7PSolver::solve(const Mat& x1, const Mat& x2, std::vector<robustEstimation::Mat3Model>& models) const
+{
+  assert(2 == x1.rows());
+  assert(7 <= x1.cols());
+  assert(x1.rows() == x2.rows());
+  assert(x1.cols() == x2.cols());
+
+  FixedModels fixedModels;
+  std::size_t nbModels = 0;
+
+  if(x1.cols() == 7)
+  {
+    nbModels = solve(FixedX1(x1), FixedX2(x2), fixedModels);
+  }
+  else
+  {
+    // set up the homogeneous system Af = 0 from the equations x'T*F*x = 0.
+    Mat A(x1.cols(), 9);
+    encodeEpipolarEquation(x1, x2, &A);
+
+    // find the two F matrices in the nullspace of A.
+    Vec9 f1, f2;
+    Nullspace2(&A, &f1, &f2);
+
+    nbModels = computeFundamentalFromNullspace(f1, f2, fixedModels);
+  }
+
+  models.insert(models.end(), fixedModels.begin(), fixedModels.begin() + nbModels);
 }
 
 }  // namespace relativePose
@@ -10,6 +10,8 @@
 
 #include <aliceVision/robustEstimation/ISolver.hpp>
 
+#include <array>
+
 namespace aliceVision {
 namespace multiview {
 namespace relativePose {
@@ -18,6 +20,11 @@ class Fundamental7PSolver : public robustEstimation::ISolver<robustEstimation::M
 {
 public:
 
+  /// fixed-size minimal sample and models buffer, see robustEstimation::IsFixedSizeSolver
+  using FixedX1 = Eigen::Matrix<double, 2, 7>;
+  using FixedX2 = Eigen::Matrix<double, 2, 7>;
+  using FixedModels = std::array<robustEstimation::Mat3Model, 3>;
+
   /**
    * @brief Return the minimum number of required samples
    * @return minimum number of required samples
@@ -52,6 +59,15 @@ public:
    */
    void solve(const Mat& x1, const Mat& x2, std::vector<robustEstimation::Mat3Model>& models) const override;
 
+   /**
+    * @brief Solve the problem on a fixed-size minimal sample, without heap allocation.
+    * @param[in] x1 Points in the first image. One per column.
+    * @param[in] x2 Corresponding points in the second image. One per column.
+    * @param[out] models The buffer of candidate solutions.
+    * @return The number of solutions written at the beginning of models.
+    */
+   std::size_t solve(const FixedX1& x1, const FixedX2& x2, FixedModels& models) const;
+
    /**
     * @brief Solve the problem.
     * @param[in]  x1  A 2xN matrix of column vectors.
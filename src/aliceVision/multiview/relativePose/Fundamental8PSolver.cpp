@@ -26,7 +26,7 @@ void solveProblem(const Mat& x1, const Mat& x2, std::vector<robustEstimation::Ma
   {
     // in the minimal solution use fixed sized matrix to let Eigen and the
     // compiler doing the maximum of optimization.
-    Mat9 A = Mat::Zero(9,9);
+    Mat9 A = Mat9::Zero();
     encodeEpipolarEquation(x1, x2, &A, weights);
     Nullspace(&A, &f);
   }
@@ -52,6 +52,18 @@ void solveProblem(const Mat& x1, const Mat& x2, std::vector<robustEstimation::Ma
   models.emplace_back(F);
 }
 
+std::size_t Fundamental8PSolver::solve(const FixedX1& x1, const FixedX2& x2, FixedModels& models) const
+{
+  Mat9 A = Mat9::Zero();
+  encodeEpipolarEquation(x1, x2, &A);
+
+  Vec9 f;
+  Nullspace(&A, &f);
+
+  models[0].setMatrix(Map<RMat3>(f.data()));
+  return 1;
+}
+
 void Fundamental8PSolver::solve(const Mat& x1, const Mat& x2, std::vector<robustEstimation::Mat3Model>& models) const
 {
   solveProblem(x1, x2, models);
@@ -17,8 +17,8 @@ namespace relativePose {
  *        Use template in order to support fixed or dynamic sized matrix.
  *        Allow solve H as homogeneous(x2) = H homogeneous(x1)
  */
-template<typename Matrix >
-void buildActionMatrix(Matrix& L, const Mat& x1, const Mat& x2)
+template<typename Matrix, typename TMatX>
+void buildActionMatrix(Matrix& L, const TMatX& x1, const TMatX& x2)
 {
   const Mat::Index n = x1.cols();
   for(Mat::Index i = 0; i < n; ++i)
@@ -41,6 +41,21 @@ void buildActionMatrix(Matrix& L, const Mat& x1, const Mat& x2)
   }
 }
 
+std::size_t Homography4PSolver::solve(const FixedX1& x1, const FixedX2& x2, FixedModels& models) const
+{
+  // in the case of minimal configuration we use fixed sized matrix to let
+  // Eigen and the compiler doing the maximum of optimization.
+  Eigen::Matrix<double, 16, 9> L = Eigen::Matrix<double, 16, 9>::Zero();
+  buildActionMatrix(L, x1, x2);
+
+  Vec9 h;
+  Nullspace(&L, &h);
+
+  // map the linear vector as the H matrix
+  models[0].setMatrix(Map<RMat3>(h.data()));
+  return 1;
+}
+
 void Homography4PSolver::solve(const Mat& x1, const Mat& x2, std::vector<robustEstimation::Mat3Model>& models) const
 {
   assert(2 == x1.rows());
@@ -50,23 +65,19 @@ void Homography4PSolver::solve(const Mat& x1, const Mat& x2, std::vector<robustE
 
   const Mat::Index n = x1.cols();
 
-  Vec9 h;
   if(n == 4)
   {
-    // in the case of minimal configuration we use fixed sized matrix to let
-    // Eigen and the compiler doing the maximum of optimization.
-    typedef Eigen::Matrix<double, 16, 9> Mat16_9;
-    Mat16_9 L = Mat::Zero(16, 9);
-    buildActionMatrix(L, x1, x2);
-    Nullspace(&L, &h);
-  }
-  else
-  {
-    MatX9 L = Mat::Zero(n * 2, 9);
-    buildActionMatrix(L, x1, x2);
-    Nullspace(&L, &h);
+    FixedModels fixedModels;
+    solve(FixedX1(x1), FixedX2(x2), fixedModels);
+    models.push_back(fixedModels[0]);
+    return;
   }
 
+  Vec9 h;
+  MatX9 L = Mat::Zero(n * 2, 9);
+  buildActionMatrix(L, x1, x2);
+  Nullspace(&L, &h);
+
   // map the linear vector as the H matrix
   Mat3 H = Map<RMat3>(h.data());
   models.emplace_back(H);
@@ -0,0 +1,221 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+#include <aliceVision/multiview/essential.hpp>
+#include <aliceVision/multiview/RelativePoseKernel.hpp>
+#include <aliceVision/multiview/Unnormalizer.hpp>
+#include <aliceVision/multiview/relativePose/Essential5PSolver.hpp>
+#include <aliceVision/multiview/relativePose/Fundamental7PSolver.hpp>
+#include <aliceVision/multiview/relativePose/Fundamental8PSolver.hpp>
+#include <aliceVision/multiview/relativePose/Homography4PSolver.hpp>
+#include <aliceVision/multiview/relativePose/FundamentalError.hpp>
+#include <aliceVision/multiview/relativePose/HomographyError.hpp>
+#include <aliceVision/robustEstimation/randSampling.hpp>
+
+#define BOOST_TEST_MODULE relativePoseSolverAllocation
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+#include <aliceVision/unitTest.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+
+using namespace aliceVision;
+using namespace aliceVision::multiview;
+
+// Count the heap allocations of the fitting loop (operator new and Eigen both end up in malloc).
+// Counting is only available with the GNU C library, where malloc can be interposed.
+
+namespace {
+
+std::atomic<bool> countAllocations(false);
+std::atomic<std::size_t> nbAllocations(0);
+
+} // namespace
+
+#if defined(__GLIBC__)
+#define ALICEVISION_COUNT_ALLOCATIONS
+
+extern "C" void* __libc_malloc(std::size_t size);
+
+extern "C" void* malloc(std::size_t size)
+{
+  if(countAllocations)
+    ++nbAllocations;
+  return __libc_malloc(size);
+}
+#endif
+
+/**
+ * @brief Fit models on random minimal samples like ACRANSAC does: the models vector is reused across iterations.
+ * @param[in] kernel the kernel to benchmark
+ * @param[in] useKernelFit fit with the kernel (fixed-size path) or with the dynamic solver on extracted columns
+ * @param[out] nbModels the total number of models
+ * @return the number of heap allocations per iteration
+ */
+template<typename KernelT>
+double benchmarkFit(const KernelT& kernel, const Mat& x1, const Mat& x2, bool useKernelFit, std::size_t& nbModels)
+{
+  const std::size_t nbIterations = 1000;
+  const std::size_t sampleSize = kernel.getMinimumNbRequiredSamples();
+
+  // draw the samples before counting
+  std::vector<std::vector<std::size_t>> samples(nbIterations);
+  for(auto& sample : samples)
+    robustEstimation::uniformSample(sampleSize, kernel.nbSamples(), sample);
+
+  std::vector<robustEstimation::Mat3Model> models;
+  models.reserve(kernel.getMaximumNbModels());
+  const typename KernelT::SolverT solver;
+  nbModels = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  nbAllocations = 0;
+  countAllocations = true;
+
+  for(const auto& sample : samples)
+  {
+    models.clear();
+    if(useKernelFit)
+      kernel.fit(sample, models);
+    else
+      solver.solve(ExtractColumns(x1, sample), ExtractColumns(x2, sample), models);
+    nbModels += models.size();
+  }
+
+  countAllocations = false;
+  const double duration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  ALICEVISION_LOG_INFO((useKernelFit ? "fixed-size" : "dynamic") << " fit: "
+                       << duration / nbIterations << " us/iteration, "
+                       << nbAllocations / double(nbIterations) << " allocations/iteration");
+
+  return nbAllocations / double(nbIterations);
+}
+
+template<typename KernelT>
+void checkAllocationFree(const KernelT& kernel, const Mat& x1, const Mat& x2)
+{
+  std::size_t nbModelsFixed = 0;
+  std::size_t nbModelsDynamic = 0;
+
+  const double allocationsFixed = benchmarkFit(kernel, x1, x2, true, nbModelsFixed);
+  const double allocationsDynamic = benchmarkFit(kernel, x1, x2, false, nbModelsDynamic);
+
+  BOOST_CHECK(nbModelsFixed > 0);
+  BOOST_CHECK(nbModelsDynamic > 0);
+
+#ifdef ALICEVISION_COUNT_ALLOCATIONS
+  BOOST_CHECK_EQUAL(allocationsFixed, 0.0);
+  BOOST_CHECK(allocationsDynamic > 0.0);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(RelativePoseKernel_fixedSizeSolvers_noAllocation)
+{
+  const NViewDataSet d = NRealisticCamerasRing(2, 50, NViewDatasetConfigurator());
+  const Mat x1 = d._x[0];
+  const Mat x2 = d._x[1];
+  const int w = 2 * d._K[0](0, 2);
+  const int h = 2 * d._K[0](1, 2);
+
+  {
+    ALICEVISION_LOG_INFO("Fundamental7PSolver");
+    using KernelT = RelativePoseKernel<relativePose::Fundamental7PSolver, relativePose::FundamentalEpipolarDistanceError, UnnormalizerT>;
+    const KernelT kernel(x1, w, h, x2, w, h, true);
+    checkAllocationFree(kernel, x1, x2);
+  }
+  {
+    ALICEVISION_LOG_INFO("Fundamental8PSolver");
+    using KernelT = RelativePoseKernel<relativePose::Fundamental8PSolver, relativePose::FundamentalEpipolarDistanceError, UnnormalizerT>;
+    const KernelT kernel(x1, w, h, x2, w, h, true);
+    checkAllocationFree(kernel, x1, x2);
+  }
+  {
+    ALICEVISION_LOG_INFO("Homography4PSolver");
+    using KernelT = RelativePoseKernel<relativePose::Homography4PSolver, relativePose::HomographyAsymmetricError, UnnormalizerI>;
+    const KernelT kernel(x1, w, h, x2, w, h, false);
+    checkAllocationFree(kernel, x1, x2);
+  }
+  {
+    ALICEVISION_LOG_INFO("Essential5PSolver");
+    using KernelT = RelativePoseKernel_K<relativePose::Essential5PSolver, relativePose::FundamentalEpipolarDistanceError>;
+    const KernelT kernel(x1, w, h, x2, w, h, d._K[0], d._K[1]);
+    checkAllocationFree(kernel, x1, x2);
+  }
+}
+
+/**
+ * @brief Check that one of the models is the ground truth model, up to scale
+ */
+bool hasModel(const std::vector<robustEstimation::Mat3Model>& models, const Mat3& modelGT)
+{
+  const Mat3 normalizedGT = modelGT / modelGT.norm();
+  for(const robustEstimation::Mat3Model& model : models)
+  {
+    const Mat3 normalized = model.getMatrix() / model.getMatrix().norm();
+    if(std::min((normalized - normalizedGT).norm(), (normalized + normalizedGT).norm()) < 1e-6)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Solve a minimal sample with the fixed-size and the dynamic solve() and check both against the ground truth
+ */
+template<typename SolverT>
+void checkGroundTruthModel(const Mat& x1, const Mat& x2, const Mat3& modelGT)
+{
+  const SolverT solver;
+
+  typename SolverT::FixedModels fixedModels;
+  const std::size_t nbModels = solver.solve(typename SolverT::FixedX1(x1), typename SolverT::FixedX2(x2), fixedModels);
+  BOOST_CHECK(hasModel(std::vector<robustEstimation::Mat3Model>(fixedModels.begin(), fixedModels.begin() + nbModels), modelGT));
+
+  std::vector<robustEstimation::Mat3Model> dynamicModels;
+  solver.solve(x1, x2, dynamicModels);
+  BOOST_CHECK_EQUAL(dynamicModels.size(), nbModels);
+  BOOST_CHECK(hasModel(dynamicModels, modelGT));
+}
+
+BOOST_AUTO_TEST_CASE(RelativePoseKernel_fixedSizeSolvers_groundTruth)
+{
+  const NViewDataSet d = NRealisticCamerasRing(2, 8, NViewDatasetConfigurator());
+  const Mat x1 = d._x[0];
+  const Mat x2 = d._x[1];
+
+  Mat3 E, F;
+  essentialFromRt(d._R[0], d._t[0], d._R[1], d._t[1], &E);
+  fundamentalFromEssential(E, d._K[0], d._K[1], &F);
+
+  {
+    ALICEVISION_LOG_INFO("Fundamental7PSolver");
+    checkGroundTruthModel<relativePose::Fundamental7PSolver>(x1.leftCols<7>(), x2.leftCols<7>(), F);
+  }
+  {
+    ALICEVISION_LOG_INFO("Fundamental8PSolver");
+    checkGroundTruthModel<relativePose::Fundamental8PSolver>(x1, x2, F);
+  }
+  {
+    ALICEVISION_LOG_INFO("Essential5PSolver");
+    // the essential matrix is estimated from camera coordinates
+    const Mat x1Cam = (d._K[0].inverse() * x1.leftCols<5>().colwise().homogeneous()).colwise().hnormalized();
+    const Mat x2Cam = (d._K[1].inverse() * x2.leftCols<5>().colwise().homogeneous()).colwise().hnormalized();
+    checkGroundTruthModel<relativePose::Essential5PSolver>(x1Cam, x2Cam, E);
+  }
+  {
+    ALICEVISION_LOG_INFO("Homography4PSolver");
+    Mat3 H;
+    H << 1.2, 0.1, -20.0,
+         -0.05, 0.9, 35.0,
+         1e-4, -2e-4, 1.0;
+    const Mat x2H = (H * x1.leftCols<4>().colwise().homogeneous()).colwise().hnormalized();
+    checkGroundTruthModel<relativePose::Homography4PSolver>(x1.leftCols<4>(), x2H, H);
+  }
+}
@@ -71,16 +71,14 @@ void solveQuartic(const Vec5& factors, Vec4& realRoots)
  *
  * @param[in] featureVectors: 3x3 matrix with UNITARY feature vectors (each column is a vector)
  * @param[in] worldPoints: 3x3 matrix with corresponding 3D world points (each column is a point)
- * @param[out] solutions: 3x16 matrix that will contain the solutions
+ * @param[out] solutions: 3x16 fixed-size matrix that will contain the solutions
  *                   form: [ C1,R1, C2,R2 ... ]
  *                   the obtained orientation matrices are defined as transforming points from the cam to the world frame
  * @return true if correct execution, false if world points aligned
  * @author: Laurent Kneip, adapted to the project by Pierre Moulon
  */
-bool computeP3PPoses(const Mat3& featureVectors, const Mat3& worldPoints, Mat& solutions)
+bool computeP3PPoses(const Mat3& featureVectors, const Mat3& worldPoints, Eigen::Matrix<double, 3, 16>& solutions)
 {
-  solutions = Mat(3, 4 * 4);
-
   // extraction of world points
 
   Vec3 P1 = worldPoints.col(0);
@@ -250,17 +248,9 @@ bool computeP3PPoses(const Mat3& featureVectors, const Mat3& worldPoints, Mat& s
   return true;
 }
 
-void P3PSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<robustEstimation::Mat34Model>& models) const
+std::size_t P3PSolver::solve(const FixedX1& x2d, const FixedX2& x3d, FixedModels& models) const
 {
-  assert(2 == x2d.rows());
-  assert(3 == x3d.rows());
-  assert(x2d.cols() == x3d.cols());
-
-  Mat3 R;
-  Vec3 t;
-  Mat34 P;
-
-  Mat solutions = Mat(3, 16);
+  Eigen::Matrix<double, 3, 16> solutions;
 
   Mat3 pt2D_3x3;
   pt2D_3x3.block<2, 3>(0, 0) = x2d;
@@ -269,19 +259,31 @@ void P3PSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<robustEstimati
   pt2D_3x3.col(1).normalize();
   pt2D_3x3.col(2).normalize();
 
-  Mat3 pt3D_3x3 = x3d;
+  if(!computeP3PPoses(pt2D_3x3, x3d, solutions))
+    return 0;
+
+  Mat34 P;
 
-  if(computeP3PPoses(pt2D_3x3, pt3D_3x3, solutions))
+  for(std::size_t i = 0; i < 4; ++i)
   {
-    for(size_t i = 0; i < 4; ++i)
-    {
-      R = solutions.block<3, 3>(0, i * 4 + 1);
-      t = -R * solutions.col(i * 4);
-      P_from_KRt(Mat3::Identity(), R, t, &P); // K = Id
-
-      models.emplace_back(P);
-    }
+    const Mat3 R = solutions.block<3, 3>(0, i * 4 + 1);
+    const Vec3 t = -R * solutions.col(i * 4);
+    P_from_KRt(Mat3::Identity(), R, t, &P); // K = Id
+
+    models[i].setMatrix(P);
   }
+  return 4;
+}
+
+void P3PSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<robustEstimation::Mat34Model>& models) const
+{
+  assert(2 == x2d.rows());
+  assert(3 == x3d.rows());
+  assert(x2d.cols() == x3d.cols());
+
+  FixedModels fixedModels;
+  const std::size_t nbModels = solve(FixedX1(x2d.leftCols<3>()), FixedX2(x3d.leftCols<3>()), fixedModels);
+  models.insert(models.end(), fixedModels.begin(), fixedModels.begin() + nbModels);
 }
 
 }  // namespace resection
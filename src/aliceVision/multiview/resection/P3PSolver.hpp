@@ -10,6 +10,8 @@
 
 #include <aliceVision/robustEstimation/ISolver.hpp>
 
+#include <array>
+
 namespace aliceVision {
 namespace multiview {
 namespace resection {
@@ -20,6 +22,11 @@ class P3PSolver : public robustEstimation::ISolver<robustEstimation::Mat34Model>
 {
 public:
 
+  /// fixed-size minimal sample and models buffer, see robustEstimation::IsFixedSizeSolver
+  using FixedX1 = Eigen::Matrix<double, 2, 3>;
+  using FixedX2 = Mat3;
+  using FixedModels = std::array<robustEstimation::Mat34Model, 4>;
+
   /**
    * @brief Return the minimum number of required samples
    * @return minimum number of required samples
@@ -47,6 +54,16 @@ public:
    */
    void solve(const Mat& x2d, const Mat& x3d, std::vector<robustEstimation::Mat34Model>& models) const override;
 
+   /**
+    * @brief Solve the problem of camera pose on a fixed-size minimal sample, without heap allocation.
+    *
+    * @param[in] x2d 2d points in the first image. One per column.
+    * @param[in] x3d Corresponding 3d points in the second image. One per column.
+    * @param[out] models The buffer of candidate solutions.
+    * @return The number of solutions written at the beginning of models (0 or 4).
+    */
+   std::size_t solve(const FixedX1& x2d, const FixedX2& x3d, FixedModels& models) const;
+
    /**
     * @brief Solve the problem.
     *
@@ -1066,57 +1066,37 @@ void computeP4pfPoses(const double *glab, const double *a1, const double *b1, co
  * @brief isNan
  * @param[in] A matrix
  */
-bool isNan(const Eigen::MatrixXcd &A)
+bool isNan(const Eigen::Matrix<std::complex<double>, 4, 10>& A)
 {
-  const Mat B = A.real();
-  for(Mat::Index i = 0; i < B.cols() * B.rows(); ++i)
-  {
-    if(std::isnan(B.data()[i])) return true;
-  }
-  return false;
+  return A.real().hasNaN();
 }
 
 /**
  * @brief validSol
  * @param[in] sol
- * @param[out] vSol
+ * @param[out] vSol the real solutions, in the first nbSolutions columns
+ * @param[out] nbSolutions the number of real solutions
  */
-bool validSol(const Eigen::MatrixXcd &sol, Mat &vSol)
+bool validSol(const Eigen::Matrix<std::complex<double>, 4, 10>& sol, Eigen::Matrix<double, 4, 10>& vSol, Mat::Index& nbSolutions)
 {
-  assert(sol.cols() == 10 && sol.rows() == 4);
-
-  Mat imSol = sol.imag();
-  Mat reSol = sol.real();
-  std::vector<Mat::Index> correct;
+  nbSolutions = 0;
   for(Mat::Index i = 0; i < 10; ++i)
   {
     bool isReal = true;
     for(Mat::Index j = 0; j < 4; ++j)
     {
-      if(imSol(j, i) != 0)
+      if(sol(j, i).imag() != 0)
       {
         isReal = false;
         break;
       }
     }
-    if(isReal && reSol(3, i) > 0)
-    {
-      correct.push_back(i);
-    }
-  }
-  if(correct.empty())
-  {
-    return false;
-  }
-  else
-  {
-    vSol = Mat(4, correct.size());
-    for(std::size_t i = 0; i < correct.size(); ++i)
+    if(isReal && sol(3, i).real() > 0)
     {
-      vSol.block(0, i, 4, 1) = reSol.block(0, correct.at(i), 4, 1);
+      vSol.col(nbSolutions++) = sol.col(i).real();
     }
   }
-  return true;
+  return nbSolutions > 0;
 }
 
 /**
@@ -1126,30 +1106,27 @@ bool validSol(const Eigen::MatrixXcd &sol, Mat &vSol)
  * @param[out] R
  * @param[out] t
  */
-void getRigidTransform(const Mat &pp1, const Mat &pp2, Mat &R, Vec3 &t)
+void getRigidTransform(const Mat34& pp1, const Mat34& pp2, Mat3& R, Vec3& t)
 {
-  Mat p1(pp1);
-  Mat p2(pp2);
+  Mat34 p1(pp1);
+  Mat34 p2(pp2);
 
   // shift centers of gravity to the origin
-  const Mat p1mean = p1.rowwise().sum() * 0.25;
-  const Mat p2mean = p2.rowwise().sum() * 0.25;
-  for(Mat::Index i = 0; i < 4; i++)
-  {
-    p1.block(0, i, 3, 1) -= p1mean;
-    p2.block(0, i, 3, 1) -= p2mean;
-  }
+  const Vec3 p1mean = p1.rowwise().sum() * 0.25;
+  const Vec3 p2mean = p2.rowwise().sum() * 0.25;
+  p1.colwise() -= p1mean;
+  p2.colwise() -= p2mean;
 
   // normalize to unit size
-  const Mat u1 = p1 * p1.colwise().norm().cwiseInverse().asDiagonal();
-  const Mat u2 = p2 * p2.colwise().norm().cwiseInverse().asDiagonal();
+  const Mat34 u1 = p1 * p1.colwise().norm().cwiseInverse().asDiagonal();
+  const Mat34 u2 = p2 * p2.colwise().norm().cwiseInverse().asDiagonal();
 
   // calc rotation
-  const Mat C = u2 * u1.transpose();
-  Eigen::JacobiSVD<Mat> svd(C, Eigen::ComputeThinU | Eigen::ComputeThinV);
-  const Mat U = svd.matrixU();
-  const Mat V = svd.matrixV();
-  Mat S = svd.singularValues();
+  const Mat3 C = u2 * u1.transpose();
+  Eigen::JacobiSVD<Mat3> svd(C, Eigen::ComputeFullU | Eigen::ComputeFullV);
+  const Mat3 U = svd.matrixU();
+  const Mat3 V = svd.matrixV();
+  Vec3 S = svd.singularValues();
 
   // fit to rotation space
   S(0) = (S(0) >= 0 ? 1 : -1);
@@ -1160,18 +1137,14 @@ void getRigidTransform(const Mat &pp1, const Mat &pp2, Mat &R, Vec3 &t)
   t = -R * p1mean + p2mean;
 }
 
-void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& models) const
+std::size_t P4PfSolver::solve(const FixedX1& x2d, const FixedX2& x3d, FixedModels& models) const
 {
-  Mat pt2D(x2d);
-  Mat pt3D(x3d);
-
-  assert(2 == pt2D.rows());
-  assert(3 == pt3D.rows());
-  assert(pt2D.cols() == pt3D.cols());
+  FixedX1 pt2D(x2d);
+  FixedX2 pt3D(x3d);
 
   const Vec3 mean3d = pt3D.rowwise().mean();
 
-  pt3D -= (mean3d * Mat::Constant(1, 4, 1.0));
+  pt3D.colwise() -= mean3d;
 
   const double var = pt3D.colwise().norm().sum() / 4;
   const double var2d = pt2D.colwise().norm().sum() / 4;
@@ -1189,9 +1162,9 @@ void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& m
 
   // initial solution degeneracy - invalid input
   if(glab * glac * glad * glbc * glbd * glcd < tol)
-    return;
+    return 0;
 
-  Mat A = Mat::Zero(10, 10);
+  Eigen::Matrix<double, 10, 10> A = Eigen::Matrix<double, 10, 10>::Zero();
   {
     const double gl[] = {glab, glac, glad, glbc, glbd, glcd};
     const double *a1 = pt2D.col(0).data();
@@ -1202,25 +1175,24 @@ void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& m
     computeP4pfPoses(gl, a1, b1, c1, d1, A.data());
   }
 
-  Mat vSol;
+  Eigen::Matrix<double, 4, 10> vSol;
+  Mat::Index nbSolutions = 0;
   {
-    Eigen::EigenSolver<Mat> es(A.transpose());
-    Eigen::MatrixXcd sol = es.eigenvectors();
-    Eigen::MatrixXcd diag = sol.row(0).cwiseInverse().asDiagonal();
-
-    sol = sol.block(1, 0, 4, 10) * diag;
+    const Eigen::EigenSolver<Eigen::Matrix<double, 10, 10> > es(A.transpose());
+    const Eigen::Matrix<std::complex<double>, 10, 10> eigenvectors = es.eigenvectors();
+    const Eigen::Matrix<std::complex<double>, 4, 10> sol = eigenvectors.block<4, 10>(1, 0) * eigenvectors.row(0).cwiseInverse().asDiagonal();
 
     // contain at least one NaN
     if(isNan(sol))
-      return;
+      return 0;
 
     // separarte valid solutions
-    if(!validSol(sol, vSol))
-      return;
+    if(!validSol(sol, vSol, nbSolutions))
+      return 0;
   }
 
   // recover camera rotation and translation
-  for(Mat::Index i = 0; i < vSol.cols(); ++i)
+  for(Mat::Index i = 0; i < nbSolutions; ++i)
   {
     const double f = sqrt(vSol(3, i));
     const double zd = vSol(0, i);
@@ -1228,19 +1200,19 @@ void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& m
     const double zb = vSol(2, i);
 
     // create p3d points in a camera coordinate system(using depths)
-    Mat p3dc = Mat(3, 4);
+    Mat34 p3dc;
     p3dc << pt2D(0, 0), zb * pt2D(0, 1), zc * pt2D(0, 2), zd * pt2D(0, 3),
             pt2D(1, 0), zb * pt2D(1, 1), zc * pt2D(1, 2), zd * pt2D(1, 3),
             f, zb * f, zc * f, zd * f;
 
     // fix scale(recover 'za')
-    Mat d = Mat(6, 1);
-    d(0, 0) = sqrt(glab / (p3dc.col(0) - p3dc.col(1)).squaredNorm());
-    d(1, 0) = sqrt(glac / (p3dc.col(0) - p3dc.col(2)).squaredNorm());
-    d(2, 0) = sqrt(glad / (p3dc.col(0) - p3dc.col(3)).squaredNorm());
-    d(3, 0) = sqrt(glbc / (p3dc.col(1) - p3dc.col(2)).squaredNorm());
-    d(4, 0) = sqrt(glbd / (p3dc.col(1) - p3dc.col(3)).squaredNorm());
-    d(5, 0) = sqrt(glcd / (p3dc.col(2) - p3dc.col(3)).squaredNorm());
+    Vec6 d;
+    d(0) = sqrt(glab / (p3dc.col(0) - p3dc.col(1)).squaredNorm());
+    d(1) = sqrt(glac / (p3dc.col(0) - p3dc.col(2)).squaredNorm());
+    d(2) = sqrt(glad / (p3dc.col(0) - p3dc.col(3)).squaredNorm());
+    d(3) = sqrt(glbc / (p3dc.col(1) - p3dc.col(2)).squaredNorm());
+    d(4) = sqrt(glbd / (p3dc.col(1) - p3dc.col(3)).squaredNorm());
+    d(5) = sqrt(glcd / (p3dc.col(2) - p3dc.col(3)).squaredNorm());
     // all d(i) should be equal...
 
     //gta = median(d);
@@ -1248,16 +1220,27 @@ void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& m
     p3dc = gta * p3dc;
 
     // calc camera
-    Mat Rr;
+    Mat3 Rr;
     Vec3 tt;
     getRigidTransform(pt3D, p3dc, Rr, tt);
     const Vec3 t = var * tt - Rr * mean3d;
 
     // output
-    models.emplace_back(Rr, t, f * var2d);
+    models[i] = P4PfModel(Rr, t, f * var2d);
   }
+  return static_cast<std::size_t>(nbSolutions);
 }
 
+void P4PfSolver::solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& models) const
+{
+  assert(2 == x2d.rows());
+  assert(3 == x3d.rows());
+  assert(x2d.cols() == x3d.cols());
+
+  FixedModels fixedModels;
+  const std::size_t nbModels = solve(FixedX1(x2d.leftCols<4>()), FixedX2(x3d.leftCols<4>()), fixedModels);
+  models.insert(models.end(), fixedModels.begin(), fixedModels.begin() + nbModels);
+}
 
 } // namespace resection
 } // namespace multiview
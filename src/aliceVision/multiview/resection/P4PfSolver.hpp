@@ -10,6 +10,8 @@
 #include <aliceVision/robustEstimation/ISolver.hpp>
 #include <aliceVision/multiview/resection/ISolverErrorResection.hpp>
 
+#include <array>
+
 namespace aliceVision {
 namespace multiview {
 namespace resection {
@@ -19,7 +21,9 @@ namespace resection {
  */
 struct P4PfModel
 {
-  P4PfModel(Mat R, Vec3 t, double f)
+  P4PfModel() = default;
+
+  P4PfModel(const Mat3& R, const Vec3& t, double f)
     : _R(R)
     , _t(t)
     , _f(f)
@@ -28,7 +32,7 @@ struct P4PfModel
   Mat34 getP() const
   {
     Mat34 P;
-    Mat K = Mat(3, 3);
+    Mat3 K;
 
     K << _f, 0, 0,
          0, _f, 0,
@@ -41,11 +45,11 @@ struct P4PfModel
   }
 
   /// rotation matrix
-  Mat _R;
+  Mat3 _R = Mat3::Identity();
   /// translation vector
-  Vec3 _t;
+  Vec3 _t = Vec3::Zero();
   /// focal length
-  double _f;
+  double _f = 1.0;
 };
 
 struct P4PfError : public ISolverErrorResection<P4PfModel>
@@ -73,6 +77,11 @@ class P4PfSolver : public robustEstimation::ISolver<P4PfModel>
 {
 public:
 
+  /// fixed-size minimal sample and models buffer, see robustEstimation::IsFixedSizeSolver
+  using FixedX1 = Eigen::Matrix<double, 2, 4>;
+  using FixedX2 = Mat34;
+  using FixedModels = std::array<P4PfModel, 10>;
+
   /**
    * @brief Return the minimum number of required samples
    * @return minimum number of required samples
@@ -101,6 +110,15 @@ public:
    */
   void solve(const Mat& x2d, const Mat& x3d, std::vector<P4PfModel>& models)  const override;
 
+  /**
+   * @brief Solve the problem of camera pose on a fixed-size minimal sample, without heap allocation.
+   * @param[in] x2d featureVectors 2 x 4 matrix with feature vectors with subtracted principal point (each column is a vector)
+   * @param[in] x3d worldPoints 3 x 4 matrix with corresponding 3D world points (each column is a point)
+   * @param[out] models The buffer of candidate solutions
+   * @return The number of solutions written at the beginning of models
+   */
+  std::size_t solve(const FixedX1& x2d, const FixedX2& x3d, FixedModels& models) const;
+
   /**
    * @brief Solve the problem.
    *
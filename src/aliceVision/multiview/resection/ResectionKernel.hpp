@@ -31,15 +31,13 @@ public:
 
   void fit(const std::vector<std::size_t>& samples, std::vector<ModelT>& models) const override
   {
-    const Mat x2d = ExtractColumns(KernelBase::_x1, samples);
-    const Mat x3d = ExtractColumns(KernelBase::_x2, samples);
+    assert(2 == KernelBase::_x1.rows());
+    assert(3 == KernelBase::_x2.rows());
+    assert(KernelBase::_kernelSolver.getMinimumNbRequiredSamples() <= samples.size());
+    assert(KernelBase::_x1.cols() == KernelBase::_x2.cols());
 
-    assert(2 == x2d.rows());
-    assert(3 == x3d.rows());
-    assert(KernelBase::_kernelSolver.getMinimumNbRequiredSamples() <= x2d.cols());
-    assert(x2d.cols() == x3d.cols());
-
-    KernelBase::_kernelSolver.solve(x2d, x3d, models);
+    // minimal samples of fixed-size solvers are solved without heap allocation
+    KernelBase::fit(samples, models);
   }
 };
 
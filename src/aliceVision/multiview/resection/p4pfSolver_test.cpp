@@ -99,6 +99,31 @@ BOOST_AUTO_TEST_CASE(Resection_P4Pf_AssignmentWithMoreResults)
   BOOST_CHECK(pass);
 }
 
+BOOST_AUTO_TEST_CASE(Resection_P4Pf_FixedSize)
+{
+  // DATA
+  resection::P4PfSolver::FixedX1 pt2D;
+  pt2D << 774.88000, -772.31000, -1661.63300, -1836.57300,
+          -534.74500, -554.09400, -585.53300, -430.03000;
+  resection::P4PfSolver::FixedX2 pt3D;
+  pt3D << 2.01852, 1.00709, 0.74051, 0.61962,
+          0.02133, 0.30770, 0.16656, 0.11249,
+          -1.68077, 0.81502, 1.21056, 1.22624;
+
+  // PROCESS
+  resection::P4PfSolver solver;
+  resection::P4PfSolver::FixedModels fixedModels;
+  const std::size_t nbModels = solver.solve(pt2D, pt3D, fixedModels);
+
+  std::vector<resection::P4PfModel> models;
+  solver.solve(Mat(pt2D), Mat(pt3D), models);
+
+  BOOST_CHECK_EQUAL(nbModels, 3);
+  BOOST_CHECK_EQUAL(nbModels, models.size());
+  for(std::size_t i = 0; i < std::min(nbModels, models.size()); ++i)
+    BOOST_CHECK(isEqual(fixedModels.at(i), models.at(i)));
+}
+
 BOOST_AUTO_TEST_CASE(Resection_P4Pf_AssignmentWithNoResults)
 {
   // DATA
@@ -101,6 +101,51 @@ BOOST_AUTO_TEST_CASE(P3P_Kneip_CVPR11_Multiview)
 }
 */
 
+BOOST_AUTO_TEST_CASE(P3P_FixedSize)
+{
+  const int nViews = 3;
+  const int nbPoints = 12;
+  const NViewDataSet d = NRealisticCamerasRing(nViews, nbPoints,
+    NViewDatasetConfigurator(1,1,0,0,5,0)); // Suppose a camera with Unit matrix as K
+
+  const int nResectionCameraIndex = 2;
+  const Mat x = d._x[nResectionCameraIndex];
+  const Mat X = d._X;
+  const Mat34 GT_ProjectionMatrix = d.P(nResectionCameraIndex).array() / d.P(nResectionCameraIndex).norm();
+
+  // the kernel uses the fixed-size solver on minimal samples
+  using Kernel = resection::ResectionKernel<resection::P3PSolver, resection::ProjectionDistanceError>;
+  static_assert(robustEstimation::IsFixedSizeSolver<resection::P3PSolver>::value, "P3PSolver should provide a fixed-size solve");
+
+  const Kernel kernel(x, X);
+  const resection::P3PSolver solver;
+
+  // 4 disjoint minimal samples
+  for(std::size_t s = 0; s < nbPoints / 3; ++s)
+  {
+    const std::vector<std::size_t> sample = {3 * s, 3 * s + 1, 3 * s + 2};
+
+    std::vector<robustEstimation::Mat34Model> kernelModels;
+    kernel.fit(sample, kernelModels);
+
+    std::vector<robustEstimation::Mat34Model> dynamicModels;
+    solver.solve(ExtractColumns(x, sample), ExtractColumns(X, sample), dynamicModels);
+
+    BOOST_CHECK_EQUAL(kernelModels.size(), dynamicModels.size());
+
+    bool bFound = false;
+    for(std::size_t i = 0; i < kernelModels.size(); ++i)
+    {
+      EXPECT_MATRIX_NEAR(kernelModels.at(i).getMatrix(), dynamicModels.at(i).getMatrix(), 1e-12);
+
+      const Mat34 COMPUTED_ProjectionMatrix = kernelModels.at(i).getMatrix().array() / kernelModels.at(i).getMatrix().norm();
+      if(NormLInfinity(GT_ProjectionMatrix - COMPUTED_ProjectionMatrix) < 1e-6)
+        bFound = true;
+    }
+    BOOST_CHECK(bFound);
+  }
+}
+
 // Create a new synthetic dataset for the EPnP implementation.
 // It seems it do not perform well on translation like t = (0,0,x)
 
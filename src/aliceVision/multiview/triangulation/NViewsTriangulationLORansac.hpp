@@ -28,7 +28,8 @@ namespace multiview {
  * the LORansac framework.
  * 
  * @tparam SolverArg The minimal solver able to find a solution from a
- * minimum set of points.
+ * minimum set of points. The solvers are given the indices of the samples
+ * (see TriangulateNViewsSolver) so that fitting does not copy the data.
  * @tparam ErrorArg The functor computing the error for each data sample with
  * respect to the estimated model, usually a reprojection error functor.
  * @tparam UnnormalizerArg The functor used to normalize the data before the 
@@ -78,7 +79,7 @@ public:
    * @param[in] _pt2d The feature points, a 2xN matrix.
    * @param[in] projMatrices The N projection matrix for each view.
    */
-  NViewsTriangulationLORansac(const Mat2X& _pt2d, const std::vector<Mat34>& projMatrices)
+  NViewsTriangulationLORansac(const Eigen::Ref<const Mat2X>& _pt2d, const std::vector<Mat34>& projMatrices)
   : _pt2d(_pt2d)
   , _projMatrices(projMatrices)
   {
@@ -92,10 +93,7 @@ public:
    */
   void fit(const std::vector<std::size_t>& samples, std::vector<ModelT_>& models) const override
   {
-    const Mat p2d = ExtractColumns(_pt2d, samples);
-    std::vector<Mat34> sampledMats;
-    pick(sampledMats, _projMatrices, samples);
-    _kernelSolver.solve(p2d, sampledMats, models);
+    _kernelSolver.solve(_pt2d, _projMatrices, samples, models);
   }
 
   /**
@@ -108,10 +106,7 @@ public:
              std::vector<ModelT_>& models,
              const std::vector<double> *weights = nullptr) const override
   {
-    const Mat p2d = ExtractColumns(_pt2d, inliers);
-    std::vector<Mat34> sampledMats;
-    pick(sampledMats, _projMatrices, inliers);
-    _kernelSolverLs.solve(p2d, sampledMats, models, *weights);
+    _kernelSolverLs.solve(_pt2d, _projMatrices, inliers, models, weights);
   }
 
 
@@ -209,7 +204,7 @@ public:
   }
 
 private:
-  const Mat2X& _pt2d;
+  const Eigen::Ref<const Mat2X> _pt2d;
   const std::vector<Mat34>& _projMatrices;
 
   const SolverT _kernelSolver = SolverT();
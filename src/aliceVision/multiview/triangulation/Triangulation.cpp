@@ -11,6 +11,7 @@
 #include <aliceVision/numeric/projection.hpp>
 #include <aliceVision/robustEstimation/LORansac.hpp>
 #include <aliceVision/robustEstimation/ScoreEvaluator.hpp>
+#include <aliceVision/stl/Arena.hpp>
 
 namespace aliceVision {
 namespace multiview {
@@ -22,8 +23,11 @@ void TriangulateNView(const Mat2X &x,
 {
   Mat2X::Index nviews = x.cols();
   assert(static_cast<std::size_t>(nviews) == Ps.size());
+  assert(nviews >= 2);
 
-  Mat design = Mat::Zero(3 * nviews, 4 + nviews);
+  stl::arena_scope scratch;
+  Eigen::Map<Mat> design(scratch.allocate<double>(3 * nviews * (4 + nviews)), 3 * nviews, 4 + nviews);
+  design.setZero();
   for(Mat2X::Index i = 0; i < nviews; i++)
   {
     design.block<3, 4>(3 * i, 0) = -Ps[i];
@@ -31,33 +35,67 @@ void TriangulateNView(const Mat2X &x,
     design(3 * i + 1, 4 + i) = x(1, i);
     design(3 * i + 2, 4 + i) = 1.0;
   }
-  Vec X_and_alphas;
-  Nullspace(&design, &X_and_alphas);
-  *X = X_and_alphas.head(4);
+  // nullspace of the design matrix (at least as many rows as columns with 2 views)
+  const Eigen::JacobiSVD<Mat> svd(design, Eigen::ComputeFullV);
+  *X = svd.matrixV().col(design.cols() - 1).head<4>();
 }
 
-void TriangulateNViewAlgebraic(const Mat2X &x,
-                               const std::vector< Mat34 > &Ps,
-                               Vec4 *X, 
-                               const std::vector<double> *weights)
+namespace {
+
+/**
+ * @brief Algebraic triangulation from the views getView(0) ... getView(nviews - 1).
+ * The design matrix is scratch data of the thread arena.
+ */
+template <typename GetViewT>
+void triangulateNViewAlgebraic(const Eigen::Ref<const Mat2X>& x,
+                               const std::vector<Mat34>& Ps,
+                               Mat::Index nviews,
+                               GetViewT getView,
+                               Vec4* X,
+                               const std::vector<double>* weights)
 {
   assert(X != nullptr);
-  Mat2X::Index nviews = x.cols();
-  assert(static_cast<std::size_t>(nviews) == Ps.size());
+  assert(nviews >= 2);
 
-  Mat design(2 * nviews, 4);
-  for(Mat2X::Index i = 0; i < nviews; ++i)
+  stl::arena_scope scratch;
+  Eigen::Map<Mat> design(scratch.allocate<double>(2 * nviews * 4), 2 * nviews, 4);
+  for(Mat::Index i = 0; i < nviews; ++i)
   {
-    design.block<2, 4>(2 * i, 0) = SkewMatMinimal(x.col(i)) * Ps[i];
+    const std::size_t view = getView(i);
+    design.block<2, 4>(2 * i, 0) = SkewMatMinimal(x.col(view)) * Ps[view];
     if(weights != nullptr)
     {
       design.block<2, 4>(2 * i, 0) *= (*weights)[i];
     }
   }
-  Nullspace(&design, X);
+  // nullspace of the design matrix (at least as many rows as columns with 2 views)
+  const Eigen::JacobiSVD<Mat> svd(design, Eigen::ComputeFullV);
+  *X = svd.matrixV().col(3);
 }
 
-void TriangulateNViewLORANSAC(const Mat2X& x,
+} // namespace
+
+void TriangulateNViewAlgebraic(const Mat2X &x,
+                               const std::vector< Mat34 > &Ps,
+                               Vec4 *X, 
+                               const std::vector<double> *weights)
+{
+  assert(static_cast<std::size_t>(x.cols()) == Ps.size());
+  triangulateNViewAlgebraic(x, Ps, x.cols(), [](Mat::Index i) { return static_cast<std::size_t>(i); }, X, weights);
+}
+
+void TriangulateNViewAlgebraic(const Eigen::Ref<const Mat2X>& x,
+                               const std::vector<Mat34>& Ps,
+                               const std::vector<std::size_t>& indices,
+                               Vec4* X,
+                               const std::vector<double>* weights)
+{
+  assert(static_cast<std::size_t>(x.cols()) == Ps.size());
+  assert(weights == nullptr || weights->size() == indices.size());
+  triangulateNViewAlgebraic(x, Ps, indices.size(), [&indices](Mat::Index i) { return indices[i]; }, X, weights);
+}
+
+void TriangulateNViewLORANSAC(const Eigen::Ref<const Mat2X>& x,
                               const std::vector<Mat34>& Ps,
                               Vec4* X,
                               std::vector<std::size_t>* inliersIndex,
@@ -92,7 +130,7 @@ Vec3 Triangulation::compute(int iter) const
   // Iterative weighted linear least squares
   Mat3 AtA;
   Vec3 Atb, X;
-  std::vector<double> weights(nviews, double(1.0));
+  weights.assign(nviews, 1.0);
   for(int it = 0; it < iter; ++it)
   {
     AtA.fill(0.0);
@@ -161,6 +199,18 @@ void TriangulateNViewsSolver::solve(const Mat2X& x, const std::vector<Mat34>& Ps
   assert(X.size() == 1);
 }
 
+void TriangulateNViewsSolver::solve(const Eigen::Ref<const Mat2X>& x,
+                                    const std::vector<Mat34>& Ps,
+                                    const std::vector<std::size_t>& samples,
+                                    std::vector<robustEstimation::MatrixModel<Vec4>>& X,
+                                    const std::vector<double>* weights) const
+{
+  Vec4 pt3d;
+  TriangulateNViewAlgebraic(x, Ps, samples, &pt3d, weights);
+  X.push_back(robustEstimation::MatrixModel<Vec4>(pt3d));
+  assert(X.size() == 1);
+}
+
 } // namespace multiview
 } // namespace aliceVision
 
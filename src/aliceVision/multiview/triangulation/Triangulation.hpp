@@ -50,6 +50,22 @@ void TriangulateNViewAlgebraic(const Mat2X &x,
                                Vec4 *X, 
                                const std::vector<double> *weights = nullptr);
 
+/**
+ * @brief Compute a 3D position of a point from a subset of its images, see TriangulateNViewAlgebraic.
+ * The observations are not copied and the design matrix is allocated in the thread arena.
+ *
+ * @param[in] x are 2D coordinates (x,y,1) in each image
+ * @param[in] Ps is the list of projective matrices for each camera
+ * @param[in] indices the indices of the images to use
+ * @param[out] X is the estimated 3D point
+ * @param[in] weights a (optional) list of weights, one for each index
+ */
+void TriangulateNViewAlgebraic(const Eigen::Ref<const Mat2X>& x,
+                               const std::vector<Mat34>& Ps,
+                               const std::vector<std::size_t>& indices,
+                               Vec4* X,
+                               const std::vector<double>* weights = nullptr);
+
 /**
  * @brief Compute a 3D position of a point from several images of it. In particular,
  * compute the projective point X in R^4 such that x ~ PX.
@@ -62,7 +78,7 @@ void TriangulateNViewAlgebraic(const Mat2X &x,
  * @param[out] inliersIndex (optional) store the index of the cameras (following Ps ordering, not the view_id) set as Inliers by Lo-RANSAC
  * @param[in] thresholdError (optional) set a threashold value to the Lo-RANSAC scorer
  */                               
-void TriangulateNViewLORANSAC(const Mat2X &x, 
+void TriangulateNViewLORANSAC(const Eigen::Ref<const Mat2X> &x, 
                               const std::vector< Mat34 > &Ps,
                               Vec4 *X,
                               std::vector<std::size_t> *inliersIndex = NULL,
@@ -103,6 +119,7 @@ protected:
   mutable double zmin; // min depth, mutable since modified in compute(...) const;
   mutable double zmax; // max depth, mutable since modified in compute(...) const;
   mutable double err; // re-projection error, mutable since modified in compute(...) const;
+  mutable std::vector<double> weights; // per view weights buffer, reused across calls to compute(...) const;
   std::vector< std::pair<Mat34, Vec2> > views; // Proj matrix and associated image point
 };
 
@@ -131,6 +148,16 @@ struct TriangulateNViewsSolver
   
   void solve(const Mat2X& x, const std::vector<Mat34>& Ps, std::vector<robustEstimation::MatrixModel<Vec4>>& X, const std::vector<double>& weights) const;
 
+  /**
+   * @brief Triangulate from the subset \p samples of the views, without copying the observations.
+   * @param[in] weights (optional) one weight for each sample
+   */
+  void solve(const Eigen::Ref<const Mat2X>& x,
+             const std::vector<Mat34>& Ps,
+             const std::vector<std::size_t>& samples,
+             std::vector<robustEstimation::MatrixModel<Vec4>>& X,
+             const std::vector<double>* weights = nullptr) const;
+
 };
 
 } // namespace multiview
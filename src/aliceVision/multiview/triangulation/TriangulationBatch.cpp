@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "TriangulationBatch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace aliceVision {
+namespace multiview {
+
+void TriangulationBatch::reserve(std::size_t nbTracks, std::size_t nbObservations)
+{
+  _offsets.reserve(nbTracks + 1);
+  _points.reserve(nbTracks);
+  _valid.reserve(nbTracks);
+  _x.reserve(nbObservations);
+  _Ps.reserve(nbObservations);
+  _centers.reserve(nbObservations);
+  _maxErrors.reserve(nbObservations);
+}
+
+void TriangulationBatch::clear()
+{
+  _offsets.resize(1);
+  _points.clear();
+  _valid.clear();
+  _x.clear();
+  _Ps.clear();
+  _centers.clear();
+  _maxErrors.clear();
+}
+
+std::size_t TriangulationBatch::addTrack(std::size_t nbObservations)
+{
+  assert(nbObservations >= 2);
+
+  const std::size_t nbTotalObservations = _offsets.back() + nbObservations;
+  _offsets.push_back(nbTotalObservations);
+  _x.resize(nbTotalObservations);
+  _Ps.resize(nbTotalObservations);
+  _centers.resize(nbTotalObservations);
+  _maxErrors.resize(nbTotalObservations);
+
+  _points.emplace_back(Vec3::Zero());
+  _valid.push_back(0);
+  return _points.size() - 1;
+}
+
+void TriangulationBatch::setObservation(std::size_t track, std::size_t i, const Vec2& x, const Mat34& P, const Vec3& center, double maxError)
+{
+  assert(i < nbObservations(track));
+
+  const std::size_t index = _offsets[track] + i;
+  _x[index] = x;
+  _Ps[index] = P;
+  _centers[index] = center;
+  _maxErrors[index] = maxError;
+}
+
+void TriangulationBatch::triangulate(bool parallel)
+{
+  // pack the tracks by number of observations
+  std::vector<std::size_t> tracks(size());
+  std::iota(tracks.begin(), tracks.end(), 0);
+  std::stable_sort(tracks.begin(), tracks.end(), [this](std::size_t a, std::size_t b) {
+    return nbObservations(a) < nbObservations(b);
+  });
+
+  std::size_t begin = 0;
+  while(begin < tracks.size())
+  {
+    const std::size_t nbViews = nbObservations(tracks[begin]);
+    std::size_t end = begin + 1;
+    while(end < tracks.size() && nbObservations(tracks[end]) == nbViews)
+      ++end;
+
+    switch(nbViews)
+    {
+      case 2: triangulateTracks<2>(tracks, begin, end, parallel); break;
+      case 3: triangulateTracks<3>(tracks, begin, end, parallel); break;
+      case 4: triangulateTracks<4>(tracks, begin, end, parallel); break;
+      case 5: triangulateTracks<5>(tracks, begin, end, parallel); break;
+      case 6: triangulateTracks<6>(tracks, begin, end, parallel); break;
+      case 7: triangulateTracks<7>(tracks, begin, end, parallel); break;
+      case 8: triangulateTracks<8>(tracks, begin, end, parallel); break;
+      default: triangulateTracks<Eigen::Dynamic>(tracks, begin, end, parallel); break;
+    }
+    begin = end;
+  }
+}
+
+template <int NbViews>
+void TriangulationBatch::triangulateTracks(const std::vector<std::size_t>& tracks, std::size_t begin, std::size_t end, bool parallel)
+{
+  static_assert(NbViews == Eigen::Dynamic || NbViews <= getMaxFixedSizeViews(), "Too many views for a fixed-size triangulation");
+  using DesignMatrix = Eigen::Matrix<double, (NbViews == Eigen::Dynamic) ? Eigen::Dynamic : 2 * NbViews, 4>;
+
+  #pragma omp parallel for if(parallel)
+  for(std::ptrdiff_t i = begin; i < static_cast<std::ptrdiff_t>(end); ++i)
+  {
+    const std::size_t track = tracks[i];
+    const std::size_t first = _offsets[track];
+    const std::size_t nbViews = nbObservations(track);
+
+    DesignMatrix design(2 * nbViews, 4);
+    for(std::size_t v = 0; v < nbViews; ++v)
+      design.template block<2, 4>(2 * v, 0) = SkewMatMinimal(_x[first + v]) * _Ps[first + v];
+
+    // nullspace of the design matrix
+    const Eigen::JacobiSVD<DesignMatrix> svd(design, Eigen::ComputeFullV);
+    const Vec4 X = svd.matrixV().col(3);
+
+    _points[track] = X.hnormalized();
+    _valid[track] = checkPoint(track, _points[track]) ? 1 : 0;
+  }
+}
+
+bool TriangulationBatch::checkPoint(std::size_t track, const Vec3& X) const
+{
+  if(!X.allFinite())
+    return false;
+
+  const std::size_t first = _offsets[track];
+  const std::size_t last = _offsets[track + 1];
+  bool hasMinAngle = (_minAngle <= 0.0);
+
+  for(std::size_t i = first; i < last; ++i)
+  {
+    const Vec3 proj = _Ps[i] * X.homogeneous();
+
+    // cheirality: the third row of P is the depth row of [R|t]
+    if(proj(2) <= 0.0)
+      return false;
+
+    // reprojection error
+    if(!((proj.hnormalized() - _x[i]).norm() <= _maxErrors[i]))
+      return false;
+
+    // angle between the ray of this observation and the rays of the previous ones
+    for(std::size_t j = first; j < i && !hasMinAngle; ++j)
+    {
+      const Vec3 rayI = X - _centers[i];
+      const Vec3 rayJ = X - _centers[j];
+      const double cosAngle = rayI.dot(rayJ) / (rayI.norm() * rayJ.norm());
+      hasMinAngle = (radianToDegree(std::acos(clamp(cosAngle, -1.0 + 1.e-8, 1.0 - 1.e-8))) >= _minAngle);
+    }
+  }
+  return hasMinAngle;
+}
+
+} // namespace multiview
+} // namespace aliceVision
@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace multiview {
+
+/**
+ * @brief Algebraic triangulation (see TriangulateNViewAlgebraic) of many tracks at once.
+ *
+ * The tracks are packed by number of observations: the tracks seen by up to getMaxFixedSizeViews() views
+ * are solved with fixed-size matrices (no heap allocation), in parallel.
+ * Each triangulated point is validated in the same pass:
+ * - it is in front of all the cameras (cheirality)
+ * - its reprojection error is below the maximal error of each observation
+ * - at least one pair of rays forms an angle larger than the minimal angle
+ *
+ * The observations of a track are set after reserving them with addTrack,
+ * setObservation can be called concurrently on different tracks.
+ */
+class TriangulationBatch
+{
+public:
+
+  /**
+   * @param[in] minAngle the minimal angle (degree) between the rays of at least one pair of observations
+   */
+  explicit TriangulationBatch(double minAngle = 0.0)
+    : _minAngle(minAngle)
+  {}
+
+  /**
+   * @brief Return the maximum number of views of the tracks solved with fixed-size matrices
+   */
+  static constexpr int getMaxFixedSizeViews()
+  {
+    return 8;
+  }
+
+  /**
+   * @brief Reserve the memory for a batch.
+   * @param[in] nbTracks the number of tracks
+   * @param[in] nbObservations the total number of observations
+   */
+  void reserve(std::size_t nbTracks, std::size_t nbObservations);
+
+  /**
+   * @brief Remove all the tracks, the memory is kept.
+   */
+  void clear();
+
+  /**
+   * @brief Add a new track.
+   * @param[in] nbObservations the number of observations of the track (at least 2)
+   * @return the index of the track in the batch
+   */
+  std::size_t addTrack(std::size_t nbObservations);
+
+  /**
+   * @brief Set an observation of a track.
+   * @param[in] track the index of the track
+   * @param[in] i the index of the observation in the track
+   * @param[in] x the undistorted image point
+   * @param[in] P the projection matrix of the view: K [R|t] with K(2,2) = 1
+   * @param[in] center the center of the camera
+   * @param[in] maxError the maximal reprojection error of the observation (pixels)
+   */
+  void setObservation(std::size_t track, std::size_t i, const Vec2& x, const Mat34& P, const Vec3& center, double maxError);
+
+  /**
+   * @brief Triangulate and validate all the tracks.
+   * @param[in] parallel triangulate the tracks in parallel, disable it when called from a parallel region
+   */
+  void triangulate(bool parallel = true);
+
+  /**
+   * @brief Return the number of tracks
+   */
+  inline std::size_t size() const
+  {
+    return _points.size();
+  }
+
+  /**
+   * @brief Return the number of observations of a track
+   */
+  inline std::size_t nbObservations(std::size_t track) const
+  {
+    return _offsets[track + 1] - _offsets[track];
+  }
+
+  /**
+   * @brief Return the undistorted image point of an observation of a track
+   */
+  inline const Vec2& observation(std::size_t track, std::size_t i) const
+  {
+    return _x[_offsets[track] + i];
+  }
+
+  /**
+   * @brief Return the projection matrix of an observation of a track
+   */
+  inline const Mat34& projectionMatrix(std::size_t track, std::size_t i) const
+  {
+    return _Ps[_offsets[track] + i];
+  }
+
+  /**
+   * @brief Return the triangulated point of a track (valid after triangulate())
+   */
+  inline const Vec3& point(std::size_t track) const
+  {
+    return _points[track];
+  }
+
+  /**
+   * @brief Return true if the triangulated point passed all the checks (valid after triangulate())
+   */
+  inline bool isValid(std::size_t track) const
+  {
+    return _valid[track] != 0;
+  }
+
+private:
+
+  template <int NbViews>
+  void triangulateTracks(const std::vector<std::size_t>& tracks, std::size_t begin, std::size_t end, bool parallel);
+
+  bool checkPoint(std::size_t track, const Vec3& X) const;
+
+  double _minAngle;
+
+  /// offsets of the tracks in the observations arrays, size() + 1 elements
+  std::vector<std::size_t> _offsets = {0};
+  /// undistorted image points
+  std::vector<Vec2> _x;
+  /// projection matrices
+  std::vector<Mat34> _Ps;
+  /// camera centers
+  std::vector<Vec3> _centers;
+  /// maximal reprojection errors
+  std::vector<double> _maxErrors;
+
+  std::vector<Vec3> _points;
+  std::vector<unsigned char> _valid;
+};
+
+} // namespace multiview
+} // namespace aliceVision
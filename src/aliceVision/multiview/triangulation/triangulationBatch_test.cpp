@@ -0,0 +1,151 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/multiview/triangulation/TriangulationBatch.hpp>
+#include <aliceVision/multiview/triangulation/Triangulation.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+
+#define BOOST_TEST_MODULE TriangulationBatch
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+#include <aliceVision/unitTest.hpp>
+
+#include <vector>
+
+using namespace aliceVision;
+
+/**
+ * @brief Add to the batch the track of point i seen by the views [0, nbViews).
+ * @param[in] outlierView the view of a wrong observation (or -1)
+ */
+std::size_t addTrack(multiview::TriangulationBatch& batch, const NViewDataSet& d, int i, int nbViews, int outlierView = -1)
+{
+  const std::size_t track = batch.addTrack(nbViews);
+  for(int j = 0; j < nbViews; ++j)
+  {
+    const Vec2 x = (j == outlierView) ? Vec2(d._x[j].col(i) + Vec2(50.0, -50.0)) : Vec2(d._x[j].col(i));
+    batch.setObservation(track, j, x, d.P(j), d._C[j], 1.0);
+  }
+  return track;
+}
+
+BOOST_AUTO_TEST_CASE(TriangulationBatch_SameAsAlgebraic)
+{
+  const int nbViews = 12;
+  const int nbPoints = 20;
+  const NViewDataSet d = NRealisticCamerasRing(nbViews, nbPoints);
+
+  std::vector<Mat34> Ps(nbViews);
+  for(int j = 0; j < nbViews; ++j)
+    Ps[j] = d.P(j);
+
+  // tracks of all the lengths, interleaved, to exercise the fixed-size and dynamic solvers
+  multiview::TriangulationBatch batch(2.0);
+  std::vector<std::pair<int, int> > tracks; // <point, nb views>
+  for(int i = 0; i < nbPoints; ++i)
+  {
+    for(int n = 2; n <= nbViews; ++n)
+    {
+      addTrack(batch, d, i, n);
+      tracks.emplace_back(i, n);
+    }
+  }
+  batch.triangulate();
+
+  BOOST_CHECK_EQUAL(batch.size(), tracks.size());
+  for(std::size_t t = 0; t < tracks.size(); ++t)
+  {
+    const int i = tracks[t].first;
+    const int n = tracks[t].second;
+
+    Mat2X xs(2, n);
+    for(int j = 0; j < n; ++j)
+      xs.col(j) = d._x[j].col(i);
+    Vec4 X;
+    multiview::TriangulateNViewAlgebraic(xs, std::vector<Mat34>(Ps.begin(), Ps.begin() + n), &X);
+
+    BOOST_CHECK(batch.isValid(t));
+    BOOST_CHECK_EQUAL(batch.nbObservations(t), n);
+    EXPECT_MATRIX_NEAR(batch.point(t), X.hnormalized(), 1e-8);
+    EXPECT_MATRIX_NEAR(batch.point(t), d._X.col(i), 1e-8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TriangulationBatch_Serial)
+{
+  const int nbViews = 10;
+  const int nbPoints = 20;
+  const NViewDataSet d = NRealisticCamerasRing(nbViews, nbPoints);
+
+  // same results when triangulated from a parallel region
+  multiview::TriangulationBatch parallelBatch;
+  multiview::TriangulationBatch serialBatch;
+  for(int i = 0; i < nbPoints; ++i)
+  {
+    const int n = 2 + i % (nbViews - 1);
+    addTrack(parallelBatch, d, i, n, (i % 3 == 0) ? 0 : -1);
+    addTrack(serialBatch, d, i, n, (i % 3 == 0) ? 0 : -1);
+  }
+  parallelBatch.triangulate();
+  serialBatch.triangulate(false);
+
+  BOOST_CHECK_EQUAL(serialBatch.size(), parallelBatch.size());
+  for(std::size_t t = 0; t < serialBatch.size(); ++t)
+  {
+    BOOST_CHECK_EQUAL(serialBatch.isValid(t), parallelBatch.isValid(t));
+    BOOST_CHECK(serialBatch.point(t) == parallelBatch.point(t));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TriangulationBatch_Checks)
+{
+  const int nbViews = 6;
+  const int nbPoints = 10;
+  const NViewDataSet d = NRealisticCamerasRing(nbViews, nbPoints);
+
+  for(int i = 0; i < nbPoints; ++i)
+  {
+    multiview::TriangulationBatch batch(2.0);
+    const std::size_t inlierTrack = addTrack(batch, d, i, 4);
+    const std::size_t outlierTrack = addTrack(batch, d, i, 4, 2);
+    const std::size_t outlierPairTrack = addTrack(batch, d, i, 2, 1);
+    batch.triangulate();
+
+    BOOST_CHECK(batch.isValid(inlierTrack));
+    // the reprojection error of the wrong observation is too large
+    BOOST_CHECK(!batch.isValid(outlierTrack));
+    BOOST_CHECK(!batch.isValid(outlierPairTrack));
+  }
+
+  {
+    // no pair of rays forms a large enough angle
+    multiview::TriangulationBatch batch(180.0);
+    addTrack(batch, d, 0, 4);
+    batch.triangulate();
+    BOOST_CHECK(!batch.isValid(0));
+  }
+  {
+    // the point is behind the cameras
+    multiview::TriangulationBatch batch;
+    const std::size_t track = batch.addTrack(2);
+    for(int j = 0; j < 2; ++j)
+      batch.setObservation(track, j, d._x[j].col(0), -d.P(j), d._C[j], 1.0);
+    batch.triangulate();
+    BOOST_CHECK(!batch.isValid(track));
+  }
+  {
+    // clear keeps a usable batch
+    multiview::TriangulationBatch batch;
+    addTrack(batch, d, 0, 3);
+    batch.clear();
+    BOOST_CHECK_EQUAL(batch.size(), 0);
+    addTrack(batch, d, 1, 3);
+    batch.triangulate();
+    BOOST_CHECK(batch.isValid(0));
+    EXPECT_MATRIX_NEAR(batch.point(0), d._X.col(1), 1e-8);
+  }
+}
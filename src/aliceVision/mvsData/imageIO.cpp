@@ -177,6 +177,28 @@ void readImageSpec(const std::string& path,
   in->close();
 }
 
+void readImageSpec(const std::string& path,
+                   int& width,
+                   int& height,
+                   int& nchannels,
+                   oiio::ParamValueList& metadata)
+{
+  ALICEVISION_LOG_DEBUG("[IO] Read Image Spec and Metadata: " << path);
+  std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path));
+
+  if(!in)
+    throw std::runtime_error("Can't find/open image file '" + path + "'.");
+
+  const oiio::ImageSpec &spec = in->spec();
+
+  width = spec.width;
+  height = spec.height;
+  nchannels = spec.nchannels;
+  metadata = spec.extra_attribs;
+
+  in->close();
+}
+
 void readImageMetadata(const std::string& path, oiio::ParamValueList& metadata)
 {
   ALICEVISION_LOG_DEBUG("[IO] Read Image Metadata: " << path);
@@ -205,7 +227,8 @@ void readImage(const std::string& path,
                int& width,
                int& height,
                std::vector<T>& buffer,
-               EImageColorSpace toColorSpace)
+               EImageColorSpace toColorSpace,
+               int downscale = 1)
 {
     ALICEVISION_LOG_DEBUG("[IO] Read Image: " << path);
 
@@ -225,9 +248,34 @@ void readImage(const std::string& path,
     configSpec.attribute("raw:ColorSpace", "Linear");   // want linear colorspace with sRGB primaries
 #endif
 
-    oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
+    // use a reduced resolution level of the image file if available (e.g. mipmapped EXR),
+    // to avoid decoding the full resolution image
+    int miplevel = 0;
+    if(downscale > 1)
+    {
+        oiio::ImageBuf headerBuf;
+        if(headerBuf.init_spec(path, 0, 0))
+        {
+            const int levelWidth = headerBuf.spec().width / downscale;
+            const int levelHeight = headerBuf.spec().height / downscale;
+            const int nbLevels = headerBuf.nmiplevels();
+
+            for(int level = 1; level < nbLevels && headerBuf.init_spec(path, 0, level); ++level)
+            {
+                if(headerBuf.spec().width == levelWidth && headerBuf.spec().height == levelHeight)
+                {
+                    miplevel = level;
+                    break;
+                }
+            }
+        }
+        if(miplevel > 0)
+            ALICEVISION_LOG_TRACE("Read image " << path << " at mip level " << miplevel << " (downscale: " << downscale << ").");
+    }
+
+    oiio::ImageBuf inBuf(path, 0, miplevel, NULL, &configSpec);
 
-    inBuf.read(0, 0, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+    inBuf.read(0, miplevel, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
 
     if(!inBuf.initialized())
         throw std::runtime_error("Cannot find/open image file '" + path + "'.");
@@ -339,10 +387,10 @@ void readImage(const std::string& path, int& width, int& height, std::vector<Col
     readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, buffer, toColorSpace);
 }
 
-void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace)
+void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace, int downscale)
 {
     int width, height;
-    readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, image.data(), toColorSpace);
+    readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, image.data(), toColorSpace, downscale);
     image.setWidth(width);
     image.setHeight(height);
 }
@@ -166,6 +166,16 @@ std::istream& operator>>(std::istream& in, EImageFileType& imageFileType);
  */
 void readImageSpec(const std::string& path, int& width, int& height, int& nchannels);
 
+/**
+ * @brief read image dimension and metadata from a given path, opening the file once
+ * @param[in] path The given path to the image
+ * @param[out] width The image width
+ * @param[out] height The image height
+ * @param[out] nchannels The image channel number
+ * @param[out] metadata The image metadata
+ */
+void readImageSpec(const std::string& path, int& width, int& height, int& nchannels, oiio::ParamValueList& metadata);
+
 /**
  * @brief read image metadata from a given path
  * @param[in] path The given path to the image
@@ -193,7 +203,17 @@ void readImage(const std::string& path, int& width, int& height, std::vector<uns
 void readImage(const std::string& path, int& width, int& height, std::vector<rgb>& buffer, EImageColorSpace toColorSpace);
 void readImage(const std::string& path, int& width, int& height, std::vector<float>& buffer, EImageColorSpace toColorSpace);
 void readImage(const std::string& path, int& width, int& height, std::vector<Color>& buffer, EImageColorSpace toColorSpace);
-void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace);
+
+/**
+ * @brief read an image with a given path, using a reduced resolution level of the file if available
+ * @param[in] path The given path to the image
+ * @param[out] image The output image
+ * @param[in] toColorSpace The output image color space
+ * @param[in] downscale The requested downscale factor. If the file contains a resolution level (e.g. mipmapped EXR)
+ *            of exactly the original size / downscale, only this level is decoded. Otherwise the full resolution
+ *            image is returned and has to be downscaled by the caller.
+ */
+void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace, int downscale = 1);
 
 /**
  * @brief write an image with a given path and buffer
@@ -0,0 +1,182 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ImageSpecCache.hpp"
+#include <aliceVision/mvsData/imageIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const std::string cacheFileHeader = "# AliceVision image spec cache v1";
+
+bool getFileStamp(const std::string& path, std::uintmax_t& fileSize, std::time_t& lastWriteTime)
+{
+    boost::system::error_code ec;
+    fileSize = fs::file_size(path, ec);
+    if(ec)
+        return false;
+    lastWriteTime = fs::last_write_time(path, ec);
+    return !ec;
+}
+
+} // namespace
+
+void readImageSpec(const std::string& path, ImageSpec& spec)
+{
+    oiio::ParamValueList metadata;
+    int nchannels;
+    imageIO::readImageSpec(path, spec.width, spec.height, nchannels, metadata);
+
+    const auto scaleIt = metadata.find("AliceVision:downscale");
+    const auto pIt = metadata.find("AliceVision:P");
+
+    spec.downscale = (scaleIt != metadata.end() && scaleIt->type() == oiio::TypeDesc::INT) ? scaleIt->get_int() : 0;
+    spec.minDepth = metadata.get_float("AliceVision:minDepth", -1);
+    spec.maxDepth = metadata.get_float("AliceVision:maxDepth", -1);
+    spec.hasP = (pIt != metadata.end() && pIt->type() == oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44));
+
+    if(spec.hasP)
+    {
+        const double* rawP = static_cast<const double*>(pIt->data());
+        std::copy(rawP, rawP + 16, spec.P.begin());
+    }
+}
+
+ImageSpecCache::ImageSpecCache(const std::string& filename)
+    : _filename(filename)
+{
+    load(_filename, _entries);
+    ALICEVISION_LOG_DEBUG("Image spec cache '" << _filename << "': " << _entries.size() << " entries loaded.");
+}
+
+bool ImageSpecCache::find(const std::string& path, ImageSpec& spec) const
+{
+    const auto it = _entries.find(path);
+    if(it == _entries.end())
+        return false;
+
+    std::uintmax_t fileSize;
+    std::time_t lastWriteTime;
+    if(!getFileStamp(path, fileSize, lastWriteTime) ||
+       fileSize != it->second.fileSize ||
+       lastWriteTime != it->second.lastWriteTime)
+        return false;
+
+    spec = it->second.spec;
+    return true;
+}
+
+void ImageSpecCache::add(const std::string& path, const ImageSpec& spec)
+{
+    Entry entry;
+    if(!getFileStamp(path, entry.fileSize, entry.lastWriteTime))
+        return;
+    entry.spec = spec;
+    _entries[path] = entry;
+    _addedEntries[path] = entry;
+}
+
+void ImageSpecCache::load(const std::string& filename, std::map<std::string, Entry>& entries)
+{
+    std::ifstream is(filename);
+    if(!is.is_open())
+        return;
+
+    std::string line;
+    if(!std::getline(is, line) || line != cacheFileHeader)
+    {
+        ALICEVISION_LOG_WARNING("Ignore invalid image spec cache file: " << filename);
+        return;
+    }
+
+    while(std::getline(is, line))
+    {
+        std::istringstream ls(line);
+        Entry entry;
+        ImageSpec& spec = entry.spec;
+
+        ls >> entry.fileSize >> entry.lastWriteTime >> spec.width >> spec.height >> spec.downscale
+           >> spec.minDepth >> spec.maxDepth >> spec.hasP;
+
+        if(spec.hasP)
+            for(double& v : spec.P)
+                ls >> v;
+
+        std::string path;
+        ls.get(); // separator
+        std::getline(ls, path);
+
+        if(ls.fail() || path.empty())
+        {
+            ALICEVISION_LOG_WARNING("Ignore invalid line in image spec cache file: " << filename);
+            continue;
+        }
+        entries[path] = entry;
+    }
+}
+
+bool ImageSpecCache::save() const
+{
+    if(_addedEntries.empty())
+        return true;
+
+    // several MVS processes may share the same cache: reload the current file content
+    // to keep the entries saved by the other processes since this cache has been loaded
+    std::map<std::string, Entry> entries;
+    load(_filename, entries);
+    for(const auto& entryPair : _addedEntries)
+        entries[entryPair.first] = entryPair.second;
+
+    // write a temporary file first, then replace the cache file atomically
+    const std::string tmpFilename = _filename + "." + fs::unique_path().string();
+    {
+        std::ofstream os(tmpFilename);
+        if(!os.is_open())
+        {
+            ALICEVISION_LOG_WARNING("Cannot write image spec cache file: " << _filename);
+            return false;
+        }
+
+        os << cacheFileHeader << "\n" << std::setprecision(17);
+        for(const auto& entryPair : entries)
+        {
+            const Entry& entry = entryPair.second;
+            const ImageSpec& spec = entry.spec;
+
+            os << entry.fileSize << " " << entry.lastWriteTime << " " << spec.width << " " << spec.height << " " << spec.downscale << " "
+               << spec.minDepth << " " << spec.maxDepth << " " << spec.hasP;
+            if(spec.hasP)
+                for(double v : spec.P)
+                    os << " " << v;
+            os << " " << entryPair.first << "\n";
+        }
+    }
+
+    boost::system::error_code ec;
+    fs::rename(tmpFilename, _filename, ec);
+    if(ec)
+    {
+        fs::remove(tmpFilename, ec);
+        ALICEVISION_LOG_WARNING("Cannot write image spec cache file: " << _filename);
+        return false;
+    }
+    return true;
+}
+
+} // namespace mvsUtils
+} // namespace aliceVision
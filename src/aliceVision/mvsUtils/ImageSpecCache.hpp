@@ -0,0 +1,93 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <string>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+/**
+ * @brief Image header information used by the MVS pipeline
+ */
+struct ImageSpec
+{
+    int width = 0;
+    int height = 0;
+    /// AliceVision:downscale metadata, 0 if not available
+    int downscale = 0;
+    /// AliceVision:minDepth metadata, -1 if not available
+    float minDepth = -1.0f;
+    /// AliceVision:maxDepth metadata, -1 if not available
+    float maxDepth = -1.0f;
+    /// true if the AliceVision:P metadata (raw 4x4 projection matrix) is available
+    bool hasP = false;
+    std::array<double, 16> P{};
+};
+
+/**
+ * @brief Read the image header and fill the ImageSpec
+ * @param[in] path the image path
+ * @param[out] spec the image spec
+ */
+void readImageSpec(const std::string& path, ImageSpec& spec);
+
+/**
+ * @brief Persistent cache of image specs, stored in a single text file.
+ *        Entries are only valid if the image file size and last write time are unchanged.
+ *        The file can be shared by several processes: save() merges the entries added by
+ *        this instance into the current file content and replaces the file atomically.
+ */
+class ImageSpecCache
+{
+public:
+    explicit ImageSpecCache(const std::string& filename);
+
+    /**
+     * @brief Get a valid cached spec
+     * @note thread-safe, as long as no entry is added concurrently
+     * @param[in] path the image path
+     * @param[out] spec the cached image spec
+     * @return true if a valid entry is found
+     */
+    bool find(const std::string& path, ImageSpec& spec) const;
+
+    /**
+     * @brief Add or replace an entry, stamped with the current image file size and last write time
+     * @param[in] path the image path
+     * @param[in] spec the image spec
+     */
+    void add(const std::string& path, const ImageSpec& spec);
+
+    /**
+     * @brief Merge the added entries into the cache file if entries have been added
+     * @return false if the file cannot be written
+     */
+    bool save() const;
+
+private:
+    struct Entry
+    {
+        std::uintmax_t fileSize = 0;
+        std::time_t lastWriteTime = 0;
+        ImageSpec spec;
+    };
+
+    std::string _filename;
+    std::map<std::string, Entry> _entries;
+    /// entries added by this instance, to merge into the cache file
+    std::map<std::string, Entry> _addedEntries;
+
+    static void load(const std::string& filename, std::map<std::string, Entry>& entries);
+};
+
+} // namespace mvsUtils
+} // namespace aliceVision
@@ -6,6 +6,7 @@
 
 #include "MultiViewParams.hpp"
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/CompactObservations.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/Matrix3x4.hpp>
@@ -13,9 +14,11 @@
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
+#include <aliceVision/mvsUtils/ImageSpecCache.hpp>
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/numeric/projection.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/filesystem.hpp>
 #include <boost/accumulators/accumulators.hpp>
@@ -25,7 +28,9 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <set>
 
 namespace aliceVision {
@@ -39,7 +44,8 @@ MultiViewParams::MultiViewParams(const sfmData::SfMData& sfmData,
                                  const std::string& depthMapsFilterFolder,
                                  bool readFromDepthMaps,
                                  int downscale,
-                                 StaticVector<CameraMatrices>* cameras)
+                                 StaticVector<CameraMatrices>* cameras,
+                                 const std::string& imagesSpecCacheFilename)
     : _sfmData(sfmData)
     , _imagesFolder(imagesFolder + "/")
     , _depthMapsFolder(depthMapsFolder + "/")
@@ -50,8 +56,24 @@ MultiViewParams::MultiViewParams(const sfmData::SfMData& sfmData,
     simThr = userParams.get<double>("global.simThr", 0.0);
     _useSil = userParams.get<bool>("global.use_silhouettes", _useSil);
 
+    // images which are the original view images: their dimensions are given by the view
+    std::vector<char> originalImages;
+
     // load image uid, path and dimensions
     {
+        // image file extension per file stem in the images folder, the first one found is used
+        std::map<std::string, std::string> imagesExtensions;
+
+        if(!readFromDepthMaps && _imagesFolder != "/" && !_imagesFolder.empty() && fs::is_directory(_imagesFolder) && !fs::is_empty(_imagesFolder))
+        {
+            for(const fs::directory_entry& e : fs::recursive_directory_iterator(_imagesFolder))
+            {
+                const std::string extension = e.path().extension().string();
+                if(imageIO::isSupportedUndistortFormat(extension))
+                    imagesExtensions.emplace(e.path().stem().string(), extension);
+            }
+        }
+
         std::set<std::pair<int, int>> dimensions; // for print only
         int i = 0;
         for(const auto& viewPair : sfmData.getViews())
@@ -70,19 +92,15 @@ MultiViewParams::MultiViewParams(const sfmData::SfMData& sfmData,
           else if(_imagesFolder != "/" && !_imagesFolder.empty() && fs::is_directory(_imagesFolder) && !fs::is_empty(_imagesFolder))
           {
             // find folder file extension
-            const fs::recursive_directory_iterator end;
-            const auto findIt = std::find_if(fs::recursive_directory_iterator(_imagesFolder), end,
-                                     [&view](const fs::directory_entry& e) {
-                                        return (e.path().stem() == std::to_string(view.getViewId()) &&
-                                        (imageIO::isSupportedUndistortFormat(e.path().extension().string())));
-                                     });
-
-            if(findIt == end)
+            const auto findIt = imagesExtensions.find(std::to_string(view.getViewId()));
+
+            if(findIt == imagesExtensions.end())
               throw std::runtime_error("Cannot find image file " + std::to_string(view.getViewId()) + " in folder " + _imagesFolder);
 
-            path = _imagesFolder + std::to_string(view.getViewId()) + findIt->path().extension().string();
+            path = _imagesFolder + std::to_string(view.getViewId()) + findIt->second;
           }
 
+          originalImages.push_back(path == view.getImagePath() && view.getWidth() > 0 && view.getHeight() > 0);
           dimensions.emplace(view.getWidth(), view.getHeight());
           _imagesParams.emplace_back(view.getViewId(), view.getWidth(), view.getHeight(), path);
           _imageIdsPerViewId[view.getViewId()] = i;
@@ -99,29 +117,26 @@ MultiViewParams::MultiViewParams(const sfmData::SfMData& sfmData,
     // Resize internal structures
     resizeCams(getNbCameras());
 
+    const std::vector<ImageSpec> imagesSpecs = readImagesSpecs(originalImages, imagesSpecCacheFilename);
+
     for(int i = 0; i < getNbCameras(); ++i)
     {
         const ImageParams& imgParams = _imagesParams.at(i);
+        const ImageSpec& imgSpec = imagesSpecs.at(i);
 
-        oiio::ParamValueList metadata;
-        imageIO::readImageMetadata(imgParams.path, metadata);
-
-        const auto scaleIt = metadata.find("AliceVision:downscale");
-        const auto pIt = metadata.find("AliceVision:P");
+        _imagesMinMaxDepths.at(i) = Point2d(imgSpec.minDepth, imgSpec.maxDepth);
 
         // find image scale information
-        if(scaleIt != metadata.end() && scaleIt->type() == oiio::TypeDesc::INT)
+        if(imgSpec.downscale > 0)
         {
             // use aliceVision image metadata
-            _imagesScale.at(i) = scaleIt->get_int();
+            _imagesScale.at(i) = imgSpec.downscale;
         }
         else
         {
             // use image dimension
-            int w, h, channels;
-            imageIO::readImageSpec(imgParams.path, w, h, channels);
-            const int widthScale = imgParams.width / w;
-            const int heightScale = imgParams.height / h;
+            const int widthScale = imgParams.width / imgSpec.width;
+            const int heightScale = imgParams.height / imgSpec.height;
 
             if((widthScale != 1) && (heightScale != 1))
                 ALICEVISION_LOG_INFO("Reading '" << imgParams.path << "' x" << widthScale << "downscale from file dimension" << std::endl
@@ -148,10 +163,10 @@ MultiViewParams::MultiViewParams(const sfmData::SfMData& sfmData,
             iCamArr.at(i) = (*cameras)[i].iCam;
             FocK1K2Arr.at(i) = Point3d((*cameras)[i].f, (*cameras)[i].k1, (*cameras)[i].k2);
         }
-        else if(pIt != metadata.end() && pIt->type() == oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44))
+        else if(imgSpec.hasP)
         {
             ALICEVISION_LOG_DEBUG("Reading view " << getViewId(i) << " projection matrix from image metadata.");
-            loadMatricesFromRawProjectionMatrix(i, static_cast<const double*>(pIt->data()));
+            loadMatricesFromRawProjectionMatrix(i, imgSpec.P.data());
         }
         else
         {
@@ -221,8 +236,104 @@ MultiViewParams::MultiViewParams(const sfmData::SfMData& sfmData,
     }
 
     ALICEVISION_LOG_INFO("Overall maximum dimension: [" << _maxImageWidth << "x" << _maxImageHeight << "]");
+
+    buildLandmarksPerViewIndex();
 }
 
+std::vector<ImageSpec> MultiViewParams::readImagesSpecs(const std::vector<char>& originalImages, const std::string& imagesSpecCacheFilename) const
+{
+    std::vector<ImageSpec> imagesSpecs(getNbCameras());
+
+    // optional persistent spec cache, shared by the MVS nodes
+    std::unique_ptr<ImageSpecCache> specCache;
+    if(!imagesSpecCacheFilename.empty())
+        specCache.reset(new ImageSpecCache(imagesSpecCacheFilename));
+
+    std::vector<char> probed(getNbCameras(), 0);
+    std::vector<std::string> errors(getNbCameras());
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < getNbCameras(); ++i)
+    {
+        const ImageParams& imgParams = _imagesParams.at(i);
+        ImageSpec& imgSpec = imagesSpecs.at(i);
+
+        // original images have no AliceVision metadata, use the view dimensions
+        if(originalImages.at(i))
+        {
+            imgSpec.width = imgParams.width;
+            imgSpec.height = imgParams.height;
+            continue;
+        }
+
+        if(specCache && specCache->find(imgParams.path, imgSpec))
+            continue;
+
+        try
+        {
+            readImageSpec(imgParams.path, imgSpec);
+            probed.at(i) = 1;
+        }
+        catch(const std::exception& e)
+        {
+            errors.at(i) = e.what();
+        }
+    }
+
+    for(const std::string& error : errors)
+    {
+        if(!error.empty())
+            throw std::runtime_error(error);
+    }
+
+    if(specCache)
+    {
+        int nbProbed = 0;
+        for(int i = 0; i < getNbCameras(); ++i)
+        {
+            if(probed.at(i))
+            {
+                specCache->add(getImagePath(i), imagesSpecs.at(i));
+                ++nbProbed;
+            }
+        }
+        specCache->save();
+        ALICEVISION_LOG_INFO("Image specs: " << nbProbed << " read from image headers, " << (getNbCameras() - nbProbed) << " from cache or views.");
+    }
+
+    return imagesSpecs;
+}
+
+void MultiViewParams::buildLandmarksPerViewIndex()
+{
+    const sfmData::Landmarks& landmarks = _sfmData.getLandmarks();
+
+    _landmarks.clear();
+    _landmarks.reserve(landmarks.size());
+    for(const auto& landmarkPair : landmarks)
+      _landmarks.push_back(&landmarkPair.second);
+
+    // observations grouped by landmark and by view, in the sfmData landmarks order
+    _observations.reset(new sfmData::CompactObservations(landmarks));
+
+    _observationsViewIndexes.resize(getNbCameras());
+    for(int i = 0; i < getNbCameras(); ++i)
+      _observationsViewIndexes[i] = _observations->getViewIndex(getViewId(i));
+
+    ALICEVISION_LOG_DEBUG("Landmarks per view index: " << _landmarks.size() << " landmarks, " << _observations->getNbObservations() << " observations.");
+}
+
+std::size_t MultiViewParams::getNbLandmarks(int index) const
+{
+    const int viewIndex = _observationsViewIndexes.at(index);
+    return (viewIndex < 0) ? 0 : _observations->getNbViewObservations(viewIndex);
+}
+
+const sfmData::Landmark& MultiViewParams::getLandmark(int index, std::size_t i) const
+{
+    const std::size_t o = _observations->getViewObservation(_observationsViewIndexes.at(index), i);
+    return *_landmarks[_observations->getLandmarkIndex(o)];
+}
 
 void MultiViewParams::loadMatricesFromTxtFile(int index, const std::string& fileNameP, const std::string& fileNameD)
 {
@@ -334,22 +445,16 @@ void MultiViewParams::getMinMaxMidNbDepth(int index, float& min, float& max, flo
   Point3d midDepthPoint = Point3d();
   nbDepths = 0;
 
-  for(const auto& landmarkPair : _sfmData.getLandmarks())
+  for(std::size_t i = 0; i < getNbLandmarks(index); ++i)
   {
-    const sfmData::Landmark& landmark = landmarkPair.second;
+    const sfmData::Landmark& landmark = getLandmark(index, i);
     const Point3d point(landmark.X(0), landmark.X(1), landmark.X(2));
 
-    for(const auto& observationPair : landmark.observations)
-    {
-      if(observationPair.first == viewId)
-      {
-        const float distance = static_cast<float>(pointPlaneDistance(point, cameraPlane.p, cameraPlane.n));
-        accDistanceMin(distance);
-        accDistanceMax(distance);
-        midDepthPoint = midDepthPoint + point;
-        ++nbDepths;
-      }
-    }
+    const float distance = static_cast<float>(pointPlaneDistance(point, cameraPlane.p, cameraPlane.n));
+    accDistanceMin(distance);
+    accDistanceMax(distance);
+    midDepthPoint = midDepthPoint + point;
+    ++nbDepths;
   }
 
   min = quantile(accDistanceMin, quantile_probability = 1.0 - percentile);
@@ -566,17 +671,16 @@ StaticVector<int> MultiViewParams::findNearestCamsFromLandmarks(int rc, int nbNe
   const geometry::Pose3 pose = _sfmData.getPose(view).getTransform();
   const camera::IntrinsicBase* intrinsicPtr = _sfmData.getIntrinsicPtr(view.getIntrinsicId());
 
-  for(const auto& landmarkPair :_sfmData.getLandmarks())
-  {
-    const auto& observations = landmarkPair.second.observations;
+  const int viewIndex = _observationsViewIndexes.at(rc);
 
-    auto viewObsIt = observations.find(viewId);
-    if(viewObsIt == observations.end())
-      continue;
+  for(std::size_t i = 0; i < getNbLandmarks(rc); ++i)
+  {
+    const std::size_t viewObs = _observations->getViewObservation(viewIndex, i);
+    const std::size_t l = _observations->getLandmarkIndex(viewObs);
 
-    for(const auto& observationPair : observations)
+    for(std::size_t o = _observations->getLandmarkObservationsBegin(l); o < _observations->getLandmarkObservationsEnd(l); ++o)
     {
-      const IndexT otherViewId = observationPair.first;
+      const IndexT otherViewId = _observations->getViewId(o);
 
       if(otherViewId == viewId)
        continue;
@@ -585,7 +689,7 @@ StaticVector<int> MultiViewParams::findNearestCamsFromLandmarks(int rc, int nbNe
       const geometry::Pose3 otherPose = _sfmData.getPose(otherView).getTransform();
       const camera::IntrinsicBase* otherIntrinsicPtr = _sfmData.getIntrinsicPtr(otherView.getIntrinsicId());
 
-      const double angle = camera::AngleBetweenRays(pose, intrinsicPtr, otherPose, otherIntrinsicPtr, viewObsIt->second.x, observationPair.second.x);
+      const double angle = camera::AngleBetweenRays(pose, intrinsicPtr, otherPose, otherIntrinsicPtr, _observations->getX(viewObs), _observations->getX(o));
 
       if(angle < _minViewAngle || angle > _maxViewAngle)
         continue;
@@ -641,11 +745,8 @@ StaticVector<int> MultiViewParams::findCamsWhichIntersectsHexahedron(const Point
     tcams.reserve(getNbCameras());
     for(int rc = 0; rc < getNbCameras(); rc++)
     {
-        oiio::ParamValueList metadata;
-        imageIO::readImageMetadata(getImagePath(rc), metadata);
-
-        const float minDepth = metadata.get_float("AliceVision:minDepth", -1);
-        const float maxDepth = metadata.get_float("AliceVision:maxDepth", -1);
+        const float minDepth = static_cast<float>(_imagesMinMaxDepths.at(rc).x);
+        const float maxDepth = static_cast<float>(_imagesMinMaxDepths.at(rc).y);
 
         if(minDepth == -1 && maxDepth == -1)
         {
@@ -12,9 +12,11 @@
 #include <aliceVision/mvsData/Pixel.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsData/structures.hpp>
+#include <aliceVision/mvsUtils/ImageSpecCache.hpp>
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <map>
@@ -25,6 +27,8 @@ namespace bpt = boost::property_tree;
 
 namespace sfmData {
 class SfMData;
+struct Landmark;
+class CompactObservations;
 } // namespace sfmData
 
 namespace mvsUtils {
@@ -106,7 +110,8 @@ public:
                     const std::string& depthMapsFilterFolder = "",
                     bool readFromDepthMaps = false,
                     int downscale = 1,
-                    StaticVector<CameraMatrices>* cameras = nullptr);
+                    StaticVector<CameraMatrices>* cameras = nullptr,
+                    const std::string& imagesSpecCacheFilename = "");
 
     ~MultiViewParams();
 
@@ -281,6 +286,21 @@ public:
      */
     StaticVector<int> findNearestCamsFromLandmarks(int rc, int nbNearestCams) const;
 
+    /**
+     * @brief Get the number of landmarks observed by the given camera
+     * @param[in] index the camera index
+     * @return number of landmarks
+     */
+    std::size_t getNbLandmarks(int index) const;
+
+    /**
+     * @brief Get a landmark observed by the given camera
+     * @param[in] index the camera index
+     * @param[in] i the landmark local index in [0, getNbLandmarks(index)[
+     * @return the landmark
+     */
+    const sfmData::Landmark& getLandmark(int index, std::size_t i) const;
+
 
     inline void setMinViewAngle(float minViewAngle)
     {
@@ -299,6 +319,8 @@ private:
     std::map<IndexT, int> _imageIdsPerViewId;
     /// image scale list
     std::vector<int> _imagesScale;
+    /// image min/max depth from AliceVision metadata (-1 if not available)
+    std::vector<Point2d> _imagesMinMaxDepths;
     /// downscale apply to input images during process
     int _processDownscale = 1;
     /// maximum width
@@ -317,10 +339,18 @@ private:
     float _maxViewAngle = 70.0f;  // WARNING: may be too low, especially when using seeds from SfM
     /// input sfmData
     const sfmData::SfMData& _sfmData;
+    /// input sfmData landmarks, in the sfmData order
+    std::vector<const sfmData::Landmark*> _landmarks;
+    /// input sfmData landmarks observations, with the same landmark indexes as _landmarks
+    std::unique_ptr<sfmData::CompactObservations> _observations;
+    /// view index in _observations per camera index, -1 if the camera has no observation
+    std::vector<int> _observationsViewIndexes;
 
     void loadMatricesFromTxtFile(int index, const std::string& fileNameP, const std::string& fileNameD);
     void loadMatricesFromRawProjectionMatrix(int index, const double* rawProjMatix);
     void loadMatricesFromSfM(int index);
+    void buildLandmarksPerViewIndex();
+    std::vector<ImageSpec> readImagesSpecs(const std::vector<char>& originalImages, const std::string& imagesSpecCacheFilename) const;
 
     inline void resizeCams(int _ncams)
     {
@@ -334,6 +364,7 @@ private:
         iCamArr.resize(ncams);
         FocK1K2Arr.resize(ncams);
         _imagesScale.resize(ncams);
+        _imagesMinMaxDepths.resize(ncams);
     }
 };
 
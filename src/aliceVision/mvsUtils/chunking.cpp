@@ -0,0 +1,304 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "chunking.hpp"
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+std::string EChunkingMode_informations()
+{
+  return "Chunking mode:\n"
+         "* index: chunks of contiguous camera indexes\n"
+         "* neighbors: chunks of cameras sharing the same neighbor cameras";
+}
+
+EChunkingMode EChunkingMode_stringToEnum(const std::string& chunkingMode)
+{
+  std::string mode = chunkingMode;
+  std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower); //tolower
+
+  if(mode == "index")     return EChunkingMode::INDEX;
+  if(mode == "neighbors") return EChunkingMode::NEIGHBORS;
+
+  throw std::out_of_range("Invalid chunking mode: " + chunkingMode);
+}
+
+std::string EChunkingMode_enumToString(const EChunkingMode chunkingMode)
+{
+  switch(chunkingMode)
+  {
+    case EChunkingMode::INDEX:     return "index";
+    case EChunkingMode::NEIGHBORS: return "neighbors";
+  }
+  throw std::out_of_range("Invalid chunking mode enum: " + std::to_string(int(chunkingMode)));
+}
+
+std::ostream& operator<<(std::ostream& os, EChunkingMode chunkingMode)
+{
+  return os << EChunkingMode_enumToString(chunkingMode);
+}
+
+std::istream& operator>>(std::istream& in, EChunkingMode& chunkingMode)
+{
+  std::string token;
+  in >> token;
+  chunkingMode = EChunkingMode_stringToEnum(token);
+  return in;
+}
+
+namespace {
+
+/**
+ * @brief Get the sorted images (reference and neighbors) needed by a set of reference cameras
+ */
+std::vector<int> getChunkImages(const std::vector<int>& chunk, const std::vector<std::vector<int>>& neighbors)
+{
+  std::vector<int> images;
+  for(int rc : chunk)
+  {
+    images.push_back(rc);
+    images.insert(images.end(), neighbors.at(rc).begin(), neighbors.at(rc).end());
+  }
+  std::sort(images.begin(), images.end());
+  images.erase(std::unique(images.begin(), images.end()), images.end());
+  return images;
+}
+
+/**
+ * @brief Split the camera indexes into contiguous chunks
+ */
+std::vector<std::vector<int>> getIndexChunks(int nbCameras, int chunkSize)
+{
+  std::vector<std::vector<int>> chunks;
+  for(int rc = 0; rc < nbCameras; rc += chunkSize)
+  {
+    chunks.emplace_back();
+    for(int c = rc; c < std::min(rc + chunkSize, nbCameras); ++c)
+      chunks.back().push_back(c);
+  }
+  return chunks;
+}
+
+} // namespace
+
+std::vector<std::vector<int>> computeChunks(const std::vector<std::vector<int>>& neighbors,
+                                            EChunkingMode mode,
+                                            int chunkSize,
+                                            std::vector<std::vector<int>>* chunksImages)
+{
+  const int nbCameras = static_cast<int>(neighbors.size());
+  chunkSize = std::max(1, chunkSize);
+
+  std::vector<std::vector<int>> chunks;
+
+  // a single chunk (e.g. no camera range) does not need the neighbors grouping
+  if(mode == EChunkingMode::INDEX || chunkSize >= nbCameras)
+  {
+    chunks = getIndexChunks(nbCameras, chunkSize);
+  }
+  else
+  {
+    // reference cameras using each image as neighbor
+    std::vector<std::vector<int>> users(nbCameras);
+    for(int rc = 0; rc < nbCameras; ++rc)
+      for(int tc : neighbors.at(rc))
+        users.at(tc).push_back(rc);
+
+    std::vector<char> assigned(nbCameras, 0);
+    std::vector<char> loaded(nbCameras, 0);
+    // number of images needed by a candidate camera which are already needed by the current chunk
+    std::vector<int> gain(nbCameras, 0);
+
+    int nextSeed = 0;
+    int nbAssigned = 0;
+
+    while(nbAssigned < nbCameras)
+    {
+      chunks.emplace_back();
+      std::vector<int>& chunk = chunks.back();
+      std::vector<int> loadedImages;
+      std::vector<int> candidates;
+
+      const auto loadImage = [&](int image)
+      {
+        if(loaded[image])
+          return;
+        loaded[image] = 1;
+        loadedImages.push_back(image);
+
+        ++gain[image];
+        candidates.push_back(image);
+        for(int rc : users[image])
+        {
+          ++gain[rc];
+          candidates.push_back(rc);
+        }
+      };
+
+      const auto addCamera = [&](int rc)
+      {
+        assigned[rc] = 1;
+        ++nbAssigned;
+        chunk.push_back(rc);
+        loadImage(rc);
+        for(int tc : neighbors[rc])
+          loadImage(tc);
+      };
+
+      while(static_cast<int>(chunk.size()) < chunkSize && nbAssigned < nbCameras)
+      {
+        // select the candidate with the fewest new images, then the highest gain, then the smallest index
+        int best = -1;
+        int bestNewImages = 0;
+
+        for(int rc : candidates)
+        {
+          if(assigned[rc])
+            continue;
+
+          const int newImages = 1 + static_cast<int>(neighbors[rc].size()) - gain[rc];
+
+          if(best == -1 ||
+             newImages < bestNewImages ||
+             (newImages == bestNewImages && (gain[rc] > gain[best] || (gain[rc] == gain[best] && rc < best))))
+          {
+            best = rc;
+            bestNewImages = newImages;
+          }
+        }
+
+        if(best == -1)
+        {
+          // no camera shares an image with the current chunk: start from the next free index
+          while(assigned[nextSeed])
+            ++nextSeed;
+          best = nextSeed;
+        }
+
+        addCamera(best);
+
+        // drop assigned candidates to keep the candidate list small
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](int rc) { return assigned[rc] != 0; }),
+                         candidates.end());
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+      }
+
+      // reset the chunk state
+      for(int image : loadedImages)
+      {
+        loaded[image] = 0;
+        gain[image] = 0;
+        for(int rc : users[image])
+          gain[rc] = 0;
+      }
+    }
+  }
+
+  if(chunksImages != nullptr)
+  {
+    chunksImages->resize(chunks.size());
+    std::size_t nbImagesLoaded = 0;
+    for(std::size_t i = 0; i < chunks.size(); ++i)
+    {
+      chunksImages->at(i) = getChunkImages(chunks.at(i), neighbors);
+      nbImagesLoaded += chunksImages->at(i).size();
+    }
+    ALICEVISION_LOG_INFO("Chunking (" << EChunkingMode_enumToString(mode) << "): " << chunks.size() << " chunk(s) of at most "
+                         << chunkSize << " camera(s), " << nbImagesLoaded << " image loads in total.");
+  }
+
+  return chunks;
+}
+
+std::vector<std::vector<int>> computeChunks(const MultiViewParams& mp,
+                                            EChunkingMode mode,
+                                            int chunkSize,
+                                            int nbNeighbors,
+                                            std::vector<std::vector<int>>* chunksImages)
+{
+  const int nbCameras = mp.getNbCameras();
+
+  // neighbor cameras are not needed to split by index or to build a single chunk
+  if((mode == EChunkingMode::INDEX || chunkSize >= nbCameras) && chunksImages == nullptr)
+    return getIndexChunks(nbCameras, std::max(1, chunkSize));
+
+  // neighbor cameras per reference camera
+  std::vector<std::vector<int>> neighbors(nbCameras);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int rc = 0; rc < nbCameras; ++rc)
+  {
+    const StaticVector<int> tcams = mp.findNearestCamsFromLandmarks(rc, nbNeighbors);
+    neighbors.at(rc).assign(tcams.getData().begin(), tcams.getData().end());
+  }
+
+  return computeChunks(neighbors, mode, chunkSize, chunksImages);
+}
+
+void writeChunksManifest(const std::string& filename,
+                         const MultiViewParams& mp,
+                         EChunkingMode mode,
+                         const std::vector<std::vector<int>>& chunks,
+                         const std::vector<std::vector<int>>& chunksImages)
+{
+  namespace bpt = boost::property_tree;
+
+  bpt::ptree fileTree;
+  fileTree.put("chunkingMode", EChunkingMode_enumToString(mode));
+  fileTree.put("nbChunks", chunks.size());
+
+  bpt::ptree chunksTree;
+  std::size_t rangeStart = 0;
+  std::size_t nbImagesLoaded = 0;
+
+  for(std::size_t i = 0; i < chunks.size(); ++i)
+  {
+    bpt::ptree chunkTree;
+    chunkTree.put("rangeStart", rangeStart);
+    chunkTree.put("rangeSize", chunks.at(i).size());
+
+    bpt::ptree viewIdsTree;
+    for(int rc : chunks.at(i))
+    {
+      bpt::ptree viewIdTree;
+      viewIdTree.put("", mp.getViewId(rc));
+      viewIdsTree.push_back(std::make_pair("", viewIdTree));
+    }
+    chunkTree.add_child("viewIds", viewIdsTree);
+
+    bpt::ptree imagesTree;
+    for(int c : chunksImages.at(i))
+    {
+      bpt::ptree viewIdTree;
+      viewIdTree.put("", mp.getViewId(c));
+      imagesTree.push_back(std::make_pair("", viewIdTree));
+    }
+    chunkTree.add_child("neededViewIds", imagesTree);
+
+    chunksTree.push_back(std::make_pair("", chunkTree));
+
+    rangeStart += chunks.at(i).size();
+    nbImagesLoaded += chunksImages.at(i).size();
+  }
+
+  fileTree.put("nbImagesLoaded", nbImagesLoaded);
+  fileTree.add_child("chunks", chunksTree);
+
+  bpt::write_json(filename, fileTree);
+}
+
+} // namespace mvsUtils
+} // namespace aliceVision
@@ -0,0 +1,81 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+/**
+ * @brief Strategy used to split the cameras into chunks (see rangeStart / rangeSize)
+ */
+enum class EChunkingMode
+{
+  /// contiguous camera indexes
+  INDEX,
+  /// cameras sharing the same neighbor cameras are grouped together
+  NEIGHBORS
+};
+
+std::string EChunkingMode_informations();
+EChunkingMode EChunkingMode_stringToEnum(const std::string& chunkingMode);
+std::string EChunkingMode_enumToString(const EChunkingMode chunkingMode);
+std::ostream& operator<<(std::ostream& os, EChunkingMode chunkingMode);
+std::istream& operator>>(std::istream& in, EChunkingMode& chunkingMode);
+
+/**
+ * @brief Split the cameras into chunks of at most chunkSize cameras.
+ *        In NEIGHBORS mode, each chunk is grown greedily with the camera requiring the fewest
+ *        images that are not already needed by the chunk (reference and neighbor images).
+ * @param[in] mp the multi-view parameters
+ * @param[in] mode the chunking mode
+ * @param[in] chunkSize the maximum number of cameras per chunk
+ * @param[in] nbNeighbors the number of neighbor cameras used per reference camera
+ * @param[out] chunksImages if not null, the sorted camera indexes of all images needed per chunk
+ * @return the camera indexes per chunk, the concatenation of all chunks contains each camera once
+ */
+std::vector<std::vector<int>> computeChunks(const MultiViewParams& mp,
+                                            EChunkingMode mode,
+                                            int chunkSize,
+                                            int nbNeighbors,
+                                            std::vector<std::vector<int>>* chunksImages = nullptr);
+
+/**
+ * @brief Split the cameras into chunks of at most chunkSize cameras, from precomputed neighbor cameras.
+ * @param[in] neighbors the neighbor camera indexes per reference camera
+ * @param[in] mode the chunking mode
+ * @param[in] chunkSize the maximum number of cameras per chunk
+ * @param[out] chunksImages if not null, the sorted camera indexes of all images needed per chunk
+ * @return the camera indexes per chunk, the concatenation of all chunks contains each camera once
+ */
+std::vector<std::vector<int>> computeChunks(const std::vector<std::vector<int>>& neighbors,
+                                            EChunkingMode mode,
+                                            int chunkSize,
+                                            std::vector<std::vector<int>>* chunksImages = nullptr);
+
+/**
+ * @brief Write a JSON chunk manifest: for each chunk, its range in the camera processing order,
+ *        its reference view ids and all the view ids it needs to load.
+ * @param[in] filename the output JSON file
+ * @param[in] mp the multi-view parameters
+ * @param[in] mode the chunking mode used to compute the chunks
+ * @param[in] chunks the camera indexes per chunk
+ * @param[in] chunksImages the camera indexes of all images needed per chunk
+ */
+void writeChunksManifest(const std::string& filename,
+                         const MultiViewParams& mp,
+                         EChunkingMode mode,
+                         const std::vector<std::vector<int>>& chunks,
+                         const std::vector<std::vector<int>>& chunksImages);
+
+} // namespace mvsUtils
+} // namespace aliceVision
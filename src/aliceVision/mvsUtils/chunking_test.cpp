@@ -0,0 +1,196 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsUtils/chunking.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+#define BOOST_TEST_MODULE mvsUtilsChunking
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mvsUtils;
+
+/**
+ * @brief Neighbor cameras of a ring of cameras: the nbNeighbors / 2 previous and next cameras
+ */
+std::vector<std::vector<int>> ringNeighbors(int nbCameras, int nbNeighbors)
+{
+  std::vector<std::vector<int>> neighbors(nbCameras);
+  for(int rc = 0; rc < nbCameras; ++rc)
+  {
+    for(int i = 1; i <= nbNeighbors / 2; ++i)
+    {
+      for(int tc : {(rc + i) % nbCameras, (rc - i + nbCameras) % nbCameras})
+      {
+        if(tc != rc && std::find(neighbors[rc].begin(), neighbors[rc].end(), tc) == neighbors[rc].end())
+          neighbors[rc].push_back(tc);
+      }
+    }
+  }
+  return neighbors;
+}
+
+/**
+ * @brief Check that the chunks are not empty, not larger than chunkSize
+ *        and contain each camera exactly once
+ */
+void checkChunks(const std::vector<std::vector<int>>& chunks, int nbCameras, int chunkSize)
+{
+  std::vector<int> cameras;
+  for(const std::vector<int>& chunk : chunks)
+  {
+    BOOST_CHECK(!chunk.empty());
+    BOOST_CHECK_LE(chunk.size(), chunkSize);
+    cameras.insert(cameras.end(), chunk.begin(), chunk.end());
+  }
+  std::sort(cameras.begin(), cameras.end());
+
+  std::vector<int> expected(nbCameras);
+  std::iota(expected.begin(), expected.end(), 0);
+  BOOST_CHECK_EQUAL_COLLECTIONS(cameras.begin(), cameras.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(chunking_empty)
+{
+  for(EChunkingMode mode : {EChunkingMode::INDEX, EChunkingMode::NEIGHBORS})
+  {
+    std::vector<std::vector<int>> chunksImages;
+    const std::vector<std::vector<int>> chunks = computeChunks({}, mode, 4, &chunksImages);
+    BOOST_CHECK(chunks.empty());
+    BOOST_CHECK(chunksImages.empty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(chunking_smallerThanChunkSize)
+{
+  const int nbCameras = 3;
+  const std::vector<std::vector<int>> neighbors = ringNeighbors(nbCameras, 2);
+
+  for(EChunkingMode mode : {EChunkingMode::INDEX, EChunkingMode::NEIGHBORS})
+  {
+    std::vector<std::vector<int>> chunksImages;
+    const std::vector<std::vector<int>> chunks = computeChunks(neighbors, mode, 8, &chunksImages);
+
+    BOOST_REQUIRE_EQUAL(chunks.size(), 1);
+    checkChunks(chunks, nbCameras, 8);
+
+    // a single chunk needs all the images once
+    BOOST_REQUIRE_EQUAL(chunksImages.size(), 1);
+    BOOST_CHECK_EQUAL(chunksImages.front().size(), nbCameras);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(chunking_nonDivisibleSize)
+{
+  const int nbCameras = 10;
+  const int chunkSize = 3;
+  const std::vector<std::vector<int>> neighbors = ringNeighbors(nbCameras, 2);
+
+  // index mode: contiguous chunks, the last one holds the remainder
+  {
+    const std::vector<std::vector<int>> chunks = computeChunks(neighbors, EChunkingMode::INDEX, chunkSize);
+
+    BOOST_REQUIRE_EQUAL(chunks.size(), 4);
+    checkChunks(chunks, nbCameras, chunkSize);
+    BOOST_CHECK_EQUAL(chunks.back().size(), 1);
+    BOOST_CHECK_EQUAL(chunks.back().front(), nbCameras - 1);
+  }
+
+  // neighbors mode: full chunks, the last one holds the remainder
+  {
+    std::vector<std::vector<int>> chunksImages;
+    const std::vector<std::vector<int>> chunks = computeChunks(neighbors, EChunkingMode::NEIGHBORS, chunkSize, &chunksImages);
+
+    BOOST_REQUIRE_EQUAL(chunks.size(), 4);
+    checkChunks(chunks, nbCameras, chunkSize);
+    BOOST_CHECK_EQUAL(chunks.back().size(), 1);
+    BOOST_REQUIRE_EQUAL(chunksImages.size(), chunks.size());
+
+    // each chunk needs its cameras and their neighbors
+    for(std::size_t i = 0; i < chunks.size(); ++i)
+    {
+      for(int rc : chunks.at(i))
+      {
+        BOOST_CHECK(std::binary_search(chunksImages.at(i).begin(), chunksImages.at(i).end(), rc));
+        for(int tc : neighbors.at(rc))
+          BOOST_CHECK(std::binary_search(chunksImages.at(i).begin(), chunksImages.at(i).end(), tc));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(chunking_neighborsLocality)
+{
+  // cameras on a ring, the camera indexes do not follow the ring (consecutive indexes are 7 cameras apart)
+  const int nbCameras = 30;
+  const int chunkSize = 5;
+  std::vector<int> ringPosition(nbCameras);
+  std::vector<int> cameraAtPosition(nbCameras);
+  for(int rc = 0; rc < nbCameras; ++rc)
+  {
+    ringPosition[rc] = (rc * 7) % nbCameras;
+    cameraAtPosition[ringPosition[rc]] = rc;
+  }
+
+  // the 2 previous and 2 next cameras on the ring
+  std::vector<std::vector<int>> neighbors(nbCameras);
+  for(int rc = 0; rc < nbCameras; ++rc)
+  {
+    for(int offset : {-2, -1, 1, 2})
+      neighbors[rc].push_back(cameraAtPosition[(ringPosition[rc] + offset + nbCameras) % nbCameras]);
+  }
+
+  const auto getNbImagesLoaded = [&](EChunkingMode mode, std::size_t& maxChunkImages)
+  {
+    std::vector<std::vector<int>> chunksImages;
+    const std::vector<std::vector<int>> chunks = computeChunks(neighbors, mode, chunkSize, &chunksImages);
+    checkChunks(chunks, nbCameras, chunkSize);
+
+    std::size_t nbImagesLoaded = 0;
+    maxChunkImages = 0;
+    for(const std::vector<int>& images : chunksImages)
+    {
+      nbImagesLoaded += images.size();
+      maxChunkImages = std::max(maxChunkImages, images.size());
+    }
+    return nbImagesLoaded;
+  };
+
+  std::size_t indexMaxChunkImages;
+  std::size_t neighborsMaxChunkImages;
+  const std::size_t indexImagesLoaded = getNbImagesLoaded(EChunkingMode::INDEX, indexMaxChunkImages);
+  const std::size_t neighborsImagesLoaded = getNbImagesLoaded(EChunkingMode::NEIGHBORS, neighborsMaxChunkImages);
+
+  // index chunks are scattered on the ring, neighbors chunks are mostly arcs of the ring
+  BOOST_CHECK_LT(neighborsMaxChunkImages, indexMaxChunkImages);
+  BOOST_CHECK_LT(neighborsImagesLoaded, indexImagesLoaded);
+}
+
+BOOST_AUTO_TEST_CASE(chunking_singleChunk)
+{
+  // a chunk size covering all the cameras gives a single chunk in index order, in both modes
+  const int nbCameras = 6;
+  std::vector<int> expected(nbCameras);
+  std::iota(expected.begin(), expected.end(), 0);
+
+  for(EChunkingMode mode : {EChunkingMode::INDEX, EChunkingMode::NEIGHBORS})
+  {
+    const std::vector<std::vector<int>> chunks = computeChunks(ringNeighbors(nbCameras, 2), mode, nbCameras);
+    BOOST_REQUIRE_EQUAL(chunks.size(), 1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(chunks.front().begin(), chunks.front().end(), expected.begin(), expected.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(chunking_invalidChunkSize)
+{
+  // a chunk size lower than 1 is clamped to 1
+  const std::vector<std::vector<int>> chunks = computeChunks(ringNeighbors(4, 2), EChunkingMode::INDEX, 0);
+  BOOST_CHECK_EQUAL(chunks.size(), 4);
+  checkChunks(chunks, 4, 1);
+}
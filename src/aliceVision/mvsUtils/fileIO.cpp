@@ -325,14 +325,25 @@ Matrix3x4 load3x4MatrixFromFile(FILE* fi)
 
 void loadImage(const std::string& path, const MultiViewParams* mp, int camId, Image& img, imageIO::EImageColorSpace colorspace, ImagesCache::ECorrectEV correctEV)
 {
+    // scale choosed by the user and apply during the process
+    const int processScale = mp->getProcessDownscale();
+
+    // whether the image file provides the downscaled resolution level (e.g. mipmapped EXR)
+    bool isDownscaled = false;
+
     // check image size
-    auto checkImageSize = [&path, &mp, camId, &img](){
-        if((mp->getOriginalWidth(camId) != img.width()) || (mp->getOriginalHeight(camId) != img.height()))
+    auto checkImageSize = [&path, &mp, camId, &img, processScale, &isDownscaled](){
+        const int originalWidth = mp->getOriginalWidth(camId);
+        const int originalHeight = mp->getOriginalHeight(camId);
+
+        isDownscaled = (processScale > 1) && (img.width() == originalWidth / processScale) && (img.height() == originalHeight / processScale);
+
+        if(!isDownscaled && ((originalWidth != img.width()) || (originalHeight != img.height())))
         {
             std::stringstream s;
             s << "Bad image dimension for camera : " << camId << "\n";
             s << "\t- image path : " << path << "\n";
-            s << "\t- expected dimension : " << mp->getOriginalWidth(camId) << "x" << mp->getOriginalHeight(camId) << "\n";
+            s << "\t- expected dimension : " << originalWidth << "x" << originalHeight << "\n";
             s << "\t- real dimension : " << img.width() << "x" << img.height() << "\n";
             throw std::runtime_error(s.str());
         }
@@ -340,13 +351,13 @@ void loadImage(const std::string& path, const MultiViewParams* mp, int camId, Im
 
     if(correctEV == ImagesCache::ECorrectEV::NO_CORRECTION)
     {
-        imageIO::readImage(path, img, colorspace);
+        imageIO::readImage(path, img, colorspace, processScale);
         checkImageSize();
     }
     // if exposure correction, apply it in linear colorspace and then convert colorspace
     else
     {
-        imageIO::readImage(path, img, imageIO::EImageColorSpace::LINEAR);
+        imageIO::readImage(path, img, imageIO::EImageColorSpace::LINEAR, processScale);
         checkImageSize();
 
         oiio::ParamValueList metadata;
@@ -370,10 +381,7 @@ void loadImage(const std::string& path, const MultiViewParams* mp, int camId, Im
         }
     }
 
-    // scale choosed by the user and apply during the process
-    const int processScale = mp->getProcessDownscale();
-
-    if(processScale > 1)
+    if(processScale > 1 && !isDownscaled)
     {
         ALICEVISION_LOG_DEBUG("Downscale (x" << processScale << ") image: " << mp->getViewId(camId) << ".");
         Image bmpr;
@@ -8,9 +8,11 @@
 #include "ResidualError.hpp"
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <ceres/rotation.h>
 
+#include <algorithm>
 #include <fstream>
 #include <exception>
 
@@ -136,7 +138,8 @@ bool Rig::initializeCalibration()
   for(std::size_t iRelativePose = 0 ; iRelativePose < _vRelativePoses.size() ; ++iRelativePose )
   {
     std::size_t iRes = iRelativePose+1;
-    for(std::size_t iView = 0 ; iView < _vLocalizationResults[iRes].size() ; ++iView )
+    #pragma omp parallel for
+    for(std::ptrdiff_t iView = 0 ; iView < static_cast<std::ptrdiff_t>(_vLocalizationResults[iRes].size()) ; ++iView )
     {
       if(  _vLocalizationResults[0][iView].isValid() )
       {
@@ -165,32 +168,37 @@ void Rig::findBestRelativePose(
   const std::vector<localization::LocalizationResult> & resMainCamera = _vLocalizationResults[0];
   const std::vector<localization::LocalizationResult> & resWitnessCamera = _vLocalizationResults[iLocalizer];
   
-  double minReprojError = std::numeric_limits<double>::max();
-  std::size_t iMin = 0;
-  
   assert(vPoses.size() > 0);
-  
-  for(std::size_t i=0 ; i < vPoses.size() ; ++i)
+
+  // frames where both pose computations succeeded
+  std::vector<std::size_t> validFrames;
+  validFrames.reserve(resWitnessCamera.size());
+  for(std::size_t j=0 ; j < resWitnessCamera.size() ; ++j )
+  {
+    if ( ( resMainCamera[j].isValid() ) && ( resWitnessCamera[j].isValid() ) )
+      validFrames.push_back(j);
+  }
+
+  // each candidate is evaluated over all valid frames independently
+  std::vector<double> errors(vPoses.size(), 0.0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t i=0 ; i < static_cast<std::ptrdiff_t>(vPoses.size()) ; ++i)
   {
     const geometry::Pose3 & relativePose = vPoses[i];
 
     double error = 0;
-    for(std::size_t j=0 ; j < resWitnessCamera.size() ; ++j )
+    for(const std::size_t j : validFrames)
     {
-      // Check that both pose computations succeeded 
-      if ( ( resMainCamera[j].isValid() ) && ( resWitnessCamera[j].isValid() ) )
-      {
-        // [poseWitness] = [relativePose]*[poseMainCamera]
-        const geometry::Pose3 poseWitnessCamera = poseFromMainToWitness(resMainCamera[j].getPose(), relativePose);
-        error += reprojectionError(resWitnessCamera[j], poseWitnessCamera);
-      }
+      // [poseWitness] = [relativePose]*[poseMainCamera]
+      const geometry::Pose3 poseWitnessCamera = poseFromMainToWitness(resMainCamera[j].getPose(), relativePose);
+      error += reprojectionError(resWitnessCamera[j], poseWitnessCamera);
     }
-    if ( error < minReprojError )
-    {
-      iMin = i;
-      minReprojError = error;
-    }           
+    errors[i] = error;
   }
+
+  // first minimum, as in a sequential scan
+  const std::size_t iMin = std::distance(errors.begin(), std::min_element(errors.begin(), errors.end()));
   result = vPoses[iMin];
   
   displayRelativePoseReprojection(geometry::Pose3(aliceVision::Mat3::Identity(), aliceVision::Vec3::Zero()), 0);
@@ -269,69 +277,56 @@ bool Rig::optimizeCalibration()
   
   ceres::Problem problem;
 
-  // Add relative pose as a parameter block over all witness cameras.
-  std::vector<std::vector<double> > vRelativePoses;
-  vRelativePoses.reserve(_vRelativePoses.size());
-  for(std::size_t iRelativePose = 0 ; iRelativePose < _vRelativePoses.size() ; ++iRelativePose )
+  const std::size_t nbViews = _vLocalizationResults[0].size();
+
+  // Relative poses and rig poses are stored in contiguous arrays of 6 parameters
+  // (angleAxis + translation) so that ceres parameter blocks remain valid during
+  // the whole problem lifetime.
+  std::vector<double> vRelativePoses(6 * _vRelativePoses.size());
+  std::vector<double> vMainPoses(6 * nbViews, 0.0);
+
+  const auto poseToBlock = [](const geometry::Pose3& pose, double* block)
   {
-    geometry::Pose3 & pose = _vRelativePoses[iRelativePose];
-    
     const aliceVision::Mat3 & R = pose.rotation();
     const aliceVision::Vec3 & t = pose.translation();
 
-    double angleAxis[3];
-    ceres::RotationMatrixToAngleAxis((const double*)R.data(), angleAxis);
-    
-    std::vector<double> relativePose;
-    relativePose.reserve(6); //angleAxis + translation
-    relativePose.push_back(angleAxis[0]);
-    relativePose.push_back(angleAxis[1]);
-    relativePose.push_back(angleAxis[2]);
-    relativePose.push_back(t(0));
-    relativePose.push_back(t(1));
-    relativePose.push_back(t(2));
-
-    vRelativePoses.push_back(relativePose);
-  }
-  for(std::vector<double> &pose : vRelativePoses)
+    ceres::RotationMatrixToAngleAxis((const double*)R.data(), block);
+    block[3] = t(0);
+    block[4] = t(1);
+    block[5] = t(2);
+  };
+
+  // Add relative pose as a parameter block over all witness cameras.
+  for(std::size_t iRelativePose = 0 ; iRelativePose < _vRelativePoses.size() ; ++iRelativePose )
+    poseToBlock(_vRelativePoses[iRelativePose], &vRelativePoses[6 * iRelativePose]);
+
+  // Add rig pose (i.e. main camera pose) as a parameter block over all views (i.e. timestamps).
+  #pragma omp parallel for
+  for(std::ptrdiff_t iView = 0 ; iView < static_cast<std::ptrdiff_t>(nbViews) ; ++iView )
   {
-    double * parameter_block = &pose[0];
-    assert(parameter_block && "parameter_block is null in vRelativePoses");
-    problem.AddParameterBlock(parameter_block, 6);
+    if(_vLocalizationResults[0][iView].isValid())
+      poseToBlock(_vLocalizationResults[0][iView].getPose(), &vMainPoses[6 * iView]);
   }
-  
-  // Add rig pose (i.e. main camera pose) as a parameter block over all views (i.e. timestamps).
-  std::map<std::size_t, std::vector<double> > vMainPoses;
-  for(std::size_t iView = 0 ; iView < _vLocalizationResults[0].size() ; ++iView )
+
+  // Schur ordering: rig poses are eliminated first, the reduced system only
+  // involves the relative poses of the witness cameras.
+  ceres::ParameterBlockOrdering linearSolverOrdering;
+
+  for(std::size_t iView = 0 ; iView < nbViews ; ++iView )
   {
     if(!_vLocalizationResults[0][iView].isValid())
       continue;
-    
-    const geometry::Pose3 & pose = _vLocalizationResults[0][iView].getPose();
-    const aliceVision::Mat3 & R = pose.rotation();
-    const aliceVision::Vec3 & t = pose.translation();
 
-    double angleAxis[3];
-    ceres::RotationMatrixToAngleAxis((const double*)R.data(), angleAxis);
-
-    std::vector<double> mainPose;
-    mainPose.reserve(6); //angleAxis + translation
-    mainPose.push_back(angleAxis[0]);
-    mainPose.push_back(angleAxis[1]);
-    mainPose.push_back(angleAxis[2]);
-    mainPose.push_back(t(0));
-    mainPose.push_back(t(1));
-    mainPose.push_back(t(2));
-
-    vMainPoses.emplace(iView, mainPose);
+    double * parameter_block = &vMainPoses[6 * iView];
+    problem.AddParameterBlock(parameter_block, 6);
+    linearSolverOrdering.AddElementToGroup(parameter_block, 0);
   }
 
-  for(auto &elem : vMainPoses)
+  for(std::size_t iRelativePose = 0 ; iRelativePose < _vRelativePoses.size() ; ++iRelativePose )
   {
-    auto pose = elem.second;
-    double * parameter_block = &pose[0];
-    assert(parameter_block && "parameter_block is null in vMainPoses");
+    double * parameter_block = &vRelativePoses[6 * iRelativePose];
     problem.AddParameterBlock(parameter_block, 6);
+    linearSolverOrdering.AddElementToGroup(parameter_block, 1);
   }
 
 // The following code can be used if the intrinsics have to be refined in the bundle adjustment
@@ -435,10 +430,9 @@ bool Rig::optimizeCalibration()
             
           if (cost_function)
           {
-            assert(vMainPoses.find(iView) != vMainPoses.end());
             problem.AddResidualBlock( cost_function,
                                       p_LossFunction,
-                                      &vMainPoses[iView][0]);
+                                      &vMainPoses[6 * iView]);
           }else
           {
             ALICEVISION_CERR("Fail in adding residual block for the main camera");
@@ -455,12 +449,11 @@ bool Rig::optimizeCalibration()
           
           if (cost_function)
           {
-            assert(vMainPoses.find(iView) != vMainPoses.end());
-            assert(iLocalizer-1 < vRelativePoses.size());
+            assert(iLocalizer-1 < _vRelativePoses.size());
             problem.AddResidualBlock( cost_function,
                                       p_LossFunction,
-                                      &vMainPoses[iView][0],
-                                      &vRelativePoses[iLocalizer-1][0]);
+                                      &vMainPoses[6 * iView],
+                                      &vRelativePoses[6 * (iLocalizer-1)]);
           }else
           {
             ALICEVISION_CERR("Fail in adding residual block for a secondary camera");
@@ -481,10 +474,11 @@ bool Rig::optimizeCalibration()
   options.sparse_linear_algebra_library_type = aliceVision_options.sparseLinearAlgebraLibraryType;
   options.minimizer_progress_to_stdout = aliceVision_options.verbose;
   options.logging_type = ceres::SILENT;
-  options.num_threads = 1;//aliceVision_options._nbThreads;
+  options.num_threads = aliceVision_options.nbThreads;
 #if CERES_VERSION_MAJOR < 2
-  options.num_linear_solver_threads = 1;//aliceVision_options._nbThreads;
+  options.num_linear_solver_threads = aliceVision_options.nbThreads;
 #endif
+  options.linear_solver_ordering.reset(new ceres::ParameterBlockOrdering(linearSolverOrdering));
   
   // Solve BA
   ceres::Solver::Summary summary;
@@ -515,11 +509,10 @@ bool Rig::optimizeCalibration()
   // Update relative pose after optimization
   for(std::size_t iRelativePose = 0 ; iRelativePose < _vRelativePoses.size() ; ++iRelativePose)
   {
+    const double * block = &vRelativePoses[6 * iRelativePose];
     aliceVision::Mat3 R_refined;
-    std::vector<double> vPose;
-    vPose.reserve(6);
-    ceres::AngleAxisToRotationMatrix(&vRelativePoses[iRelativePose][0], R_refined.data());
-    aliceVision::Vec3 t_refined(vRelativePoses[iRelativePose][3], vRelativePoses[iRelativePose][4], vRelativePoses[iRelativePose][5]);
+    ceres::AngleAxisToRotationMatrix(block, R_refined.data());
+    aliceVision::Vec3 t_refined(block[3], block[4], block[5]);
     // Update the pose
     geometry::Pose3 & pose = _vRelativePoses[iRelativePose];
     pose = geometry::Pose3(R_refined, -R_refined.transpose() * t_refined);
@@ -530,11 +523,10 @@ bool Rig::optimizeCalibration()
   {
     if( _vLocalizationResults[0][iView].isValid() )
     {
+      const double * block = &vMainPoses[6 * iView];
       aliceVision::Mat3 R_refined;
-      std::vector<double> vPose;
-      vPose.reserve(6);
-      ceres::AngleAxisToRotationMatrix(&vMainPoses[iView][0], R_refined.data());
-      aliceVision::Vec3 t_refined(vMainPoses[iView][3], vMainPoses[iView][4], vMainPoses[iView][5]);
+      ceres::AngleAxisToRotationMatrix(block, R_refined.data());
+      aliceVision::Vec3 t_refined(block[3], block[4], block[5]);
       // Push the optimized pose
       geometry::Pose3 pose = geometry::Pose3(R_refined, -R_refined.transpose() * t_refined);
       _vLocalizationResults[0][iView].setPose(pose);
@@ -549,7 +541,8 @@ bool Rig::optimizeCalibration()
   {
     const std::size_t iLocalizer = iRelativePose+1;
     // Loop over all views
-    for(std::size_t iView = 0; iView < _vLocalizationResults[iLocalizer].size(); ++iView)
+    #pragma omp parallel for
+    for(std::ptrdiff_t iView = 0; iView < static_cast<std::ptrdiff_t>(_vLocalizationResults[iLocalizer].size()); ++iView)
     {
       // If the localization has succeeded then if the witness camera localization succeeded 
       // then update the pose else continue.
@@ -11,6 +11,7 @@
 
 #include <aliceVision/robustEstimation/randSampling.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/stl/Arena.hpp>
 
 #include <algorithm>
 #include <cmath>
@@ -49,8 +50,8 @@ namespace robustEstimation{
 /**
  * @brief Logarithm (base 10) of binomial coefficient
  */
-template <typename T>
-T logcombi(std::size_t k, std::size_t n, const std::vector<T>& vec_log10) // vec_log10: lookuptable in [0,n+1]
+template <typename T, typename Allocator>
+T logcombi(std::size_t k, std::size_t n, const std::vector<T, Allocator>& vec_log10) // vec_log10: lookuptable in [0,n+1]
 
 {
   if (k>=n || k<=0) return(0.0f);
@@ -64,8 +65,8 @@ T logcombi(std::size_t k, std::size_t n, const std::vector<T>& vec_log10) // vec
 /**
  * @brief Tabulate logcombi(.,n)
  */
-template<typename Type>
-void makelogcombi_n(std::size_t n, std::vector<Type>& l, std::vector<Type>& vec_log10) // vec_log10: lookuptable [0,n+1]
+template<typename Type, typename Allocator>
+void makelogcombi_n(std::size_t n, std::vector<Type, Allocator>& l, std::vector<Type, Allocator>& vec_log10) // vec_log10: lookuptable [0,n+1]
 {
   l.resize(n+1);
   for (std::size_t k = 0; k <= n; ++k)
@@ -75,19 +76,19 @@ void makelogcombi_n(std::size_t n, std::vector<Type>& l, std::vector<Type>& vec_
 /**
  * @brief Tabulate logcombi(k,.)
  */
-template<typename Type>
-void makelogcombi_k(std::size_t k, std::size_t nmax, std::vector<Type>& l, std::vector<Type>& vec_log10) // vec_log10: lookuptable [0,n+1]
+template<typename Type, typename Allocator>
+void makelogcombi_k(std::size_t k, std::size_t nmax, std::vector<Type, Allocator>& l, std::vector<Type, Allocator>& vec_log10) // vec_log10: lookuptable [0,n+1]
 {
   l.resize(nmax+1);
   for (std::size_t n = 0; n <= nmax; ++n)
     l[n] = logcombi<Type>(k, n, vec_log10);
 }
 
-template <typename Type>
-void makelogcombi(std::size_t k, std::size_t n, std::vector<Type>& vec_logc_k, std::vector<Type>& vec_logc_n)
+template <typename Type, typename Allocator>
+void makelogcombi(std::size_t k, std::size_t n, std::vector<Type, Allocator>& vec_logc_k, std::vector<Type, Allocator>& vec_logc_n)
 {
   // compute a lookuptable of log10 value for the range [0,n+1]
-  std::vector<Type> vec_log10(n + 1);
+  std::vector<Type, Allocator> vec_log10(n + 1, Type(), vec_logc_k.get_allocator());
   for (std::size_t k = 0; k <= n; ++k)
     vec_log10[k] = log10((Type)k);
 
@@ -103,13 +104,14 @@ using ErrorIndex = std::pair<double,size_t>;
 /**
  * @brief Find best NFA and its index wrt square error threshold in e.
  */
+template <typename ErrorIndexAllocator, typename LogcAllocator>
 inline ErrorIndex bestNFA(int startIndex, //number of point required for estimation
                           double logalpha0,
-                          const std::vector<ErrorIndex>& e,
+                          const std::vector<ErrorIndex, ErrorIndexAllocator>& e,
                           double loge0,
                           double maxThreshold,
-                          const std::vector<float> &logc_n,
-                          const std::vector<float> &logc_k,
+                          const std::vector<float, LogcAllocator> &logc_n,
+                          const std::vector<float, LogcAllocator> &logc_k,
                           double multError = 1.0)
 {
   ErrorIndex bestIndex(std::numeric_limits<double>::infinity(), startIndex);
@@ -159,7 +161,10 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
     std::numeric_limits<double>::infinity() :
     precision * kernel.normalizer2()(0,0) * kernel.normalizer2()(0,0);
 
-  std::vector<ErrorIndex> vec_residuals(nData); // [residual,index]
+  // scratch buffers private to ACRANSAC are drawn from the thread arena, released when returning
+  stl::arena_scope scratch;
+
+  stl::arena_vector<ErrorIndex> vec_residuals(nData, ErrorIndex(), scratch.allocator<ErrorIndex>()); // [residual,index]
   std::vector<double> vec_residuals_(nData);
 
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
@@ -168,7 +173,10 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
 
   // Precompute log combi
   const double loge0 = log10((double)kernel.getMaximumNbModels() * (nData-sizeSample));
-  std::vector<float> vec_logc_n, vec_logc_k;
+  stl::arena_vector<float> vec_logc_n(scratch.allocator<float>());
+  stl::arena_vector<float> vec_logc_k(scratch.allocator<float>());
+  vec_logc_n.reserve(nData + 1);
+  vec_logc_k.reserve(nData + 1);
   makelogcombi(sizeSample, nData, vec_logc_k, vec_logc_n);
 
   // Output parameters
@@ -181,16 +189,20 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
 
   bool bACRansacMode = (precision == std::numeric_limits<double>::infinity());
 
+  std::vector<typename Kernel::ModelT> vec_models; // Up to max_models solutions
+  vec_models.reserve(kernel.getMaximumNbModels());
+
+  std::vector<std::size_t> vec_sample(sizeSample); // Sample indices
+
   // Main estimation loop.
   for(std::size_t iter = 0; iter < nIter; ++iter)
   {
-    std::vector<std::size_t> vec_sample(sizeSample); // Sample indices
     if (bACRansacMode)
       uniformSample(sizeSample, vec_index, vec_sample); // Get random sample
     else
       uniformSample(sizeSample, nData, vec_sample); // Get random sample
 
-    std::vector<typename Kernel::ModelT> vec_models; // Up to max_models solutions
+    vec_models.clear();
     kernel.fit(vec_sample, vec_models);
 
     // Evaluate models
@@ -49,6 +49,8 @@ class IRansacKernel
    * @param[in] samples A vector containing the indices of the data to be used for
    * the minimal estimation.
    * @param[out] models The model(s) estimated by the minimal solver.
+   * @note The models are appended: the robust estimators clear and reuse the same vector at each iteration,
+   *       so fixed-size solvers (see IsFixedSizeSolver) fit minimal samples without any heap allocation.
    */
   virtual void fit(const std::vector<std::size_t>& samples, std::vector<ModelT>& models) const = 0;
 
@@ -8,6 +8,7 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 
+#include <type_traits>
 #include <vector>
 
 namespace aliceVision {
@@ -51,6 +52,20 @@ public:
   virtual void solve(const Mat& x1, const Mat& x2, std::vector<ModelT_>& models, const std::vector<double>& weights) const = 0;
 };
 
+/**
+ * @brief Detect the solvers able to solve a minimal sample of compile-time size without heap allocation.
+ *
+ * Such a solver defines:
+ *  - FixedX1 / FixedX2: the fixed-size matrices of a minimal sample (one point per column),
+ *  - FixedModels: a std::array buffer of getMaximumNbModels() models,
+ *  - std::size_t solve(const FixedX1&, const FixedX2&, FixedModels&) const: returns the number of valid models.
+ */
+template<typename SolverT, typename = void>
+struct IsFixedSizeSolver : std::false_type {};
+
+template<typename SolverT>
+struct IsFixedSizeSolver<SolverT, typename std::conditional<false, typename SolverT::FixedModels, void>::type> : std::true_type {};
+
 /**
  * @brief An Undefined Solver
  */
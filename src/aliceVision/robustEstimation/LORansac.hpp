@@ -81,6 +81,9 @@ double iterativeReweightedLeastSquares(const Kernel &kernel,
   
   // change threshold for refinement
   theta *= mtheta;
+
+  // weights of the inliers, reused across the iterations
+  std::vector<double> weights;
   
   // iterative refinement
   for(std::size_t i = 0; i < numIter; ++i)
@@ -104,7 +107,6 @@ double iterativeReweightedLeastSquares(const Kernel &kernel,
 //            << " num inliers: " << inliers.size());
     
     // compute the weights for the inliers
-    std::vector<double> weights;
     kernel.computeWeights(models[0], inliers, weights);
     
     // LS with weights on inliers
@@ -324,12 +326,15 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
   std::vector<std::size_t> all_samples(total_samples);
   std::iota(all_samples.begin(), all_samples.end(), 0);
 
+  std::vector<typename Kernel::ModelT> models;
+  models.reserve(kernel.getMaximumNbModels());
+
   for(iteration = 0; iteration < max_iterations; ++iteration) 
   {
     std::vector<std::size_t> sample;
     uniformSample(min_samples, total_samples, sample);
 
-    std::vector<typename Kernel::ModelT> models;
+    models.clear();
     kernel.fit(sample, models);
 
     // Compute the inlier list for each fit.
@@ -83,9 +83,7 @@ public:
    */
   inline virtual void fit(const std::vector<std::size_t>& samples, std::vector<ModelT>& models) const
   {
-    const Mat x1 = ExtractColumns(_x1, samples);
-    const Mat x2 = ExtractColumns(_x2, samples);
-    _kernelSolver.solve(x1, x2, models);
+    fitSamples(_x1, _x2, samples, models);
   }
 
   /**
@@ -122,6 +120,57 @@ public:
 
 protected:
 
+  /**
+   * @brief Fit model(s) to the given samples of x1 / x2.
+   *        Minimal samples of fixed-size solvers are solved without heap allocation (see IsFixedSizeSolver).
+   * @param[in] x1 left data
+   * @param[in] x2 right data
+   * @param[in] samples
+   * @param[out] models
+   */
+  inline void fitSamples(const Mat& x1, const Mat& x2, const std::vector<std::size_t>& samples, std::vector<ModelT>& models) const
+  {
+    fitSamples(x1, x2, samples, models, IsFixedSizeSolver<SolverT>());
+  }
+
+  /**
+   * @brief Extract the samples in dynamic matrices and fit model(s)
+   */
+  inline void fitSamples(const Mat& x1, const Mat& x2, const std::vector<std::size_t>& samples, std::vector<ModelT>& models, std::false_type) const
+  {
+    const Mat x1Samples = ExtractColumns(x1, samples);
+    const Mat x2Samples = ExtractColumns(x2, samples);
+    _kernelSolver.solve(x1Samples, x2Samples, models);
+  }
+
+  /**
+   * @brief Copy a minimal sample in fixed-size matrices and fit model(s) without heap allocation,
+   *        larger samples use the dynamic solver
+   */
+  inline void fitSamples(const Mat& x1, const Mat& x2, const std::vector<std::size_t>& samples, std::vector<ModelT>& models, std::true_type) const
+  {
+    using FixedX1 = typename SolverT::FixedX1;
+    using FixedX2 = typename SolverT::FixedX2;
+
+    if(samples.size() != static_cast<std::size_t>(FixedX1::ColsAtCompileTime))
+    {
+      fitSamples(x1, x2, samples, models, std::false_type());
+      return;
+    }
+
+    FixedX1 x1Samples;
+    FixedX2 x2Samples;
+    for(std::size_t i = 0; i < samples.size(); ++i)
+    {
+      x1Samples.col(i) = x1.col(samples[i]);
+      x2Samples.col(i) = x2.col(samples[i]);
+    }
+
+    typename SolverT::FixedModels fixedModels;
+    const std::size_t nbModels = _kernelSolver.solve(x1Samples, x2Samples, fixedModels);
+    models.insert(models.end(), fixedModels.begin(), fixedModels.begin() + nbModels);
+  }
+
   /// left corresponding data
   const Mat& _x1;
   /// right corresponding data
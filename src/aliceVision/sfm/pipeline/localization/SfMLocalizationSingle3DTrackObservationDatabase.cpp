@@ -32,39 +32,42 @@ namespace sfm {
       return false;
     }
 
-    /*
-    TODO: DELI
-
     // Setup the database
     // A collection of regions
     // - each view observation leads to a new regions
     // - link each observation region to a track id to ease 2D-3D correspondences search
 
-    const feature::Regions& regionsType = regionsPerView.getFirstViewRegions();
-    landmark_observations_descriptors_.reset(regionsType.EmptyClone());
-    for (const auto & landmark : sfm_data.getLandmarks())
+    _descType = regionsPerView.getData().begin()->second.begin()->first;
+
+    const feature::Regions& regionsType = regionsPerView.getFirstViewRegions(_descType);
+    _landmarkObservationsDescriptors.reset(regionsType.EmptyClone());
+    _indexToLandmarkId.clear();
+
+    for(const auto& landmark : sfmData.getLandmarks())
     {
-      for (const auto & observation : landmark.second.obs)
+      if(landmark.second.descType != _descType)
+        continue;
+
+      for(const auto& observation : landmark.second.observations)
       {
-        if (observation.second.id_feat != UndefinedIndexT)
-        {
-          // copy the feature/descriptor to landmark_observations_descriptors
-          const feature::Regions& viewRegions = regionsPerView.getRegions(observation.first, landmark.second.descType);
-          viewRegions.CopyRegion(observation.second.id_feat, landmark_observations_descriptors_.get());
-          // link this descriptor to the track Id
-          index_to_landmark_id_.push_back(landmark.first);
-        }
+        if(observation.second.id_feat == UndefinedIndexT || !regionsPerView.viewExist(observation.first))
+          continue;
+
+        // copy the feature/descriptor to the landmark observations descriptors
+        const feature::Regions& viewRegions = regionsPerView.getRegions(observation.first, _descType);
+        viewRegions.CopyRegion(observation.second.id_feat, _landmarkObservationsDescriptors.get());
+        // link this descriptor to the track Id
+        _indexToLandmarkId.push_back(landmark.first);
       }
     }
+
     ALICEVISION_LOG_DEBUG("Init retrieval database ... ");
-    matching_interface_.reset(new
-      matching::Matcher_Regions_Database(matching::ANN_L2, *landmark_observations_descriptors_));
+    _matchingInterface.reset(new matching::RegionsDatabaseMatcher(matching::ANN_L2, *_landmarkObservationsDescriptors));
     ALICEVISION_LOG_DEBUG("Retrieval database initialized\n"
-      "#landmark: " << sfm_data.getLandmarks().size() << "\n"
-      "#descriptor initialized: " << landmark_observations_descriptors_->RegionCount());
+      "#landmark: " << sfmData.getLandmarks().size() << "\n"
+      "#descriptor initialized: " << _landmarkObservationsDescriptors->RegionCount());
 
-    sfm_data_ = &sfm_data;
-    */
+    _sfmData = &sfmData;
 
     return true;
   }
@@ -92,11 +95,17 @@ namespace sfm {
 
     resectionData.pt3D.resize(3, putativeMatches.size());
     resectionData.pt2D.resize(2, putativeMatches.size());
+    resectionData.vec_landmarkIds.resize(putativeMatches.size());
+    resectionData.vec_featureIds.resize(putativeMatches.size());
+    resectionData.vec_descType.resize(putativeMatches.size(), _descType);
 
     for(std::size_t i = 0; i < putativeMatches.size(); ++i)
     {
-      resectionData.pt3D.col(i) = _sfmData->getLandmarks().at(_indexToLandmarkId[putativeMatches[i]._i]).X;
+      const IndexT landmarkId = _indexToLandmarkId[putativeMatches[i]._i];
+      resectionData.pt3D.col(i) = _sfmData->getLandmarks().at(landmarkId).X;
       resectionData.pt2D.col(i) = queryRegions.GetRegionPosition(putativeMatches[i]._j);
+      resectionData.vec_landmarkIds[i] = landmarkId;
+      resectionData.vec_featureIds[i] = putativeMatches[i]._j;
     }
 
     const bool resection =  SfMLocalizer::Localize(imageSize, optionalIntrinsics, resectionData, pose);
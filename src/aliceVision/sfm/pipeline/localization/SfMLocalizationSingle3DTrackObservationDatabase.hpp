@@ -28,6 +28,7 @@ public:
 
   /**
   * @brief Build the retrieval database (3D points descriptors)
+  * The database is built for the first describer type found in the regions provider.
   *
   * @param[in] sfmData the SfM scene that have to be described
   * @param[in] regionPerView regions provider
@@ -45,6 +46,7 @@ public:
   * @param[out] pose found pose
   * @param[out] resectionData matching data (2D-3D and inliers; optional)
   * @return True if a putative pose has been estimated
+  * @note Thread-safe: the database is only read, several images can be localized concurrently.
   */
   bool Localize(const Pair& imageSize,
                 const camera::IntrinsicBase* optionalIntrinsics,
@@ -53,9 +55,14 @@ public:
                 ImageLocalizerMatchData* resectionDataPtr = nullptr // optional
                 ) const;
 
+  /// Describer type of the database regions
+  feature::EImageDescriberType getDescriberType() const { return _descType; }
+
 private:
   // Reference to the scene
   const sfmData::SfMData* _sfmData;
+  /// Describer type of the database regions
+  feature::EImageDescriberType _descType = feature::EImageDescriberType::UNINITIALIZED;
   /// Association of a regions to a landmark observation
   std::unique_ptr<feature::Regions> _landmarkObservationsDescriptors;
   /// Association of a track observation to a track Id (used for retrieval)
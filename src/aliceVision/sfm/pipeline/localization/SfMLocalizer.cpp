@@ -7,6 +7,7 @@
 
 #include "SfMLocalizer.hpp"
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/robustEstimation/ACRansac.hpp>
 #include <aliceVision/robustEstimation/LORansac.hpp>
@@ -22,6 +23,31 @@
 namespace aliceVision {
 namespace sfm {
 
+std::vector<bool> SfMLocalizer::LocalizeBatch(const std::vector<Pair>& imageSizes,
+                                              const std::vector<const camera::IntrinsicBase*>& optionalIntrinsics,
+                                              const std::vector<const feature::Regions*>& queryRegions,
+                                              std::vector<geometry::Pose3>& poses,
+                                              std::vector<ImageLocalizerMatchData>& resectionData) const
+{
+  const std::size_t nbQueries = queryRegions.size();
+  assert(imageSizes.size() == nbQueries);
+  assert(optionalIntrinsics.size() == nbQueries);
+
+  poses.resize(nbQueries);
+  resectionData.resize(nbQueries);
+
+  // std::vector<bool> cannot be written concurrently
+  std::vector<char> localized(nbQueries, 0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nbQueries); ++i)
+  {
+    localized[i] = Localize(imageSizes[i], optionalIntrinsics[i], *queryRegions[i], poses[i], &resectionData[i]);
+  }
+
+  return std::vector<bool>(localized.begin(), localized.end());
+}
+
 bool SfMLocalizer::Localize(const Pair& imageSize,
                             const camera::IntrinsicBase* optionalIntrinsics,
                             ImageLocalizerMatchData& resectionData,
@@ -38,6 +38,12 @@ struct ImageLocalizerMatchData
   std::vector<std::size_t> vec_inliers;
 
   std::vector<feature::EImageDescriberType> vec_descType;
+
+  /// Landmark id of each pt3D column (optional, filled by database localizers).
+  std::vector<IndexT> vec_landmarkIds;
+
+  /// Query feature index of each pt2D column (optional, filled by database localizers).
+  std::vector<IndexT> vec_featureIds;
   
   /// Upper bound pixel(s) tolerance for residual errors
   double error_max = std::numeric_limits<double>::infinity();
@@ -75,6 +81,23 @@ public:
                         ImageLocalizerMatchData* resectionData = nullptr // optional
                         ) const = 0;
 
+  /**
+  * @brief Try to localize several images in the database concurrently.
+  *        The database is built once and shared by all the queries.
+  *
+  * @param[in] imageSizes the w,h size of each image
+  * @param[in] optionalIntrinsics camera intrinsic of each image if known (else nullptr)
+  * @param[in] queryRegions the regions of each image (type must be the same as the database)
+  * @param[out] poses found pose of each image
+  * @param[in,out] resectionData matching data of each image (error_max is used as input)
+  * @return for each image, true if a putative pose has been estimated
+  */
+  std::vector<bool> LocalizeBatch(const std::vector<Pair>& imageSizes,
+                                  const std::vector<const camera::IntrinsicBase*>& optionalIntrinsics,
+                                  const std::vector<const feature::Regions*>& queryRegions,
+                                  std::vector<geometry::Pose3>& poses,
+                                  std::vector<ImageLocalizerMatchData>& resectionData) const;
+
 
   /**
   * @brief Try to localize an image from known 2D-3D matches
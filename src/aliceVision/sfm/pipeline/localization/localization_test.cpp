@@ -0,0 +1,126 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/regionsFactory.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfm/pipeline/localization/SfMLocalizationSingle3DTrackObservationDatabase.hpp>
+
+#include <memory>
+#include <random>
+
+#define BOOST_TEST_MODULE SFM_LOCALIZATION
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+using DescriptorT = feature::SIFT_Regions::DescriptorT;
+
+/**
+ * @brief Create the regions of a view: one feature per landmark,
+ *        with the landmark descriptor slightly perturbed
+ */
+feature::SIFT_Regions* createRegions(const Mat2X& points,
+                                     const std::vector<DescriptorT>& descriptors,
+                                     std::mt19937& generator)
+{
+  std::uniform_int_distribution<int> noise(-2, 2);
+
+  feature::SIFT_Regions* regions = new feature::SIFT_Regions();
+  for(Mat::Index i = 0; i < points.cols(); ++i)
+  {
+    regions->Features().emplace_back(points(0, i), points(1, i), 1.0f, 0.0f);
+
+    DescriptorT descriptor = descriptors.at(i);
+    for(std::size_t d = 0; d < DescriptorT::static_size; ++d)
+      descriptor[d] = static_cast<unsigned char>(std::min(255, std::max(0, descriptor[d] + noise(generator))));
+    regions->Descriptors().push_back(descriptor);
+  }
+  return regions;
+}
+
+// Test summary:
+// - Create a synthetic scene with one random descriptor per landmark
+// - Init the localization database from the scene
+// - Localize all the views of the scene at once (unknown intrinsics)
+// - Assert that all the views are localized at their ground truth pose
+BOOST_AUTO_TEST_CASE(SFM_LOCALIZATION_LocalizeBatch)
+{
+  const int nviews = 6;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  SfMData sfmData = getInputScene(d, config, camera::PINHOLE_CAMERA);
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> descValue(0, 255);
+
+  std::vector<DescriptorT> descriptors(npoints);
+  for(DescriptorT& descriptor : descriptors)
+  {
+    for(std::size_t i = 0; i < DescriptorT::static_size; ++i)
+      descriptor[i] = static_cast<unsigned char>(descValue(generator));
+  }
+
+  // keep a single observation per landmark, so that each landmark descriptor is unique in the database
+  for(auto& landmarkPair : sfmData.structure)
+  {
+    Landmark& landmark = landmarkPair.second;
+    const IndexT viewId = landmarkPair.first % nviews;
+    const Observation observation = landmark.observations.at(viewId);
+
+    landmark.descType = feature::EImageDescriberType::SIFT;
+    landmark.observations.clear();
+    landmark.observations[viewId] = observation;
+  }
+
+  feature::RegionsPerView regionsPerView;
+  for(int i = 0; i < nviews; ++i)
+    regionsPerView.addRegions(i, feature::EImageDescriberType::SIFT, createRegions(d._x[i], descriptors, generator));
+
+  SfMLocalizationSingle3DTrackObservationDatabase localizer;
+  BOOST_REQUIRE(localizer.Init(sfmData, regionsPerView));
+
+  // query images: the views of the scene, described again
+  std::vector<std::unique_ptr<feature::Regions>> queryRegions(nviews);
+  std::vector<const feature::Regions*> queryRegionsPtrs(nviews);
+  std::vector<Pair> imageSizes(nviews, Pair(config._cx * 2, config._cy * 2));
+  std::vector<const camera::IntrinsicBase*> optionalIntrinsics(nviews, nullptr);
+  for(int i = 0; i < nviews; ++i)
+  {
+    queryRegions[i].reset(createRegions(d._x[i], descriptors, generator));
+    queryRegionsPtrs[i] = queryRegions[i].get();
+  }
+
+  std::vector<geometry::Pose3> poses;
+  std::vector<ImageLocalizerMatchData> resectionData(nviews);
+  for(ImageLocalizerMatchData& data : resectionData)
+    data.error_max = 4.0;
+
+  const std::vector<bool> localized = localizer.LocalizeBatch(imageSizes, optionalIntrinsics, queryRegionsPtrs, poses, resectionData);
+
+  BOOST_CHECK_EQUAL(localized.size(), nviews);
+  BOOST_CHECK_EQUAL(poses.size(), nviews);
+  BOOST_CHECK_EQUAL(resectionData.size(), nviews);
+
+  for(int i = 0; i < nviews; ++i)
+  {
+    BOOST_CHECK(localized.at(i));
+    BOOST_CHECK_EQUAL(resectionData.at(i).vec_inliers.size(), npoints);
+    BOOST_CHECK_SMALL((poses.at(i).center() - d._C[i]).norm(), 1e-6);
+    BOOST_CHECK_SMALL(FrobeniusDistance(poses.at(i).rotation(), d._R[i]), 1e-6);
+
+    // each 2D-3D correspondence links the query feature to its landmark
+    const ImageLocalizerMatchData& data = resectionData.at(i);
+    for(std::size_t j = 0; j < data.vec_landmarkIds.size(); ++j)
+      BOOST_CHECK_EQUAL(data.vec_landmarkIds.at(j), data.vec_featureIds.at(j));
+  }
+}
@@ -17,10 +17,12 @@
 #include <aliceVision/multiview/essential.hpp>
 #include <aliceVision/multiview/triangulation/triangulationDLT.hpp>
 #include <aliceVision/multiview/triangulation/Triangulation.hpp>
+#include <aliceVision/multiview/triangulation/TriangulationBatch.hpp>
 #include <aliceVision/multiview/triangulation/NViewsTriangulationLORansac.hpp>
 #include <aliceVision/robustEstimation/LORansac.hpp>
 #include <aliceVision/robustEstimation/ScoreEvaluator.hpp>
 #include <aliceVision/graph/connectedComponent.hpp>
+#include <aliceVision/stl/Arena.hpp>
 #include <aliceVision/stl/stl.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/cpu.hpp>
@@ -1746,6 +1748,38 @@ void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<I
   }
 }
 
+namespace {
+
+/**
+ * @brief Projection data of a reconstructed view, shared by the triangulation of all its tracks
+ */
+struct TriangulationView
+{
+  const IntrinsicBase* intrinsic;
+  /// projective equivalent of the camera
+  Mat34 P;
+  Vec3 center;
+  /// a contrario threshold of the view (pixels)
+  double acThreshold;
+};
+
+TriangulationView getTriangulationView(const SfMData& scene, IndexT viewId, const HashMap<IndexT, double>& acThresholds)
+{
+  const View& view = *scene.getViews().at(viewId);
+  const Pose3 pose = scene.getPose(view).getTransform();
+  const auto acThresholdIt = acThresholds.find(viewId);
+
+  TriangulationView triangulationView;
+  triangulationView.intrinsic = scene.getIntrinsics().at(view.getIntrinsicId()).get();
+  triangulationView.P = triangulationView.intrinsic->get_projective_equivalent(pose);
+  triangulationView.center = pose.center();
+  // TODO assert(acThresholdIt != acThresholds.end());
+  triangulationView.acThreshold = (acThresholdIt != acThresholds.end()) ? acThresholdIt->second : 4.0;
+  return triangulationView;
+}
+
+} // namespace
+
 void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData& scene, const std::set<IndexT>& previousReconstructedViews, const std::set<IndexT>& newReconstructedViews)
 {
   ALICEVISION_LOG_DEBUG("Triangulating (mode: multi-view LO-RANSAC)... ");
@@ -1757,99 +1791,88 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
   getTracksToTriangulate(previousReconstructedViews, newReconstructedViews, mapTracksToTriangulate);
   
   std::vector<IndexT> setTracksId; // <trackId>
-  std::transform(mapTracksToTriangulate.begin(), mapTracksToTriangulate.end(),
-                 std::inserter(setTracksId, setTracksId.begin()),
-                 stl::RetrieveKey());
+  for(const auto& trackIt : mapTracksToTriangulate)
+  {
+    // The track needs to be seen by a min. number of views to be triangulated
+    if(trackIt.second.size() >= std::max<std::size_t>(2, _params.minNbObservationsForTriangulation))
+      setTracksId.push_back(trackIt.first);
+  }
+
+  // -- Prepare the projection of each reconstructed view once
+  std::set<IndexT> allReconstructedViews;
+  allReconstructedViews.insert(previousReconstructedViews.begin(), previousReconstructedViews.end());
+  allReconstructedViews.insert(newReconstructedViews.begin(), newReconstructedViews.end());
+
+  std::map<IndexT, TriangulationView> triangulationViews;
+  for(const IndexT viewId : allReconstructedViews)
+    triangulationViews.emplace(viewId, getTriangulationView(scene, viewId, _map_ACThreshold));
+
+  // -- Triangulate all the tracks in one batch (DLT on all the observations)
+  //  - 2 observations: the residual of each observation is checked with the a contrario threshold of its view
+  //  - N observations: all the observations have to be inliers of the LO-RANSAC threshold,
+  //    otherwise the track is triangulated with LO-RANSAC below
+  const double loRansacThreshold = 8.0;
+  multiview::TriangulationBatch batch(_params.minAngleForTriangulation);
+  for(const IndexT trackId : setTracksId)
+    batch.addTrack(mapTracksToTriangulate.at(trackId).size());
+
+#pragma omp parallel for
+  for (int i = 0; i < setTracksId.size(); i++)
+  {
+    const track::Track& track = _map_tracks.at(setTracksId.at(i));
+    const std::set<IndexT>& observations = mapTracksToTriangulate.at(setTracksId.at(i));
+
+    std::size_t j = 0;
+    for (const IndexT& viewId : observations)
+    {
+      const TriangulationView& view = triangulationViews.at(viewId);
+      const Vec2 x_ud = view.intrinsic->get_ud_pixel(_featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>()); // undistorted 2D point
+      const double maxError = (observations.size() == 2) ? view.acThreshold : loRansacThreshold;
+      batch.setObservation(i, j++, x_ud, view.P, view.center, maxError);
+    }
+  }
+
+  batch.triangulate();
 
 #pragma omp parallel for 
   for (int i = 0; i < setTracksId.size(); i++) // each track (already reconstructed or not)
   {
     const IndexT trackId = setTracksId.at(i);
-    bool isValidTrack = true;
     const track::Track& track = _map_tracks.at(trackId);
-    std::set<IndexT>& observations = mapTracksToTriangulate.at(trackId); // all the posed views possessing the track
-    
-    // The track needs to be seen by a min. number of views to be triangulated
-    if (observations.size() < _params.minNbObservationsForTriangulation)
-      continue;
+    const std::set<IndexT>& observations = mapTracksToTriangulate.at(trackId); // all the posed views possessing the track
     
-    Vec3 X_euclidean = Vec3::Zero();
+    // the batch checked the angle, the positive depth and the residual of all the observations
+    bool isValidTrack = batch.isValid(i);
+    Vec3 X_euclidean = batch.point(i);
     std::set<IndexT> inliers;
-    
-    if (observations.size() == 2) 
+
+    if (isValidTrack)
     {
-      /* --------------------------------------------
-       *    2 observations : triangulation using DLT
-       * -------------------------------------------- */ 
-       
       inliers = observations;
-      
-      // -- Prepare:
-      IndexT I =  *(observations.begin());
-      IndexT J =  *(observations.rbegin());
-      const View* viewI = scene.getViews().at(I).get();
-      const View* viewJ = scene.getViews().at(J).get();
-      const IntrinsicBase* camI = scene.getIntrinsics().at(viewI->getIntrinsicId()).get();
-      const IntrinsicBase* camJ = scene.getIntrinsics().at(viewJ->getIntrinsicId()).get();
-      const Pose3 poseI = scene.getPose(*viewI).getTransform();
-      const Pose3 poseJ = scene.getPose(*viewJ).getTransform();
-      const Vec2 xI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I)].coords().cast<double>();
-      const Vec2 xJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J)].coords().cast<double>();
-  
-      // -- Triangulate:
-      multiview::TriangulateDLT(camI->get_projective_equivalent(poseI),
-                     camI->get_ud_pixel(xI), 
-                     camJ->get_projective_equivalent(poseJ), 
-                     camI->get_ud_pixel(xJ), 
-                     &X_euclidean);
-      
-      // -- Check:
-      //  - angle (small angle leads imprecise triangulation)
-      //  - positive depth
-      //  - residual values
-      // TODO assert(acThresholdIt != _map_ACThreshold.end());
-      const auto& acThresholdItI = _map_ACThreshold.find(I);
-      const auto& acThresholdItJ = _map_ACThreshold.find(J);
-      const double& acThresholdI = (acThresholdItI != _map_ACThreshold.end()) ? acThresholdItI->second : 4.0;
-      const double& acThresholdJ = (acThresholdItJ != _map_ACThreshold.end()) ? acThresholdItJ->second : 4.0;
-      
-      if (AngleBetweenRays(poseI, camI, poseJ, camJ, xI, xJ) < _params.minAngleForTriangulation ||
-          poseI.depth(X_euclidean) < 0 || 
-          poseJ.depth(X_euclidean) < 0 || 
-          camI->residual(poseI, X_euclidean, xI).norm() > acThresholdI || 
-          camJ->residual(poseJ, X_euclidean, xJ).norm() > acThresholdJ)
-        isValidTrack = false;
     }
-    else 
+    else if (observations.size() > 2)
     {
       /* -------------------------------------------------------
        *    N obsevations (N>2) : triangulation using LORANSAC 
        * ------------------------------------------------------- */ 
      
       // -- Prepare:
-      Mat2X features(2, observations.size()); // undistorted 2D features (one per pose)
+      const std::size_t nbObservations = batch.nbObservations(i);
+      stl::arena_scope scratch; // per-track buffers from the thread arena
+      Eigen::Map<Mat2X> features(scratch.allocate<double>(2 * nbObservations), 2, nbObservations); // undistorted 2D features (one per pose)
       std::vector<Mat34> Ps; // projective matrices (one per pose)
+      Ps.reserve(nbObservations);
+      for (std::size_t j = 0; j < nbObservations; ++j)
       {
-        const track::Track& track = _map_tracks.at(trackId);
-        
-        int i = 0;
-        for (const IndexT& viewId : observations)
-        {
-          const View* view = scene.getViews().at(viewId).get();
-          const IntrinsicBase* cam = scene.getIntrinsics().at(view->getIntrinsicId()).get();
-          const Vec2 x_ud = cam->get_ud_pixel(_featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>()); // undistorted 2D point
-          features(0,i) = x_ud(0); 
-          features(1,i) = x_ud(1);  
-          Ps.push_back(cam->get_projective_equivalent(scene.getPose(*view).getTransform()));
-          i++;
-        }
+        features.col(j) = batch.observation(i, j);
+        Ps.push_back(batch.projectionMatrix(i, j));
       }
       
       // -- Triangulate: 
       Vec4 X_homogeneous = Vec4::Zero();
       std::vector<std::size_t> inliersIndex;
       
-      multiview::TriangulateNViewLORANSAC(features, Ps, &X_homogeneous, &inliersIndex, 8.0);
+      multiview::TriangulateNViewLORANSAC(features, Ps, &X_homogeneous, &inliersIndex, loRansacThreshold);
       
       homogeneousToEuclidean(X_homogeneous, &X_euclidean);     
       
@@ -1861,10 +1884,9 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
       //  - nb of cameras validing the track 
       //  - angle (small angle leads imprecise triangulation)
       //  - positive depth (chierality)
-      if (inliers.size() < _params.minNbObservationsForTriangulation ||
-          !checkAngles(X_euclidean, inliers, scene, _params.minAngleForTriangulation) ||
-          !checkChieralities(X_euclidean, inliers, scene))
-        isValidTrack = false;
+      isValidTrack = inliers.size() >= _params.minNbObservationsForTriangulation &&
+                     checkAngles(X_euclidean, inliers, scene, _params.minAngleForTriangulation) &&
+                     checkChieralities(X_euclidean, inliers, scene);
     }  
 
     // -- Add the tringulated point to the scene
@@ -1940,113 +1962,115 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, cons
       const IntrinsicBase* camJ = scene.getIntrinsics().at(viewJ->getIntrinsicId()).get();
       const Pose3 poseI = scene.getPose(*viewI).getTransform();
       const Pose3 poseJ = scene.getPose(*viewJ).getTransform();
+      const TriangulationView triangulationViewI = getTriangulationView(scene, I, _map_ACThreshold);
+      const TriangulationView triangulationViewJ = getTriangulationView(scene, J, _map_ACThreshold);
+
+      // new 3D points of the pair, triangulated in one batch
+      multiview::TriangulationBatch batch(_params.minAngleForTriangulation);
+      std::vector<const track::TracksMap::value_type*> newTracks;
       
       std::size_t new_putative_track = 0, new_added_track = 0, extented_track = 0;
-      for (const std::pair<std::size_t, track::Track >& trackIt : map_tracksCommonIJ)
+
+      // 3D point triangulated before, only add the image observations that fit it
+      // (must be called in a critical section)
+      const auto extendLandmark = [&](Landmark& landmark, const track::Track& track)
+      {
+        const feature::PointFeature& featI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I)];
+        const feature::PointFeature& featJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J)];
+        const Vec2 xI = featI.coords().cast<double>();
+        const Vec2 xJ = featJ.coords().cast<double>();
+
+        if (landmark.observations.count(I) == 0)
+        {
+          const Vec2 residual = camI->residual(poseI, landmark.X, xI);
+          if (poseI.depth(landmark.X) > 0 && residual.norm() < std::max(4.0, triangulationViewI.acThreshold))
+          {
+            const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featI.scale();
+            landmark.observations[I] = Observation(xI, track.featPerView.at(I), scale);
+            ++extented_track;
+          }
+        }
+        if (landmark.observations.count(J) == 0)
+        {
+          const Vec2 residual = camJ->residual(poseJ, landmark.X, xJ);
+          if (poseJ.depth(landmark.X) > 0 && residual.norm() < std::max(4.0, triangulationViewJ.acThreshold))
+          {
+            const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featJ.scale();
+            landmark.observations[J] = Observation(xJ, track.featPerView.at(J), scale);
+            ++extented_track;
+          }
+        }
+      };
+
+      for (const track::TracksMap::value_type& trackIt : map_tracksCommonIJ)
       {
         const std::size_t trackId = trackIt.first;
         const track::Track & track = trackIt.second;
 
         const Vec2 xI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I)].coords().cast<double>();
         const Vec2 xJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J)].coords().cast<double>();
-        
-        const feature::PointFeature& featI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I)];
-        const feature::PointFeature& featJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J)];
+
         // test if the track already exists in 3D
         bool trackIdExists;
 #pragma omp critical
         {
-          trackIdExists = scene.structure.find(trackId) != scene.structure.end();
+          const auto landmarkIt = scene.structure.find(trackId);
+          trackIdExists = landmarkIt != scene.structure.end();
+          if (trackIdExists)
+            extendLandmark(landmarkIt->second, track);
         }
-        if (trackIdExists)
-        {
-          // 3D point triangulated before, only add image observation if needed
-#pragma omp critical
-          {
-            Landmark& landmark = scene.structure.at(trackId);
-            if (landmark.observations.count(I) == 0)
-            {
-              const Vec2 residual = camI->residual(poseI, landmark.X, xI);
-              const auto& acThresholdIt = _map_ACThreshold.find(I);
-              // TODO assert(acThresholdIt != _map_ACThreshold.end());
-              const double acThreshold = (acThresholdIt != _map_ACThreshold.end()) ? acThresholdIt->second : 4.0;
-              if (poseI.depth(landmark.X) > 0 && residual.norm() < std::max(4.0, acThreshold))
-              {
-                const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featI.scale();
-                landmark.observations[I] = Observation(xI, track.featPerView.at(I), scale);
-                ++extented_track;
-              }
-            }
-            if (landmark.observations.count(J) == 0)
-            {
-              const Vec2 residual = camJ->residual(poseJ, landmark.X, xJ);
-              const auto& acThresholdIt = _map_ACThreshold.find(J);
-              // TODO assert(acThresholdIt != _map_ACThreshold.end());
-              const double acThreshold = (acThresholdIt != _map_ACThreshold.end()) ? acThresholdIt->second : 4.0;
-              if (poseJ.depth(landmark.X) > 0 && residual.norm() < std::max(4.0, acThreshold))
-              {
-                const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featJ.scale();
-                landmark.observations[J] = Observation(xJ, track.featPerView.at(J), scale);
-                ++extented_track;
-              }
-            }
-          }
-        }
-        else
+        if (!trackIdExists)
         {
           // A new 3D point must be added
+          ++new_putative_track;
+
+          const std::size_t t = batch.addTrack(2);
+          batch.setObservation(t, 0, camI->get_ud_pixel(xI), triangulationViewI.P, triangulationViewI.center, triangulationViewI.acThreshold);
+          batch.setObservation(t, 1, camJ->get_ud_pixel(xJ), triangulationViewJ.P, triangulationViewJ.center, triangulationViewJ.acThreshold);
+          newTracks.push_back(&trackIt);
+        } // else (New 3D point)
+      }// for all correspondences
+
+      // Triangulate the new 3D points and check in the same pass:
+      //  - angle (small angle leads imprecise triangulation)
+      //  - positive depth
+      //  - residual values
+      // serial: we are already in the parallel loop over the views
+      batch.triangulate(false);
+
+      for (std::size_t t = 0; t < batch.size(); ++t)
+      {
+        if (!batch.isValid(t))
+          continue;
+
+        const std::size_t trackId = newTracks[t]->first;
+        const track::Track & track = newTracks[t]->second;
+        const feature::PointFeature& featI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I)];
+        const feature::PointFeature& featJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J)];
 #pragma omp critical
+        {
+          // the track may have been added by another pair since the existence test
+          const auto landmarkIt = scene.structure.find(trackId);
+          if (landmarkIt != scene.structure.end())
           {
-            ++new_putative_track;
+            extendLandmark(landmarkIt->second, track);
           }
-          
-          Vec3 X_euclidean = Vec3::Zero();
-          const Vec2 xI_ud = camI->get_ud_pixel(xI);
-          const Vec2 xJ_ud = camJ->get_ud_pixel(xJ);
-          const Mat34 pI = camI->get_projective_equivalent(poseI);
-          const Mat34 pJ = camJ->get_projective_equivalent(poseJ);
-          
-          multiview::TriangulateDLT(pI, xI_ud, pJ, xJ_ud, &X_euclidean);
-          
-          // Check triangulation results
-          //  - Check angle (small angle leads imprecise triangulation)
-          //  - Check positive depth
-          //  - Check residual values
-          const double angle = AngleBetweenRays(poseI, camI, poseJ, camJ, xI, xJ);
-          const Vec2 residualI = camI->residual(poseI, X_euclidean, xI);
-          const Vec2 residualJ = camJ->residual(poseJ, X_euclidean, xJ);
-          
-          // TODO assert(acThresholdIt != _map_ACThreshold.end());
-          
-          const auto& acThresholdItI = _map_ACThreshold.find(I);
-          const auto& acThresholdItJ = _map_ACThreshold.find(J);
-          
-          const double& acThresholdI = (acThresholdItI != _map_ACThreshold.end()) ? acThresholdItI->second : 4.0;
-          const double& acThresholdJ = (acThresholdItJ != _map_ACThreshold.end()) ? acThresholdItJ->second : 4.0;
-          
-          if (angle > _params.minAngleForTriangulation &&
-              poseI.depth(X_euclidean) > 0 &&
-              poseJ.depth(X_euclidean) > 0 &&
-              residualI.norm() < acThresholdI &&
-              residualJ.norm() < acThresholdJ)
+          else
           {
-#pragma omp critical
-            {
-              // Add a new track
-              Landmark & landmark = scene.structure[trackId];
-              landmark.X = X_euclidean;
-              landmark.descType = track.descType;
-              
-              const double scaleI = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featI.scale();
-              const double scaleJ = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featJ.scale();
-              landmark.observations[I] = Observation(xI, track.featPerView.at(I), scaleI);
-              landmark.observations[J] = Observation(xJ, track.featPerView.at(J), scaleJ);
-              
-              ++new_added_track;
-            } // critical
-          } // 3D point is valid
-        } // else (New 3D point)
-      }// for all correspondences
+            // Add a new track
+            Landmark & landmark = scene.structure[trackId];
+            landmark.X = batch.point(t);
+            landmark.descType = track.descType;
+
+            const double scaleI = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featI.scale();
+            const double scaleJ = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featJ.scale();
+            landmark.observations[I] = Observation(featI.coords().cast<double>(), track.featPerView.at(I), scaleI);
+            landmark.observations[J] = Observation(featJ.coords().cast<double>(), track.featPerView.at(J), scaleJ);
+
+            ++new_added_track;
+          }
+        } // critical
+      } // for all new 3D points
     }
 
 //  #pragma omp critical
@@ -15,6 +15,7 @@
 #include <aliceVision/track/Track.hpp>
 #include <aliceVision/sfm/sfmTriangulation.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/progress.hpp>
 
@@ -26,37 +27,6 @@ using namespace aliceVision::feature;
 using namespace aliceVision::geometry;
 using namespace aliceVision::sfmData;
 
-/// Camera pair epipole (Projection of camera center 2 in the image plane 1)
-inline Vec3 epipole_from_P(const Mat34& P1, const Pose3& P2)
-{
-  const Vec3 c = P2.center();
-  Vec4 center;
-  center << c(0), c(1), c(2), 1.0;
-  return P1*center;
-}
-
-/// Export point feature based vector to a matrix [(x,y)'T, (x,y)'T]
-/// Use the camera intrinsics in order to get undistorted pixel coordinates
-template<typename MatT >
-void PointsToMat(
-  const IntrinsicBase * cam,
-  const PointFeatures & vec_feats,
-  MatT & m)
-{
-  m.resize(2, vec_feats.size());
-  typedef typename MatT::Scalar Scalar; // Output matrix type
-
-  size_t i = 0;
-  for( PointFeatures::const_iterator iter = vec_feats.begin();
-    iter != vec_feats.end(); ++iter, ++i)
-  {
-    if (cam && cam->isValid())
-      m.col(i) = cam->get_ud_pixel(Vec2(iter->x(), iter->y()));
-    else
-      m.col(i) << iter->x(), iter->y();
-  }
-}
-
 /// Use geometry of the views to compute a putative structure from features and descriptors.
 void StructureEstimationFromKnownPoses::run(SfMData& sfmData,
   const PairSet& pairs,
@@ -70,7 +40,45 @@ void StructureEstimationFromKnownPoses::run(SfMData& sfmData,
   triangulate(sfmData, regionsPerView);
 }
 
-// #define ALICEVISION_EXHAUSTIVE_MATCHING
+/// Compute the cache of the views used by the given pairs (views with undefined pose or intrinsic are skipped)
+void StructureEstimationFromKnownPoses::updateViewCache(const SfMData& sfmData,
+  const PairSet& pairs,
+  const feature::RegionsPerView& regionsPerView)
+{
+  std::set<IndexT> viewIds;
+  for(const Pair& pair : pairs)
+  {
+    viewIds.insert(pair.first);
+    viewIds.insert(pair.second);
+  }
+
+  std::vector<IndexT> newViewIds;
+  for(const IndexT viewId : viewIds)
+  {
+    if(_viewCache.count(viewId) == 0 && sfmData.isPoseAndIntrinsicDefined(viewId) && regionsPerView.viewExist(viewId))
+      newViewIds.push_back(viewId);
+  }
+
+  std::vector<ViewCache, Eigen::aligned_allocator<ViewCache>> newCaches(newViewIds.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(newViewIds.size()); ++i)
+  {
+    const View& view = sfmData.getView(newViewIds[i]);
+    const Pose3 pose = sfmData.getPose(view).getTransform();
+    ViewCache& cache = newCaches[i];
+
+    cache.intrinsic = sfmData.getIntrinsicPtr(view.getIntrinsicId());
+    cache.P = cache.intrinsic->get_projective_equivalent(pose);
+    cache.center = pose.center();
+
+    for(const auto& regionsPerDesc : regionsPerView.getRegionsPerDesc(view.getViewId()))
+      matching::getUndistortedRegionPositions(cache.intrinsic, *regionsPerDesc.second, cache.undistortedPositions[regionsPerDesc.first]);
+  }
+
+  for(std::size_t i = 0; i < newViewIds.size(); ++i)
+    _viewCache[newViewIds[i]] = std::move(newCaches[i]);
+}
 
 /// Use guided matching to find corresponding 2-view correspondences
 void StructureEstimationFromKnownPoses::match(const SfMData& sfmData,
@@ -78,82 +86,66 @@ void StructureEstimationFromKnownPoses::match(const SfMData& sfmData,
   const feature::RegionsPerView& regionsPerView,
   double geometricErrorMax)
 {
-  boost::progress_display my_progress_bar( pairs.size(), std::cout,
+  updateViewCache(sfmData, pairs, regionsPerView);
+
+  const PairVec pairsVec(pairs.begin(), pairs.end());
+  std::vector<matching::MatchesPerDescType> matchesPerPair(pairsVec.size());
+  std::vector<char> validPair(pairsVec.size(), 0);
+
+  boost::progress_display my_progress_bar( pairsVec.size(), std::cout,
     "Compute pairwise fundamental guided matching:\n" );
 
-  #pragma omp parallel
-  for (PairSet::const_iterator it = pairs.begin(); it != pairs.end(); ++it)
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(pairsVec.size()); ++i)
   {
-    #pragma omp single nowait
-    {
     // --
     // Perform GUIDED MATCHING
     // --
     // Use the computed model to check valid correspondences
     // - by considering geometric error and descriptor distance ratio.
 
-    const View * viewL = sfmData.getViews().at(it->first).get();
-    const Pose3 poseL = sfmData.getPose(*viewL).getTransform();
-    const Intrinsics::const_iterator iterIntrinsicL = sfmData.getIntrinsics().find(viewL->getIntrinsicId());
-    const View * viewR = sfmData.getViews().at(it->second).get();
-    const Pose3 poseR = sfmData.getPose(*viewR).getTransform();
-    const Intrinsics::const_iterator iterIntrinsicR = sfmData.getIntrinsics().find(viewR->getIntrinsicId());
+    const Pair& pair = pairsVec[i];
+    const auto itCacheL = _viewCache.find(pair.first);
+    const auto itCacheR = _viewCache.find(pair.second);
 
-    if (sfmData.getIntrinsics().count(viewL->getIntrinsicId()) != 0 ||
-        sfmData.getIntrinsics().count(viewR->getIntrinsicId()) != 0)
+    if(itCacheL != _viewCache.end() && itCacheR != _viewCache.end())
     {
-      const Mat34 P_L = iterIntrinsicL->second.get()->get_projective_equivalent(poseL);
-      const Mat34 P_R = iterIntrinsicR->second.get()->get_projective_equivalent(poseR);
-
-      const Mat3 F_lr = F_from_P(P_L, P_R);
-      std::vector<feature::EImageDescriberType> commonDescTypes = regionsPerView.getCommonDescTypes(*it);
-      
-      matching::MatchesPerDescType allImagePairMatches;
-      for(feature::EImageDescriberType descType: commonDescTypes)
-      {
-        std::vector<matching::IndMatch> matches;
-#ifdef ALICEVISION_EXHAUSTIVE_MATCHING
-          matching::guidedMatching
-          <Mat3, multiview::relativePose::FundamentalEpipolarDistanceError>
-          (
-            F_lr,
-            iterIntrinsicL->second.get(),
-            regionsPerView.getRegions(it->first, descType),
-            iterIntrinsicR->second.get(),
-            regionsPerView.getRegions(it->second, descType),
-            // descType,
-            Square(thresholdF), Square(0.8),
-            matches
-          );
-      #else
-        const Vec3 epipole2  = epipole_from_P(P_R, poseL);
+      const ViewCache& cacheL = itCacheL->second;
+      const ViewCache& cacheR = itCacheR->second;
+
+      const Mat3 F_lr = F_from_P(cacheL.P, cacheR.P);
+      // Camera pair epipole (Projection of camera center L in the image plane R)
+      const Vec3 epipole2 = cacheR.P * cacheL.center.homogeneous();
 
-        //const feature::Regions& regions = regionsPerView.getRegions(it->first);
+      for(feature::EImageDescriberType descType : regionsPerView.getCommonDescTypes(pair))
+      {
         matching::guidedMatchingFundamentalFast<multiview::relativePose::FundamentalEpipolarDistanceError>
           (
             F_lr,
             epipole2,
-            iterIntrinsicL->second.get(),
-            regionsPerView.getRegions(it->first, descType),
-            iterIntrinsicR->second.get(),
-            regionsPerView.getRegions(it->second, descType),
-            iterIntrinsicR->second->w(), iterIntrinsicR->second->h(),
-            //descType,
+            cacheL.undistortedPositions.at(descType),
+            regionsPerView.getRegions(pair.first, descType),
+            cacheR.undistortedPositions.at(descType),
+            regionsPerView.getRegions(pair.second, descType),
+            cacheR.intrinsic->w(), cacheR.intrinsic->h(),
             Square(geometricErrorMax), Square(0.8),
-            matches
+            matchesPerPair[i][descType]
           );
-      #endif
-         allImagePairMatches[descType] = matches;
-      }
-
-      #pragma omp critical
-      {
-        ++my_progress_bar;
-        _putativeMatches[*it] = allImagePairMatches;
       }
+      validPair[i] = 1;
     }
+
+    #pragma omp critical
+    {
+      ++my_progress_bar;
     }
   }
+
+  for(std::size_t i = 0; i < pairsVec.size(); ++i)
+  {
+    if(validPair[i])
+      _putativeMatches[pairsVec[i]] = std::move(matchesPerPair[i]);
+  }
 }
 
 /// Filter inconsistent correspondences by using 3-view correspondences on view triplets
@@ -166,78 +158,91 @@ void StructureEstimationFromKnownPoses::filter(
   // Triangulate triplet tracks
   //  - keep valid one
 
+  updateViewCache(sfmData, pairs, regionsPerView);
+
   typedef std::vector< graph::Triplet > Triplets;
   const Triplets triplets = graph::tripletListing(pairs);
 
+  // validated triplet matches are accumulated per thread and merged at the end
+  std::vector<matching::PairwiseMatches> tripletMatchesPerThread(omp_get_max_threads());
+
   boost::progress_display my_progress_bar( triplets.size(), std::cout,
     "Per triplet tracks validation (discard spurious correspondences):\n" );
-  #pragma omp parallel
-  for( Triplets::const_iterator it = triplets.begin(); it != triplets.end(); ++it)
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t t = 0; t < static_cast<std::ptrdiff_t>(triplets.size()); ++t)
   {
-    #pragma omp single nowait
+    const graph::Triplet & triplet = triplets[t];
+    const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
+    matching::PairwiseMatches& tripletMatches = tripletMatchesPerThread[omp_get_thread_num()];
+
+    track::TracksMap map_tracksCommon;
+    track::TracksBuilder tracksBuilder;
     {
-      #pragma omp critical
-      {++my_progress_bar;}
+      matching::PairwiseMatches map_matchesIJK;
+      if (_putativeMatches.count(std::make_pair(I,J)))
+        map_matchesIJK.insert(*_putativeMatches.find(std::make_pair(I,J)));
 
-      const graph::Triplet & triplet = *it;
-      const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
+      if (_putativeMatches.count(std::make_pair(I,K)))
+        map_matchesIJK.insert(*_putativeMatches.find(std::make_pair(I,K)));
 
-      track::TracksMap map_tracksCommon;
-      track::TracksBuilder tracksBuilder;
-      {
-        matching::PairwiseMatches map_matchesIJK;
-        if (_putativeMatches.count(std::make_pair(I,J)))
-          map_matchesIJK.insert(*_putativeMatches.find(std::make_pair(I,J)));
+      if (_putativeMatches.count(std::make_pair(J,K)))
+        map_matchesIJK.insert(*_putativeMatches.find(std::make_pair(J,K)));
 
-        if (_putativeMatches.count(std::make_pair(I,K)))
-          map_matchesIJK.insert(*_putativeMatches.find(std::make_pair(I,K)));
-
-        if (_putativeMatches.count(std::make_pair(J,K)))
-          map_matchesIJK.insert(*_putativeMatches.find(std::make_pair(J,K)));
+      if (map_matchesIJK.size() >= 2) {
+        tracksBuilder.build(map_matchesIJK);
+        tracksBuilder.filter(true,3, false);
+        tracksBuilder.exportToSTL(map_tracksCommon);
+      }
 
-        if (map_matchesIJK.size() >= 2) {
-          tracksBuilder.build(map_matchesIJK);
-          tracksBuilder.filter(true,3, false);
-          tracksBuilder.exportToSTL(map_tracksCommon);
+      // Triangulate the tracks
+      multiview::Triangulation trianObj;
+      for (track::TracksMap::const_iterator iterTracks = map_tracksCommon.begin();
+        iterTracks != map_tracksCommon.end(); ++iterTracks)
+      {
+        const track::Track & subTrack = iterTracks->second;
+        trianObj.clear();
+        for (auto iter = subTrack.featPerView.begin(); iter != subTrack.featPerView.end(); ++iter)
+        {
+          const ViewCache& cache = _viewCache.at(iter->first);
+          trianObj.add(cache.P, cache.undistortedPositions.at(subTrack.descType).col(iter->second));
         }
-
-        // Triangulate the tracks
-        for (track::TracksMap::const_iterator iterTracks = map_tracksCommon.begin();
-          iterTracks != map_tracksCommon.end(); ++iterTracks) {
-          {
-            const track::Track & subTrack = iterTracks->second;
-            multiview::Triangulation trianObj;
-            for (auto iter = subTrack.featPerView.begin(); iter != subTrack.featPerView.end(); ++iter)
-            {
-              const size_t imaIndex = iter->first;
-              const size_t featIndex = iter->second;
-              const View * view = sfmData.getViews().at(imaIndex).get();
-              const IntrinsicBase * cam = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-              const Pose3 pose = sfmData.getPose(*view).getTransform();
-              const Vec2 pt = regionsPerView.getRegions(imaIndex, subTrack.descType).GetRegionPosition(featIndex);
-              trianObj.add(cam->get_projective_equivalent(pose), cam->get_ud_pixel(pt));
-            }
-            const Vec3 Xs = trianObj.compute();
-            if (trianObj.minDepth() > 0 && trianObj.error()/(double)trianObj.size() < 4.0)
-            // TODO: Add an angular check ?
-            {
-              #pragma omp critical
-              {
-                track::Track::FeatureIdPerView::const_iterator iterI, iterJ, iterK;
-                iterI = iterJ = iterK = subTrack.featPerView.begin();
-                std::advance(iterJ,1);
-                std::advance(iterK,2);
-
-                _tripletMatches[std::make_pair(I,J)][subTrack.descType].emplace_back(iterI->second, iterJ->second);
-                _tripletMatches[std::make_pair(J,K)][subTrack.descType].emplace_back(iterJ->second, iterK->second);
-                _tripletMatches[std::make_pair(I,K)][subTrack.descType].emplace_back(iterI->second, iterK->second);
-              }
-            }
-          }
+        const Vec3 Xs = trianObj.compute();
+        if (trianObj.minDepth() > 0 && trianObj.error()/(double)trianObj.size() < 4.0)
+        // TODO: Add an angular check ?
+        {
+          track::Track::FeatureIdPerView::const_iterator iterI, iterJ, iterK;
+          iterI = iterJ = iterK = subTrack.featPerView.begin();
+          std::advance(iterJ,1);
+          std::advance(iterK,2);
+
+          tripletMatches[std::make_pair(I,J)][subTrack.descType].emplace_back(iterI->second, iterJ->second);
+          tripletMatches[std::make_pair(J,K)][subTrack.descType].emplace_back(iterJ->second, iterK->second);
+          tripletMatches[std::make_pair(I,K)][subTrack.descType].emplace_back(iterI->second, iterK->second);
         }
       }
     }
+
+    #pragma omp critical
+    {
+      ++my_progress_bar;
+    }
   }
+
+  // Merge the per thread validated matches
+  for(matching::PairwiseMatches& tripletMatches : tripletMatchesPerThread)
+  {
+    for(auto& matchesPerDesc : tripletMatches)
+    {
+      for(auto& matches : matchesPerDesc.second)
+      {
+        matching::IndMatches& outMatches = _tripletMatches[matchesPerDesc.first][matches.first];
+        outMatches.insert(outMatches.end(), matches.second.begin(), matches.second.end());
+      }
+    }
+    matching::PairwiseMatches().swap(tripletMatches);
+  }
+
   // Clear putatives matches since they are no longer required
   matching::PairwiseMatches().swap(_putativeMatches);
 }
@@ -253,6 +258,7 @@ void StructureEstimationFromKnownPoses::triangulate(
   tracksBuilder.filter(true,3);
   tracksBuilder.exportToSTL(map_tracksCommon);
   matching::PairwiseMatches().swap(_tripletMatches);
+  HashMap<IndexT, ViewCache>().swap(_viewCache);
 
   // Generate new Structure tracks
   sfmData.structure.clear();
@@ -46,11 +46,30 @@ public:
   const matching::PairwiseMatches& getPutativesMatches() const { return _putativeMatches; }
 
 private:
+
+  /// Per-view data shared by all the pairs and triplets using the view
+  struct ViewCache
+  {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    const camera::IntrinsicBase* intrinsic = nullptr;
+    Mat34 P;
+    Vec3 center;
+    /// undistorted feature positions per describer type
+    std::map<feature::EImageDescriberType, Mat2X> undistortedPositions;
+  };
+
+  /// Compute the cache of the views used by the given pairs (views with undefined pose or intrinsic are skipped)
+  void updateViewCache(const sfmData::SfMData& sfmData,
+    const PairSet& pairs,
+    const feature::RegionsPerView& regionsPerView);
+
   //--
   // DATA (temporary)
   //--
   matching::PairwiseMatches _putativeMatches;
   matching::PairwiseMatches _tripletMatches;
+  HashMap<IndexT, ViewCache> _viewCache;
 };
 
 } // namespace sfm
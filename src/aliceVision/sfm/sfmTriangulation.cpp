@@ -9,10 +9,10 @@
 #include <aliceVision/multiview/triangulation/Triangulation.hpp>
 #include <aliceVision/robustEstimation/randSampling.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/progress.hpp>
 
-#include <deque>
 #include <memory>
 
 namespace aliceVision {
@@ -21,6 +21,74 @@ namespace sfm {
 using namespace aliceVision::geometry;
 using namespace aliceVision::camera;
 
+namespace {
+
+/**
+ * @brief Number of landmarks processed by a parallel task.
+ * @note Each chunk still solves its landmarks one by one: the blind triangulation reuses a single
+ *       Triangulation object (no allocation per landmark) and keeps its iterative weighted least squares
+ *       instead of the algebraic multiview::TriangulationBatch, which would change the triangulated points.
+ *       The robust triangulation runs a RANSAC per landmark, whose sampling does not fit a batch kernel.
+ */
+const std::size_t triangulationChunkSize = 1024;
+
+/// Per-view data shared by the triangulation of all the landmarks
+struct ViewProjection
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  const IntrinsicBase* intrinsic = nullptr;
+  Mat34 P;
+};
+
+using ViewProjections = HashMap<IndexT, ViewProjection>;
+
+/**
+ * @brief Compute the projection matrix of each view with a valid pose and intrinsic once,
+ *        instead of once per observation.
+ */
+ViewProjections computeViewProjections(const sfmData::SfMData& sfmData)
+{
+  std::vector<const sfmData::View*> validViews;
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    if(sfmData.isPoseAndIntrinsicDefined(viewPair.second.get()))
+      validViews.push_back(viewPair.second.get());
+  }
+
+  std::vector<ViewProjection, Eigen::aligned_allocator<ViewProjection>> projections(validViews.size());
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(validViews.size()); ++i)
+  {
+    const sfmData::View& view = *validViews[i];
+    projections[i].intrinsic = sfmData.getIntrinsics().at(view.getIntrinsicId()).get();
+    projections[i].P = projections[i].intrinsic->get_projective_equivalent(sfmData.getPose(view).getTransform());
+  }
+
+  ViewProjections viewProjections;
+  for(std::size_t i = 0; i < validViews.size(); ++i)
+    viewProjections.emplace(validViews[i]->getViewId(), projections[i]);
+
+  return viewProjections;
+}
+
+/**
+ * @brief Gather the landmarks in a flat array to allow index-based parallel loops
+ */
+void getLandmarksArray(sfmData::SfMData& sfmData, std::vector<IndexT>& landmarkIds, std::vector<sfmData::Landmark*>& landmarks)
+{
+  landmarkIds.reserve(sfmData.structure.size());
+  landmarks.reserve(sfmData.structure.size());
+  for(auto& landmarkPair : sfmData.structure)
+  {
+    landmarkIds.push_back(landmarkPair.first);
+    landmarks.push_back(&landmarkPair.second);
+  }
+}
+
+} // namespace
+
 StructureComputation_basis::StructureComputation_basis(bool verbose)
   : _bConsoleVerbose(verbose)
 {}
@@ -31,69 +99,70 @@ StructureComputation_blind::StructureComputation_blind(bool verbose)
 
 void StructureComputation_blind::triangulate(sfmData::SfMData& sfmData) const
 {
-  std::deque<IndexT> rejectedId;
+  const ViewProjections viewProjections = computeViewProjections(sfmData);
+
+  std::vector<IndexT> landmarkIds;
+  std::vector<sfmData::Landmark*> landmarks;
+  getLandmarksArray(sfmData, landmarkIds, landmarks);
+
   std::unique_ptr<boost::progress_display> my_progress_bar;
   if (_bConsoleVerbose)
     my_progress_bar.reset( new boost::progress_display(
-    sfmData.structure.size(),
+    landmarks.size(),
     std::cout,
     "Blind triangulation progress:\n" ));
-  #pragma omp parallel
-  for(sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
-    iterTracks != sfmData.structure.end();
-    ++iterTracks)
+
+  std::vector<std::vector<IndexT>> rejectedIdPerThread(omp_get_max_threads());
+  const std::ptrdiff_t nbChunks = (landmarks.size() + triangulationChunkSize - 1) / triangulationChunkSize;
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t chunk = 0; chunk < nbChunks; ++chunk)
   {
-    #pragma omp single nowait
+    std::vector<IndexT>& rejectedId = rejectedIdPerThread[omp_get_thread_num()];
+    const std::size_t begin = chunk * triangulationChunkSize;
+    const std::size_t end = std::min(begin + triangulationChunkSize, landmarks.size());
+
+    multiview::Triangulation trianObj;
+
+    for(std::size_t i = begin; i < end; ++i)
     {
-      if (_bConsoleVerbose)
-      {
-        #pragma omp critical
-        ++(*my_progress_bar);
-      }
       // Triangulate each landmark
-      multiview::Triangulation trianObj;
-      const sfmData::Observations & observations = iterTracks->second.observations;
-      for(const auto& itObs : observations)
+      sfmData::Landmark& landmark = *landmarks[i];
+      trianObj.clear();
+
+      for(const auto& itObs : landmark.observations)
       {
-        const sfmData::View * view = sfmData.views.at(itObs.first).get();
-        if (sfmData.isPoseAndIntrinsicDefined(view))
-        {
-          const IntrinsicBase * cam = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-          const Pose3 pose = sfmData.getPose(*view).getTransform();
-          trianObj.add(
-            cam->get_projective_equivalent(pose),
-            cam->get_ud_pixel(itObs.second.x));
-        }
+        const auto itView = viewProjections.find(itObs.first);
+        if(itView != viewProjections.end())
+          trianObj.add(itView->second.P, itView->second.intrinsic->get_ud_pixel(itObs.second.x));
       }
+
       if (trianObj.size() < 2)
       {
-        #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
+        rejectedId.push_back(landmarkIds[i]);
+        continue;
       }
+
+      // Compute the 3D point
+      const Vec3 X = trianObj.compute();
+      if (trianObj.minDepth() > 0) // Keep the point only if it have a positive depth
+        landmark.X = X;
       else
-      {
-        // Compute the 3D point
-        const Vec3 X = trianObj.compute();
-        if (trianObj.minDepth() > 0) // Keep the point only if it have a positive depth
-        {
-          iterTracks->second.X = X;
-        }
-        else
-        {
-          #pragma omp critical
-          {
-            rejectedId.push_front(iterTracks->first);
-          }
-        }
-      }
+        rejectedId.push_back(landmarkIds[i]);
+    }
+
+    if (_bConsoleVerbose)
+    {
+      #pragma omp critical
+      (*my_progress_bar) += (end - begin);
     }
   }
+
   // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
+  for (const auto& rejectedId : rejectedIdPerThread)
   {
-    sfmData.structure.erase(it);
+    for (const IndexT landmarkId : rejectedId)
+      sfmData.structure.erase(landmarkId);
   }
 }
 
@@ -111,42 +180,52 @@ void StructureComputation_robust::triangulate(sfmData::SfMData& sfmData) const
 /// Invalid landmark are removed.
 void StructureComputation_robust::robust_triangulation(sfmData::SfMData& sfmData) const
 {
-  std::deque<IndexT> rejectedId;
+  std::vector<IndexT> landmarkIds;
+  std::vector<sfmData::Landmark*> landmarks;
+  getLandmarksArray(sfmData, landmarkIds, landmarks);
+
   std::unique_ptr<boost::progress_display> my_progress_bar;
   if(_bConsoleVerbose)
     my_progress_bar.reset( new boost::progress_display(
-    sfmData.structure.size(),
+    landmarks.size(),
     std::cout,
     "Robust triangulation progress:\n" ));
-  #pragma omp parallel
-  for(sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
-    iterTracks != sfmData.structure.end();
-    ++iterTracks)
+
+  std::vector<std::vector<IndexT>> rejectedIdPerThread(omp_get_max_threads());
+  const std::ptrdiff_t nbChunks = (landmarks.size() + triangulationChunkSize - 1) / triangulationChunkSize;
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t chunk = 0; chunk < nbChunks; ++chunk)
   {
-    #pragma omp single nowait
+    std::vector<IndexT>& rejectedId = rejectedIdPerThread[omp_get_thread_num()];
+    const std::size_t begin = chunk * triangulationChunkSize;
+    const std::size_t end = std::min(begin + triangulationChunkSize, landmarks.size());
+
+    for(std::size_t i = begin; i < end; ++i)
     {
-      if (_bConsoleVerbose)
-      {
-        #pragma omp critical
-        ++(*my_progress_bar);
-      }
+      sfmData::Landmark& landmark = *landmarks[i];
       Vec3 X;
-      if (robust_triangulation(sfmData, iterTracks->second.observations, X)) {
-        iterTracks->second.X = X;
+      if (robust_triangulation(sfmData, landmark.observations, X)) {
+        landmark.X = X;
       }
       else {
-        iterTracks->second.X = Vec3::Zero();
-        #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
+        landmark.X = Vec3::Zero();
+        rejectedId.push_back(landmarkIds[i]);
       }
     }
+
+    if (_bConsoleVerbose)
+    {
+      #pragma omp critical
+      (*my_progress_bar) += (end - begin);
+    }
   }
+
   // Erase the unsuccessful triangulated tracks
-  for(auto& it : rejectedId)
+  for (const auto& rejectedId : rejectedIdPerThread)
   {
-    sfmData.structure.erase(it);
+    for (const IndexT landmarkId : rejectedId)
+      sfmData.structure.erase(landmarkId);
   }
 }
 
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <regex>
+#include <tuple>
 
 
 namespace bacc = boost::accumulators;
@@ -480,6 +481,144 @@ bool computeSimilarityFromCommonMarkers(
     return true;
 }
 
+void getCommonLandmarksFromMatches(
+    const sfmData::SfMData& sfmDataA,
+    const sfmData::SfMData& sfmDataB,
+    const matching::PairwiseMatches& pairwiseMatches,
+    std::vector<std::pair<IndexT, IndexT>>& out_commonLandmarkIds)
+{
+    // only the views of the A/B pairs are indexed
+    std::set<IndexT> viewIdsA, viewIdsB;
+    for (const auto& matchesPair : pairwiseMatches)
+    {
+        const Pair& pair = matchesPair.first;
+        if (sfmDataA.getViews().count(pair.first) && sfmDataB.getViews().count(pair.second))
+        {
+            viewIdsA.insert(pair.first);
+            viewIdsB.insert(pair.second);
+        }
+        else if (sfmDataB.getViews().count(pair.first) && sfmDataA.getViews().count(pair.second))
+        {
+            viewIdsB.insert(pair.first);
+            viewIdsA.insert(pair.second);
+        }
+    }
+
+    // landmark observed by each feature <viewId, descType, featureId>
+    using FeatureKey = std::tuple<IndexT, feature::EImageDescriberType, IndexT>;
+    const auto getLandmarkPerFeature = [](const sfmData::SfMData& sfmData, const std::set<IndexT>& viewIds) {
+        std::map<FeatureKey, IndexT> landmarkPerFeature;
+        for (const auto& landmarkIt : sfmData.getLandmarks())
+        {
+            for (const auto& observationIt : landmarkIt.second.observations)
+            {
+                if (viewIds.count(observationIt.first))
+                    landmarkPerFeature[FeatureKey(observationIt.first, landmarkIt.second.descType, observationIt.second.id_feat)] = landmarkIt.first;
+            }
+        }
+        return landmarkPerFeature;
+    };
+    const std::map<FeatureKey, IndexT> landmarkPerFeatureA = getLandmarkPerFeature(sfmDataA, viewIdsA);
+    const std::map<FeatureKey, IndexT> landmarkPerFeatureB = getLandmarkPerFeature(sfmDataB, viewIdsB);
+
+    // number of matches linking each pair of landmarks
+    std::map<std::pair<IndexT, IndexT>, std::size_t> nbMatchesPerLink;
+    for (const auto& matchesPair : pairwiseMatches)
+    {
+        const bool isAB = viewIdsA.count(matchesPair.first.first) && viewIdsB.count(matchesPair.first.second);
+        const bool isBA = viewIdsB.count(matchesPair.first.first) && viewIdsA.count(matchesPair.first.second);
+        if (!isAB && !isBA)
+            continue;
+
+        const IndexT viewIdA = isAB ? matchesPair.first.first : matchesPair.first.second;
+        const IndexT viewIdB = isAB ? matchesPair.first.second : matchesPair.first.first;
+
+        for (const auto& matchesPerDesc : matchesPair.second)
+        {
+            for (const matching::IndMatch& match : matchesPerDesc.second)
+            {
+                const auto itA = landmarkPerFeatureA.find(FeatureKey(viewIdA, matchesPerDesc.first, isAB ? match._i : match._j));
+                const auto itB = landmarkPerFeatureB.find(FeatureKey(viewIdB, matchesPerDesc.first, isAB ? match._j : match._i));
+                if (itA != landmarkPerFeatureA.end() && itB != landmarkPerFeatureB.end())
+                    ++nbMatchesPerLink[std::make_pair(itA->second, itB->second)];
+            }
+        }
+    }
+
+    // keep the links with the most matches, one per landmark
+    std::vector<std::pair<std::size_t, std::pair<IndexT, IndexT>>> links;
+    links.reserve(nbMatchesPerLink.size());
+    for (const auto& link : nbMatchesPerLink)
+        links.emplace_back(link.second, link.first);
+    std::stable_sort(links.begin(), links.end(), [](const std::pair<std::size_t, std::pair<IndexT, IndexT>>& a,
+                                                    const std::pair<std::size_t, std::pair<IndexT, IndexT>>& b) {
+        return a.first > b.first;
+    });
+
+    std::set<IndexT> linkedLandmarksA, linkedLandmarksB;
+    out_commonLandmarkIds.clear();
+    for (const auto& link : links)
+    {
+        const std::pair<IndexT, IndexT>& landmarkIds = link.second;
+        if (linkedLandmarksA.count(landmarkIds.first) || linkedLandmarksB.count(landmarkIds.second))
+            continue;
+        linkedLandmarksA.insert(landmarkIds.first);
+        linkedLandmarksB.insert(landmarkIds.second);
+        out_commonLandmarkIds.push_back(landmarkIds);
+    }
+    ALICEVISION_LOG_DEBUG("Found " << out_commonLandmarkIds.size() << " common landmarks from the matches of " << viewIdsA.size() << " + " << viewIdsB.size() << " views.");
+}
+
+bool computeSimilarityFromCommonLandmarks(
+    const sfmData::SfMData& sfmDataA,
+    const sfmData::SfMData& sfmDataB,
+    const std::vector<std::pair<IndexT, IndexT>>& commonLandmarkIds,
+    double* out_S,
+    Mat3* out_R,
+    Vec3* out_t,
+    std::vector<std::size_t>* out_inliers)
+{
+    assert(out_S != nullptr);
+    assert(out_R != nullptr);
+    assert(out_t != nullptr);
+
+    // the similarity is estimated from 3 points
+    if (commonLandmarkIds.size() < 3)
+    {
+        ALICEVISION_LOG_WARNING("Cannot compute similarities with less than 3 common landmarks.");
+        return false;
+    }
+
+    // Move input point in appropriate container
+    Mat xA(3, commonLandmarkIds.size());
+    Mat xB(3, commonLandmarkIds.size());
+    for (std::size_t i = 0; i < commonLandmarkIds.size(); ++i)
+    {
+        xA.col(i) = sfmDataA.getLandmarks().at(commonLandmarkIds[i].first).X;
+        xB.col(i) = sfmDataB.getLandmarks().at(commonLandmarkIds[i].second).X;
+    }
+
+    // Compute rigid transformation p'i = S R pi + t
+    double S;
+    Vec3 t;
+    Mat3 R;
+    std::vector<std::size_t> inliers;
+
+    if (!aliceVision::geometry::ACRansac_FindRTS(xA, xB, S, t, R, inliers, true))
+        return false;
+
+    ALICEVISION_LOG_DEBUG("There are " << commonLandmarkIds.size() << " common landmarks and " << inliers.size() << " were used to compute the similarity transform.");
+
+    *out_S = S;
+    *out_R = R;
+    *out_t = t;
+
+    if (out_inliers != nullptr)
+        out_inliers->swap(inliers);
+
+    return true;
+}
+
 void computeNewCoordinateSystemFromCameras(const sfmData::SfMData& sfmData,
                                            double& out_S,
                                            Mat3& out_R,
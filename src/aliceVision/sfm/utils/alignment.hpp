@@ -9,6 +9,7 @@
 
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/geometry/Pose3.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
 
 namespace aliceVision {
 namespace sfm {
@@ -130,6 +131,45 @@ bool computeSimilarityFromCommonMarkers(
     Mat3* out_R,
     Vec3* out_t);
 
+/**
+ * @brief Link the landmarks of two reconstructions of different views through the feature matches
+ * between their views (cross-scene tracks).
+ *
+ * A match links two landmarks if both of its features are observations of a landmark.
+ * Each landmark is linked to at most one landmark of the other reconstruction: the one with the most matches.
+ *
+ * @param[in] sfmDataA
+ * @param[in] sfmDataB
+ * @param[in] pairwiseMatches the matches between the views of A and the views of B (other pairs are ignored)
+ * @param[out] out_commonLandmarkIds the pairs of linked landmarks (landmark of A, landmark of B)
+ */
+void getCommonLandmarksFromMatches(
+    const sfmData::SfMData& sfmDataA,
+    const sfmData::SfMData& sfmDataB,
+    const matching::PairwiseMatches& pairwiseMatches,
+    std::vector<std::pair<IndexT, IndexT>>& out_commonLandmarkIds);
+
+/**
+ * @brief Compute a 7DOF similarity transform between the two reconstructions based on linked landmarks.
+ *
+ * @param[in] sfmDataA
+ * @param[in] sfmDataB
+ * @param[in] commonLandmarkIds the pairs of linked landmarks (landmark of A, landmark of B)
+ * @param[out] out_S output scale factor
+ * @param[out] out_R output rotation 3x3 matrix
+ * @param[out] out_t output translation vector
+ * @param[out] out_inliers optional indexes of the links consistent with the similarity
+ * @return true if it finds a similarity transformation
+ */
+bool computeSimilarityFromCommonLandmarks(
+    const sfmData::SfMData& sfmDataA,
+    const sfmData::SfMData& sfmDataB,
+    const std::vector<std::pair<IndexT, IndexT>>& commonLandmarkIds,
+    double* out_S,
+    Mat3* out_R,
+    Vec3* out_t,
+    std::vector<std::size_t>* out_inliers = nullptr);
+
 
 /**
  * @brief Apply a transformation the given SfMData
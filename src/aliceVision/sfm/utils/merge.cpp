@@ -0,0 +1,179 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "merge.hpp"
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+/**
+ * @brief Add the entries of a container of sfmDataIn (intrinsics, poses or rigs) used by the new views to sfmDataOut.
+ *
+ * An id already in sfmDataOut is kept if it is used by a view common to both reconstructions
+ * or if both entries are the same, otherwise the entry of sfmDataIn gets a new id.
+ * An id used by the new views without entry in sfmDataIn (e.g. an undefined pose) also gets a new id
+ * if it exists in sfmDataOut.
+ *
+ * @param[in] containerIn the container of sfmDataIn
+ * @param[in] usedIds the ids used by the new views
+ * @param[in] sharedIds the ids used by the views common to both reconstructions
+ * @param[in] isSame return true if two entries with the same id can be shared
+ * @param[in] name the entries name, for the log
+ * @param[in,out] containerOut the container of sfmDataOut
+ * @return the new id of each used id
+ */
+template <class ContainerT, class IsSameT>
+std::map<IndexT, IndexT> mergeEntries(const ContainerT& containerIn,
+                                      const std::set<IndexT>& usedIds,
+                                      const std::set<IndexT>& sharedIds,
+                                      IsSameT isSame,
+                                      const std::string& name,
+                                      ContainerT& containerOut)
+{
+  // new ids are taken after the ids of both reconstructions
+  IndexT nextId = 0;
+  for(const auto& entryPair : containerOut)
+    nextId = std::max(nextId, entryPair.first + 1);
+  for(const auto& entryPair : containerIn)
+    nextId = std::max(nextId, entryPair.first + 1);
+
+  std::map<IndexT, IndexT> newIds;
+  for(const IndexT id : usedIds)
+  {
+    const auto itIn = containerIn.find(id);
+    const auto itOut = containerOut.find(id);
+
+    if(itOut == containerOut.end())
+    {
+      if(itIn != containerIn.end())
+        containerOut.emplace(id, itIn->second);
+      newIds[id] = id;
+    }
+    else if(sharedIds.count(id) || (itIn != containerIn.end() && isSame(itIn->second, itOut->second)))
+    {
+      newIds[id] = id;
+    }
+    else
+    {
+      ALICEVISION_LOG_WARNING("Merge: the " << name << " id " << id << " is already used, the " << name
+                              << " of the merged reconstruction gets the id " << nextId << ".");
+      if(itIn != containerIn.end())
+        containerOut.emplace(nextId, itIn->second);
+      newIds[id] = nextId++;
+    }
+  }
+  return newIds;
+}
+
+} // namespace
+
+std::size_t mergeSfMData(const sfmData::SfMData& sfmDataIn,
+                         const std::vector<std::pair<IndexT, IndexT>>& commonLandmarkIds,
+                         sfmData::SfMData& sfmDataOut)
+{
+  sfmDataOut.addFeaturesFolders(sfmDataIn.getFeaturesFolders());
+  sfmDataOut.addMatchesFolders(sfmDataIn.getMatchesFolders());
+
+  // ids of intrinsics, poses and rigs used by the new views and by the views common to both reconstructions
+  std::set<IndexT> newViewIds;
+  std::set<IndexT> newIntrinsicIds, newPoseIds, newRigIds;
+  std::set<IndexT> sharedIntrinsicIds, sharedPoseIds, sharedRigIds;
+
+  for(const auto& viewPair : sfmDataIn.getViews())
+  {
+    const sfmData::View& view = *viewPair.second;
+    const bool isNew = (sfmDataOut.getViews().count(viewPair.first) == 0);
+
+    if(isNew)
+      newViewIds.insert(viewPair.first);
+
+    if(view.getIntrinsicId() != UndefinedIndexT)
+      (isNew ? newIntrinsicIds : sharedIntrinsicIds).insert(view.getIntrinsicId());
+    if(view.getPoseId() != UndefinedIndexT)
+      (isNew ? newPoseIds : sharedPoseIds).insert(view.getPoseId());
+    if(view.isPartOfRig())
+      (isNew ? newRigIds : sharedRigIds).insert(view.getRigId());
+  }
+
+  // intrinsics, poses and rigs, colliding ids are remapped
+  const std::map<IndexT, IndexT> intrinsicIds = mergeEntries(sfmDataIn.getIntrinsics(), newIntrinsicIds, sharedIntrinsicIds,
+    [](const std::shared_ptr<camera::IntrinsicBase>& a, const std::shared_ptr<camera::IntrinsicBase>& b) { return *a == *b; },
+    "intrinsic", sfmDataOut.getIntrinsics());
+  const std::map<IndexT, IndexT> poseIds = mergeEntries(sfmDataIn.getPoses(), newPoseIds, sharedPoseIds,
+    [](const sfmData::CameraPose&, const sfmData::CameraPose&) { return false; },
+    "pose", sfmDataOut.getPoses());
+  const std::map<IndexT, IndexT> rigIds = mergeEntries(sfmDataIn.getRigs(), newRigIds, sharedRigIds,
+    [](const sfmData::Rig& a, const sfmData::Rig& b) { return a == b; },
+    "rig", sfmDataOut.getRigs());
+
+  // views
+  for(const IndexT viewId : newViewIds)
+  {
+    std::shared_ptr<sfmData::View> view = sfmDataIn.getViews().at(viewId);
+
+    const IndexT intrinsicId = (view->getIntrinsicId() != UndefinedIndexT) ? intrinsicIds.at(view->getIntrinsicId()) : UndefinedIndexT;
+    const IndexT poseId = (view->getPoseId() != UndefinedIndexT) ? poseIds.at(view->getPoseId()) : UndefinedIndexT;
+    const IndexT rigId = view->isPartOfRig() ? rigIds.at(view->getRigId()) : UndefinedIndexT;
+
+    if(intrinsicId != view->getIntrinsicId() || poseId != view->getPoseId() || rigId != view->getRigId())
+    {
+      // the view is shared with sfmDataIn, update a copy
+      view = std::make_shared<sfmData::View>(*view);
+      view->setIntrinsicId(intrinsicId);
+      view->setPoseId(poseId);
+      view->setRigAndSubPoseId(rigId, view->getSubPoseId());
+    }
+    sfmDataOut.getViews().emplace(viewId, view);
+  }
+
+  // structure
+  const std::map<IndexT, IndexT> linkedLandmarks(commonLandmarkIds.begin(), commonLandmarkIds.end());
+
+  IndexT newLandmarkId = 0;
+  for(const auto& landmarkPair : sfmDataOut.getLandmarks())
+    newLandmarkId = std::max(newLandmarkId, landmarkPair.first + 1);
+
+  std::size_t nbFusedLandmarks = 0;
+  for(const auto& landmarkPair : sfmDataIn.getLandmarks())
+  {
+    const sfmData::Landmark& landmarkIn = landmarkPair.second;
+
+    sfmData::Observations observations;
+    for(const auto& observationPair : landmarkIn.observations)
+    {
+      if(newViewIds.count(observationPair.first))
+        observations.insert(observationPair);
+    }
+
+    const auto linkIt = linkedLandmarks.find(landmarkPair.first);
+    if(linkIt != linkedLandmarks.end())
+    {
+      sfmData::Landmark& landmarkOut = sfmDataOut.getLandmarks().at(linkIt->second);
+      landmarkOut.observations.insert(observations.begin(), observations.end());
+      ++nbFusedLandmarks;
+    }
+    else if(observations.size() >= 2)
+    {
+      sfmData::Landmark& landmarkOut = sfmDataOut.getLandmarks()[newLandmarkId++];
+      landmarkOut = sfmData::Landmark(landmarkIn.X, landmarkIn.descType, observations, landmarkIn.rgb);
+    }
+  }
+
+  ALICEVISION_LOG_DEBUG("Merge: " << newViewIds.size() << " new views, " << nbFusedLandmarks << " fused landmarks.");
+  return nbFusedLandmarks;
+}
+
+} // namespace sfm
+} // namespace aliceVision
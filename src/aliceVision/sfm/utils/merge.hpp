@@ -0,0 +1,45 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+
+namespace sfmData {
+class SfMData;
+} // namespace sfmData
+
+namespace sfm {
+
+/**
+ * @brief Merge a reconstruction into another one expressed in the same coordinate system
+ * (see computeSimilarityFromCommonLandmarks and applyTransform).
+ *
+ * The views of sfmDataIn are added to sfmDataOut with their intrinsics, poses and rigs,
+ * the views already in sfmDataOut are kept as they are (with their observations).
+ * An intrinsic, pose or rig id of a new view already used in sfmDataOut (e.g. rig 0 of two rig sessions)
+ * is remapped to a new id, unless it is also used by a view common to both reconstructions
+ * or both entries are the same: the new views are updated accordingly.
+ * The landmarks of sfmDataIn linked to a landmark of sfmDataOut are fused with it:
+ * their observations are added to the landmark of sfmDataOut.
+ * The other landmarks of sfmDataIn are added with new ids.
+ *
+ * @param[in] sfmDataIn the reconstruction to merge
+ * @param[in] commonLandmarkIds the pairs of linked landmarks (landmark of sfmDataIn, landmark of sfmDataOut)
+ * @param[in,out] sfmDataOut the reconstruction receiving the content of sfmDataIn
+ * @return the number of fused landmarks
+ */
+std::size_t mergeSfMData(const sfmData::SfMData& sfmDataIn,
+                         const std::vector<std::pair<IndexT, IndexT>>& commonLandmarkIds,
+                         sfmData::SfMData& sfmDataOut);
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,193 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/utils/merge.hpp>
+#include <aliceVision/sfm/utils/alignment.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+
+#define BOOST_TEST_MODULE sfmMerge
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+#include <aliceVision/unitTest.hpp>
+
+using namespace aliceVision;
+
+/**
+ * @brief Extract the reconstruction of a subset of the views and of the points of a synthetic scene.
+ * @param[in] landmarkIdOffset offset of the landmark ids, to have different ids in each reconstruction
+ */
+sfmData::SfMData getSubScene(const sfmData::SfMData& scene, IndexT viewBegin, IndexT viewEnd,
+                             IndexT pointBegin, IndexT pointEnd, IndexT landmarkIdOffset)
+{
+  sfmData::SfMData sfmData;
+  sfmData.getIntrinsics() = scene.getIntrinsics();
+  for(IndexT viewId = viewBegin; viewId < viewEnd; ++viewId)
+  {
+    sfmData.getViews().emplace(viewId, scene.getViews().at(viewId));
+    sfmData.getPoses().emplace(viewId, scene.getPoses().at(viewId));
+  }
+  for(IndexT pointId = pointBegin; pointId < pointEnd; ++pointId)
+  {
+    const sfmData::Landmark& landmark = scene.getLandmarks().at(pointId);
+    sfmData::Landmark& subLandmark = sfmData.getLandmarks()[pointId + landmarkIdOffset];
+    subLandmark.X = landmark.X;
+    subLandmark.descType = feature::EImageDescriberType::SIFT;
+    for(IndexT viewId = viewBegin; viewId < viewEnd; ++viewId)
+      subLandmark.observations[viewId] = landmark.observations.at(viewId);
+  }
+  return sfmData;
+}
+
+BOOST_AUTO_TEST_CASE(SFM_MergeFromCommonLandmarks)
+{
+  const int nbViews = 8;
+  const int nbPoints = 100;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nbViews, nbPoints, config);
+  const sfmData::SfMData scene = sfm::getInputScene(d, config, camera::PINHOLE_CAMERA);
+
+  // A: views [0, 4) and points [0, 80), B: views [4, 8) and points [20, 100) in another coordinate system
+  sfmData::SfMData sfmDataA = getSubScene(scene, 0, 4, 0, 80, 0);
+  sfmData::SfMData sfmDataB = getSubScene(scene, 4, 8, 20, 100, 1000);
+  {
+    const double S = 0.5;
+    const Mat3 R = RotationAroundX(0.3) * RotationAroundZ(-1.2);
+    const Vec3 t(1.0, -2.0, 3.0);
+    sfm::applyTransform(sfmDataB, S, R, t);
+  }
+
+  // matches of the common points between the views of A and the views of B, with a few wrong ones
+  matching::PairwiseMatches pairwiseMatches;
+  for(IndexT viewA = 0; viewA < 4; ++viewA)
+  {
+    for(IndexT viewB = 4; viewB < 8; ++viewB)
+    {
+      matching::IndMatches& matches = pairwiseMatches[Pair(viewA, viewB)][feature::EImageDescriberType::SIFT];
+      for(IndexT pointId = 20; pointId < 80; ++pointId)
+        matches.emplace_back(pointId, pointId);
+      if(viewA == 0 && viewB == 4)
+        matches.emplace_back(10, 90);
+    }
+  }
+  // matches inside a reconstruction are ignored
+  pairwiseMatches[Pair(0, 1)][feature::EImageDescriberType::SIFT].emplace_back(0, 1);
+
+  std::vector<std::pair<IndexT, IndexT>> commonLandmarkIds;
+  sfm::getCommonLandmarksFromMatches(sfmDataB, sfmDataA, pairwiseMatches, commonLandmarkIds);
+  BOOST_CHECK_EQUAL(commonLandmarkIds.size(), 60 + 1);
+
+  double S;
+  Mat3 R;
+  Vec3 t;
+  std::vector<std::size_t> inliers;
+  BOOST_CHECK(sfm::computeSimilarityFromCommonLandmarks(sfmDataB, sfmDataA, commonLandmarkIds, &S, &R, &t, &inliers));
+  BOOST_CHECK_EQUAL(inliers.size(), 60);
+
+  std::vector<std::pair<IndexT, IndexT>> inlierLandmarkIds;
+  for(std::size_t i : inliers)
+  {
+    BOOST_CHECK_EQUAL(commonLandmarkIds[i].first, commonLandmarkIds[i].second + 1000);
+    inlierLandmarkIds.push_back(commonLandmarkIds[i]);
+  }
+
+  sfm::applyTransform(sfmDataB, S, R, t);
+  for(const auto& landmarkPair : sfmDataB.getLandmarks())
+    EXPECT_MATRIX_NEAR(landmarkPair.second.X, d._X.col(landmarkPair.first - 1000), 1e-6);
+
+  BOOST_CHECK_EQUAL(sfm::mergeSfMData(sfmDataB, inlierLandmarkIds, sfmDataA), 60);
+  BOOST_CHECK_EQUAL(sfmDataA.getViews().size(), nbViews);
+  BOOST_CHECK_EQUAL(sfmDataA.getPoses().size(), nbViews);
+  BOOST_CHECK_EQUAL(sfmDataA.getLandmarks().size(), nbPoints);
+  // same intrinsic in both reconstructions
+  BOOST_CHECK_EQUAL(sfmDataA.getIntrinsics().size(), 1);
+
+  for(const auto& landmarkPair : sfmDataA.getLandmarks())
+  {
+    const sfmData::Landmark& landmark = landmarkPair.second;
+    const IndexT pointId = landmark.observations.begin()->second.id_feat;
+    const std::size_t nbObservations = (pointId >= 20 && pointId < 80) ? 8 : 4;
+    BOOST_CHECK_EQUAL(landmark.observations.size(), nbObservations);
+    for(const auto& observationPair : landmark.observations)
+      BOOST_CHECK_EQUAL(observationPair.second.id_feat, pointId);
+    EXPECT_MATRIX_NEAR(landmark.X, d._X.col(pointId), 1e-6);
+  }
+}
+
+/**
+ * @brief Offset the view ids of a scene, to simulate views of another session
+ */
+void offsetViewIds(sfmData::SfMData& sfmData, IndexT offset)
+{
+  sfmData::Views views;
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    std::shared_ptr<sfmData::View> view = std::make_shared<sfmData::View>(*viewPair.second);
+    view->setViewId(viewPair.first + offset);
+    views.emplace(viewPair.first + offset, view);
+  }
+  sfmData.getViews() = views;
+
+  for(auto& landmarkPair : sfmData.getLandmarks())
+  {
+    sfmData::Observations observations;
+    for(const auto& observationPair : landmarkPair.second.observations)
+      observations.emplace(observationPair.first + offset, observationPair.second);
+    landmarkPair.second.observations = observations;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SFM_MergeCollidingIds)
+{
+  // two rig sessions: same rig, pose and intrinsic ids, different rigs, poses and intrinsics
+  const NViewDatasetConfigurator configA;
+  const NViewDatasetConfigurator configB(1200, 1200, 1000, 1000, 5, 0);
+  const NViewDataSet dA = NRealisticCamerasRing(3, 10, configA);
+  const NViewDataSet dB = NRealisticCamerasRing(3, 10, configB);
+
+  sfmData::SfMData sfmDataA = sfm::getInputRigScene(dA, configA, camera::PINHOLE_CAMERA);
+  sfmData::SfMData sfmDataB = sfm::getInputRigScene(dB, configB, camera::PINHOLE_CAMERA);
+  sfmDataB.getRigs().at(0).getSubPose(1).pose = geometry::Pose3(Mat3::Identity(), Vec3(0.05, 0, 0));
+  offsetViewIds(sfmDataB, 100);
+
+  const sfmData::SfMData sfmDataARef = sfmDataA;
+
+  BOOST_CHECK_EQUAL(sfm::mergeSfMData(sfmDataB, {}, sfmDataA), 0);
+
+  BOOST_CHECK_EQUAL(sfmDataA.getViews().size(), 12);
+  BOOST_CHECK_EQUAL(sfmDataA.getPoses().size(), 6);
+  BOOST_CHECK_EQUAL(sfmDataA.getRigs().size(), 2);
+  BOOST_CHECK_EQUAL(sfmDataA.getIntrinsics().size(), 2);
+  BOOST_CHECK_EQUAL(sfmDataA.getLandmarks().size(), 20);
+
+  // the views of A are unchanged
+  for(const auto& viewPair : sfmDataARef.getViews())
+  {
+    const sfmData::View& view = sfmDataA.getView(viewPair.first);
+    BOOST_CHECK_EQUAL(view.getRigId(), 0);
+    BOOST_CHECK_EQUAL(view.getIntrinsicId(), 0);
+    EXPECT_MATRIX_NEAR(sfmDataA.getPose(view).getTransform().center(), sfmDataARef.getPose(*viewPair.second).getTransform().center(), 1e-12);
+  }
+
+  // the views of B use their own rig, poses and intrinsic
+  for(const auto& viewPair : sfmDataB.getViews())
+  {
+    const sfmData::View& viewIn = *viewPair.second;
+    const sfmData::View& view = sfmDataA.getView(viewPair.first);
+
+    BOOST_CHECK_NE(view.getRigId(), 0);
+    BOOST_CHECK_NE(view.getIntrinsicId(), 0);
+    BOOST_CHECK_GE(view.getPoseId(), 3);
+    BOOST_CHECK_EQUAL(view.getSubPoseId(), viewIn.getSubPoseId());
+    BOOST_CHECK(*sfmDataA.getIntrinsics().at(view.getIntrinsicId()) == *sfmDataB.getIntrinsics().at(viewIn.getIntrinsicId()));
+    EXPECT_MATRIX_NEAR(sfmDataA.getPose(view).getTransform().center(), sfmDataB.getPose(viewIn).getTransform().center(), 1e-12);
+
+    // the input views are not modified
+    BOOST_CHECK_EQUAL(viewIn.getRigId(), 0);
+    BOOST_CHECK_EQUAL(viewIn.getIntrinsicId(), 0);
+  }
+}
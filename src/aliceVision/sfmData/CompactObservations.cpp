@@ -0,0 +1,108 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CompactObservations.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+namespace aliceVision {
+namespace sfmData {
+
+void CompactObservations::build(const Landmarks& landmarks)
+{
+  clear();
+
+  const int nbLandmarks = static_cast<int>(landmarks.size());
+
+  // landmark ids and number of observations per landmark
+  _landmarkIds.resize(nbLandmarks);
+  _landmarkOffsets.assign(nbLandmarks + 1, 0);
+
+  #pragma omp parallel for
+  for(int l = 0; l < nbLandmarks; ++l)
+  {
+    const auto landmarkIt = std::next(landmarks.begin(), l);
+    _landmarkIds[l] = landmarkIt->first;
+    _landmarkOffsets[l + 1] = landmarkIt->second.observations.size();
+  }
+
+  for(int l = 0; l < nbLandmarks; ++l)
+    _landmarkOffsets[l + 1] += _landmarkOffsets[l];
+
+  // observations grouped by landmark
+  const std::size_t nbObservations = _landmarkOffsets.back();
+
+  _viewIds.resize(nbObservations);
+  _x.resize(nbObservations);
+  _featureIds.resize(nbObservations);
+  _scales.resize(nbObservations);
+  _landmarkIndexes.resize(nbObservations);
+
+  #pragma omp parallel for
+  for(int l = 0; l < nbLandmarks; ++l)
+  {
+    std::size_t o = _landmarkOffsets[l];
+    for(const auto& observationPair : std::next(landmarks.begin(), l)->second.observations)
+    {
+      _viewIds[o] = observationPair.first;
+      _x[o] = observationPair.second.x;
+      _featureIds[o] = observationPair.second.id_feat;
+      _scales[o] = observationPair.second.scale;
+      _landmarkIndexes[o] = static_cast<IndexT>(l);
+      ++o;
+    }
+  }
+
+  // view indexes, sorted by view id
+  for(const IndexT viewId : _viewIds)
+    _viewIndexes.emplace(viewId, 0);
+
+  _observedViewIds.reserve(_viewIndexes.size());
+  for(const auto& viewIndexPair : _viewIndexes)
+    _observedViewIds.push_back(viewIndexPair.first);
+  std::sort(_observedViewIds.begin(), _observedViewIds.end());
+
+  for(std::size_t v = 0; v < _observedViewIds.size(); ++v)
+    _viewIndexes.at(_observedViewIds[v]) = static_cast<IndexT>(v);
+
+  // observations grouped by view, in landmark order
+  std::vector<IndexT> observationViewIndexes(nbObservations);
+
+  #pragma omp parallel for
+  for(int o = 0; o < static_cast<int>(nbObservations); ++o)
+    observationViewIndexes[o] = _viewIndexes.at(_viewIds[o]);
+
+  _viewOffsets.assign(_observedViewIds.size() + 1, 0);
+  for(const IndexT v : observationViewIndexes)
+    ++_viewOffsets[v + 1];
+  for(std::size_t v = 0; v < _observedViewIds.size(); ++v)
+    _viewOffsets[v + 1] += _viewOffsets[v];
+
+  std::vector<std::size_t> cursors(_viewOffsets.begin(), _viewOffsets.end() - 1);
+  _viewObservations.resize(nbObservations);
+  for(std::size_t o = 0; o < nbObservations; ++o)
+    _viewObservations[cursors[observationViewIndexes[o]]++] = static_cast<IndexT>(o);
+}
+
+void CompactObservations::clear()
+{
+  _landmarkIds.clear();
+  _landmarkOffsets.assign(1, 0);
+  _viewIds.clear();
+  _x.clear();
+  _featureIds.clear();
+  _scales.clear();
+  _landmarkIndexes.clear();
+  _observedViewIds.clear();
+  _viewIndexes.clear();
+  _viewOffsets.assign(1, 0);
+  _viewObservations.clear();
+}
+
+} // namespace sfmData
+} // namespace aliceVision
@@ -0,0 +1,130 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/types.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace sfmData {
+
+/**
+ * @brief Read-only structure-of-arrays copy of all the landmarks observations of a scene.
+ *
+ * Observations are grouped by landmark (CSR layout), landmarks are indexed in the Landmarks container order.
+ * A reverse index gives the observations of each view, sorted by landmark index.
+ * It allows to iterate linearly over millions of observations instead of visiting one flat_map per landmark.
+ * The store is a snapshot: it has to be rebuilt if the landmarks are modified.
+ * Building it copies all the observations, the Landmark observations remain the owned storage:
+ * only use it where the copy is amortized over many queries (e.g. the observations per view).
+ */
+class CompactObservations
+{
+public:
+  CompactObservations() = default;
+
+  explicit CompactObservations(const Landmarks& landmarks)
+  {
+    build(landmarks);
+  }
+
+  explicit CompactObservations(const SfMData& sfmData)
+  {
+    build(sfmData.getLandmarks());
+  }
+
+  /**
+   * @brief Build the observation arrays from the given landmarks
+   * @param[in] landmarks the landmarks, in the container iteration order
+   */
+  void build(const Landmarks& landmarks);
+
+  void clear();
+
+  std::size_t getNbLandmarks() const { return _landmarkIds.size(); }
+  std::size_t getNbObservations() const { return _viewIds.size(); }
+  std::size_t getNbViews() const { return _observedViewIds.size(); }
+
+  // landmarks
+
+  IndexT getLandmarkId(std::size_t landmarkIndex) const { return _landmarkIds[landmarkIndex]; }
+
+  /// first observation index of a landmark
+  std::size_t getLandmarkObservationsBegin(std::size_t landmarkIndex) const { return _landmarkOffsets[landmarkIndex]; }
+
+  /// past-the-end observation index of a landmark
+  std::size_t getLandmarkObservationsEnd(std::size_t landmarkIndex) const { return _landmarkOffsets[landmarkIndex + 1]; }
+
+  // observations
+
+  IndexT getViewId(std::size_t observationIndex) const { return _viewIds[observationIndex]; }
+  const Vec2& getX(std::size_t observationIndex) const { return _x[observationIndex]; }
+  IndexT getFeatureId(std::size_t observationIndex) const { return _featureIds[observationIndex]; }
+  double getScale(std::size_t observationIndex) const { return _scales[observationIndex]; }
+  std::size_t getLandmarkIndex(std::size_t observationIndex) const { return _landmarkIndexes[observationIndex]; }
+
+  Observation getObservation(std::size_t observationIndex) const
+  {
+    return Observation(_x[observationIndex], _featureIds[observationIndex], _scales[observationIndex]);
+  }
+
+  // views (reverse index)
+
+  /**
+   * @brief Get the index of a view in the reverse index
+   * @param[in] viewId the view id
+   * @return the view index, -1 if the view has no observation
+   */
+  int getViewIndex(IndexT viewId) const
+  {
+    const auto it = _viewIndexes.find(viewId);
+    return (it == _viewIndexes.end()) ? -1 : static_cast<int>(it->second);
+  }
+
+  /// view id of a view index, view indexes are sorted by view id
+  IndexT getObservedViewId(std::size_t viewIndex) const { return _observedViewIds[viewIndex]; }
+
+  std::size_t getNbViewObservations(std::size_t viewIndex) const
+  {
+    return _viewOffsets[viewIndex + 1] - _viewOffsets[viewIndex];
+  }
+
+  /**
+   * @brief Get an observation of a view
+   * @param[in] viewIndex the view index
+   * @param[in] i the local observation index in [0, getNbViewObservations(viewIndex)[
+   * @return the observation index, observations of a view are sorted by landmark index
+   */
+  std::size_t getViewObservation(std::size_t viewIndex, std::size_t i) const
+  {
+    return _viewObservations[_viewOffsets[viewIndex] + i];
+  }
+
+private:
+  // per landmark
+  std::vector<IndexT> _landmarkIds;
+  std::vector<std::size_t> _landmarkOffsets;
+
+  // per observation
+  std::vector<IndexT> _viewIds;
+  std::vector<Vec2, Eigen::aligned_allocator<Vec2> > _x;
+  std::vector<IndexT> _featureIds;
+  std::vector<double> _scales;
+  std::vector<IndexT> _landmarkIndexes;
+
+  // per view
+  std::vector<IndexT> _observedViewIds;
+  IndexedMap<IndexT, IndexT> _viewIndexes;
+  std::vector<std::size_t> _viewOffsets;
+  std::vector<IndexT> _viewObservations;
+};
+
+} // namespace sfmData
+} // namespace aliceVision
@@ -23,25 +23,25 @@ namespace aliceVision {
 namespace sfmData {
 
 /// Define a collection of View
-using Views = HashMap<IndexT, std::shared_ptr<View> >;
+using Views = IndexedMap<IndexT, std::shared_ptr<View> >;
 
 /// Define a collection of Pose (indexed by view.getPoseId())
-using Poses = HashMap<IndexT, CameraPose>;
+using Poses = IndexedMap<IndexT, CameraPose>;
 
 /// Define a collection of IntrinsicParameter (indexed by view.getIntrinsicId())
 using Intrinsics = HashMap<IndexT, std::shared_ptr<camera::IntrinsicBase> >;
 
 /// Define a collection of landmarks are indexed by their TrackId
-using Landmarks = HashMap<IndexT, Landmark>;
+using Landmarks = IndexedMap<IndexT, Landmark>;
 
 /// Define a collection of Rig
 using Rigs = std::map<IndexT, Rig>;
 
 /// Define uncertainty per pose
-using PosesUncertainty = HashMap<IndexT, Vec6>;
+using PosesUncertainty = IndexedMap<IndexT, Vec6>;
 
 /// Define uncertainty per landmark
-using LandmarksUncertainty = HashMap<IndexT, Vec3>;
+using LandmarksUncertainty = IndexedMap<IndexT, Vec3>;
 
 ///Define a collection of constraints
 using Constraints2D = std::vector<Constraint2D>;
@@ -8,6 +8,7 @@
 #include "colorize.hpp"
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/CompactObservations.hpp>
 #include <aliceVision/stl/indexedSort.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
 #include <aliceVision/image/io.hpp>
@@ -24,39 +25,32 @@ void colorizeTracks(SfMData& sfmData)
 {
   boost::progress_display progressBar(sfmData.getLandmarks().size(), std::cout, "\nCompute scene structure color\n");
 
-  std::vector<std::reference_wrapper<Landmark>> remainingLandmarksToColor;
-  remainingLandmarksToColor.reserve(sfmData.getLandmarks().size());
+  // landmarks observations, in the landmarks container order
+  const CompactObservations observations(sfmData);
 
+  std::vector<Landmark*> landmarks;
+  landmarks.reserve(sfmData.getLandmarks().size());
   for(auto& landmarkPair : sfmData.getLandmarks())
-    remainingLandmarksToColor.push_back(landmarkPair.second);
+    landmarks.push_back(&landmarkPair.second);
 
   struct ViewInfo
   {
-    ViewInfo(IndexT viewId, std::size_t cardinal)
-      : viewId(viewId)
+    ViewInfo(std::size_t viewIndex, std::size_t cardinal)
+      : viewIndex(viewIndex)
       , cardinal(cardinal)
     {}
 
-    IndexT viewId;
+    std::size_t viewIndex;
     std::size_t cardinal;
-    std::vector<std::reference_wrapper<Landmark>> landmarks;
+    /// observation indexes of the landmarks to color with this view
+    std::vector<std::size_t> observations;
   };
 
   std::vector<ViewInfo> sortedViewsCardinal;
-  sortedViewsCardinal.reserve(sfmData.getViews().size());
+  sortedViewsCardinal.reserve(observations.getNbViews());
   {
-    // create cardinal per viewId map
-    std::map<IndexT, std::size_t> viewsCardinalMap; // <ViewId, Cardinal>
-    for(const auto& landmarkPair : sfmData.getLandmarks())
-    {
-      const Observations& observations = landmarkPair.second.observations;
-      for(const auto& observationPair : observations)
-        ++viewsCardinalMap[observationPair.first]; // TODO: 0
-    }
-
-    // copy key-value pairs from the map to the vector
-    for(const auto& cardinalPair : viewsCardinalMap)
-      sortedViewsCardinal.push_back(ViewInfo(cardinalPair.first, cardinalPair.second));
+    for(std::size_t v = 0; v < observations.getNbViews(); ++v)
+      sortedViewsCardinal.push_back(ViewInfo(v, observations.getNbViewObservations(v)));
 
     // sort the vector, biggest cardinality first
     std::sort(sortedViewsCardinal.begin(),
@@ -64,29 +58,24 @@ void colorizeTracks(SfMData& sfmData)
               [] (const ViewInfo& l, const ViewInfo& r) { return l.cardinal > r.cardinal; });
   }
 
-  // assign each landmark to a view
-  for(ViewInfo& viewCardinal : sortedViewsCardinal)
+  // assign each landmark to the first view observing it
   {
-    std::vector<std::reference_wrapper<Landmark>> toKeep;
-    const IndexT viewId = viewCardinal.viewId;
+    std::vector<char> assigned(observations.getNbLandmarks(), 0);
 
-    for(int i = 0; i < remainingLandmarksToColor.size(); ++i)
+    for(ViewInfo& viewCardinal : sortedViewsCardinal)
     {
-      Landmark& landmark = remainingLandmarksToColor.at(i);
-      auto it = landmark.observations.find(viewId);
-      if(it != landmark.observations.end())
+      for(std::size_t i = 0; i < viewCardinal.cardinal; ++i)
       {
-        viewCardinal.landmarks.push_back(landmark);
-      }
-      else
-      {
-        toKeep.push_back(landmark);
+        const std::size_t o = observations.getViewObservation(viewCardinal.viewIndex, i);
+        const std::size_t l = observations.getLandmarkIndex(o);
+
+        if(!assigned[l])
+        {
+          assigned[l] = 1;
+          viewCardinal.observations.push_back(o);
+        }
       }
     }
-    std::swap(toKeep, remainingLandmarksToColor);
-
-    if(remainingLandmarksToColor.empty())
-      break;
   }
 
   // create an unsorted index container
@@ -99,25 +88,25 @@ void colorizeTracks(SfMData& sfmData)
   for(int i = 0; i < unsortedIndexes.size(); ++i)
   {
     const ViewInfo& viewCardinal = sortedViewsCardinal.at(unsortedIndexes.at(i));
-    if(!viewCardinal.landmarks.empty())
+    if(!viewCardinal.observations.empty())
     {
-      const View& view = sfmData.getView(viewCardinal.viewId);
+      const View& view = sfmData.getView(observations.getObservedViewId(viewCardinal.viewIndex));
       image::Image<image::RGBColor> image;
       image::readImage(view.getImagePath(), image, image::EImageColorSpace::SRGB);
 
-      for(Landmark& landmark : viewCardinal.landmarks)
+      for(const std::size_t o : viewCardinal.observations)
       {
         // color the point
-        Vec2 pt = landmark.observations.at(view.getViewId()).x;
+        Vec2 pt = observations.getX(o);
         // clamp the pixel position if the feature/marker center is outside the image.
         pt.x() = clamp(pt.x(), 0.0, static_cast<double>(image.Width() - 1));
         pt.y() = clamp(pt.y(), 0.0, static_cast<double>(image.Height() - 1));
-        landmark.rgb = image(pt.y(), pt.x());
+        landmarks.at(observations.getLandmarkIndex(o))->rgb = image(pt.y(), pt.x());
       }
 
 #pragma omp critical
       {
-        progressBar += viewCardinal.landmarks.size();
+        progressBar += viewCardinal.observations.size();
       }
     }
   }
@@ -1,6 +1,7 @@
 
 #include <boost/filesystem.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/CompactObservations.hpp>
 
 #define BOOST_TEST_MODULE sfmData
 
@@ -51,3 +52,49 @@ BOOST_AUTO_TEST_CASE(SfMData_InternalFolders)
   BOOST_CHECK_EQUAL(sfmData.getRelativeMatchesFolders()[0], fs::relative(refFolder, otherFolder));
 }
 
+BOOST_AUTO_TEST_CASE(SfMData_CompactObservations)
+{
+  sfmData::Landmarks landmarks;
+
+  // landmark 10 seen by views 1 and 2, landmark 20 seen by views 2 and 3, landmark 30 seen by view 2
+  landmarks[10].observations[1] = sfmData::Observation(Vec2(1.0, 1.0), 100, 1.0);
+  landmarks[10].observations[2] = sfmData::Observation(Vec2(2.0, 1.0), 200, 2.0);
+  landmarks[20].observations[3] = sfmData::Observation(Vec2(3.0, 2.0), 300, 3.0);
+  landmarks[20].observations[2] = sfmData::Observation(Vec2(2.0, 2.0), 201, 2.0);
+  landmarks[30].observations[2] = sfmData::Observation(Vec2(2.0, 3.0), 202, 2.0);
+
+  const sfmData::CompactObservations observations(landmarks);
+
+  BOOST_CHECK_EQUAL(observations.getNbLandmarks(), 3);
+  BOOST_CHECK_EQUAL(observations.getNbObservations(), 5);
+  BOOST_CHECK_EQUAL(observations.getNbViews(), 3);
+
+  // observations grouped by landmark, in the container order
+  auto landmarkIt = landmarks.begin();
+  for(std::size_t l = 0; l < observations.getNbLandmarks(); ++l, ++landmarkIt)
+  {
+    BOOST_CHECK_EQUAL(observations.getLandmarkId(l), landmarkIt->first);
+    BOOST_CHECK_EQUAL(observations.getLandmarkObservationsEnd(l) - observations.getLandmarkObservationsBegin(l), landmarkIt->second.observations.size());
+
+    for(std::size_t o = observations.getLandmarkObservationsBegin(l); o < observations.getLandmarkObservationsEnd(l); ++o)
+    {
+      BOOST_CHECK_EQUAL(observations.getLandmarkIndex(o), l);
+      BOOST_CHECK(observations.getObservation(o) == landmarkIt->second.observations.at(observations.getViewId(o)));
+    }
+  }
+
+  // reverse index sorted by view id, observations of a view sorted by landmark index
+  BOOST_CHECK_EQUAL(observations.getViewIndex(4), -1);
+  BOOST_CHECK_EQUAL(observations.getObservedViewId(0), 1);
+  BOOST_CHECK_EQUAL(observations.getObservedViewId(2), 3);
+
+  const int viewIndex = observations.getViewIndex(2);
+  BOOST_REQUIRE_EQUAL(viewIndex, 1);
+  BOOST_REQUIRE_EQUAL(observations.getNbViewObservations(viewIndex), 3);
+  for(std::size_t i = 0; i < 3; ++i)
+  {
+    const std::size_t o = observations.getViewObservation(viewIndex, i);
+    BOOST_CHECK_EQUAL(observations.getViewId(o), 2);
+    BOOST_CHECK_EQUAL(observations.getLandmarkIndex(o), i);
+  }
+}
@@ -14,6 +14,7 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <numeric>
 
 namespace fs = boost::filesystem;
@@ -387,37 +388,78 @@ void AlembicExporter::addSfMCameraRig(const sfmData::SfMData& sfmData, IndexT ri
   }
 }
 
-void AlembicExporter::addLandmarks(const sfmData::Landmarks& landmarks, const sfmData::LandmarksUncertainty& landmarksUncertainty, bool withVisibility, bool withFeatures)
+void AlembicExporter::addLandmarks(const sfmData::Landmarks& landmarks, const sfmData::LandmarksUncertainty& landmarksUncertainty, bool withVisibility, bool withFeatures, std::size_t blockSize)
 {
   if(landmarks.empty())
     return;
 
+  blockSize = std::max(std::size_t(1), blockSize);
+
+  // write landmarks in blocks of at most blockSize points,
+  // so the temporary Alembic arrays do not grow with the scene size
+  sfmData::Landmarks::const_iterator blockBegin = landmarks.begin();
+  std::size_t firstIndex = 0;
+  std::size_t blockIndex = 1;
+
+  while(blockBegin != landmarks.end())
+  {
+    sfmData::Landmarks::const_iterator blockEnd = blockBegin;
+    std::size_t nbLandmarks = 0;
+    while(blockEnd != landmarks.end() && nbLandmarks < blockSize)
+    {
+      ++blockEnd;
+      ++nbLandmarks;
+    }
+
+    addLandmarksBlock(blockBegin, blockEnd, nbLandmarks, firstIndex, "particleShape" + std::to_string(blockIndex),
+                      landmarksUncertainty, withVisibility, withFeatures);
+
+    blockBegin = blockEnd;
+    firstIndex += nbLandmarks;
+    ++blockIndex;
+  }
+}
+
+void AlembicExporter::addLandmarksBlock(sfmData::Landmarks::const_iterator begin,
+                                        sfmData::Landmarks::const_iterator end,
+                                        std::size_t nbLandmarks,
+                                        std::size_t firstIndex,
+                                        const std::string& name,
+                                        const sfmData::LandmarksUncertainty& landmarksUncertainty,
+                                        bool withVisibility,
+                                        bool withFeatures)
+{
   // Fill vector with the values taken from AliceVision
   std::vector<V3f> positions;
   std::vector<Imath::C3f> colors;
   std::vector<Alembic::Util::uint32_t> descTypes;
-  positions.reserve(landmarks.size());
-  descTypes.reserve(landmarks.size());
+  positions.reserve(nbLandmarks);
+  colors.reserve(nbLandmarks);
+  descTypes.reserve(nbLandmarks);
 
-  // For all the 3d points in the hash_map
-  for(const auto& landmark : landmarks)
+  // For all the 3d points of the block
+  for(auto it = begin; it != end; ++it)
   {
-    const Vec3& pt = landmark.second.X;
-    const image::RGBColor& color = landmark.second.rgb;
+    const Vec3& pt = it->second.X;
+    const image::RGBColor& color = it->second.rgb;
     positions.emplace_back(pt[0], pt[1], pt[2]);
     colors.emplace_back(color.r()/255.f, color.g()/255.f, color.b()/255.f);
-    descTypes.emplace_back(static_cast<Alembic::Util::uint8_t>(landmark.second.descType));
+    descTypes.emplace_back(static_cast<Alembic::Util::uint8_t>(it->second.descType));
   }
 
   std::vector<Alembic::Util::uint64_t> ids(positions.size());
-  std::iota(begin(ids), end(ids), 0);
+  std::iota(ids.begin(), ids.end(), firstIndex);
 
-  OPoints partsOut(_dataImpl->_mvgPointCloud, "particleShape1");
+  OPoints partsOut(_dataImpl->_mvgPointCloud, name);
   OPointsSchema& pSchema = partsOut.getSchema();
 
   OPointsSchema::Sample psamp(std::move(V3fArraySample(positions)), std::move(UInt64ArraySample(ids)));
   pSchema.set(psamp);
 
+  // release the positions and ids before building the next arrays
+  std::vector<V3f>().swap(positions);
+  std::vector<Alembic::Util::uint64_t>().swap(ids);
+
   OCompoundProperty arbGeom = pSchema.getArbGeomParams();
 
   C3fArraySample cval_samp(&colors[0], colors.size());
@@ -425,79 +467,84 @@ void AlembicExporter::addLandmarks(const sfmData::Landmarks& landmarks, const sf
 
   OC3fGeomParam rgbOut(arbGeom, "color", false, kVertexScope, 1);
   rgbOut.set(color_samp);
+  std::vector<Imath::C3f>().swap(colors);
 
   OCompoundProperty userProps = pSchema.getUserProperties();
 
   OUInt32ArrayProperty(userProps, "mvg_describerType").set(descTypes);
+  std::vector<Alembic::Util::uint32_t>().swap(descTypes);
 
   if(withVisibility)
   {
     std::vector<::uint32_t> visibilitySize;
-    visibilitySize.reserve(positions.size());
-    for(const auto& landmark : landmarks)
+    visibilitySize.reserve(nbLandmarks);
+    std::size_t nbObservations = 0;
+    for(auto it = begin; it != end; ++it)
     {
-      visibilitySize.emplace_back(landmark.second.observations.size());
+      visibilitySize.emplace_back(it->second.observations.size());
+      nbObservations += it->second.observations.size();
     }
-    std::size_t nbObservations = std::accumulate(visibilitySize.begin(), visibilitySize.end(), 0);
+
+    OUInt32ArrayProperty(userProps, "mvg_visibilitySize" ).set(visibilitySize);
+    std::vector<::uint32_t>().swap(visibilitySize);
 
     // Use std::vector<::uint32_t> and std::vector<float> instead of std::vector<V2i> and std::vector<V2f>
     // Because Maya don't import them correctly
-    std::vector<::uint32_t> visibilityViewId;
-    std::vector<::uint32_t> visibilityFeatId;
-    visibilityViewId.reserve(nbObservations);
-
-    std::vector<float> featPos2d;
-    std::vector<float> featScale;
-    if(withFeatures)
     {
-      featPos2d.reserve(nbObservations*2);
-      visibilityFeatId.reserve(nbObservations);
-      featScale.reserve(nbObservations);
+      std::vector<::uint32_t> visibilityViewId;
+      visibilityViewId.reserve(nbObservations);
+      for(auto it = begin; it != end; ++it)
+        for(const auto& vObs : it->second.observations)
+          visibilityViewId.emplace_back(vObs.first); // viewId
+
+      OUInt32ArrayProperty(userProps, "mvg_visibilityViewId" ).set(visibilityViewId);
     }
 
-    for (const auto& landmark : landmarks)
+    if(withFeatures)
     {
-      const sfmData::Observations& observations = landmark.second.observations;
-      for(const auto& vObs: observations )
+      // one observation property at a time, to limit the temporary memory
       {
-        const sfmData::Observation& obs = vObs.second;
-
-        // viewId
-        visibilityViewId.emplace_back(vObs.first);
+        std::vector<::uint32_t> visibilityFeatId;
+        visibilityFeatId.reserve(nbObservations);
+        for(auto it = begin; it != end; ++it)
+          for(const auto& vObs : it->second.observations)
+            visibilityFeatId.emplace_back(vObs.second.id_feat); // featureId
 
-        if(withFeatures)
+        OUInt32ArrayProperty(userProps, "mvg_visibilityFeatId" ).set(visibilityFeatId);
+      }
+      {
+        std::vector<float> featPos2d;
+        featPos2d.reserve(nbObservations * 2);
+        for(auto it = begin; it != end; ++it)
         {
-          // featureId
-          visibilityFeatId.emplace_back(obs.id_feat);
-
-          // feature 2D position (x, y))
-          featPos2d.emplace_back(obs.x[0]);
-          featPos2d.emplace_back(obs.x[1]);
-
-          featScale.emplace_back(obs.scale);
+          for(const auto& vObs : it->second.observations)
+          {
+            // feature 2D position (x, y))
+            featPos2d.emplace_back(vObs.second.x[0]);
+            featPos2d.emplace_back(vObs.second.x[1]);
+          }
         }
+        OFloatArrayProperty(userProps, "mvg_visibilityFeatPos" ).set(featPos2d); // feature position (x,y)
       }
-    }
-
-    OUInt32ArrayProperty(userProps, "mvg_visibilitySize" ).set(visibilitySize);
-    OUInt32ArrayProperty(userProps, "mvg_visibilityViewId" ).set(visibilityViewId);
+      {
+        std::vector<float> featScale;
+        featScale.reserve(nbObservations);
+        for(auto it = begin; it != end; ++it)
+          for(const auto& vObs : it->second.observations)
+            featScale.emplace_back(vObs.second.scale);
 
-    if(withFeatures)
-    {
-      OUInt32ArrayProperty(userProps, "mvg_visibilityFeatId" ).set(visibilityFeatId);
-      OFloatArrayProperty(userProps, "mvg_visibilityFeatPos" ).set(featPos2d); // feature position (x,y)
-      OFloatArrayProperty(userProps, "mvg_visibilityFeatScale" ).set(featScale);
+        OFloatArrayProperty(userProps, "mvg_visibilityFeatScale" ).set(featScale);
+      }
     }
   }
   if(!landmarksUncertainty.empty())
   {
     std::vector<V3d> uncertainties;
+    uncertainties.reserve(nbLandmarks);
 
-    std::size_t indexLandmark = 0;
-    for(sfmData::Landmarks::const_iterator itLandmark = landmarks.begin(); itLandmark != landmarks.end(); ++itLandmark, ++indexLandmark)
+    for(auto it = begin; it != end; ++it)
     {
-      const IndexT idLandmark = itLandmark->first;
-      const Vec3& u = landmarksUncertainty.at(idLandmark);
+      const Vec3& u = landmarksUncertainty.at(it->first);
       uncertainties.emplace_back(u[0], u[1], u[2]);
     }
     // Uncertainty eigen values (x,y,z)
@@ -60,11 +60,19 @@ public:
   /**
    * @brief Add a set of 3d points
    * @param[in] points The 3D points to add
+   * @param[in] landmarksUncertainty The 3D points uncertainty (empty if undefined)
+   * @param[in] withVisibility Export the observations view ids
+   * @param[in] withFeatures Export the observations features (id, position, scale)
+   * @param[in] blockSize The maximum number of 3D points per Alembic points object,
+   *            bounds the temporary memory used by the export
+   * @note Landmarks that fit in one block are written in a single "particleShape1" points object,
+   *       as before. Larger sets are split in "particleShape1" to "particleShapeN".
    */
   void addLandmarks(const sfmData::Landmarks& points,
                     const sfmData::LandmarksUncertainty& landmarksUncertainty = sfmData::LandmarksUncertainty(),
                     bool withVisibility = true,
-                    bool withFeatures = true);
+                    bool withFeatures = true,
+                    std::size_t blockSize = 1000000);
 
   /**
    * @brief Add a camera
@@ -112,6 +120,23 @@ public:
   void jumpKeyframe(const std::string& imagePath = std::string());
 
 private:
+  /**
+   * @brief Add a block of 3d points as one Alembic points object
+   * @param[in] begin The first 3D point of the block
+   * @param[in] end The end of the block
+   * @param[in] nbLandmarks The number of 3D points in the block
+   * @param[in] firstIndex The index of the first 3D point in the whole export
+   * @param[in] name The Alembic points object name
+   */
+  void addLandmarksBlock(sfmData::Landmarks::const_iterator begin,
+                         sfmData::Landmarks::const_iterator end,
+                         std::size_t nbLandmarks,
+                         std::size_t firstIndex,
+                         const std::string& name,
+                         const sfmData::LandmarksUncertainty& landmarksUncertainty,
+                         bool withVisibility,
+                         bool withFeatures);
+
   struct DataImpl;
   std::unique_ptr<DataImpl> _dataImpl;
 };
@@ -113,8 +113,9 @@ bool readPointCloud(IObject iObj, M44d mat, sfmData::SfMData &sfmdata, ESfMData
 
   // Number of points before adding the Alembic data
   const std::size_t nbPointsInit = sfmdata.structure.size();
+  const std::size_t nbPoints = positions->size();
   for(std::size_t point3d_i = 0;
-      point3d_i < positions->size();
+      point3d_i < nbPoints;
       ++point3d_i)
   {
     const P3fArraySamplePtr::element_type::value_type & pos_i = positions->get()[point3d_i];
@@ -136,6 +137,11 @@ bool readPointCloud(IObject iObj, M44d mat, sfmData::SfMData &sfmdata, ESfMData
     }
   }
 
+  // release the point samples before reading the observations
+  positions.reset();
+  sampleColors.reset();
+  sampleDescs.reset();
+
   // for compatibility with files generated with a previous version
   if(userProps &&
      userProps.getPropertyHeader("mvg_visibilitySize") &&
@@ -155,11 +161,11 @@ bool readPointCloud(IObject iObj, M44d mat, sfmData::SfMData &sfmdata, ESfMData
     FloatArraySamplePtr sampleFeatPos2d;
     propFeatPos2d.get(sampleFeatPos2d);
 
-    if( positions->size() != sampleVisibilitySize->size() )
+    if( nbPoints != sampleVisibilitySize->size() )
     {
       ALICEVISION_LOG_ERROR("Alembic Error: number of observations per 3D point should be identical to the number of 2D features.\n"
                             "# observations per 3D point: " << sampleVisibilitySize->size() << ".\n"
-                            "# 3D points: " << positions->size() << ".");
+                            "# 3D points: " << nbPoints << ".");
       return false;
     }
     if( sampleVisibilityIds->size() != sampleFeatPos2d->size() )
@@ -172,7 +178,7 @@ bool readPointCloud(IObject iObj, M44d mat, sfmData::SfMData &sfmdata, ESfMData
 
     std::size_t obsGlobal_i = 0;
     for(std::size_t point3d_i = 0;
-        point3d_i < positions->size();
+        point3d_i < nbPoints;
         ++point3d_i)
     {
       sfmData::Landmark& landmark = sfmdata.structure[nbPointsInit + point3d_i];
@@ -211,11 +217,11 @@ bool readPointCloud(IObject iObj, M44d mat, sfmData::SfMData &sfmdata, ESfMData
     propVisibilityViewId.get(sampleVisibilityViewId);
 
 
-    if(positions->size() != sampleVisibilitySize->size())
+    if(nbPoints != sampleVisibilitySize->size())
     {
       ALICEVISION_LOG_ERROR("Alembic Error: number of observations per 3D point should be identical to the number of 2D features.\n"
                             "# observations per 3D point: " << sampleVisibilitySize->size() << ".\n"
-                            "# 3D points: " << positions->size() << ".");
+                            "# 3D points: " << nbPoints << ".");
       return false;
     }
 
@@ -261,28 +267,27 @@ bool readPointCloud(IObject iObj, M44d mat, sfmData::SfMData &sfmdata, ESfMData
     const bool hasFeatures = (sampleVisibilityFeatId != nullptr) && (sampleVisibilityFeatId->size() > 0);
 
     std::size_t obsGlobalIndex = 0;
-    for(std::size_t point3d_i = 0; point3d_i < positions->size(); ++point3d_i)
+    for(std::size_t point3d_i = 0; point3d_i < nbPoints; ++point3d_i)
     {
       const int landmarkId = nbPointsInit + point3d_i;
-      sfmData::Landmark& landmark = sfmdata.structure[landmarkId];
+      sfmData::Observations& observations = sfmdata.structure.at(landmarkId).observations;
 
       // Number of observation for this 3d point
       const std::size_t visibilitySize = (*sampleVisibilitySize)[point3d_i];
+      observations.reserve(visibilitySize);
 
       for(std::size_t obs_i = 0; obs_i < visibilitySize; ++obs_i, ++obsGlobalIndex)
       {
         const int viewId = (*sampleVisibilityViewId)[obsGlobalIndex];
 
+        // observations are exported sorted by view id: insert at the end in constant time
+        sfmData::Observation& observation = observations.emplace_hint(observations.end(), viewId, sfmData::Observation())->second;
+
         if(hasFeatures)
         {
-          const int featId = (*sampleVisibilityFeatId)[obsGlobalIndex];
-          sfmData::Observation& observation = landmark.observations[viewId];
-          observation.id_feat = featId;
-
-          const float posX = (*sampleVisibilityFeatPos)[2 * obsGlobalIndex];
-          const float posY = (*sampleVisibilityFeatPos)[2 * obsGlobalIndex + 1];
-          observation.x[0] = posX;
-          observation.x[1] = posY;
+          observation.id_feat = (*sampleVisibilityFeatId)[obsGlobalIndex];
+          observation.x[0] = (*sampleVisibilityFeatPos)[2 * obsGlobalIndex];
+          observation.x[1] = (*sampleVisibilityFeatPos)[2 * obsGlobalIndex + 1];
 
           // for compatibility with previous version without scale
           if(sampleVisibilityFeatScale)
@@ -290,11 +295,6 @@ bool readPointCloud(IObject iObj, M44d mat, sfmData::SfMData &sfmdata, ESfMData
               observation.scale = (*sampleVisibilityFeatScale)[obsGlobalIndex];
           }
         }
-        else
-        {
-          landmark.observations[viewId] = sfmData::Observation();
-        }
-
       }
     }
   }
@@ -5,6 +5,7 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file,
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include "AlembicExporter.hpp"
 #include "AlembicImporter.hpp"
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
@@ -14,6 +15,9 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
 
+#include <Alembic/AbcGeom/All.h>
+#include <Alembic/AbcCoreFactory/All.h>
+
 #include <iostream>
 
 using namespace aliceVision;
@@ -274,3 +278,62 @@ BOOST_AUTO_TEST_CASE(AlembicImporter_importExport) {
     }
 
 }
+
+// Get the names of the Alembic points objects under the given object
+void getPointsNames(const Alembic::Abc::IObject& object, std::vector<std::string>& names)
+{
+    for(std::size_t i = 0; i < object.getNumChildren(); ++i)
+    {
+        const Alembic::Abc::IObject child = object.getChild(i);
+        if(Alembic::AbcGeom::IPoints::matches(child.getHeader()))
+            names.push_back(child.getName());
+        getPointsNames(child, names);
+    }
+}
+
+std::vector<std::string> getPointsNames(const std::string& filename)
+{
+    Alembic::AbcCoreFactory::IFactory factory;
+    Alembic::Abc::IArchive archive = factory.getArchive(filename);
+    std::vector<std::string> names;
+    getPointsNames(archive.getTop(), names);
+    return names;
+}
+
+BOOST_AUTO_TEST_CASE(AlembicImporter_landmarksBlocks)
+{
+    const SfMData sfmData = createTestScene(5, 50, 0, 0, true);
+
+    // landmarks that fit in one block keep the single points object layout
+    {
+        const std::string abcFile = "landmarksSingleBlock.abc";
+        {
+            AlembicExporter exporter(abcFile);
+            exporter.addLandmarks(sfmData.getLandmarks());
+        }
+        const std::vector<std::string> names = getPointsNames(abcFile);
+        BOOST_REQUIRE_EQUAL(names.size(), 1);
+        BOOST_CHECK_EQUAL(names.front(), "particleShape1");
+    }
+
+    // export the landmarks in several Alembic points objects
+    const std::string abcFile = "landmarksBlocks.abc";
+    {
+        AlembicExporter exporter(abcFile);
+        exporter.addLandmarks(sfmData.getLandmarks(), LandmarksUncertainty(), true, true, 7);
+    }
+    BOOST_CHECK_EQUAL(getPointsNames(abcFile).size(), 8); // ceil(50 / 7)
+
+    SfMData sfmAbc;
+    BOOST_CHECK(Load(sfmAbc, abcFile, ESfMData(STRUCTURE | OBSERVATIONS_WITH_FEATURES)));
+    BOOST_CHECK_EQUAL(sfmData.getLandmarks().size(), sfmAbc.getLandmarks().size());
+
+    // landmarks are imported in the export order
+    IndexT landmarkId = 0;
+    for(const auto& landmarkPair : sfmData.getLandmarks())
+    {
+        BOOST_REQUIRE(sfmAbc.getLandmarks().count(landmarkId));
+        BOOST_CHECK(landmarkPair.second == sfmAbc.getLandmarks().at(landmarkId));
+        ++landmarkId;
+    }
+}
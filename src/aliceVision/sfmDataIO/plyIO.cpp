@@ -6,25 +6,238 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "plyIO.hpp"
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <sstream>
+#include <vector>
 
 namespace aliceVision {
 namespace sfmDataIO {
 
+namespace {
+
+/// number of vertices formatted or parsed at once
+const std::size_t vertexChunkSize = 1 << 18;
+
+bool isHostLittleEndian()
+{
+  const std::uint16_t value = 1;
+  std::uint8_t firstByte;
+  std::memcpy(&firstByte, &value, 1);
+  return firstByte == 1;
+}
+
+template<typename T>
+void appendBinary(std::string& buffer, T value)
+{
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * @brief Buffered PLY vertex writer.
+ *        Vertices are formatted in parallel per chunk, then written sequentially.
+ */
+class PlyVertexWriter
+{
+public:
+
+  PlyVertexWriter(std::ostream& stream, bool binary, bool withVisibility, bool withUncertainty)
+    : _stream(stream)
+    , _binary(binary)
+    , _withVisibility(withVisibility)
+    , _withUncertainty(withUncertainty)
+  {
+    _vertices.reserve(vertexChunkSize);
+  }
+
+  ~PlyVertexWriter()
+  {
+    flush();
+  }
+
+  void add(const Vec3& X, const image::RGBColor& rgb, std::size_t visibility = 0, const Vec3* uncertainty = nullptr)
+  {
+    _vertices.push_back({X, rgb, static_cast<std::uint32_t>(visibility), uncertainty});
+    if(_vertices.size() >= vertexChunkSize)
+      flush();
+  }
+
+  void flush()
+  {
+    if(_vertices.empty())
+      return;
+
+    const int nbVertices = static_cast<int>(_vertices.size());
+    const int nbBlocks = std::min(nbVertices, 4 * omp_get_max_threads());
+    std::vector<std::string> blocks(nbBlocks);
+
+    #pragma omp parallel for
+    for(int b = 0; b < nbBlocks; ++b)
+    {
+      const int begin = static_cast<int>((std::int64_t(b) * nbVertices) / nbBlocks);
+      const int end = static_cast<int>((std::int64_t(b + 1) * nbVertices) / nbBlocks);
+      std::string& block = blocks.at(b);
+
+      block.reserve((end - begin) * (_binary ? 32 : 64));
+      for(int i = begin; i < end; ++i)
+        format(_vertices[i], block);
+    }
+
+    for(const std::string& block : blocks)
+      _stream.write(block.data(), block.size());
+
+    _vertices.clear();
+  }
+
+private:
+
+  struct Vertex
+  {
+    Vec3 X;
+    image::RGBColor rgb;
+    std::uint32_t visibility;
+    const Vec3* uncertainty;
+  };
+
+  void format(const Vertex& vertex, std::string& buffer) const
+  {
+    Vec3 uncertainty = Vec3::Zero();
+    if(vertex.uncertainty != nullptr)
+      uncertainty = *vertex.uncertainty;
+
+    if(_binary)
+    {
+      for(int i = 0; i < 3; ++i)
+        appendBinary(buffer, static_cast<float>(vertex.X(i)));
+      for(int i = 0; i < 3; ++i)
+        appendBinary(buffer, vertex.rgb(i));
+      if(_withVisibility)
+        appendBinary(buffer, vertex.visibility);
+      if(_withUncertainty)
+        for(int i = 0; i < 3; ++i)
+          appendBinary(buffer, static_cast<float>(uncertainty(i)));
+      return;
+    }
+
+    char line[256];
+    int size = std::snprintf(line, sizeof(line), "%.9g %.9g %.9g %d %d %d",
+                             vertex.X(0), vertex.X(1), vertex.X(2),
+                             int(vertex.rgb.r()), int(vertex.rgb.g()), int(vertex.rgb.b()));
+    if(_withVisibility)
+      size += std::snprintf(line + size, sizeof(line) - size, " %u", static_cast<unsigned int>(vertex.visibility));
+    if(_withUncertainty)
+      size += std::snprintf(line + size, sizeof(line) - size, " %.9g %.9g %.9g", uncertainty(0), uncertainty(1), uncertainty(2));
+
+    buffer.append(line, size);
+    buffer.push_back('\n');
+  }
+
+  std::ostream& _stream;
+  const bool _binary;
+  const bool _withVisibility;
+  const bool _withUncertainty;
+  std::vector<Vertex> _vertices;
+};
+
+/// PLY scalar property types
+enum class EPlyType
+{
+  INT8,
+  UINT8,
+  INT16,
+  UINT16,
+  INT32,
+  UINT32,
+  FLOAT32,
+  FLOAT64
+};
+
+bool getPlyType(const std::string& name, EPlyType& type, std::size_t& size)
+{
+  if(name == "char"   || name == "int8")    { type = EPlyType::INT8;    size = 1; return true; }
+  if(name == "uchar"  || name == "uint8")   { type = EPlyType::UINT8;   size = 1; return true; }
+  if(name == "short"  || name == "int16")   { type = EPlyType::INT16;   size = 2; return true; }
+  if(name == "ushort" || name == "uint16")  { type = EPlyType::UINT16;  size = 2; return true; }
+  if(name == "int"    || name == "int32")   { type = EPlyType::INT32;   size = 4; return true; }
+  if(name == "uint"   || name == "uint32")  { type = EPlyType::UINT32;  size = 4; return true; }
+  if(name == "float"  || name == "float32") { type = EPlyType::FLOAT32; size = 4; return true; }
+  if(name == "double" || name == "float64") { type = EPlyType::FLOAT64; size = 8; return true; }
+  return false;
+}
+
+struct PlyProperty
+{
+  std::string name;
+  EPlyType type;
+  std::size_t size;
+  /// offset in a binary vertex record
+  std::size_t offset;
+};
+
+template<typename T>
+double readBinaryValue(const char* bytes)
+{
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return static_cast<double>(value);
+}
+
+double readBinaryValue(const char* record, const PlyProperty& property, bool swapBytes)
+{
+  char bytes[8];
+  if(swapBytes)
+    std::reverse_copy(record + property.offset, record + property.offset + property.size, bytes);
+  else
+    std::memcpy(bytes, record + property.offset, property.size);
+
+  switch(property.type)
+  {
+    case EPlyType::INT8:    return readBinaryValue<std::int8_t>(bytes);
+    case EPlyType::UINT8:   return readBinaryValue<std::uint8_t>(bytes);
+    case EPlyType::INT16:   return readBinaryValue<std::int16_t>(bytes);
+    case EPlyType::UINT16:  return readBinaryValue<std::uint16_t>(bytes);
+    case EPlyType::INT32:   return readBinaryValue<std::int32_t>(bytes);
+    case EPlyType::UINT32:  return readBinaryValue<std::uint32_t>(bytes);
+    case EPlyType::FLOAT32: return readBinaryValue<float>(bytes);
+    case EPlyType::FLOAT64: return readBinaryValue<double>(bytes);
+  }
+  return 0.0;
+}
+
+unsigned char toColorChannel(double value, EPlyType type)
+{
+  // floating point colors are normalized
+  if(type == EPlyType::FLOAT32 || type == EPlyType::FLOAT64)
+    value *= 255.0;
+  return static_cast<unsigned char>(std::min(255.0, std::max(0.0, value)));
+}
+
+} // namespace
+
 bool savePLY(
   const sfmData::SfMData& sfmData,
   const std::string& filename,
-  ESfMData partFlag)
+  ESfMData partFlag,
+  bool binary,
+  bool withAttributes)
 {
   const bool b_structure = (partFlag & STRUCTURE) == STRUCTURE;
   const bool b_extrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool b_visibility = withAttributes && ((partFlag & OBSERVATIONS) || (partFlag & OBSERVATIONS_WITH_FEATURES));
+  const bool b_uncertainty = withAttributes && b_structure && (partFlag & LANDMARKS_UNCERTAINTY) && !sfmData._landmarksUncertainty.empty();
 
   if (!(b_structure || b_extrinsics))
     return false;
 
   //Create the stream and check it is ok
-  std::ofstream stream(filename.c_str());
+  std::ofstream stream(filename.c_str(), std::ios::binary);
   if (!stream.is_open())
     return false;
 
@@ -39,8 +252,11 @@ bool savePLY(
         view_with_pose_count += sfmData.isPoseAndIntrinsicDefined(view.second.get());
       }
     }
+
+    const std::string format = !binary ? "ascii" : (isHostLittleEndian() ? "binary_little_endian" : "binary_big_endian");
+
     stream << "ply"
-      << '\n' << "format ascii 1.0"
+      << '\n' << "format " << format << " 1.0"
       << '\n' << "element vertex "
         // Vertex count: (#landmark + #view_with_valid_pose)
         << ((b_structure ? sfmData.getLandmarks().size() : 0) +
@@ -50,8 +266,17 @@ bool savePLY(
       << '\n' << "property float z"
       << '\n' << "property uchar red"
       << '\n' << "property uchar green"
-      << '\n' << "property uchar blue"
-      << '\n' << "end_header" << std::endl;
+      << '\n' << "property uchar blue";
+    if (b_visibility)
+      stream << '\n' << "property uint visibility";
+    if (b_uncertainty)
+      stream << '\n' << "property float uncertainty_x"
+             << '\n' << "property float uncertainty_y"
+             << '\n' << "property float uncertainty_z";
+    stream << '\n' << "end_header" << '\n';
+
+    {
+      PlyVertexWriter writer(stream, binary, b_visibility, b_uncertainty);
 
       if (b_extrinsics)
       {
@@ -60,8 +285,7 @@ bool savePLY(
           if (sfmData.isPoseAndIntrinsicDefined(view.second.get()))
           {
             const geometry::Pose3 pose = sfmData.getPose(*(view.second.get())).getTransform();
-            stream << pose.center().transpose()
-              << " 0 255 0" << "\n";
+            writer.add(pose.center(), image::GREEN);
           }
         }
       }
@@ -69,21 +293,235 @@ bool savePLY(
       if (b_structure)
       {
         const sfmData::Landmarks& landmarks = sfmData.getLandmarks();
-        for (sfmData::Landmarks::const_iterator iterLandmarks = landmarks.begin();
-          iterLandmarks != landmarks.end();
-          ++iterLandmarks)  {
-          stream << iterLandmarks->second.X.transpose() << " "
-                 << (int)iterLandmarks->second.rgb.r() << " "
-                 << (int)iterLandmarks->second.rgb.g() << " "
-                 << (int)iterLandmarks->second.rgb.b() << "\n";
+        for (const auto& landmarkPair : landmarks)
+        {
+          const sfmData::Landmark& landmark = landmarkPair.second;
+          const Vec3* uncertainty = nullptr;
+
+          if (b_uncertainty)
+          {
+            const auto uncertaintyIt = sfmData._landmarksUncertainty.find(landmarkPair.first);
+            if (uncertaintyIt != sfmData._landmarksUncertainty.end())
+              uncertainty = &uncertaintyIt->second;
+          }
+          writer.add(landmark.X, landmark.rgb, landmark.observations.size(), uncertainty);
         }
       }
-      stream.flush();
-      bOk = stream.good();
-      stream.close();
+    }
+    stream.flush();
+    bOk = stream.good();
+    stream.close();
   }
   return bOk;
 }
 
+bool loadPLY(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  if(!(partFlag & STRUCTURE))
+    return true;
+
+  std::ifstream stream(filename.c_str(), std::ios::binary);
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Cannot open the PLY file: '" << filename << "'.");
+    return false;
+  }
+
+  // parse the header
+  std::string format;
+  std::size_t nbVertices = 0;
+  std::vector<PlyProperty> properties;
+  std::size_t recordSize = 0;
+  {
+    std::string line;
+    std::getline(stream, line);
+    if(line.empty() || line.substr(0, 3) != "ply")
+    {
+      ALICEVISION_LOG_ERROR("Invalid PLY file: '" << filename << "'.");
+      return false;
+    }
+
+    bool inVertexElement = false;
+    bool hasElement = false;
+    bool endHeader = false;
+
+    while(std::getline(stream, line))
+    {
+      if(!line.empty() && line.back() == '\r')
+        line.pop_back();
+
+      std::istringstream ls(line);
+      std::string keyword;
+      ls >> keyword;
+
+      if(keyword == "format")
+      {
+        ls >> format;
+      }
+      else if(keyword == "element")
+      {
+        std::string name;
+        std::size_t count = 0;
+        ls >> name >> count;
+        inVertexElement = (name == "vertex");
+
+        if(inVertexElement && hasElement)
+        {
+          ALICEVISION_LOG_ERROR("Unsupported PLY file: '" << filename << "', the vertex element should be the first element.");
+          return false;
+        }
+        if(inVertexElement)
+          nbVertices = count;
+        hasElement = true;
+      }
+      else if(keyword == "property" && inVertexElement)
+      {
+        std::string typeName;
+        PlyProperty property;
+        ls >> typeName >> property.name;
+
+        if(!getPlyType(typeName, property.type, property.size))
+        {
+          ALICEVISION_LOG_ERROR("Unsupported PLY vertex property type '" << typeName << "' in file: '" << filename << "'.");
+          return false;
+        }
+        property.offset = recordSize;
+        recordSize += property.size;
+        properties.push_back(property);
+      }
+      else if(keyword == "end_header")
+      {
+        endHeader = true;
+        break;
+      }
+    }
+
+    if(!endHeader)
+    {
+      ALICEVISION_LOG_ERROR("Invalid PLY file header: '" << filename << "'.");
+      return false;
+    }
+  }
+
+  const bool binary = (format != "ascii");
+  if(binary && format != "binary_little_endian" && format != "binary_big_endian")
+  {
+    ALICEVISION_LOG_ERROR("Unsupported PLY format '" << format << "' in file: '" << filename << "'.");
+    return false;
+  }
+  const bool swapBytes = binary && ((format == "binary_little_endian") != isHostLittleEndian());
+
+  // vertex property indexes
+  const auto findProperty = [&](const std::string& name)
+  {
+    for(std::size_t i = 0; i < properties.size(); ++i)
+      if(properties[i].name == name)
+        return static_cast<int>(i);
+    return -1;
+  };
+
+  const int position[3] = {findProperty("x"), findProperty("y"), findProperty("z")};
+  const int color[3] = {findProperty("red"), findProperty("green"), findProperty("blue")};
+  const bool hasColor = (color[0] != -1 && color[1] != -1 && color[2] != -1);
+
+  if(position[0] == -1 || position[1] == -1 || position[2] == -1)
+  {
+    ALICEVISION_LOG_ERROR("Invalid PLY file: '" << filename << "', the x, y, z vertex properties are missing.");
+    return false;
+  }
+
+  // Number of points before adding the PLY data
+  const std::size_t nbLandmarksInit = sfmData.structure.size();
+
+  std::vector<Vec3> positions;
+  std::vector<image::RGBColor> colors;
+  std::vector<char> buffer;
+  std::vector<std::string> lines;
+
+  // read and parse the vertices per chunk
+  for(std::size_t first = 0; first < nbVertices; first += vertexChunkSize)
+  {
+    const int nbChunkVertices = static_cast<int>(std::min(vertexChunkSize, nbVertices - first));
+    positions.resize(nbChunkVertices);
+    colors.assign(nbChunkVertices, image::WHITE);
+
+    bool valid = true;
+
+    if(binary)
+    {
+      buffer.resize(nbChunkVertices * recordSize);
+      stream.read(buffer.data(), buffer.size());
+      valid = bool(stream);
+
+      if(valid)
+      {
+        #pragma omp parallel for
+        for(int i = 0; i < nbChunkVertices; ++i)
+        {
+          const char* record = buffer.data() + i * recordSize;
+
+          for(int c = 0; c < 3; ++c)
+            positions[i](c) = readBinaryValue(record, properties[position[c]], swapBytes);
+
+          if(hasColor)
+            for(int c = 0; c < 3; ++c)
+              colors[i](c) = toColorChannel(readBinaryValue(record, properties[color[c]], swapBytes), properties[color[c]].type);
+        }
+      }
+    }
+    else
+    {
+      lines.resize(nbChunkVertices);
+      for(int i = 0; i < nbChunkVertices && valid; ++i)
+        valid = bool(std::getline(stream, lines[i]));
+
+      std::vector<char> validLines(nbChunkVertices, 1);
+
+      #pragma omp parallel if(valid)
+      {
+        std::vector<double> values(properties.size());
+
+        #pragma omp for
+        for(int i = 0; i < nbChunkVertices; ++i)
+        {
+          const char* str = lines[i].c_str();
+          for(double& value : values)
+          {
+            char* end;
+            value = std::strtod(str, &end);
+            if(end == str)
+            {
+              validLines[i] = 0;
+              break;
+            }
+            str = end;
+          }
+          if(!validLines[i])
+            continue;
+
+          for(int c = 0; c < 3; ++c)
+            positions[i](c) = values[position[c]];
+
+          if(hasColor)
+            for(int c = 0; c < 3; ++c)
+              colors[i](c) = toColorChannel(values[color[c]], properties[color[c]].type);
+        }
+      }
+      valid = valid && std::find(validLines.begin(), validLines.end(), 0) == validLines.end();
+    }
+
+    if(!valid)
+    {
+      ALICEVISION_LOG_ERROR("Invalid PLY file: '" << filename << "', cannot read the vertices " << first << " to " << first + nbChunkVertices << ".");
+      return false;
+    }
+
+    for(int i = 0; i < nbChunkVertices; ++i)
+      sfmData.structure[nbLandmarksInit + first + i] = sfmData::Landmark(positions[i], feature::EImageDescriberType::UNKNOWN, sfmData::Observations(), colors[i]);
+  }
+
+  return true;
+}
+
 } // namespace sfmDataIO
 } // namespace aliceVision
@@ -15,13 +15,36 @@ namespace aliceVision {
 namespace sfmDataIO {
 
 /**
- * @brief Save the structure and camera positions of a SfMData container as 3D points in a PLY ASCII file.
+ * @brief Save the structure and camera positions of a SfMData container as 3D points in a PLY file.
+ *        Vertex properties:
+ *        - x, y, z (float) and red, green, blue (uchar), camera positions are green
+ *        - only if withAttributes is set:
+ *          - visibility (uint): the number of observations, if OBSERVATIONS is requested
+ *          - uncertainty_x, uncertainty_y, uncertainty_z (float): the landmark uncertainty eigen values,
+ *            if LANDMARKS_UNCERTAINTY is requested and available
  * @param[in] sfmData The input SfMData
  * @param[in] filename The filename
  * @param[in] partFlag The ESfMData save flag
+ * @param[in] binary Write a binary PLY file (host byte order, little-endian on all supported platforms) instead of ASCII
+ * @param[in] withAttributes Write the visibility and uncertainty vertex properties
  * @return true if completed
  */
 bool savePLY(const sfmData::SfMData& sfmData,
+             const std::string& filename,
+             ESfMData partFlag,
+             bool binary = false,
+             bool withAttributes = false);
+
+/**
+ * @brief Load the vertices of a PLY file (ASCII or binary) as SfMData landmarks.
+ *        Only the x, y, z and red, green, blue vertex properties are used.
+ *        The vertex element has to be the first element of the file.
+ * @param[out] sfmData The output SfMData, vertices are added to the existing structure
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData load flag, vertices are only loaded with STRUCTURE
+ * @return true if completed
+ */
+bool loadPLY(sfmData::SfMData& sfmData,
              const std::string& filename,
              ESfMData partFlag);
 
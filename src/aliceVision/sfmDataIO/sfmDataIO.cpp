@@ -108,6 +108,10 @@ bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partF
     status = true;
   }
 #endif // ALICEVISION_HAVE_ALEMBIC
+  else if(extension == ".ply") // Polygon File
+  {
+    status = loadPLY(sfmData, filename, partFlag);
+  }
   else if(fs::is_directory(filename))
   {
     status = readGt(filename, sfmData);
@@ -128,7 +132,7 @@ bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partF
   return status;
 }
 
-bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool binary, bool withAttributes)
 {
   const fs::path bPath = fs::path(filename);
   const std::string extension = bPath.extension().string();
@@ -141,7 +145,7 @@ bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData
   }
   else if(extension == ".ply") // Polygon File
   {
-    status = savePLY(sfmData, tmpPath, partFlag);
+    status = savePLY(sfmData, tmpPath, partFlag, binary, withAttributes);
   }
   else if (extension == ".baf") // Bundle Adjustment File
   {
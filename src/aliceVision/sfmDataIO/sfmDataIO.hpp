@@ -36,8 +36,17 @@ bool ValidIds(const sfmData::SfMData& sfmData, ESfMData partFlag);
 /// load SfMData SfM scene from a file
 bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
 
-/// save SfMData SfM scene to a file
-bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+/**
+ * @brief save SfMData SfM scene to a file
+ * @param[in] sfmData The input SfMData
+ * @param[in] filename The filename, the format is deduced from its extension
+ * @param[in] partFlag The ESfMData save flag
+ * @param[in] binary Write a binary file if the format has an ASCII and a binary variant (PLY)
+ * @param[in] withAttributes Write the per-point visibility and uncertainty if the format supports it (PLY)
+ * @return true if completed
+ */
+bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag,
+          bool binary = false, bool withAttributes = false);
 
 } // namespace sfmDataIO
 } // namespace aliceVision
@@ -8,9 +8,11 @@
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfmDataIO/plyIO.hpp>
 
 #include <boost/filesystem.hpp>
 
+#include <fstream>
 #include <sstream>
 
 #define BOOST_TEST_MODULE sfmDataIO
@@ -231,3 +233,53 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_PLY) {
     BOOST_CHECK( fs::is_regular_file(filename) );
   }
 }
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD_PLY) {
+
+  sfmData::SfMData sfmData = createTestScene(2, 2, true);
+  sfmData.structure[0].rgb = image::RGBColor(10, 20, 30);
+
+  for(bool binary : {true, false})
+  {
+    const std::string filename = binary ? "SAVE_LOAD_binary.ply" : "SAVE_LOAD_ascii.ply";
+    ALICEVISION_LOG_DEBUG("Testing:" << filename);
+
+    // the visibility property is skipped by the loader
+    BOOST_CHECK( savePLY(sfmData, filename, ESfMData(STRUCTURE | OBSERVATIONS), binary, true) );
+
+    // vertices are loaded as landmarks
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ESfMData(STRUCTURE)) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.getLandmarks().size(), 1 );
+    BOOST_CHECK( sfmDataLoad.getLandmarks().at(0).X == sfmData.getLandmarks().at(0).X );
+    BOOST_CHECK( sfmDataLoad.getLandmarks().at(0).rgb == sfmData.getLandmarks().at(0).rgb );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_PLY_attributes) {
+
+  const sfmData::SfMData sfmData = createTestScene(2, 2, true);
+
+  // get the PLY header lines
+  const auto readHeader = [](const std::string& filename)
+  {
+    std::ifstream stream(filename);
+    std::string header;
+    std::string line;
+    while(std::getline(stream, line) && line != "end_header")
+      header += line + '\n';
+    return header;
+  };
+
+  // the per-point attributes are only written on request
+  BOOST_CHECK( Save(sfmData, "SAVE_default.ply", ALL) );
+  const std::string defaultHeader = readHeader("SAVE_default.ply");
+  BOOST_CHECK( defaultHeader.find("format ascii") != std::string::npos );
+  BOOST_CHECK( defaultHeader.find("visibility") == std::string::npos );
+  BOOST_CHECK( defaultHeader.find("uncertainty") == std::string::npos );
+
+  BOOST_CHECK( Save(sfmData, "SAVE_attributes.ply", ALL, true, true) );
+  const std::string attributesHeader = readHeader("SAVE_attributes.ply");
+  BOOST_CHECK( attributesHeader.find("format binary") != std::string::npos );
+  BOOST_CHECK( attributesHeader.find("property uint visibility") != std::string::npos );
+}
@@ -0,0 +1,244 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace stl
+{
+
+/**
+ * @brief Bump allocator for short-lived scratch buffers.
+ *
+ * Memory is handed out sequentially from blocks that are kept alive until the arena is destroyed.
+ * Allocations are released all at once by rewinding the arena to a previous marker (see arena_scope),
+ * so once the blocks have grown to the working size of a hot loop, the loop does not hit the heap anymore.
+ *
+ * An arena is not thread-safe: use thread_arena() to get the arena of the calling thread.
+ */
+class arena
+{
+public:
+  /// position in the arena, see mark() and rewind()
+  struct marker
+  {
+    std::size_t block;
+    std::size_t offset;
+  };
+
+  explicit arena(std::size_t blockSize = 64 * 1024)
+    : _blockSize(blockSize)
+  {}
+
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  /**
+   * @brief Allocate uninitialized memory.
+   * @param[in] size the number of bytes
+   * @param[in] alignment the alignment of the returned address (power of 2)
+   * @return a pointer valid until the arena is rewound before this allocation
+   */
+  void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+  {
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+    while(_current < _blocks.size())
+    {
+      void* ptr = allocateInBlock(_blocks[_current], size, alignment);
+      if(ptr != nullptr)
+        return ptr;
+      // the remaining space of the current block is lost until the arena is rewound
+      ++_current;
+      _offset = 0;
+    }
+
+    _blocks.emplace_back(std::max(_blockSize, size + alignment));
+    _current = _blocks.size() - 1;
+    _offset = 0;
+    return allocateInBlock(_blocks.back(), size, alignment);
+  }
+
+  /**
+   * @brief Allocate an uninitialized array.
+   * @param[in] n the number of elements
+   */
+  template <class T>
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+  }
+
+  /// @return the current position, to be given to rewind()
+  marker mark() const
+  {
+    return {_current, _offset};
+  }
+
+  /**
+   * @brief Release all the allocations made since the marker.
+   * @note The blocks are kept for the next allocations.
+   */
+  void rewind(const marker& m)
+  {
+    assert(m.block < _current || (m.block == _current && m.offset <= _offset));
+    _current = m.block;
+    _offset = m.offset;
+  }
+
+  /// release all the allocations, the blocks are kept
+  void reset()
+  {
+    _current = 0;
+    _offset = 0;
+  }
+
+  /// @return the number of bytes owned by the arena
+  std::size_t capacity() const
+  {
+    std::size_t capacity = 0;
+    for(const block& b : _blocks)
+      capacity += b.size;
+    return capacity;
+  }
+
+private:
+  struct block
+  {
+    explicit block(std::size_t size)
+      : data(new char[size])
+      , size(size)
+    {}
+
+    std::unique_ptr<char[]> data;
+    std::size_t size;
+  };
+
+  void* allocateInBlock(const block& b, std::size_t size, std::size_t alignment)
+  {
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(b.data.get());
+    const std::uintptr_t aligned = (base + _offset + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+    const std::size_t begin = static_cast<std::size_t>(aligned - base);
+    if(begin + size > b.size)
+      return nullptr;
+    _offset = begin + size;
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  std::size_t _blockSize;
+  std::vector<block> _blocks;
+  std::size_t _current = 0;
+  std::size_t _offset = 0;
+};
+
+/**
+ * @brief Get the arena of the calling thread.
+ * @note Only use it through an arena_scope, so that nested scratch buffers are released in order.
+ */
+inline arena& thread_arena()
+{
+  static thread_local arena threadArena;
+  return threadArena;
+}
+
+/**
+ * @brief STL allocator drawing from an arena.
+ * @note deallocate is a no-op: the memory is given back when the arena is rewound.
+ *       Reserve containers to their final size to avoid wasting the space of the intermediate buffers.
+ */
+template <class T>
+class arena_allocator
+{
+public:
+  typedef T value_type;
+
+  explicit arena_allocator(arena& a)
+    : _arena(&a)
+  {}
+
+  template <class U>
+  arena_allocator(const arena_allocator<U>& other)
+    : _arena(&other.get_arena())
+  {}
+
+  T* allocate(std::size_t n)
+  {
+    return _arena->allocate<T>(n);
+  }
+
+  void deallocate(T*, std::size_t)
+  {}
+
+  arena& get_arena() const
+  {
+    return *_arena;
+  }
+
+  template <class U>
+  bool operator==(const arena_allocator<U>& other) const
+  {
+    return _arena == &other.get_arena();
+  }
+
+  template <class U>
+  bool operator!=(const arena_allocator<U>& other) const
+  {
+    return !(*this == other);
+  }
+
+private:
+  arena* _arena;
+};
+
+template <class T>
+using arena_vector = std::vector<T, arena_allocator<T> >;
+
+/**
+ * @brief RAII scope on an arena (by default the arena of the calling thread).
+ *
+ * Everything allocated in the arena during the lifetime of the scope is released when the scope is destroyed.
+ * Containers using an arena_allocator of the scope must be destroyed before it.
+ */
+class arena_scope
+{
+public:
+  explicit arena_scope(arena& a = thread_arena())
+    : _arena(a)
+    , _marker(a.mark())
+  {}
+
+  ~arena_scope()
+  {
+    _arena.rewind(_marker);
+  }
+
+  arena_scope(const arena_scope&) = delete;
+  arena_scope& operator=(const arena_scope&) = delete;
+
+  template <class T>
+  T* allocate(std::size_t n)
+  {
+    return _arena.allocate<T>(n);
+  }
+
+  template <class T>
+  arena_allocator<T> allocator() const
+  {
+    return arena_allocator<T>(_arena);
+  }
+
+private:
+  arena& _arena;
+  arena::marker _marker;
+};
+
+} // namespace stl
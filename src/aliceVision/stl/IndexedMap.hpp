@@ -0,0 +1,487 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stl
+{
+
+/**
+ * @brief Associative container with dense storage, designed for large maps of ids (views, poses, landmarks).
+ *
+ * The elements are stored contiguously in pages of fixed size and indexed by an open-addressing hash table
+ * (key -> slot). Compared to std::map:
+ * - iteration is sequential in memory, in insertion order (not sorted by key)
+ * - lookup is a hash probe in a flat table
+ * - references to elements remain valid on insertion (pages are never moved)
+ * - erase moves the last element into the erased slot: this only invalidates references to the last element
+ *   and keeps the "it = map.erase(it)" loop pattern valid
+ * - at most 2^32 - 2 elements
+ */
+template <class Key,
+          class T,
+          class Hash = std::hash<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T> > >
+class indexed_map
+{
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef std::pair<const Key, T> value_type;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef Hash hasher;
+  typedef Allocator allocator_type;
+  typedef value_type& reference;
+  typedef const value_type& const_reference;
+  typedef value_type* pointer;
+  typedef const value_type* const_pointer;
+
+  template <bool IsConst>
+  class iterator_base
+  {
+    typedef typename std::conditional<IsConst, const indexed_map, indexed_map>::type map_type;
+
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename indexed_map::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename std::conditional<IsConst, const value_type*, value_type*>::type pointer;
+    typedef typename std::conditional<IsConst, const value_type&, value_type&>::type reference;
+
+    iterator_base() = default;
+
+    iterator_base(map_type* map, size_type index)
+      : _map(map)
+      , _index(index)
+    {}
+
+    /// iterator to const_iterator conversion
+    template <bool OtherConst, class = typename std::enable_if<IsConst && !OtherConst>::type>
+    iterator_base(const iterator_base<OtherConst>& other)
+      : _map(other._map)
+      , _index(other._index)
+    {}
+
+    reference operator*() const { return _map->slot(_index); }
+    pointer operator->() const { return &_map->slot(_index); }
+    reference operator[](difference_type n) const { return _map->slot(_index + n); }
+
+    iterator_base& operator++() { ++_index; return *this; }
+    iterator_base& operator--() { --_index; return *this; }
+    iterator_base operator++(int) { iterator_base tmp(*this); ++_index; return tmp; }
+    iterator_base operator--(int) { iterator_base tmp(*this); --_index; return tmp; }
+    iterator_base& operator+=(difference_type n) { _index += n; return *this; }
+    iterator_base& operator-=(difference_type n) { _index -= n; return *this; }
+    iterator_base operator+(difference_type n) const { return iterator_base(_map, _index + n); }
+    iterator_base operator-(difference_type n) const { return iterator_base(_map, _index - n); }
+    friend iterator_base operator+(difference_type n, const iterator_base& it) { return it + n; }
+
+    friend difference_type operator-(const iterator_base& a, const iterator_base& b)
+    {
+      return static_cast<difference_type>(a._index) - static_cast<difference_type>(b._index);
+    }
+
+    friend bool operator==(const iterator_base& a, const iterator_base& b) { return a._index == b._index && a._map == b._map; }
+    friend bool operator!=(const iterator_base& a, const iterator_base& b) { return !(a == b); }
+    friend bool operator<(const iterator_base& a, const iterator_base& b) { return a._index < b._index; }
+    friend bool operator>(const iterator_base& a, const iterator_base& b) { return b < a; }
+    friend bool operator<=(const iterator_base& a, const iterator_base& b) { return !(b < a); }
+    friend bool operator>=(const iterator_base& a, const iterator_base& b) { return !(a < b); }
+
+  private:
+    friend class indexed_map;
+    template <bool> friend class iterator_base;
+
+    map_type* _map = nullptr;
+    size_type _index = 0;
+  };
+
+  typedef iterator_base<false> iterator;
+  typedef iterator_base<true> const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  indexed_map() = default;
+
+  explicit indexed_map(const allocator_type& alloc)
+    : _alloc(alloc)
+  {}
+
+  template <class InputIt>
+  indexed_map(InputIt first, InputIt last)
+  {
+    insert(first, last);
+  }
+
+  indexed_map(std::initializer_list<value_type> values)
+  {
+    insert(values.begin(), values.end());
+  }
+
+  indexed_map(const indexed_map& other)
+    : _alloc(other._alloc)
+  {
+    reserve(other.size());
+    for(const value_type& value : other)
+      ::new(static_cast<void*>(&slot(_size++))) value_type(value);
+    // same slots as the other map, the index table can be copied as is
+    _buckets = other._buckets;
+  }
+
+  indexed_map(indexed_map&& other) noexcept
+  {
+    swap(other);
+  }
+
+  ~indexed_map()
+  {
+    clear();
+  }
+
+  indexed_map& operator=(const indexed_map& other)
+  {
+    if(this != &other)
+    {
+      indexed_map tmp(other);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  indexed_map& operator=(indexed_map&& other) noexcept
+  {
+    if(this != &other)
+    {
+      clear();
+      swap(other);
+    }
+    return *this;
+  }
+
+  indexed_map& operator=(std::initializer_list<value_type> values)
+  {
+    clear();
+    insert(values.begin(), values.end());
+    return *this;
+  }
+
+  allocator_type get_allocator() const { return _alloc; }
+
+  // iterators
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, _size); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, _size); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+  const_reverse_iterator crbegin() const { return rbegin(); }
+  const_reverse_iterator crend() const { return rend(); }
+
+  // capacity
+
+  bool empty() const { return _size == 0; }
+  size_type size() const { return _size; }
+  size_type max_size() const { return static_cast<size_type>(npos - 1); }
+
+  /**
+   * @brief Allocate the storage and the index table for at least count elements
+   */
+  void reserve(size_type count)
+  {
+    while(_pages.size() * pageSize < count)
+      _pages.push_back(std::allocator_traits<allocator_type>::allocate(_alloc, pageSize));
+
+    if(count * 2 > _buckets.size())
+      rehash(count);
+  }
+
+  // modifiers
+
+  void clear()
+  {
+    for(size_type i = 0; i < _size; ++i)
+      slot(i).~value_type();
+    for(value_type* page : _pages)
+      std::allocator_traits<allocator_type>::deallocate(_alloc, page, pageSize);
+    _pages.clear();
+    _buckets.clear();
+    _size = 0;
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args)
+  {
+    if(_size == _pages.size() * pageSize)
+      _pages.push_back(std::allocator_traits<allocator_type>::allocate(_alloc, pageSize));
+
+    // construct the element in the next free slot to get its key
+    value_type* value = &slot(_size);
+    ::new(static_cast<void*>(value)) value_type(std::forward<Args>(args)...);
+
+    if((_size + 1) * 2 > _buckets.size())
+      rehash(_size + 1);
+
+    const size_type b = findBucket(value->first);
+    if(_buckets[b].slot != npos)
+    {
+      value->~value_type();
+      return std::make_pair(iterator(this, _buckets[b].slot), false);
+    }
+
+    _buckets[b].key = value->first;
+    _buckets[b].slot = static_cast<std::uint32_t>(_size);
+    return std::make_pair(iterator(this, _size++), true);
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator, Args&&... args)
+  {
+    return emplace(std::forward<Args>(args)...).first;
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) { return emplace(value); }
+  std::pair<iterator, bool> insert(value_type&& value) { return emplace(std::move(value)); }
+
+  template <class P, class = typename std::enable_if<std::is_constructible<value_type, P&&>::value>::type>
+  std::pair<iterator, bool> insert(P&& value)
+  {
+    return emplace(std::forward<P>(value));
+  }
+
+  iterator insert(const_iterator, const value_type& value) { return emplace(value).first; }
+  iterator insert(const_iterator, value_type&& value) { return emplace(std::move(value)).first; }
+
+  template <class InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    for(; first != last; ++first)
+      emplace(*first);
+  }
+
+  void insert(std::initializer_list<value_type> values)
+  {
+    insert(values.begin(), values.end());
+  }
+
+  /**
+   * @brief Erase the element at the given position.
+   *        The last element is moved to this position.
+   * @return iterator to the same position, i.e. to the next element to visit
+   */
+  iterator erase(const_iterator pos)
+  {
+    const size_type index = pos._index;
+    const size_type last = _size - 1;
+
+    eraseBucket(findBucket(slot(index).first));
+    slot(index).~value_type();
+
+    if(index != last)
+    {
+      ::new(static_cast<void*>(&slot(index))) value_type(std::move(slot(last)));
+      slot(last).~value_type();
+      _buckets[findBucket(slot(index).first)].slot = static_cast<std::uint32_t>(index);
+    }
+
+    --_size;
+    return iterator(this, index);
+  }
+
+  iterator erase(iterator pos)
+  {
+    return erase(const_iterator(pos));
+  }
+
+  size_type erase(const key_type& key)
+  {
+    const const_iterator it = find(key);
+    if(it == cend())
+      return 0;
+    erase(it);
+    return 1;
+  }
+
+  void swap(indexed_map& other) noexcept
+  {
+    std::swap(_alloc, other._alloc);
+    _pages.swap(other._pages);
+    _buckets.swap(other._buckets);
+    std::swap(_size, other._size);
+  }
+
+  // lookup
+
+  iterator find(const key_type& key)
+  {
+    const size_type index = findSlot(key);
+    return iterator(this, index == npos ? _size : index);
+  }
+
+  const_iterator find(const key_type& key) const
+  {
+    const size_type index = findSlot(key);
+    return const_iterator(this, index == npos ? _size : index);
+  }
+
+  size_type count(const key_type& key) const
+  {
+    return findSlot(key) == npos ? 0 : 1;
+  }
+
+  mapped_type& at(const key_type& key)
+  {
+    const size_type index = findSlot(key);
+    if(index == npos)
+      throw std::out_of_range("indexed_map::at: key not found");
+    return slot(index).second;
+  }
+
+  const mapped_type& at(const key_type& key) const
+  {
+    const size_type index = findSlot(key);
+    if(index == npos)
+      throw std::out_of_range("indexed_map::at: key not found");
+    return slot(index).second;
+  }
+
+  mapped_type& operator[](const key_type& key)
+  {
+    const size_type index = findSlot(key);
+    if(index != npos)
+      return slot(index).second;
+    return emplace(std::piecewise_construct, std::forward_as_tuple(key), std::tuple<>()).first->second;
+  }
+
+  mapped_type& operator[](key_type&& key)
+  {
+    const size_type index = findSlot(key);
+    if(index != npos)
+      return slot(index).second;
+    return emplace(std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::tuple<>()).first->second;
+  }
+
+  /**
+   * @brief Maps are equal if they contain the same (key, value) pairs, whatever the insertion order
+   */
+  friend bool operator==(const indexed_map& a, const indexed_map& b)
+  {
+    if(a.size() != b.size())
+      return false;
+    for(const value_type& value : a)
+    {
+      const const_iterator it = b.find(value.first);
+      if(it == b.end() || !(it->second == value.second))
+        return false;
+    }
+    return true;
+  }
+
+  friend bool operator!=(const indexed_map& a, const indexed_map& b)
+  {
+    return !(a == b);
+  }
+
+private:
+  static const size_type pageShift = 8;
+  static const size_type pageSize = size_type(1) << pageShift;
+  static const size_type pageMask = pageSize - 1;
+  static const std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+  struct Bucket
+  {
+    key_type key;
+    std::uint32_t slot = npos;
+  };
+
+  value_type& slot(size_type index) { return _pages[index >> pageShift][index & pageMask]; }
+  const value_type& slot(size_type index) const { return _pages[index >> pageShift][index & pageMask]; }
+
+  /// ideal bucket of a key (Fibonacci hashing), the table size is a power of two
+  size_type idealBucket(const key_type& key) const
+  {
+    const std::uint64_t h = static_cast<std::uint64_t>(hasher()(key)) * UINT64_C(0x9E3779B97F4A7C15);
+    return static_cast<size_type>(h >> 32) & (_buckets.size() - 1);
+  }
+
+  /// bucket containing the key or the empty bucket where it would be inserted (linear probing)
+  size_type findBucket(const key_type& key) const
+  {
+    const size_type mask = _buckets.size() - 1;
+    size_type b = idealBucket(key);
+    while(_buckets[b].slot != npos && !(_buckets[b].key == key))
+      b = (b + 1) & mask;
+    return b;
+  }
+
+  size_type findSlot(const key_type& key) const
+  {
+    if(_size == 0)
+      return npos;
+    return _buckets[findBucket(key)].slot;
+  }
+
+  /// remove a bucket with backward shift deletion, to keep the probe sequences without tombstones
+  void eraseBucket(size_type b)
+  {
+    const size_type mask = _buckets.size() - 1;
+    size_type next = (b + 1) & mask;
+
+    while(_buckets[next].slot != npos)
+    {
+      const size_type ideal = idealBucket(_buckets[next].key);
+      // move the next bucket into the hole if its ideal bucket is not in ]b, next]
+      if(((next - ideal) & mask) >= ((next - b) & mask))
+      {
+        _buckets[b] = _buckets[next];
+        b = next;
+      }
+      next = (next + 1) & mask;
+    }
+    _buckets[b].slot = npos;
+  }
+
+  /// rebuild the index table with a load factor lower than 0.5 for count elements
+  void rehash(size_type count)
+  {
+    size_type nbBuckets = 16;
+    while(nbBuckets < count * 2)
+      nbBuckets *= 2;
+
+    _buckets.assign(nbBuckets, Bucket());
+    for(size_type i = 0; i < _size; ++i)
+    {
+      const size_type b = findBucket(slot(i).first);
+      _buckets[b].key = slot(i).first;
+      _buckets[b].slot = static_cast<std::uint32_t>(i);
+    }
+  }
+
+  allocator_type _alloc;
+  std::vector<value_type*> _pages;
+  std::vector<Bucket> _buckets;
+  size_type _size = 0;
+};
+
+} // namespace stl
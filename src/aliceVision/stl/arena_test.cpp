@@ -0,0 +1,93 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Arena.hpp"
+
+#include <cstdint>
+#include <numeric>
+#include <thread>
+
+#define BOOST_TEST_MODULE stlArena
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(ARENA_AllocateAlignment)
+{
+  stl::arena arena(256);
+
+  for(std::size_t alignment = 1; alignment <= 64; alignment *= 2)
+  {
+    arena.allocate(3);
+    const void* ptr = arena.allocate(10, alignment);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(ptr) % alignment, 0);
+  }
+
+  // larger than a block
+  double* big = arena.allocate<double>(1000);
+  std::fill(big, big + 1000, 1.0);
+  BOOST_CHECK_EQUAL(std::accumulate(big, big + 1000, 0.0), 1000.0);
+}
+
+BOOST_AUTO_TEST_CASE(ARENA_ScopeReusesMemory)
+{
+  stl::arena arena(1024);
+  const void* first = nullptr;
+
+  for(int i = 0; i < 100; ++i)
+  {
+    stl::arena_scope scope(arena);
+    double* values = scope.allocate<double>(100);
+    if(i == 0)
+      first = values;
+    // the memory released by the previous scope is handed out again
+    BOOST_CHECK_EQUAL(values, first);
+
+    {
+      stl::arena_scope nested(arena);
+      nested.allocate<double>(500);
+    }
+    BOOST_CHECK_EQUAL(scope.allocate<double>(1), values + 100);
+  }
+
+  // the blocks do not grow after the first iteration
+  const std::size_t capacity = arena.capacity();
+  {
+    stl::arena_scope scope(arena);
+    scope.allocate<double>(100);
+    scope.allocate<double>(500);
+  }
+  BOOST_CHECK_EQUAL(arena.capacity(), capacity);
+}
+
+BOOST_AUTO_TEST_CASE(ARENA_Vector)
+{
+  stl::arena arena;
+  stl::arena_scope scope(arena);
+
+  stl::arena_vector<int> values(scope.allocator<int>());
+  values.reserve(10);
+  for(int i = 0; i < 1000; ++i)
+    values.push_back(i);
+
+  BOOST_CHECK_EQUAL(values.size(), 1000);
+  BOOST_CHECK_EQUAL(std::accumulate(values.begin(), values.end(), 0), 999 * 1000 / 2);
+
+  const stl::arena_vector<int> copy(values);
+  BOOST_CHECK(copy == values);
+  BOOST_CHECK(copy.get_allocator() == values.get_allocator());
+}
+
+BOOST_AUTO_TEST_CASE(ARENA_ThreadArena)
+{
+  const stl::arena* mainArena = &stl::thread_arena();
+  BOOST_CHECK_EQUAL(mainArena, &stl::thread_arena());
+
+  const stl::arena* otherArena = nullptr;
+  std::thread thread([&otherArena]() { otherArena = &stl::thread_arena(); });
+  thread.join();
+
+  BOOST_CHECK(otherArena != mainArena);
+}
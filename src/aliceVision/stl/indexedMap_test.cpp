@@ -0,0 +1,136 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "IndexedMap.hpp"
+
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE stlIndexedMap
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(INDEXED_MAP_InsertFindErase)
+{
+  stl::indexed_map<std::uint32_t, int> map;
+  std::map<std::uint32_t, int> reference;
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<std::uint32_t> keyDistribution(0, 5000);
+  std::uniform_int_distribution<int> operationDistribution(0, 3);
+
+  for(int i = 0; i < 100000; ++i)
+  {
+    const std::uint32_t key = keyDistribution(generator);
+    switch(operationDistribution(generator))
+    {
+      case 0:
+        BOOST_CHECK_EQUAL(map.insert(std::make_pair(key, i)).second, reference.insert(std::make_pair(key, i)).second);
+        break;
+      case 1:
+        map[key] = i;
+        reference[key] = i;
+        break;
+      case 2:
+        BOOST_CHECK_EQUAL(map.erase(key), reference.erase(key));
+        break;
+      case 3:
+        BOOST_CHECK_EQUAL(map.count(key), reference.count(key));
+        if(reference.count(key))
+          BOOST_CHECK_EQUAL(map.at(key), reference.at(key));
+        else
+          BOOST_CHECK(map.find(key) == map.end());
+        break;
+    }
+  }
+
+  BOOST_CHECK_EQUAL(map.size(), reference.size());
+  for(const auto& value : reference)
+  {
+    const auto it = map.find(value.first);
+    BOOST_REQUIRE(it != map.end());
+    BOOST_CHECK_EQUAL(it->first, value.first);
+    BOOST_CHECK_EQUAL(it->second, value.second);
+  }
+
+  BOOST_CHECK_THROW(map.at(10000), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(INDEXED_MAP_EraseWhileIterating)
+{
+  stl::indexed_map<std::uint32_t, int> map;
+  for(std::uint32_t i = 0; i < 1000; ++i)
+    map.emplace(i, static_cast<int>(i));
+
+  // remove odd values, each element is visited once
+  std::size_t nbVisited = 0;
+  for(auto it = map.begin(); it != map.end();)
+  {
+    ++nbVisited;
+    if(it->second % 2)
+      it = map.erase(it);
+    else
+      ++it;
+  }
+
+  BOOST_CHECK_EQUAL(nbVisited, 1000);
+  BOOST_CHECK_EQUAL(map.size(), 500);
+  for(std::uint32_t i = 0; i < 1000; ++i)
+    BOOST_CHECK_EQUAL(map.count(i), (i % 2) ? 0 : 1);
+}
+
+BOOST_AUTO_TEST_CASE(INDEXED_MAP_StableReferencesAndOrder)
+{
+  stl::indexed_map<std::uint32_t, int> map;
+  map[7] = 7;
+  int& first = map.at(7);
+
+  for(std::uint32_t i = 100; i > 8; --i)
+    map[i] = static_cast<int>(i);
+
+  // references are kept on insertion
+  BOOST_CHECK_EQUAL(&first, &map.at(7));
+
+  // iteration follows the insertion order
+  auto it = map.begin();
+  BOOST_CHECK_EQUAL(it->first, 7);
+  for(std::uint32_t i = 100; i > 8; --i)
+    BOOST_CHECK_EQUAL((++it)->first, i);
+}
+
+BOOST_AUTO_TEST_CASE(INDEXED_MAP_CopyAndCompare)
+{
+  typedef stl::indexed_map<std::uint32_t, Eigen::Vector4d, std::hash<std::uint32_t>,
+                           Eigen::aligned_allocator<std::pair<const std::uint32_t, Eigen::Vector4d> > > AlignedMap;
+
+  AlignedMap map;
+  for(std::uint32_t i = 0; i < 1000; ++i)
+    map[i * 3] = Eigen::Vector4d::Constant(i);
+
+  for(const auto& value : map)
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(value.second.data()) % 16, 0);
+
+  AlignedMap copy(map);
+  BOOST_CHECK(copy == map);
+
+  // same content in a different insertion order
+  AlignedMap reversed(map.rbegin(), map.rend());
+  BOOST_CHECK(reversed == map);
+
+  copy.erase(0);
+  BOOST_CHECK(copy != map);
+  BOOST_CHECK_EQUAL(copy.size(), 999);
+  BOOST_CHECK(copy.at(3) == Eigen::Vector4d::Constant(1));
+
+  AlignedMap moved(std::move(copy));
+  BOOST_CHECK(copy.empty());
+  BOOST_CHECK_EQUAL(moved.size(), 999);
+}
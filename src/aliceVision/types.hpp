@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <aliceVision/stl/IndexedMap.hpp>
+
 #include <Eigen/Core>
 
 #include <cstdint>
@@ -35,6 +37,9 @@ template<typename K, typename V>
 using HashMap = std::map<K, V, std::less<K>, Eigen::aligned_allocator<std::pair<const K,V> > >;
 #endif
 
+/// dense storage associative container for large maps of ids (see stl::indexed_map)
+template<typename K, typename V>
+using IndexedMap = stl::indexed_map<K, V, std::hash<K>, Eigen::aligned_allocator<std::pair<const K, V> > >;
 
 struct EstimationStatus
 {
@@ -0,0 +1,89 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/stl/IndexedMap.hpp>
+
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// landmark-like value: a position, a color and a few observations
+struct TestLandmark
+{
+  Eigen::Vector3d X;
+  std::uint8_t rgb[3];
+  std::vector<std::uint32_t> observations;
+};
+
+template <class Map>
+double benchmarkMap(const std::string& name, const std::vector<std::uint32_t>& ids, const std::vector<std::uint32_t>& queries)
+{
+  typedef std::chrono::steady_clock clock;
+
+  Map map;
+  auto start = clock::now();
+  for(std::uint32_t id : ids)
+  {
+    TestLandmark& landmark = map[id];
+    landmark.X = Eigen::Vector3d::Constant(id);
+    landmark.observations.assign(3, id);
+  }
+  const double insertTime = std::chrono::duration<double>(clock::now() - start).count();
+
+  start = clock::now();
+  double sum = 0.0;
+  for(int i = 0; i < 10; ++i)
+    for(const auto& landmark : map)
+      sum += landmark.second.X(0) + landmark.second.observations.size();
+  const double iterationTime = std::chrono::duration<double>(clock::now() - start).count();
+
+  start = clock::now();
+  for(std::uint32_t id : queries)
+    sum += map.find(id)->second.X(1);
+  const double lookupTime = std::chrono::duration<double>(clock::now() - start).count();
+
+  std::cout << name << " (" << map.size() << " landmarks): insert " << insertTime << " s, 10 iterations " << iterationTime
+            << " s, " << queries.size() << " lookups " << lookupTime << " s" << std::endl;
+  return sum;
+}
+
+} // namespace
+
+// iteration and lookup timings on landmarks, compared with the std::map based HashMap
+int main(int argc, char** argv)
+{
+  const std::size_t nbLandmarks = (argc > 1) ? std::stoul(argv[1]) : 1000000;
+
+  std::vector<std::uint32_t> ids(nbLandmarks);
+  for(std::size_t i = 0; i < nbLandmarks; ++i)
+    ids[i] = static_cast<std::uint32_t>(i * 7);
+
+  std::mt19937 generator(0);
+  std::shuffle(ids.begin(), ids.end(), generator);
+
+  std::vector<std::uint32_t> queries(ids);
+  std::shuffle(queries.begin(), queries.end(), generator);
+
+  typedef std::pair<const std::uint32_t, TestLandmark> Value;
+  const double mapChecksum = benchmarkMap<std::map<std::uint32_t, TestLandmark, std::less<std::uint32_t>, Eigen::aligned_allocator<Value> > >("std::map", ids, queries);
+  const double indexedMapChecksum = benchmarkMap<stl::indexed_map<std::uint32_t, TestLandmark, std::hash<std::uint32_t>, Eigen::aligned_allocator<Value> > >("stl::indexed_map", ids, queries);
+  if(mapChecksum != indexedMapChecksum)
+  {
+    std::cerr << "Different checksums: " << mapChecksum << " != " << indexedMapChecksum << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
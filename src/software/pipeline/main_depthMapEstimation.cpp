@@ -11,6 +11,7 @@
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/chunking.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/main.hpp>
@@ -23,7 +24,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -41,6 +42,9 @@ int aliceVision_main(int argc, char* argv[])
     // program range
     int rangeStart = -1;
     int rangeSize = -1;
+    mvsUtils::EChunkingMode chunkingMode = mvsUtils::EChunkingMode::INDEX;
+    std::string chunkManifestFilename;
+    std::string imagesSpecCacheFilename;
 
     // image downscale factor during process
     int downscale = 2;
@@ -90,6 +94,12 @@ int aliceVision_main(int argc, char* argv[])
             "Compute a sub-range of images from index rangeStart to rangeStart+rangeSize.")
         ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
             "Compute a sub-range of N images (N=rangeSize).")
+        ("chunkingMode", po::value<mvsUtils::EChunkingMode>(&chunkingMode)->default_value(chunkingMode),
+            std::string("Order of the cameras used by rangeStart / rangeSize. " + mvsUtils::EChunkingMode_informations()).c_str())
+        ("chunkManifest", po::value<std::string>(&chunkManifestFilename)->default_value(chunkManifestFilename),
+            "Write a JSON manifest of the chunks of rangeSize cameras (range, view ids and needed images) and exit.")
+        ("imagesSpecCache", po::value<std::string>(&imagesSpecCacheFilename)->default_value(imagesSpecCacheFilename),
+            "Image spec cache file, shared by the MVS nodes to avoid reading the same image headers again. Disabled if empty.")
         ("downscale", po::value<int>(&downscale)->default_value(downscale),
             "Image downscale factor.")
         ("minViewAngle", po::value<float>(&minViewAngle)->default_value(minViewAngle),
@@ -193,7 +203,7 @@ int aliceVision_main(int argc, char* argv[])
     }
 
     // initialization
-    mvsUtils::MultiViewParams mp(sfmData, imagesFolder, outputFolder, "", false, downscale);
+    mvsUtils::MultiViewParams mp(sfmData, imagesFolder, outputFolder, "", false, downscale, nullptr, imagesSpecCacheFilename);
 
     mp.setMinViewAngle(minViewAngle);
     mp.setMaxViewAngle(maxViewAngle);
@@ -220,12 +230,29 @@ int aliceVision_main(int argc, char* argv[])
     // intermediate results
     mp.userParams.put("depthMap.intermediateResults", exportIntermediateResults);
 
+    // camera processing order: concatenation of the chunks of rangeSize cameras
+    std::vector<int> camsOrder;
+    {
+        const int chunkSize = (rangeSize == -1) ? mp.ncams : rangeSize;
+        std::vector<std::vector<int>> chunksImages;
+        const std::vector<std::vector<int>> chunks = mvsUtils::computeChunks(mp, chunkingMode, chunkSize, std::max(sgmMaxTCams, refineMaxTCams),
+                                                                             chunkManifestFilename.empty() ? nullptr : &chunksImages);
+        if(!chunkManifestFilename.empty())
+        {
+            mvsUtils::writeChunksManifest(chunkManifestFilename, mp, chunkingMode, chunks, chunksImages);
+            ALICEVISION_LOG_INFO("Chunk manifest written: " << chunkManifestFilename);
+            return EXIT_SUCCESS;
+        }
+        for(const std::vector<int>& chunk : chunks)
+            camsOrder.insert(camsOrder.end(), chunk.begin(), chunk.end());
+    }
+
     std::vector<int> cams;
     cams.reserve(mp.ncams);
     if(rangeSize == -1)
     {
       for(int rc = 0; rc < mp.ncams; ++rc) // process all cameras
-        cams.push_back(rc);
+        cams.push_back(camsOrder[rc]);
     }
     else
     {
@@ -235,7 +262,7 @@ int aliceVision_main(int argc, char* argv[])
         return EXIT_FAILURE;
       }
       for(int rc = rangeStart; rc < std::min(rangeStart + rangeSize, mp.ncams); ++rc)
-        cams.push_back(rc);
+        cams.push_back(camsOrder[rc]);
       if(cams.empty())
       {
         ALICEVISION_LOG_INFO("No camera to process.");
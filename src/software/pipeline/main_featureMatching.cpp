@@ -142,7 +142,7 @@ int aliceVision_main(int argc, char **argv)
     ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
       feature::EImageDescriberType_informations().c_str())
     ("imagePairsList,l", po::value<std::vector<std::string>>(&predefinedPairList)->multitoken(),
-      "Path(s) to one or more files which contain the list of image pairs to match.")
+      "Path(s) to one or more files which contain the list of image pairs to match (text or binary pair list).")
     ("photometricMatchingMethod,p", po::value<std::string>(&nearestMatchingMethod)->default_value(nearestMatchingMethod),
       "For Scalar based regions descriptor:\n"
       "* BRUTE_FORCE_L2: L2 BruteForce matching\n"
@@ -7,6 +7,7 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/sfm/FrustumFilter.hpp>
+#include <aliceVision/matchingImageCollection/pairBuilder.hpp>
 #include <aliceVision/voctree/Database.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 #include <aliceVision/voctree/databaseIO.hpp>
@@ -14,6 +15,7 @@
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <Eigen/Core>
 
@@ -30,7 +32,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 static const int DIMENSION = 128;
 
@@ -50,15 +52,9 @@ using aliceVision::IndexT;
 // just a list of doc id
 typedef std::vector<ImageID> ListOfImageID;
 
-// An ordered and unique list of doc id
-typedef std::set<ImageID> OrderedListOfImageID;
-
 // For each image ID it contains the  list of matching imagess
 typedef std::map<ImageID, ListOfImageID> PairList;
 
-// For each image ID it contains the ordered list of matching images
-typedef std::map<ImageID, OrderedListOfImageID> OrderedPairList;
-
 /**
  * @brief Function that prints a PairList
  * @param os The stream on which to print
@@ -80,19 +76,21 @@ std::ostream& operator<<(std::ostream& os, const PairList & pl)
 }
 
 /**
- * @brief Function that prints a OrderedPairList
+ * @brief Function that prints sorted pairs as a text pair list:
+ * one line per image with the list of images paired with it (I J K L)
  * @param os The stream on which to print
- * @param pl The pair list
+ * @param pairs The sorted pairs (see sortUniquePairs)
  * @return the stream
  */
-std::ostream& operator<<(std::ostream& os, const OrderedPairList & pl)
+std::ostream& writePairList(std::ostream& os, const PairVec& pairs)
 {
-  for(OrderedPairList::const_iterator plIter = pl.begin(); plIter != pl.end(); ++plIter)
+  for(std::size_t i = 0; i < pairs.size();)
   {
-    os << plIter->first;
-    for(ImageID id : plIter->second)
+    const IndexT imageId = pairs[i].first;
+    os << imageId;
+    for(; i < pairs.size() && pairs[i].first == imageId; ++i)
     {
-      os << " " << id;
+      os << " " << pairs[i].second;
     }
     os << "\n";
   }
@@ -181,7 +179,7 @@ std::string EImageMatchingMode_description()
   return "The mode to combine image matching between the input SfMData A and B: \n"
              "* a/a+a/b : A with A + A with B\n"
              "* a/ab    : A with A and B\n"
-             "* a/b     : A with B\n"
+             "* a/b     : A with B (e.g. to merge the reconstruction of B into A with sfmMerge)\n"
              "* a/a     : A with A";
 }
 
@@ -228,19 +226,24 @@ std::string EImageMatchingMode_enumToString(EImageMatchingMode modeMultiSfM)
  *
  * @param[in] allMatches A pairlist containing all the matching images for each image of the dataset
  * @param[in] numMatches The maximum number of matching images to consider for each image (if 0, consider all matches)
- * @param[out] matches A processed version of allMatches that consider only the first numMatches without repetitions
+ * @param[in,out] outPairs The pairs of the first numMatches of each image without repetitions are appended
  */
-void convertAllMatchesToPairList(const PairList &allMatches, std::size_t numMatches, OrderedPairList &outPairList)
+void convertAllMatchesToPairList(const PairList &allMatches, std::size_t numMatches, PairVec &outPairs)
 {
-  outPairList.clear();
-
   if(numMatches == 0)
     numMatches = allMatches.size();  // disable image matching limit
 
+  // the selection of an image depends on the selections of the lower image IDs:
+  // it is done in order, in flat sorted lists, and only the output is filled in parallel
+  std::vector<ImageID> imageIds;
+  std::vector<ListOfImageID> bestMatchesPerImage;
+  imageIds.reserve(allMatches.size());
+  bestMatchesPerImage.reserve(allMatches.size());
+
   for(const auto& match : allMatches)
   {
-    ImageID currImageId = match.first;
-    OrderedListOfImageID bestMatches;
+    const ImageID currImageId = match.first;
+    ListOfImageID bestMatches; // sorted
 
     for(const ImageID currMatchId : match.second)
     {
@@ -248,36 +251,47 @@ void convertAllMatchesToPairList(const PairList &allMatches, std::size_t numMatc
       if(currMatchId == currImageId)
         continue;
 
-      // if the currMatchId ID is lower than the current image ID and
-      // the current image ID is not already in the list of currMatchId
-      //BOOST_ASSERT( ( currMatchId < currImageId ) && ( outPairList.find( currMatchId ) != outPairList.end() ) );
+      // if the currMatchId ID is lower than the current image ID,
+      // only add it if the current image ID is not already in the list of currMatchId
       if(currMatchId < currImageId)
       {
-        OrderedPairList::const_iterator currMatches = outPairList.find(currMatchId);
-        if(currMatches != outPairList.end() &&
-                currMatches->second.find(currImageId) == currMatches->second.end())
-        {
-          // then add it to the list
-          bestMatches.insert(currMatchId);
-        }
-      }
-      else
-      {
-        bestMatches.insert(currMatchId);
+        const auto itImage = std::lower_bound(imageIds.begin(), imageIds.end(), currMatchId);
+        if(itImage == imageIds.end() || *itImage != currMatchId)
+          continue;
+
+        const ListOfImageID& currMatches = bestMatchesPerImage[itImage - imageIds.begin()];
+        if(currMatches.empty() || std::binary_search(currMatches.begin(), currMatches.end(), currImageId))
+          continue;
       }
 
+      const auto itMatch = std::lower_bound(bestMatches.begin(), bestMatches.end(), currMatchId);
+      if(itMatch == bestMatches.end() || *itMatch != currMatchId)
+        bestMatches.insert(itMatch, currMatchId);
+
       // stop if numMatches is satisfied
       if(bestMatches.size() == numMatches)
         break;
     }
 
-    // fill the output if we have matches
-    if(!bestMatches.empty())
-      outPairList[currImageId] = bestMatches;
+    imageIds.push_back(currImageId);
+    bestMatchesPerImage.push_back(std::move(bestMatches));
+  }
+
+  std::vector<std::size_t> offsets(imageIds.size() + 1, outPairs.size());
+  for(std::size_t i = 0; i < imageIds.size(); ++i)
+    offsets[i + 1] = offsets[i] + bestMatchesPerImage[i].size();
+  outPairs.resize(offsets.back());
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(imageIds.size()); ++i)
+  {
+    const ListOfImageID& bestMatches = bestMatchesPerImage[i];
+    for(std::size_t j = 0; j < bestMatches.size(); ++j)
+      outPairs[offsets[i] + j] = Pair(static_cast<IndexT>(imageIds[i]), static_cast<IndexT>(bestMatches[j]));
   }
 }
 
-void generateSequentialMatches(const sfmData::SfMData& sfmData, size_t nbMatches, OrderedPairList& outPairList)
+void generateSequentialMatches(const sfmData::SfMData& sfmData, size_t nbMatches, PairVec& outPairs)
 {
     std::vector<std::pair<std::string, IndexT>> sortedImagePaths;
     sortedImagePaths.reserve(sfmData.getViews().size());
@@ -286,62 +300,61 @@ void generateSequentialMatches(const sfmData::SfMData& sfmData, size_t nbMatches
         sortedImagePaths.emplace_back(vIt.second->getImagePath(), vIt.first);
     }
     std::sort(sortedImagePaths.begin(), sortedImagePaths.end());
-    for(size_t i = 0; i < sortedImagePaths.size(); ++i)
+
+    // each image is paired with its nbMatches next images
+    const std::size_t nbImages = sortedImagePaths.size();
+    std::vector<std::size_t> offsets(nbImages + 1, outPairs.size());
+    for(size_t i = 0; i < nbImages; ++i)
+        offsets[i + 1] = offsets[i] + std::min(nbMatches, nbImages - i - 1);
+    outPairs.resize(offsets.back());
+
+    #pragma omp parallel for
+    for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nbImages); ++i)
     {
-        for(size_t n = i+1, nMax = std::min(i+nbMatches+1, sortedImagePaths.size()); n < nMax; ++n)
-        {
-            size_t a = sortedImagePaths[i].second;
-            size_t b = sortedImagePaths[n].second;
-            outPairList[std::min(a, b)].insert(std::max(a, b));
-        }
+        for(size_t n = 0; n < offsets[i + 1] - offsets[i]; ++n)
+            outPairs[offsets[i] + n] = Pair(sortedImagePaths[i].second, sortedImagePaths[i + 1 + n].second);
     }
 }
 
-void generateAllMatchesInOneMap(const std::map<IndexT, std::string>& descriptorsFiles, OrderedPairList& outPairList)
+void generateAllMatchesInOneMap(const std::map<IndexT, std::string>& descriptorsFiles, PairVec& outPairs)
 {
-  for(const auto& descItA: descriptorsFiles)
-  {
-    const IndexT imgA = descItA.first;
-    OrderedListOfImageID outPerImg;
+  std::vector<IndexT> imageIds;
+  imageIds.reserve(descriptorsFiles.size());
+  for(const auto& descIt: descriptorsFiles)
+    imageIds.push_back(descIt.first);
 
-    for(const auto& descItB: descriptorsFiles)
-    {
-      const IndexT imgB = descItB.first;
-      if(imgB > imgA)
-        outPerImg.insert(imgB);
-    }
-
-    if(!outPerImg.empty())
-    {
-      OrderedPairList::iterator itFind = outPairList.find(imgA);
+  // upper diagonal of the matrix: the row i has (n - i - 1) pairs
+  const std::size_t n = imageIds.size();
+  const std::size_t begin = outPairs.size();
+  outPairs.resize(begin + n * (n - 1) / 2);
 
-      if(itFind == outPairList.end())
-        outPairList[imgA] = outPerImg;
-      else
-        itFind->second.insert(outPerImg.begin(), outPerImg.end());
-    }
+  #pragma omp parallel for
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(n); ++i)
+  {
+    const std::size_t rowOffset = begin + i * n - i * (i + 1) / 2;
+    for(std::size_t j = i + 1; j < n; ++j)
+      outPairs[rowOffset + j - i - 1] = Pair(imageIds[i], imageIds[j]);
   }
 }
 
-void generateAllMatchesBetweenTwoMap(const std::map<IndexT, std::string>& descriptorsFilesA, const std::map<IndexT, std::string>& descriptorsFilesB, OrderedPairList& outPairList)
+void generateAllMatchesBetweenTwoMap(const std::map<IndexT, std::string>& descriptorsFilesA, const std::map<IndexT, std::string>& descriptorsFilesB, PairVec& outPairs)
 {
+  std::vector<IndexT> imageIdsA, imageIdsB;
+  imageIdsA.reserve(descriptorsFilesA.size());
+  imageIdsB.reserve(descriptorsFilesB.size());
   for(const auto& descItA: descriptorsFilesA)
-  {
-    const IndexT imgA = descItA.first;
-    OrderedListOfImageID outPerImg;
-
-    for(const auto& descItB: descriptorsFilesB)
-      outPerImg.insert(descItB.first);
+    imageIdsA.push_back(descItA.first);
+  for(const auto& descItB: descriptorsFilesB)
+    imageIdsB.push_back(descItB.first);
 
-    if(!outPerImg.empty())
-    {
-      OrderedPairList::iterator itFind = outPairList.find(imgA);
+  const std::size_t begin = outPairs.size();
+  outPairs.resize(begin + imageIdsA.size() * imageIdsB.size());
 
-      if(itFind == outPairList.end())
-        outPairList[imgA] = outPerImg;
-      else
-        itFind->second.insert(outPerImg.begin(), outPerImg.end());
-    }
+  #pragma omp parallel for
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(imageIdsA.size()); ++i)
+  {
+    for(std::size_t j = 0; j < imageIdsB.size(); ++j)
+      outPairs[begin + i * imageIdsB.size() + j] = Pair(imageIdsA[i], imageIdsB[j]);
   }
 }
 
@@ -410,7 +423,7 @@ void generateFromVoctree(PairList& allMatches,
 
 void conditionVocTree(const std::string& treeName, bool withWeights, const std::string& weightsName, const EImageMatchingMode matchingMode, const std::vector<std::string>& featuresFolders,
                       const sfmData::SfMData& sfmDataA, std::size_t nbMaxDescriptors, const std::string& sfmDataFilenameA, const sfmData::SfMData& sfmDataB, const std::string& sfmDataFilenameB,
-                      bool useMultiSfM, const std::map<IndexT, std::string>& descriptorsFilesA, std::size_t numImageQuery, OrderedPairList& selectedPairs)
+                      bool useMultiSfM, const std::map<IndexT, std::string>& descriptorsFilesA, std::size_t numImageQuery, PairVec& selectedPairs)
 {
     if(treeName.empty())
     {
@@ -556,6 +569,8 @@ int aliceVision_main(int argc, char** argv)
   std::vector<std::string> featuresFolders;
   /// the file in which to save the results
   std::string outputFile;
+  /// write the results in the binary pair list format
+  bool outputBinary = false;
 
   // user optional parameters
   EImageMatchingMethod method = EImageMatchingMethod::VOCABULARYTREE;
@@ -625,7 +640,9 @@ int aliceVision_main(int argc, char** argv)
       "Input file path of the vocabulary tree. This file can be generated by 'createVoctree'. "
       "This software is intended to be used with a generic, pre-trained vocabulary tree.")
     ("weights,w", po::value<std::string>(&weightsFilepath)->default_value(weightsFilepath),
-      "Input name for the vocabulary tree weight file, if not provided all voctree leaves will have the same weight.");
+      "Input name for the vocabulary tree weight file, if not provided all voctree leaves will have the same weight.")
+    ("outputBinary", po::value<bool>(&outputBinary)->default_value(outputBinary),
+      "Write the list of image pairs in a binary file, smaller and faster to load by ranges in featureMatching.");
 
   po::options_description multiSfMParams("Multiple SfM");
   multiSfMParams.add_options()
@@ -711,7 +728,7 @@ int aliceVision_main(int argc, char** argv)
     }
   }
 
-  OrderedPairList selectedPairs;
+  PairVec selectedPairs;
 
   std::map<IndexT, std::string> descriptorsFilesA, descriptorsFilesB;
 
@@ -769,14 +786,15 @@ int aliceVision_main(int argc, char** argv)
       // For all cameras with valid extrinsic/intrinsic, we select the camera with common visibilities based on cameras' frustum.
       // We use an epsilon near value for the frustum, to ensure that mulitple images with a pure rotation will not intersect at the nodal point.
       PairSet pairs = sfm::FrustumFilter(sfmDataA, 0.01).getFrustumIntersectionPairs();
-      for(const auto& p: pairs)
-      {
-          selectedPairs[p.first].insert(p.second);
-      }
+      selectedPairs.insert(selectedPairs.end(), pairs.begin(), pairs.end());
       break;
     }
   }
 
+  // order the pairs (I < J) and remove the duplicates between the methods
+  sortUniquePairs(selectedPairs);
+  ALICEVISION_LOG_INFO("Number of selected image pairs: " << selectedPairs.size());
+
   // check if the output folder exists
   const auto basePath = fs::path(outputFile).parent_path();
   if(!basePath.empty() && !fs::exists(basePath))
@@ -790,10 +808,21 @@ int aliceVision_main(int argc, char** argv)
   }
 
   // write it to file
-  std::ofstream fileout;
-  fileout.open(outputFile, std::ofstream::out);
-  fileout << selectedPairs;
-  fileout.close();
+  if(outputBinary)
+  {
+    if(!savePairsBinary(outputFile, selectedPairs))
+    {
+      ALICEVISION_LOG_ERROR("Unable to save the pair list: " << outputFile);
+      return EXIT_FAILURE;
+    }
+  }
+  else
+  {
+    std::ofstream fileout;
+    fileout.open(outputFile, std::ofstream::out);
+    writePairList(fileout, selectedPairs);
+    fileout.close();
+  }
 
   ALICEVISION_LOG_INFO("pairList exported in: " << outputFile);
 
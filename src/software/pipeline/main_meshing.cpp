@@ -28,7 +28,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 3
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -140,6 +140,7 @@ int aliceVision_main(int argc, char* argv[])
     std::string outputDensePointCloud;
     std::string depthMapsFolder;
     std::string depthMapsFilterFolder;
+    std::string imagesSpecCacheFilename;
     EPartitioningMode partitioningMode = ePartitioningSingleBlock;
     ERepartitionMode repartitionMode = eRepartitionMultiResolution;
     std::size_t estimateSpaceMinObservations = 3;
@@ -171,6 +172,8 @@ int aliceVision_main(int argc, char* argv[])
             "Input depth maps folder.")
         ("depthMapsFilterFolder", po::value<std::string>(&depthMapsFilterFolder),
             "Input filtered depth maps folder.")
+        ("imagesSpecCache", po::value<std::string>(&imagesSpecCacheFilename)->default_value(imagesSpecCacheFilename),
+            "Image spec cache file, shared by the MVS nodes to avoid reading the same image headers again. Disabled if empty.")
         ("maxInputPoints", po::value<int>(&fuseParams.maxInputPoints)->default_value(fuseParams.maxInputPoints),
             "Max input points loaded from images.")
         ("maxPoints", po::value<int>(&fuseParams.maxPoints)->default_value(fuseParams.maxPoints),
@@ -290,7 +293,7 @@ int aliceVision_main(int argc, char* argv[])
     }
 
     // initialization
-    mvsUtils::MultiViewParams mp(sfmData, "", depthMapsFolder, depthMapsFilterFolder, meshingFromDepthMaps);
+    mvsUtils::MultiViewParams mp(sfmData, "", depthMapsFolder, depthMapsFilterFolder, meshingFromDepthMaps, 1, nullptr, imagesSpecCacheFilename);
 
     mp.userParams.put("LargeScale.universePercentile", universePercentile);
 
@@ -529,7 +532,8 @@ int aliceVision_main(int argc, char* argv[])
 
     removeLandmarksWithoutObservations(densePointCloud);
     ALICEVISION_LOG_INFO("Save dense point cloud.");
-    sfmDataIO::Save(densePointCloud, outputDensePointCloud, sfmDataIO::ESfMData::ALL_DENSE);
+    // large cloud: binary PLY with the visibility of each point if the output is a .ply file
+    sfmDataIO::Save(densePointCloud, outputDensePointCloud, sfmDataIO::ESfMData::ALL_DENSE, true, true);
 
     ALICEVISION_LOG_INFO("Save obj mesh file.");
     mesh->saveToObj(outputMesh);
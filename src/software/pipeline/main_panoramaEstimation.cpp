@@ -24,6 +24,7 @@
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 
+#include <algorithm>
 #include <cstdlib>
 
 // These constants define the current software version.
@@ -43,6 +44,17 @@ inline std::istream& operator>>(std::istream& in, std::pair<int, int>& out)
     return in;
 }
 
+/**
+ * @brief Get the rotation of the pose with the smallest id, used as reference
+ *        (the poses are stored in insertion order, not sorted by id)
+ */
+Eigen::Matrix3d getReferencePoseRotation(const sfmData::Poses& poses)
+{
+  const auto it = std::min_element(poses.begin(), poses.end(),
+                                   [](const sfmData::Poses::value_type& a, const sfmData::Poses::value_type& b) { return a.first < b.first; });
+  return it->second.getTransform().rotation();
+}
+
 int aliceVision_main(int argc, char **argv)
 {
   // command-line parameters
@@ -179,7 +191,7 @@ int aliceVision_main(int argc, char **argv)
   Eigen::Matrix3d ref_R_base = Eigen::Matrix3d::Identity();
   if (!initial_poses.empty()) { 
     
-    ref_R_base = initial_poses.begin()->second.getTransform().rotation();
+    ref_R_base = getReferencePoseRotation(initial_poses);
   }
 
   // get describerTypes
@@ -261,7 +273,7 @@ int aliceVision_main(int argc, char **argv)
   sfmData::Poses & final_poses = outSfmData.getPoses();
   if (!final_poses.empty()) { 
     
-    Eigen::Matrix3d ref_R_current = final_poses.begin()->second.getTransform().rotation();
+    Eigen::Matrix3d ref_R_current = getReferencePoseRotation(final_poses);
     Eigen::Matrix3d R_restore = ref_R_current.transpose() * ref_R_base;
     
     for (auto & pose : outSfmData.getPoses()) {    
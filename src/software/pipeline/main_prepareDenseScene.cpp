@@ -10,12 +10,16 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/stl/hash.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/progress.hpp>
 
+#include <algorithm>
 #include <stdlib.h>
 #include <stdio.h>
 #include <cmath>
@@ -27,7 +31,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -38,6 +42,74 @@ using namespace aliceVision::sfmData;
 namespace po = boost::program_options;
 namespace fs = boost::filesystem;
 
+/**
+ * @brief Undistort and exposure compensate an image in a single pass
+ * @param[in] image the input image
+ * @param[in] cam the camera intrinsics
+ * @param[in] exposureCompensation the exposure compensation factor
+ * @param[out] image_ud the output image
+ */
+void undistortAndCompensateImage(const Image<RGBfColor>& image,
+                                 const IntrinsicBase* cam,
+                                 float exposureCompensation,
+                                 Image<RGBfColor>& image_ud)
+{
+  const bool undistort = cam->isValid() && cam->have_disto();
+
+  image_ud.resize(image.Width(), image.Height(), true, FBLACK);
+  const image::Sampler2d<image::SamplerLinear> sampler;
+
+  #pragma omp parallel for
+  for(int j = 0; j < image.Height(); ++j)
+    for(int i = 0; i < image.Width(); ++i)
+    {
+      if(!undistort)
+      {
+        image_ud(j, i) = image(j, i) * exposureCompensation;
+        continue;
+      }
+
+      // compute coordinates with distortion
+      const Vec2 disto_pix = cam->get_d_pixel(Vec2(i, j));
+
+      // pick pixel if it is in the image domain
+      if(image.Contains(disto_pix(1), disto_pix(0)))
+        image_ud(j, i) = sampler(image, disto_pix(1), disto_pix(0)) * exposureCompensation;
+    }
+}
+
+/**
+ * @brief Compute the hash of everything used to export a view image:
+ *        the source image file, the camera intrinsics and pose and the export options
+ */
+std::size_t computeExportHash(const std::string& srcImage,
+                              const IntrinsicBase* cam,
+                              const Mat34& P,
+                              image::EImageFileType outputFileType,
+                              bool saveMetadata,
+                              bool saveMipmaps,
+                              bool evCorrection,
+                              float ev,
+                              float exposureCompensation)
+{
+  std::size_t seed = 0;
+  stl::hash_combine(seed, fs::canonical(srcImage).string());
+  stl::hash_combine(seed, fs::file_size(srcImage));
+  stl::hash_combine(seed, fs::last_write_time(srcImage));
+  stl::hash_combine(seed, cam->hashValue());
+  stl::hash_combine(seed, static_cast<int>(outputFileType));
+  stl::hash_combine(seed, saveMetadata);
+  stl::hash_combine(seed, saveMipmaps);
+  // the exposure values are always written in the output metadata
+  stl::hash_combine(seed, evCorrection);
+  stl::hash_combine(seed, ev);
+  stl::hash_combine(seed, exposureCompensation);
+  if(saveMetadata)
+    for(int i = 0; i < P.size(); ++i)
+      stl::hash_combine(seed, P(i));
+  return seed;
+}
+
 bool prepareDenseScene(const SfMData& sfmData,
                        const std::vector<std::string>& imagesFolders,
                        int beginIndex,
@@ -46,10 +118,13 @@ bool prepareDenseScene(const SfMData& sfmData,
                        image::EImageFileType outputFileType,
                        bool saveMetadata,
                        bool saveMatricesFiles,
-                       bool evCorrection)
+                       bool evCorrection,
+                       bool saveMipmaps,
+                       bool skipUnchanged,
+                       int maxThreads)
 {
   // defined view Ids
-  std::set<IndexT> viewIds;
+  std::vector<IndexT> viewIds;
 
   sfmData::Views::const_iterator itViewBegin = sfmData.getViews().begin();
   sfmData::Views::const_iterator itViewEnd = sfmData.getViews().end();
@@ -68,13 +143,17 @@ bool prepareDenseScene(const SfMData& sfmData,
     const View* view = it->second.get();
     if (!sfmData.isPoseAndIntrinsicDefined(view))
       continue;
-    viewIds.insert(view->getViewId());
+    viewIds.push_back(view->getViewId());
   }
 
   if((outputFileType != image::EImageFileType::EXR) && saveMetadata)
     ALICEVISION_LOG_WARNING("Cannot save informations in images metadata.\n"
                             "Choose '.exr' file type if you want AliceVision custom metadata");
 
+  if((outputFileType != image::EImageFileType::EXR) && saveMipmaps)
+    ALICEVISION_LOG_WARNING("Cannot save resolution levels in images.\n"
+                            "Choose '.exr' file type if you want to save mipmapped images");
+
   // export data
   boost::progress_display progressBar(viewIds.size(), std::cout, "Exporting Scene Undistorted Images\n");
 
@@ -82,36 +161,73 @@ bool prepareDenseScene(const SfMData& sfmData,
   const float medianCameraExposure = sfmData.getMedianCameraExposureSetting();
   ALICEVISION_LOG_INFO("Median Camera Exposure: " << medianCameraExposure << ", Median EV: " << std::log2(1.0f/medianCameraExposure));
 
-#pragma omp parallel for num_threads(3)
-  for(int i = 0; i < viewIds.size(); ++i)
+  // images are exported in parallel, within the available memory
+  std::size_t nbThreads = omp_get_num_procs();
   {
-    auto itView = viewIds.begin();
-    std::advance(itView, i);
+    // input image, undistorted image and half float conversion buffer
+    std::size_t jobMaxMemoryConsumption = 0;
+    for(const IndexT viewId : viewIds)
+    {
+      const View& view = sfmData.getView(viewId);
+      const std::size_t imageMemory = std::size_t(view.getWidth()) * std::size_t(view.getHeight()) * sizeof(RGBfColor);
+      jobMaxMemoryConsumption = std::max(jobMaxMemoryConsumption, 3 * imageMemory);
+    }
 
-    const IndexT viewId = *itView;
-    const View* view = sfmData.getViews().at(viewId).get();
+    const system::MemoryInfo memoryInformation = system::getMemoryInfo();
+
+    ALICEVISION_LOG_DEBUG("Job max memory consumption: " << jobMaxMemoryConsumption << " B");
+    ALICEVISION_LOG_DEBUG("Memory information: " << std::endl << memoryInformation);
+
+    if(memoryInformation.freeRam == 0)
+    {
+      ALICEVISION_LOG_WARNING("Cannot find available system memory, this can be due to OS limitations.\n"
+                              "Use only one thread for image export.");
+      nbThreads = 1;
+    }
+    else if(jobMaxMemoryConsumption > 0)
+    {
+      nbThreads = std::min(nbThreads, static_cast<std::size_t>((0.9 * memoryInformation.freeRam) / jobMaxMemoryConsumption));
+    }
 
-    Intrinsics::const_iterator iterIntrinsic = sfmData.getIntrinsics().find(view->getIntrinsicId());
+    // nbThreads should not be higher than user maxThreads param
+    if(maxThreads > 0)
+      nbThreads = std::min(static_cast<std::size_t>(maxThreads), nbThreads);
 
-    //we have a valid view with a corresponding camera & pose
-    const std::string baseFilename = std::to_string(viewId);
+    // nbThreads should not be higher than the job number
+    nbThreads = std::max(std::size_t(1), std::min(viewIds.size(), nbThreads));
 
-    // get metadata from source image to be sure we get all metadata. We don't use the metadatas from the Views inside the SfMData to avoid type conversion problems with string maps.
-    std::string srcImage = view->getImagePath();
-    oiio::ParamValueList metadata = image::readImageMetadata(srcImage);
+    ALICEVISION_LOG_INFO("Export " << viewIds.size() << " images using " << nbThreads << " thread(s).");
+  }
 
-    // export camera
-    if(saveMetadata || saveMatricesFiles)
+  int nbSkipped = 0;
+  std::vector<char> failedViews(viewIds.size(), 0);
+
+  #pragma omp parallel for num_threads(nbThreads) schedule(dynamic)
+  for(int i = 0; i < viewIds.size(); ++i)
+  {
+    const IndexT viewId = viewIds.at(i);
+    const View* view = sfmData.getViews().at(viewId).get();
+
+    try
     {
+      Intrinsics::const_iterator iterIntrinsic = sfmData.getIntrinsics().find(view->getIntrinsicId());
+      const IntrinsicBase* cam = iterIntrinsic->second.get();
+
+      //we have a valid view with a corresponding camera & pose
+      const std::string baseFilename = std::to_string(viewId);
+
       // get camera pose / projection
       const Pose3 pose = sfmData.getPose(*view).getTransform();
-      Mat34 P = iterIntrinsic->second.get()->get_projective_equivalent(pose);
+      const Mat34 P = cam->get_projective_equivalent(pose);
 
       // get camera intrinsics matrices
-      const Mat3 K = dynamic_cast<const Pinhole*>(sfmData.getIntrinsicPtr(view->getIntrinsicId()))->K();
+      Mat3 K = Mat3::Identity();
+      if(saveMetadata || saveMatricesFiles)
+        K = dynamic_cast<const Pinhole*>(cam)->K();
       const Mat3& R = pose.rotation();
       const Vec3& t = pose.translation();
 
+      // export camera
       if(saveMatricesFiles)
       {
         std::ofstream fileP((fs::path(outFolder) / (baseFilename + "_P.txt")).string());
@@ -135,36 +251,9 @@ bool prepareDenseScene(const SfMData& sfmData,
         fileKRt.close();
       }
 
-      if(saveMetadata)
-      {
-        // convert to 44 matix
-        Mat4 projectionMatrix;
-        projectionMatrix << P(0, 0), P(0, 1), P(0, 2), P(0, 3),
-                            P(1, 0), P(1, 1), P(1, 2), P(1, 3),
-                            P(2, 0), P(2, 1), P(2, 2), P(2, 3),
-                                  0,       0,       0,       1;
-
-        // convert matrices to rowMajor
-        std::vector<double> vP(projectionMatrix.size());
-        std::vector<double> vK(K.size());
-        std::vector<double> vR(R.size());
-
-        typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXd;
-        Eigen::Map<RowMatrixXd>(vP.data(), projectionMatrix.rows(), projectionMatrix.cols()) = projectionMatrix;
-        Eigen::Map<RowMatrixXd>(vK.data(), K.rows(), K.cols()) = K;
-        Eigen::Map<RowMatrixXd>(vR.data(), R.rows(), R.cols()) = R;
+      // find the source image
+      std::string srcImage = view->getImagePath();
 
-        // add metadata
-        metadata.push_back(oiio::ParamValue("AliceVision:downscale", 1));
-        metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, vP.data()));
-        metadata.push_back(oiio::ParamValue("AliceVision:K", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vK.data()));
-        metadata.push_back(oiio::ParamValue("AliceVision:R", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vR.data()));
-        metadata.push_back(oiio::ParamValue("AliceVision:t", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::VEC3), 1, t.data()));
-      }
-    }
-
-    // export undistort image
-    {      
       if(!imagesFolders.empty())
       {
         bool found = false;
@@ -188,47 +277,108 @@ bool prepareDenseScene(const SfMData& sfmData,
           throw std::runtime_error("Cannot find view " + std::to_string(view->getViewId()) + " image file in given folder(s)");
       }
 
-
       const std::string dstColorImage = (fs::path(outFolder) / (baseFilename + "." + image::EImageFileType_enumToString(outputFileType))).string();
-      const IntrinsicBase* cam = iterIntrinsic->second.get();
-      Image<RGBfColor> image, image_ud;
 
-      readImage(srcImage, image, image::EImageColorSpace::LINEAR);
+      // exposure values
+      const float cameraExposure = view->getCameraExposureSetting();
+      const float ev = std::log2(1.0 / cameraExposure);
+      const float exposureCompensation = medianCameraExposure / cameraExposure;
+      const float imageExposureCompensation = evCorrection ? exposureCompensation : 1.0f;
+
+      // skip the image export if the existing output has been exported from the same inputs
+      const std::string exportHash = std::to_string(computeExportHash(srcImage, cam, P, outputFileType, saveMetadata, saveMipmaps, evCorrection, ev, exposureCompensation));
+
+      if(skipUnchanged && fs::exists(dstColorImage))
+      {
+        const oiio::ParamValueList dstMetadata = image::readImageMetadata(dstColorImage);
+        if(dstMetadata.get_string("AliceVision:exportHash") == exportHash)
+        {
+          ALICEVISION_LOG_DEBUG("View: " << viewId << ", skip unchanged image: " << dstColorImage);
+          #pragma omp atomic
+          ++nbSkipped;
+          #pragma omp critical
+          ++progressBar;
+          continue;
+        }
+      }
+
+      // get metadata from source image to be sure we get all metadata. We don't use the metadatas from the Views inside the SfMData to avoid type conversion problems with string maps.
+      oiio::ParamValueList metadata = image::readImageMetadata(srcImage);
+
+      if(saveMetadata)
+      {
+        // convert to 44 matix
+        Mat4 projectionMatrix;
+        projectionMatrix << P(0, 0), P(0, 1), P(0, 2), P(0, 3),
+                            P(1, 0), P(1, 1), P(1, 2), P(1, 3),
+                            P(2, 0), P(2, 1), P(2, 2), P(2, 3),
+                                  0,       0,       0,       1;
+
+        // convert matrices to rowMajor
+        std::vector<double> vP(projectionMatrix.size());
+        std::vector<double> vK(K.size());
+        std::vector<double> vR(R.size());
+
+        typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXd;
+        Eigen::Map<RowMatrixXd>(vP.data(), projectionMatrix.rows(), projectionMatrix.cols()) = projectionMatrix;
+        Eigen::Map<RowMatrixXd>(vK.data(), K.rows(), K.cols()) = K;
+        Eigen::Map<RowMatrixXd>(vR.data(), R.rows(), R.cols()) = R;
+
+        // add metadata
+        metadata.push_back(oiio::ParamValue("AliceVision:downscale", 1));
+        metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, vP.data()));
+        metadata.push_back(oiio::ParamValue("AliceVision:K", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vK.data()));
+        metadata.push_back(oiio::ParamValue("AliceVision:R", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vR.data()));
+        metadata.push_back(oiio::ParamValue("AliceVision:t", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::VEC3), 1, t.data()));
+      }
 
       // add exposure values to images metadata
-      float cameraExposure = view->getCameraExposureSetting();
-      float ev = std::log2(1.0 / cameraExposure);
-      float exposureCompensation = medianCameraExposure / cameraExposure;
       metadata.push_back(oiio::ParamValue("AliceVision:EV", ev));
       metadata.push_back(oiio::ParamValue("AliceVision:EVComp", exposureCompensation));
+      metadata.push_back(oiio::ParamValue("AliceVision:exportHash", exportHash));
 
-      //exposure correction
       if(evCorrection)
-      {
-          ALICEVISION_LOG_INFO("View: " << viewId << ", Ev: " << ev << ", Ev compensation: " << exposureCompensation);
+        ALICEVISION_LOG_INFO("View: " << viewId << ", Ev: " << ev << ", Ev compensation: " << exposureCompensation);
 
-          for(int pix = 0; pix < image.Width() * image.Height(); ++pix)
-              image(pix) = image(pix) * exposureCompensation;
+      // export undistort image
+      Image<RGBfColor> image, image_ud;
+      readImage(srcImage, image, image::EImageColorSpace::LINEAR);
 
-      }
-      
-      // undistort
-      if(cam->isValid() && cam->have_disto())
+      const Image<RGBfColor>* outImage = &image;
+
+      // undistortion and exposure correction
+      if(evCorrection || (cam->isValid() && cam->have_disto()))
       {
-        // undistort the image and save it
-        UndistortImage(image, cam, image_ud, FBLACK);
-        writeImage(dstColorImage, image_ud, image::EImageColorSpace::AUTO, metadata);
+        undistortAndCompensateImage(image, cam, imageExposureCompensation, image_ud);
+        image = Image<RGBfColor>(); // release the input image
+        outImage = &image_ud;
       }
+
+      if(saveMipmaps)
+        writeImageWithMipmaps(dstColorImage, *outImage, image::EImageColorSpace::AUTO, metadata);
       else
-      {
-        writeImage(dstColorImage, image, image::EImageColorSpace::AUTO, metadata);
-      }
+        writeImage(dstColorImage, *outImage, image::EImageColorSpace::AUTO, metadata);
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_ERROR("Failed to export view " << viewId << ":\n" << e.what());
+      failedViews.at(i) = 1;
     }
 
     #pragma omp critical
     ++progressBar;
   }
 
+  if(nbSkipped > 0)
+    ALICEVISION_LOG_INFO(nbSkipped << " unchanged image(s) have not been exported again.");
+
+  const std::size_t nbFailed = std::count(failedViews.begin(), failedViews.end(), 1);
+  if(nbFailed > 0)
+  {
+    ALICEVISION_LOG_ERROR(nbFailed << " image(s) cannot be exported.");
+    return false;
+  }
+
   return true;
 }
 
@@ -246,6 +396,9 @@ int aliceVision_main(int argc, char *argv[])
   bool saveMetadata = true;
   bool saveMatricesTxtFiles = false;
   bool evCorrection = false;
+  bool saveMipmaps = false;
+  bool skipUnchanged = true;
+  int maxThreads = 0;
 
   po::options_description allParams("AliceVision prepareDenseScene");
 
@@ -272,7 +425,14 @@ int aliceVision_main(int argc, char *argv[])
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
       "Range size.")
     ("evCorrection", po::value<bool>(&evCorrection)->default_value(evCorrection),
-      "Correct exposure value.");
+      "Correct exposure value.")
+    ("saveMipmaps", po::value<bool>(&saveMipmaps)->default_value(saveMipmaps),
+      "Save the images with all their resolution levels (tiled EXR only), "
+      "so that the depth map estimation can directly read the downscaled images.")
+    ("skipUnchanged", po::value<bool>(&skipUnchanged)->default_value(skipUnchanged),
+      "Do not export again images already exported from the same source image, camera and options.")
+    ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads),
+      "Maximum number of threads used to export images (0: automatic, depending on the available memory).");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -350,7 +510,7 @@ int aliceVision_main(int argc, char *argv[])
   }
 
   // export
-  if(prepareDenseScene(sfmData, imagesFolders, rangeStart, rangeEnd, outFolder, outputFileType, saveMetadata, saveMatricesTxtFiles, evCorrection))
+  if(prepareDenseScene(sfmData, imagesFolders, rangeStart, rangeEnd, outFolder, outputFileType, saveMetadata, saveMatricesTxtFiles, evCorrection, saveMipmaps, skipUnchanged, maxThreads))
     return EXIT_SUCCESS;
 
   return EXIT_FAILURE;
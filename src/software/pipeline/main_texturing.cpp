@@ -25,7 +25,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 3
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -46,6 +46,7 @@ int aliceVision_main(int argc, char* argv[])
     std::string inputMeshFilepath;
     std::string outputFolder;
     std::string imagesFolder;
+    std::string imagesSpecCacheFilename;
     std::string outTextureFileTypeName = imageIO::EImageFileType_enumToString(imageIO::EImageFileType::PNG);
     std::string processColorspaceName = imageIO::EImageColorSpace_enumToString(imageIO::EImageColorSpace::SRGB);
     bool flipNormals = false;
@@ -71,6 +72,8 @@ int aliceVision_main(int argc, char* argv[])
         ("imagesFolder", po::value<std::string>(&imagesFolder),
           "Use images from a specific folder instead of those specify in the SfMData file.\n"
           "Filename should be the image uid.")
+        ("imagesSpecCache", po::value<std::string>(&imagesSpecCacheFilename)->default_value(imagesSpecCacheFilename),
+            "Image spec cache file, shared by the MVS nodes to avoid reading the same image headers again. Disabled if empty.")
         ("textureSide", po::value<unsigned int>(&texParams.textureSide)->default_value(texParams.textureSide),
             "Output texture size")
         ("downscale", po::value<unsigned int>(&texParams.downscale)->default_value(texParams.downscale),
@@ -172,7 +175,7 @@ int aliceVision_main(int argc, char* argv[])
     }
 
     // initialization
-    mvsUtils::MultiViewParams mp(sfmData, imagesFolder);
+    mvsUtils::MultiViewParams mp(sfmData, imagesFolder, "", "", false, 1, nullptr, imagesSpecCacheFilename);
 
     mesh::Texturing mesh;
     mesh.texParams = texParams;
@@ -3,10 +3,12 @@
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/main.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <OpenImageIO/imageio.h>
 #include <OpenImageIO/imagebuf.h>
@@ -20,7 +22,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 namespace po = boost::program_options;
@@ -38,6 +40,7 @@ int aliceVision_main(int argc, char * argv[])
     float contrast = 1.0f;
     int medianFilter = 0;
     std::string extension;
+    int maxThreads = 0;
 
     int sharpenWidth = 1;
     float sharpenContrast = 1.f;
@@ -80,6 +83,8 @@ int aliceVision_main(int argc, char * argv[])
 
         ("extension", po::value<std::string>(&extension)->default_value(extension),
          "Output image extension (like exr, or empty to keep the source file format.")
+        ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads),
+         "Specifies the maximum number of images processed simultaneously (0 for automatic mode).")
         ;
 
     po::options_description logParams("Log parameters");
@@ -138,12 +143,62 @@ int aliceVision_main(int argc, char * argv[])
         return EXIT_FAILURE;
     }
 
-    for (auto & viewIt : sfmData.getViews())
+    // views to process
+    std::vector<sfmData::View*> views;
+    std::size_t jobMaxMemoryConsumption = 0;
+    for(auto& viewIt : sfmData.getViews())
     {
-        auto& view = *viewIt.second;
-        if(reconstructedViewsOnly && !sfmData.isPoseAndIntrinsicDefined(&view))
+        sfmData::View* view = viewIt.second.get();
+        if(reconstructedViewsOnly && !sfmData.isPoseAndIntrinsicDefined(view))
             continue;
+        views.push_back(view);
 
+        // input image, processing buffer and intermediate read / resize buffers
+        const std::size_t imageMemory = std::size_t(view->getWidth()) * std::size_t(view->getHeight()) * sizeof(image::RGBfColor);
+        jobMaxMemoryConsumption = std::max(jobMaxMemoryConsumption, 4 * imageMemory);
+    }
+
+    // the median exposure is the same for all views
+    const float medianCameraExposure = exposureCompensation ? sfmData.getMedianCameraExposureSetting() : 1.0f;
+
+    // images are processed in parallel, within the available memory
+    std::size_t nbThreads = omp_get_num_procs();
+    {
+        const system::MemoryInfo memoryInformation = system::getMemoryInfo();
+
+        ALICEVISION_LOG_DEBUG("Job max memory consumption: " << jobMaxMemoryConsumption << " B");
+        ALICEVISION_LOG_DEBUG("Memory information: " << std::endl << memoryInformation);
+
+        if(memoryInformation.freeRam == 0)
+        {
+            ALICEVISION_LOG_WARNING("Cannot find available system memory, this can be due to OS limitations.\n"
+                                    "Use only one thread for image processing.");
+            nbThreads = 1;
+        }
+        else if(jobMaxMemoryConsumption > 0)
+        {
+            nbThreads = std::min(nbThreads, static_cast<std::size_t>((0.9 * memoryInformation.freeRam) / jobMaxMemoryConsumption));
+        }
+
+        // nbThreads should not be higher than user maxThreads param
+        if(maxThreads > 0)
+            nbThreads = std::min(static_cast<std::size_t>(maxThreads), nbThreads);
+
+        // nbThreads should not be higher than the job number
+        nbThreads = std::max(std::size_t(1), std::min(views.size(), nbThreads));
+
+        ALICEVISION_LOG_INFO("Process " << views.size() << " images using " << nbThreads << " thread(s).");
+    }
+
+    std::vector<char> failedViews(views.size(), 0);
+
+    #pragma omp parallel for num_threads(nbThreads) schedule(dynamic)
+    for(int viewIndex = 0; viewIndex < static_cast<int>(views.size()); ++viewIndex)
+    {
+      sfmData::View& view = *views.at(viewIndex);
+
+      try
+      {
         ALICEVISION_LOG_INFO("Process view '" << view.getViewId() << "', url: '" << view.getImagePath() << "'");
 
         // Read original image
@@ -153,31 +208,28 @@ int aliceVision_main(int argc, char * argv[])
 
         unsigned int nchannels = 3;
 
+        // buffer reused by the successive filters
+        image::Image<image::RGBfColor> filtered;
+
         if (downscale != 1.0f)
         {
-            const unsigned int w = view.getWidth();
-            const unsigned int h = view.getHeight();
+            const unsigned int w = image.Width();
+            const unsigned int h = image.Height();
             const unsigned int nw = (unsigned int)(floor(float(w) / downscale));
             const unsigned int nh = (unsigned int)(floor(float(h) / downscale));
 
-            image::Image<image::RGBfColor> rescaled(nw, nh);
-
-            const oiio::ImageSpec imageSpecResized(nw, nh, 3, oiio::TypeDesc::FLOAT);
-            const oiio::ImageSpec imageSpecOrigin(w, h, 3, oiio::TypeDesc::FLOAT);
-            oiio::ImageBuf bufferOrigin(imageSpecOrigin, image.data());
-            oiio::ImageBuf bufferResized(imageSpecResized, rescaled.data());
-            oiio::ImageBufAlgo::resample(bufferResized, bufferOrigin);
+            filtered.resize(nw, nh, false);
 
             const oiio::ImageBuf inBuf(oiio::ImageSpec(w, h, nchannels, oiio::TypeDesc::FLOAT), image.data());
-            oiio::ImageBuf outBuf(oiio::ImageSpec(nw, nh, nchannels, oiio::TypeDesc::FLOAT), rescaled.data());
+            oiio::ImageBuf outBuf(oiio::ImageSpec(nw, nh, nchannels, oiio::TypeDesc::FLOAT), filtered.data());
 
             oiio::ImageBufAlgo::resize(outBuf, inBuf);
 
-            image.swap(rescaled);
+            image.swap(filtered);
         }
         if (exposureCompensation)
         {
-            const float medianCameraExposure = sfmData.getMedianCameraExposureSetting();
+            // applied after the downscale: fewer pixels, same result as resize is linear
             const float cameraExposure = view.getCameraExposureSetting();
             const float ev = std::log2(1.0 / cameraExposure);
             const float exposureCompensation = medianCameraExposure / cameraExposure;
@@ -190,7 +242,7 @@ int aliceVision_main(int argc, char * argv[])
         if (contrast != 1.0f)
         {
     #if OIIO_VERSION >= (10000 * 2 + 100 * 0 + 0) // OIIO_VERSION >= 2.0.0
-            image::Image<image::RGBfColor> filtered(image.Width(), image.Height());
+            filtered.resize(image.Width(), image.Height(), false);
             const oiio::ImageBuf inBuf(oiio::ImageSpec(image.Width(), image.Height(), nchannels, oiio::TypeDesc::FLOAT), image.data());
             oiio::ImageBuf outBuf(oiio::ImageSpec(image.Width(), image.Height(), nchannels, oiio::TypeDesc::FLOAT), filtered.data());
             oiio::ImageBufAlgo::contrast_remap(outBuf, inBuf, 0.0f, 1.0f, 0.0f, 1.0f, contrast);
@@ -199,7 +251,7 @@ int aliceVision_main(int argc, char * argv[])
         }
         if (medianFilter >= 3)
         {
-            image::Image<image::RGBfColor> filtered(image.Width(), image.Height());
+            filtered.resize(image.Width(), image.Height(), false);
             const oiio::ImageBuf inBuf(oiio::ImageSpec(image.Width(), image.Height(), nchannels, oiio::TypeDesc::FLOAT), image.data());
             oiio::ImageBuf outBuf(oiio::ImageSpec(image.Width(), image.Height(), nchannels, oiio::TypeDesc::FLOAT), filtered.data());
             oiio::ImageBufAlgo::median_filter(outBuf, inBuf, medianFilter);
@@ -208,7 +260,7 @@ int aliceVision_main(int argc, char * argv[])
         }
         if (sharpenWidth >= 3.f && sharpenContrast > 0.f)
         {
-            image::Image<image::RGBfColor> filtered(image.Width(), image.Height());
+            filtered.resize(image.Width(), image.Height(), false);
             const oiio::ImageBuf inBuf(oiio::ImageSpec(image.Width(), image.Height(), nchannels, oiio::TypeDesc::FLOAT), image.data());
             oiio::ImageBuf outBuf(oiio::ImageSpec(image.Width(), image.Height(), nchannels, oiio::TypeDesc::FLOAT), filtered.data());
             oiio::ImageBufAlgo::unsharp_mask(outBuf, inBuf, "gaussian", sharpenWidth, sharpenContrast, sharpenThreshold);
@@ -227,6 +279,18 @@ int aliceVision_main(int argc, char * argv[])
         view.setImagePath(outputImagePath);
         view.setWidth(image.Width());
         view.setHeight(image.Height());
+      }
+      catch(const std::exception& e)
+      {
+        ALICEVISION_LOG_ERROR("Failed to process view '" << view.getViewId() << "': " << e.what());
+        failedViews.at(viewIndex) = 1;
+      }
+    }
+
+    if(std::find(failedViews.begin(), failedViews.end(), 1) != failedViews.end())
+    {
+        ALICEVISION_LOG_ERROR("Some images cannot be processed.");
+        return EXIT_FAILURE;
     }
 
     if (downscale != 1.0f)
@@ -21,7 +21,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -40,6 +40,8 @@ int aliceVision_main( int argc, char **argv )
   std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
   int selectionMethod;
   int imgRef;
+  int solver = 0;
+  int histogramDownscale = 1;
 
   // user optional parameters
 
@@ -65,7 +67,14 @@ int aliceVision_main( int argc, char **argv )
   po::options_description optionalParams("Optional parameters");
   optionalParams.add_options()
     ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
-      feature::EImageDescriberType_informations().c_str());
+      feature::EImageDescriberType_informations().c_str())
+    ("solver", po::value<int>(&solver)->default_value(solver),
+      "Gain/offset solver:\n"
+      "- 0: L-infinity linear program\n"
+      "- 1: Iteratively reweighted least squares (sparse, for large image graphs)")
+    ("histogramDownscale", po::value<int>(&histogramDownscale)->default_value(histogramDownscale),
+      "Compute the histograms on one pixel out of histogramDownscale in each direction "
+      "(FullFrame and Matched Points selection methods).");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -112,6 +121,12 @@ int aliceVision_main( int argc, char **argv )
     return EXIT_FAILURE;
   }
 
+  if(solver != eHarmonizeSolverLinearProgramming && solver != eHarmonizeSolverIRLS)
+  {
+    ALICEVISION_LOG_ERROR("Invalid solver: " << solver);
+    return EXIT_FAILURE;
+  }
+
   const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
 
   if(!fs::exists(outputFolder))
@@ -127,7 +142,9 @@ int aliceVision_main( int argc, char **argv )
     outputFolder,
     describerTypes,
     selectionMethod,
-    imgRef);
+    imgRef,
+    static_cast<EHarmonizationSolver>(solver),
+    histogramDownscale);
 
   if(colorHarmonizeEngine.Process())
   {
@@ -6,6 +6,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/uid.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/sfm/sfm.hpp>
 #include <aliceVision/sfm/pipeline/regionsIO.hpp>
@@ -15,6 +16,7 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -24,18 +26,52 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
 namespace po = boost::program_options;
 namespace fs = boost::filesystem;
 
+/**
+ * @brief Append a localized image to the scene: new view, intrinsic, pose and
+ *        observations of the inlier 2D-3D correspondences
+ */
+void appendLocalizedView(sfmData::SfMData& sfmData,
+                         const std::string& imagePath,
+                         const Pair& imageSize,
+                         const std::shared_ptr<camera::IntrinsicBase>& intrinsic,
+                         const geometry::Pose3& pose,
+                         const sfm::ImageLocalizerMatchData& matchData,
+                         const feature::Regions& queryRegions)
+{
+  auto view = std::make_shared<sfmData::View>(imagePath, UndefinedIndexT, UndefinedIndexT, UndefinedIndexT, imageSize.first, imageSize.second);
+  IndexT viewId = static_cast<IndexT>(sfmData::computeViewUID(*view));
+  while(sfmData.getViews().count(viewId) || sfmData.getIntrinsics().count(viewId) || sfmData.getPoses().count(viewId))
+    ++viewId;
+
+  view->setViewId(viewId);
+  view->setIntrinsicId(viewId);
+  view->setPoseId(viewId);
+
+  sfmData.getViews().emplace(viewId, view);
+  sfmData.getIntrinsics().emplace(viewId, intrinsic);
+  sfmData.setAbsolutePose(viewId, sfmData::CameraPose(pose));
+
+  for(const std::size_t inlier : matchData.vec_inliers)
+  {
+    const IndexT featureId = matchData.vec_featureIds.at(inlier);
+    sfmData::Landmark& landmark = sfmData.structure.at(matchData.vec_landmarkIds.at(inlier));
+    landmark.observations[viewId] = sfmData::Observation(matchData.pt2D.col(inlier), featureId, queryRegions.Features()[featureId].scale());
+  }
+}
+
 // Image localization API sample:
-// - Allow to locate an image to an existing SfM_reconstruction
+// - Allow to locate images in an existing SfM_reconstruction
 //   if 3D-2D matches are found
-// - A demonstration mode (default):
-//   - try to locate all the view of the SfM_Data reconstruction
+// - The retrieval database is built once and shared by all the query images,
+//   localized concurrently
+// - Optionally append the localized views to the scene and run a final bundle adjustment
 int aliceVision_main(int argc, char **argv)
 {
   // command-line parameters
@@ -44,12 +80,13 @@ int aliceVision_main(int argc, char **argv)
   std::string sfmDataFilename;
   std::vector<std::string> featuresFolders;
   std::string outputFolder;
-  std::string queryImage;
+  std::vector<std::string> queryImages;
 
   // user optional parameters
 
   std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
   double maxResidualError = std::numeric_limits<double>::infinity();
+  std::string outputSfMDataFilename;
 
   po::options_description allParams(
     "Image localization in an existing SfM reconstruction\n"
@@ -63,15 +100,17 @@ int aliceVision_main(int argc, char **argv)
       "Output path.")
     ("featuresFolders,f", po::value<std::vector<std::string>>(&featuresFolders)->multitoken()->required(),
       "Path to folder(s) containing the extracted features.")
-    ("queryImage", po::value<std::string>(&queryImage)->required(),
-      "Path to the image that must be localized.");
+    ("queryImage", po::value<std::vector<std::string>>(&queryImages)->multitoken()->required(),
+      "Path to the image(s) that must be localized.");
 
   po::options_description optionalParams("Optional parameters");
   optionalParams.add_options()
     ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
       feature::EImageDescriberType_informations().c_str())
     ("maxResidualError", po::value<double>(&maxResidualError)->default_value(maxResidualError),
-      "Upper bound of the residual error tolerance.");
+      "Upper bound of the residual error tolerance.")
+    ("outputSfMData", po::value<std::string>(&outputSfMDataFilename)->default_value(outputSfMDataFilename),
+      "If set, append the localized views to the scene, run a final bundle adjustment and save it to this SfMData file.");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -135,8 +174,10 @@ int aliceVision_main(int argc, char **argv)
   // Get imageDescriberMethodType
   EImageDescriberType describerType = EImageDescriberType_stringToEnum(describerTypesName);
   
-  // Get imageDecriber fom type
-  std::unique_ptr<ImageDescriber> imageDescribers = createImageDescriber(describerType);
+  // Get one imageDescriber per thread
+  std::vector<std::unique_ptr<ImageDescriber>> imageDescribers(omp_get_max_threads());
+  for(auto& imageDescriber : imageDescribers)
+    imageDescriber = createImageDescriber(describerType);
 
   // Load the SfM_Data region's views
   //-
@@ -170,39 +211,54 @@ int aliceVision_main(int argc, char **argv)
     }
   }
   
-  std::vector<Vec3> vec_found_poses;
-
-  ALICEVISION_LOG_INFO("SfM::localization => try with image: " << queryImage);
-  std::unique_ptr<Regions> query_regions;
-  image::Image<unsigned char> imageGray;
+  const std::size_t nbQueries = queryImages.size();
+  std::vector<std::unique_ptr<Regions>> queryRegions(nbQueries);
+  std::vector<Pair> imageSizes(nbQueries);
+  std::vector<std::shared_ptr<camera::IntrinsicBase>> intrinsics(nbQueries); // Suppose intrinsics as unknown
+  std::vector<geometry::Pose3> poses(nbQueries);
+  std::vector<sfm::ImageLocalizerMatchData> matchingData(nbQueries);
+
+  // describe the query images
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nbQueries); ++i)
   {
-    image::readImage(queryImage, imageGray, image::EImageColorSpace::NO_CONVERSION);
+    ALICEVISION_LOG_INFO("SfM::localization => try with image: " << queryImages[i]);
 
-    // Compute features and descriptors
-    imageDescribers->describe(imageGray, query_regions);
-    ALICEVISION_LOG_INFO("# regions detected in query image: " << query_regions->RegionCount());
-  }
+    image::Image<unsigned char> imageGray;
+    image::readImage(queryImages[i], imageGray, image::EImageColorSpace::NO_CONVERSION);
+    imageSizes[i] = Pair(imageGray.Width(), imageGray.Height());
 
-  // Suppose intrinsic as unknown
-  std::shared_ptr<camera::IntrinsicBase> optional_intrinsic (nullptr);
+    // Compute features and descriptors
+    imageDescribers[omp_get_thread_num()]->describe(imageGray, queryRegions[i]);
+    ALICEVISION_LOG_INFO("# regions detected in query image '" << queryImages[i] << "': " << queryRegions[i]->RegionCount());
 
-  geometry::Pose3 pose;
-  sfm::ImageLocalizerMatchData matching_data;
-  matching_data.error_max = maxResidualError;
+    matchingData[i].error_max = maxResidualError;
+  }
 
-  // Try to localize the image in the database thanks to its regions
-  if (!localizer.Localize(
-    Pair(imageGray.Width(), imageGray.Height()),
-    optional_intrinsic.get(),
-    *(query_regions.get()),
-    pose,
-    &matching_data))
+  // Try to localize the images in the database thanks to their regions
+  std::vector<bool> localized;
   {
-    ALICEVISION_LOG_ERROR("Cannot locate the image");
+    std::vector<const camera::IntrinsicBase*> optionalIntrinsics(nbQueries);
+    std::vector<const feature::Regions*> queryRegionsPtrs(nbQueries);
+    for(std::size_t i = 0; i < nbQueries; ++i)
+    {
+      optionalIntrinsics[i] = intrinsics[i].get();
+      queryRegionsPtrs[i] = queryRegions[i].get();
+    }
+    localized = localizer.LocalizeBatch(imageSizes, optionalIntrinsics, queryRegionsPtrs, poses, matchingData);
   }
-  else
+
+  // refine the found poses
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nbQueries); ++i)
   {
-    const bool b_new_intrinsic = (optional_intrinsic == nullptr);
+    if(!localized[i])
+    {
+      ALICEVISION_LOG_ERROR("Cannot locate the image: " << queryImages[i]);
+      continue;
+    }
+
+    const bool b_new_intrinsic = (intrinsics[i] == nullptr);
     // A valid pose has been found (try to refine it):
     // If not intrinsic as input:
     //  init a new one from the projection matrix decomposition
@@ -212,22 +268,73 @@ int aliceVision_main(int argc, char **argv)
       // setup a default camera model from the found projection matrix
       Mat3 K, R;
       Vec3 t;
-      KRt_from_P(matching_data.projection_matrix, &K, &R, &t);
+      KRt_from_P(matchingData[i].projection_matrix, &K, &R, &t);
 
       const double focal = (K(0,0) + K(1,1))/2.0;
       const Vec2 principal_point(K(0,2), K(1,2));
-      optional_intrinsic = std::make_shared<camera::PinholeRadialK3>(
-        imageGray.Width(), imageGray.Height(),
+      intrinsics[i] = std::make_shared<camera::PinholeRadialK3>(
+        imageSizes[i].first, imageSizes[i].second,
         focal, principal_point(0), principal_point(1));
     }
     sfm::SfMLocalizer::RefinePose
     (
-      optional_intrinsic.get(),
-      pose, matching_data,
+      intrinsics[i].get(),
+      poses[i], matchingData[i],
       true, b_new_intrinsic
     );
+  }
 
-    vec_found_poses.push_back(pose.center());
+  std::vector<Vec3> vec_found_poses;
+  for(std::size_t i = 0; i < nbQueries; ++i)
+  {
+    if(localized[i])
+      vec_found_poses.push_back(poses[i].center());
+  }
+  ALICEVISION_LOG_INFO("Localized images: " << vec_found_poses.size() << "/" << nbQueries);
+
+  if(!outputSfMDataFilename.empty() && !vec_found_poses.empty())
+  {
+    // lock the existing scene and refine only the appended views
+    std::vector<IndexT> lockedPoses, lockedIntrinsics;
+    for(auto& posePair : sfmData.getPoses())
+    {
+      if(!posePair.second.isLocked())
+      {
+        posePair.second.lock();
+        lockedPoses.push_back(posePair.first);
+      }
+    }
+    for(auto& intrinsicPair : sfmData.getIntrinsics())
+    {
+      if(!intrinsicPair.second->isLocked())
+      {
+        intrinsicPair.second->lock();
+        lockedIntrinsics.push_back(intrinsicPair.first);
+      }
+    }
+
+    for(std::size_t i = 0; i < nbQueries; ++i)
+    {
+      if(localized[i])
+        appendLocalizedView(sfmData, queryImages[i], imageSizes[i], intrinsics[i], poses[i], matchingData[i], *queryRegions[i]);
+    }
+
+    sfm::BundleAdjustmentCeres bundleAdjustmentObj;
+    const sfm::BundleAdjustment::ERefineOptions refineOptions =
+      sfm::BundleAdjustment::REFINE_ROTATION | sfm::BundleAdjustment::REFINE_TRANSLATION | sfm::BundleAdjustment::REFINE_INTRINSICS_ALL;
+    if(!bundleAdjustmentObj.adjust(sfmData, refineOptions))
+      ALICEVISION_LOG_WARNING("Final bundle adjustment of the localized views failed.");
+
+    for(const IndexT poseId : lockedPoses)
+      sfmData.getPoses().at(poseId).unlock();
+    for(const IndexT intrinsicId : lockedIntrinsics)
+      sfmData.getIntrinsics().at(intrinsicId)->unlock();
+
+    if(!sfmDataIO::Save(sfmData, outputSfMDataFilename, sfmDataIO::ESfMData::ALL))
+    {
+      ALICEVISION_LOG_ERROR("Unable to save the output SfMData file '" << outputSfMDataFilename << "'");
+      return EXIT_FAILURE;
+    }
   }
 
   // export the found camera position
@@ -254,5 +361,5 @@ int aliceVision_main(int argc, char **argv)
       outfile.close();
     }
   }
-  return EXIT_FAILURE;
+  return vec_found_poses.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
 }
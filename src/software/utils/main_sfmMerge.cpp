@@ -0,0 +1,239 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfm/utils/alignment.hpp>
+#include <aliceVision/sfm/utils/merge.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/matching/io.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/config.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <string>
+#include <sstream>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+int aliceVision_main(int argc, char **argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string sfmDataFilename;
+  std::string sfmDataReferenceFilename;
+  std::string outSfMDataFilename;
+  std::vector<std::string> matchesFolders;
+  std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+  std::size_t minNbCommonLandmarks = 20;
+  bool refine = true;
+  bool lockReference = true;
+
+  po::options_description allParams(
+    "Merge a reconstruction into a reference reconstruction of other views of the same scene.\n"
+    "Only the matches between the views of the two reconstructions are needed "
+    "(see imageMatching with the a/b matching mode and its combined SfMData output, then featureMatching): "
+    "they link the landmarks of both reconstructions, which are used to align the reconstruction "
+    "to the reference coordinate system and are fused in the merged reconstruction.\n"
+    "AliceVision sfmMerge");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+      "SfMData file to merge.")
+    ("reference,r", po::value<std::string>(&sfmDataReferenceFilename)->required(),
+      "SfMData file of the reference scene, receiving the input scene.")
+    ("matchesFolders,m", po::value<std::vector<std::string>>(&matchesFolders)->multitoken()->required(),
+      "Path to folder(s) in which the matches between the views of the two scenes are stored.")
+    ("output,o", po::value<std::string>(&outSfMDataFilename)->required(),
+      "Output merged SfMData scene.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
+      feature::EImageDescriberType_informations().c_str())
+    ("minNbCommonLandmarks", po::value<std::size_t>(&minNbCommonLandmarks)->default_value(minNbCommonLandmarks),
+      "Minimal number of landmarks linked between the two scenes to merge them.")
+    ("refine", po::value<bool>(&refine)->default_value(refine),
+      "Refine the merged scene with a final bundle adjustment.")
+    ("lockReference", po::value<bool>(&lockReference)->default_value(lockReference),
+      "Lock the poses and intrinsics of the reference scene during the final bundle adjustment.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal,  error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  // Load input scene
+  sfmData::SfMData sfmDataIn;
+  if(!sfmDataIO::Load(sfmDataIn, sfmDataFilename, sfmDataIO::ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" << sfmDataFilename << "' cannot be read");
+    return EXIT_FAILURE;
+  }
+
+  // Load reference scene
+  sfmData::SfMData sfmDataRef;
+  if(!sfmDataIO::Load(sfmDataRef, sfmDataReferenceFilename, sfmDataIO::ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("The reference SfMData file '" << sfmDataReferenceFilename << "' cannot be read");
+    return EXIT_FAILURE;
+  }
+
+  // Load the matches between the views of the two scenes
+  const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
+  matching::PairwiseMatches pairwiseMatches;
+  {
+    std::set<IndexT> viewIds = sfmDataIn.getViewsKeys();
+    const std::set<IndexT> viewIdsRef = sfmDataRef.getViewsKeys();
+    viewIds.insert(viewIdsRef.begin(), viewIdsRef.end());
+
+    if(!matching::Load(pairwiseMatches, viewIds, matchesFolders, describerTypes))
+    {
+      ALICEVISION_LOG_ERROR("Unable to load the matches between the two scenes.");
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Link the landmarks of the two scenes
+  std::vector<std::pair<IndexT, IndexT>> commonLandmarkIds;
+  sfm::getCommonLandmarksFromMatches(sfmDataIn, sfmDataRef, pairwiseMatches, commonLandmarkIds);
+  ALICEVISION_LOG_INFO("Common landmarks: " << commonLandmarkIds.size());
+
+  if(commonLandmarkIds.size() < minNbCommonLandmarks)
+  {
+    ALICEVISION_LOG_ERROR("Not enough common landmarks between the two scenes (" << commonLandmarkIds.size() << " < " << minNbCommonLandmarks << ").");
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_LOG_INFO("Search similarity transformation.");
+
+  double S;
+  Mat3 R;
+  Vec3 t;
+  std::vector<std::size_t> inliers;
+  if(!sfm::computeSimilarityFromCommonLandmarks(sfmDataIn, sfmDataRef, commonLandmarkIds, &S, &R, &t, &inliers))
+  {
+    std::stringstream ss;
+    ss << "Failed to find similarity between the 2 SfM scenes:";
+    ss << "\t- " << sfmDataFilename << std::endl;
+    ss << "\t- " << sfmDataReferenceFilename << std::endl;
+    ALICEVISION_LOG_ERROR(ss.str());
+    return EXIT_FAILURE;
+  }
+
+  {
+    std::stringstream ss;
+    ss << "Transformation:" << std::endl;
+    ss << "\t- Scale: " << S << std::endl;
+    ss << "\t- Rotation:\n" << R << std::endl;
+    ss << "\t- Translate: " << t.transpose() << std::endl;
+    ALICEVISION_LOG_INFO(ss.str());
+  }
+
+  sfm::applyTransform(sfmDataIn, S, R, t);
+
+  // only fuse the landmarks consistent with the similarity
+  std::vector<std::pair<IndexT, IndexT>> inlierLandmarkIds;
+  inlierLandmarkIds.reserve(inliers.size());
+  for(const std::size_t i : inliers)
+    inlierLandmarkIds.push_back(commonLandmarkIds[i]);
+
+  // keep the lock state of the reference scene
+  std::vector<IndexT> lockedPoses, lockedIntrinsics;
+  if(refine && lockReference)
+  {
+    for(auto& posePair : sfmDataRef.getPoses())
+    {
+      if(!posePair.second.isLocked())
+      {
+        posePair.second.lock();
+        lockedPoses.push_back(posePair.first);
+      }
+    }
+    for(auto& intrinsicPair : sfmDataRef.getIntrinsics())
+    {
+      if(!intrinsicPair.second->isLocked())
+      {
+        intrinsicPair.second->lock();
+        lockedIntrinsics.push_back(intrinsicPair.first);
+      }
+    }
+  }
+
+  const std::size_t nbFusedLandmarks = sfm::mergeSfMData(sfmDataIn, inlierLandmarkIds, sfmDataRef);
+  ALICEVISION_LOG_INFO("Merged scene: " << sfmDataRef.getViews().size() << " views, " << sfmDataRef.getLandmarks().size() << " landmarks (" << nbFusedLandmarks << " fused).");
+
+  if(refine)
+  {
+    sfm::BundleAdjustmentCeres bundleAdjustmentObj;
+    const sfm::BundleAdjustment::ERefineOptions refineOptions =
+      sfm::BundleAdjustment::REFINE_ROTATION | sfm::BundleAdjustment::REFINE_TRANSLATION |
+      sfm::BundleAdjustment::REFINE_STRUCTURE | sfm::BundleAdjustment::REFINE_INTRINSICS_ALL;
+    if(!bundleAdjustmentObj.adjust(sfmDataRef, refineOptions))
+      ALICEVISION_LOG_WARNING("Final bundle adjustment of the merged scene failed.");
+
+    for(const IndexT poseId : lockedPoses)
+      sfmDataRef.getPoses().at(poseId).unlock();
+    for(const IndexT intrinsicId : lockedIntrinsics)
+      sfmDataRef.getIntrinsics().at(intrinsicId)->unlock();
+  }
+
+  ALICEVISION_LOG_INFO("Save into '" << outSfMDataFilename << "'");
+
+  // Export the SfMData scene in the expected format
+  if(!sfmDataIO::Save(sfmDataRef, outSfMDataFilename, sfmDataIO::ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("An error occurred while trying to save '" << outSfMDataFilename << "'");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -11,6 +11,8 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <dependencies/vectorGraphics/svgDrawer.hpp>
 
@@ -21,16 +23,21 @@
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <iostream>
 #include <iterator>
 #include <fstream>
+#include <map>
+#include <memory>
 #include <vector>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -52,11 +59,12 @@ public:
     _K << focal,     0,  width/2.0,
               0, focal, height/2.0,
               0,     0,          1;
+    _Kinv = _K.inverse();
   }
 
   Vec3 getLocalRay(double x, double y) const
   {
-    return (_K.inverse() * Vec3(x, y, 1.0)).normalized();
+    return (_Kinv * Vec3(x, y, 1.0)).normalized();
   }
 
   Vec3 getRay(double x, double y) const
@@ -69,6 +77,8 @@ private:
   Mat3 _R;
   /// Intrinsic matrix
   Mat3 _K;
+  /// Inverse intrinsic matrix
+  Mat3 _Kinv;
 };
 
 /**
@@ -170,66 +180,204 @@ bool splitDualFisheye(const std::string& imagePath, const std::string& outputFol
   return true;
 }
 
-bool splitEquirectangular(const std::string& imagePath, const std::string& outputFolder, std::size_t nbSplits, std::size_t splitResolution)
+/**
+ * @brief Backward mapping of the pinhole split images into an equirectangular image.
+ *        It only depends on the input image size and on the split configuration,
+ *        so it is computed once and shared by all the images of a capture.
+ */
+class EquirectangularSplitRemap
 {
-  image::Image<image::RGBColor> imageSource;
-  image::readImage(imagePath, imageSource, image::EImageColorSpace::LINEAR);
+public:
 
-  const int inWidth = imageSource.Width();
-  const int inHeight = imageSource.Height();
+  EquirectangularSplitRemap(int inWidth, int inHeight, std::size_t nbSplits, std::size_t splitResolution)
+    : _inWidth(inWidth)
+    , _inHeight(inHeight)
+    , _nbSplits(nbSplits)
+    , _splitResolution(splitResolution)
+    , _focal(focalFromPinholeHeight(inHeight, degreeToRadian(60.0)))
+    , _coords(nbSplits * splitResolution * splitResolution)
+  {
+    const double alpha = (M_PI * 2.0) / static_cast<double>(nbSplits);
+    const int resolution = static_cast<int>(splitResolution);
 
-  std::vector<PinholeCameraR> cameras;
+    std::vector<PinholeCameraR> cameras;
+    for(std::size_t s = 0; s < nbSplits; ++s)
+      cameras.emplace_back(_focal, resolution, resolution, RotationAroundY(alpha * s));
 
-  const double twoPi = M_PI * 2.0;
-  const double alpha = twoPi / static_cast<double>(nbSplits);
-  const double focal = focalFromPinholeHeight(inHeight, degreeToRadian(60.0));
+    // Backward mapping:
+    // - Find for each pixels of the pinhole image where it comes from the panoramic image
+    #pragma omp parallel for
+    for(int row = 0; row < static_cast<int>(nbSplits) * resolution; ++row)
+    {
+      const PinholeCameraR& camera = cameras.at(row / resolution);
+      const int j = row % resolution;
+      Coord* coords = &_coords.at(std::size_t(row) * resolution);
 
-  double angle = 0.0;
-  for(std::size_t i = 0; i < nbSplits; ++i)
+      for(int i = 0; i < resolution; ++i)
+      {
+        const Vec3 ray = camera.getRay(i, j);
+        const Vec2 x = SphericalMapping::get2DPoint(ray, inWidth, inHeight);
+
+        int x0, y0;
+        getBilinearCoord(x(0), inWidth, x0, coords[i].wx);
+        getBilinearCoord(x(1), inHeight, y0, coords[i].wy);
+        coords[i].index = static_cast<std::uint32_t>(y0) * inWidth + x0;
+      }
+    }
+  }
+
+  double focal() const { return _focal; }
+  std::size_t nbSplits() const { return _nbSplits; }
+
+  /**
+   * @brief Bilinear sampling of a split image
+   * @param[in] imageSource the equirectangular image, of the remap input size
+   * @param[in] splitIndex the split index
+   * @param[out] imageOut the split image
+   */
+  void remap(const image::Image<image::RGBColor>& imageSource, std::size_t splitIndex, image::Image<image::RGBColor>& imageOut) const
   {
-    cameras.emplace_back(focal, splitResolution, splitResolution, RotationAroundY(angle));
-    angle += alpha;
+    assert(imageSource.Width() == _inWidth && imageSource.Height() == _inHeight);
+
+    const int resolution = static_cast<int>(_splitResolution);
+    const image::RGBColor* src = imageSource.data();
+
+    imageOut.resize(resolution, resolution, false);
+
+    // only parallel if not already called from a parallel region
+    #pragma omp parallel for
+    for(int j = 0; j < resolution; ++j)
+    {
+      const Coord* coords = &_coords.at((splitIndex * resolution + j) * resolution);
+
+      for(int i = 0; i < resolution; ++i)
+      {
+        const Coord& coord = coords[i];
+        const image::RGBColor& p00 = src[coord.index];
+        const image::RGBColor& p01 = src[coord.index + 1];
+        const image::RGBColor& p10 = src[coord.index + _inWidth];
+        const image::RGBColor& p11 = src[coord.index + _inWidth + 1];
+        image::RGBColor& out = imageOut(j, i);
+
+        for(int c = 0; c < 3; ++c)
+        {
+          const float top    = p00(c) + coord.wx * (float(p01(c)) - p00(c));
+          const float bottom = p10(c) + coord.wx * (float(p11(c)) - p10(c));
+          out(c) = static_cast<unsigned char>(top + coord.wy * (bottom - top) + 0.5f);
+        }
+      }
+    }
   }
 
-  const image::Sampler2d<image::SamplerLinear> sampler;
-  image::Image<image::RGBColor> imaOut(splitResolution, splitResolution, image::BLACK);
+private:
 
-  size_t index = 0;
-  for(const PinholeCameraR& camera : cameras)
+  /// top-left source pixel index and bilinear weights of an output pixel
+  struct Coord
   {
-    imaOut.fill(image::BLACK);
+    std::uint32_t index;
+    float wx;
+    float wy;
+  };
+
+  /**
+   * @brief Get the first bilinear neighbor and its weight along one axis.
+   *        Coordinates are clamped to the image borders, so v0 + 1 is always inside the image.
+   */
+  static void getBilinearCoord(double v, int size, int& v0, float& w)
+  {
+    if(v <= 0.0)
+    {
+      v0 = 0;
+      w = 0.f;
+    }
+    else if(v >= size - 1)
+    {
+      v0 = size - 2;
+      w = 1.f;
+    }
+    else
+    {
+      v0 = static_cast<int>(v);
+      w = static_cast<float>(v - v0);
+    }
+  }
 
-    // Backward mapping:
-    // - Find for each pixels of the pinhole image where it comes from the panoramic image
-    for(int j = 0; j < splitResolution; ++j)
+  int _inWidth;
+  int _inHeight;
+  std::size_t _nbSplits;
+  std::size_t _splitResolution;
+  double _focal;
+  std::vector<Coord> _coords;
+};
+
+/**
+ * @brief Equirectangular remaps per input image size, for a given split configuration
+ */
+class EquirectangularSplitRemapCache
+{
+public:
+
+  EquirectangularSplitRemapCache(std::size_t nbSplits, std::size_t splitResolution)
+    : _nbSplits(nbSplits)
+    , _splitResolution(splitResolution)
+  {}
+
+  /**
+   * @brief Get the remap of an input image size, computed on first use
+   * @note thread-safe
+   */
+  std::shared_ptr<const EquirectangularSplitRemap> get(int inWidth, int inHeight)
+  {
+    if(inWidth < 2 || inHeight < 2)
+      throw std::runtime_error("Cannot split an equirectangular image of size " + std::to_string(inWidth) + "x" + std::to_string(inHeight) + ".");
+
+    std::shared_ptr<const EquirectangularSplitRemap> remap;
+
+    #pragma omp critical(equirectangularSplitRemapCache)
     {
-      for(int i = 0; i < splitResolution; ++i)
+      std::shared_ptr<const EquirectangularSplitRemap>& cached = _remaps[std::make_pair(inWidth, inHeight)];
+      if(!cached)
       {
-        const Vec3 ray = camera.getRay(i, j);
-        const Vec2 x = SphericalMapping::get2DPoint(ray, inWidth, inHeight);
-        imaOut(j,i) = sampler(imageSource, x(1), x(0));
+        ALICEVISION_LOG_INFO("Compute equirectangular split remap for input size " << inWidth << "x" << inHeight << ".");
+        cached = std::make_shared<const EquirectangularSplitRemap>(inWidth, inHeight, _nbSplits, _splitResolution);
       }
+      remap = cached;
     }
+    return remap;
+  }
 
-    // save image
+private:
+  std::size_t _nbSplits;
+  std::size_t _splitResolution;
+  std::map<std::pair<int, int>, std::shared_ptr<const EquirectangularSplitRemap>> _remaps;
+};
+
+bool splitEquirectangular(const std::string& imagePath, const std::string& outputFolder, EquirectangularSplitRemapCache& remapCache)
+{
+  image::Image<image::RGBColor> imageSource;
+  image::readImage(imagePath, imageSource, image::EImageColorSpace::LINEAR);
 
-    oiio::ImageBuf bufferOut;
-    image::getBufferFromImage(imageSource, bufferOut);
+  const std::shared_ptr<const EquirectangularSplitRemap> remap = remapCache.get(imageSource.Width(), imageSource.Height());
 
-    oiio::ImageSpec& outMetadataSpec = bufferOut.specmod();
+  // output metadata, the same for all splits
+  oiio::ImageSpec outMetadataSpec;
+  outMetadataSpec.extra_attribs = image::readImageMetadata(imagePath);
 
-    outMetadataSpec.extra_attribs = image::readImageMetadata(imagePath);
+  // Override make and model in order to force camera model in SfM
+  outMetadataSpec.attribute("Make",  "Custom");
+  outMetadataSpec.attribute("Model", "Pinhole");
+  outMetadataSpec.attribute("Exif:FocalLength", static_cast<float>(remap->focal()));
 
-    // Ooerride make and model in order to force camera model in SfM
-    outMetadataSpec.attribute("Make",  "Custom");
-    outMetadataSpec.attribute("Model", "Pinhole");
-    outMetadataSpec.attribute("Exif:FocalLength", static_cast<float>(focal));
+  const boost::filesystem::path path(imagePath);
+  image::Image<image::RGBColor> imaOut;
 
-    boost::filesystem::path path(imagePath);
+  for(std::size_t index = 0; index < remap->nbSplits(); ++index)
+  {
+    remap->remap(imageSource, index, imaOut);
+
+    // save image
     image::writeImage(outputFolder + std::string("/") + path.stem().string() + std::string("_") + std::to_string(index) + path.extension().string(),
                       imaOut, image::EImageColorSpace::AUTO, outMetadataSpec.extra_attribs);
-
-    ++index;
   }
   ALICEVISION_LOG_INFO(imagePath + " successfully split");
   return true;
@@ -315,6 +463,7 @@ int aliceVision_main(int argc, char** argv)
   std::size_t equirectangularNbSplits;        // nb splits for equirectangular image
   std::size_t equirectangularSplitResolution; // split resolution for equirectangular image
   bool equirectangularDemoMode;
+  int maxThreads = 0;                         // max number of images processed simultaneously
 
   po::options_description allParams("This program is used to extract multiple images from equirectangular or dualfisheye images or image folder\n"
                                     "AliceVision split360Images");
@@ -339,7 +488,9 @@ int aliceVision_main(int argc, char** argv)
     ("equirectangularSplitResolution", po::value<std::size_t>(&equirectangularSplitResolution)->default_value(1200),
       "Equirectangular split resolution")
     ("equirectangularDemoMode", po::value<bool>(&equirectangularDemoMode)->default_value(false),
-      "Export a SVG file that simulate the split");
+      "Export a SVG file that simulate the split")
+    ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads),
+      "Specifies the maximum number of images processed simultaneously (0 for automatic mode).");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -441,35 +592,101 @@ int aliceVision_main(int argc, char** argv)
     }
   }
 
-  for(const std::string& imagePath : imagePaths)
+  // images are processed in parallel, within the available memory
+  std::size_t nbThreads = omp_get_num_procs();
   {
-    bool hasCorrectPath = true;
+    // all images of a capture are expected to have the same size, use the first readable one
+    std::size_t jobMaxMemoryConsumption = 0;
+    for(const std::string& imagePath : imagePaths)
+    {
+      try
+      {
+        int width, height;
+        image::readImageMetadata(imagePath, width, height);
+        // source image, reading buffer and split image
+        jobMaxMemoryConsumption = std::size_t(width) * std::size_t(height) * (sizeof(image::RGBfColor) + 4 * sizeof(float)) +
+                                  equirectangularSplitResolution * equirectangularSplitResolution * sizeof(image::RGBColor);
+        break;
+      }
+      catch(const std::exception&)
+      {
+        // not an image, reported in the processing loop
+      }
+    }
+
+    const system::MemoryInfo memoryInformation = system::getMemoryInfo();
 
-    if(splitMode == "equirectangular")
+    ALICEVISION_LOG_DEBUG("Job max memory consumption: " << jobMaxMemoryConsumption << " B");
+    ALICEVISION_LOG_DEBUG("Memory information: " << std::endl << memoryInformation);
+
+    if(memoryInformation.freeRam == 0)
+    {
+      ALICEVISION_LOG_WARNING("Cannot find available system memory, this can be due to OS limitations.\n"
+                              "Use only one thread for image splitting.");
+      nbThreads = 1;
+    }
+    else if(jobMaxMemoryConsumption > 0)
     {
-      if(equirectangularDemoMode)
-        hasCorrectPath = splitEquirectangularDemo(imagePath, outputFolder, equirectangularNbSplits, equirectangularSplitResolution);
-      else
-        hasCorrectPath = splitEquirectangular(imagePath, outputFolder, equirectangularNbSplits, equirectangularSplitResolution);
+      nbThreads = std::min(nbThreads, static_cast<std::size_t>((0.9 * memoryInformation.freeRam) / jobMaxMemoryConsumption));
     }
-    else if(splitMode == "dualfisheye")
+
+    // nbThreads should not be higher than user maxThreads param
+    if(maxThreads > 0)
+      nbThreads = std::min(static_cast<std::size_t>(maxThreads), nbThreads);
+
+    // nbThreads should not be higher than the job number
+    nbThreads = std::max(std::size_t(1), std::min(imagePaths.size(), nbThreads));
+
+    ALICEVISION_LOG_INFO("Split " << imagePaths.size() << " images using " << nbThreads << " thread(s).");
+  }
+
+  // split geometry is shared by all images of the same size
+  EquirectangularSplitRemapCache remapCache(equirectangularNbSplits, equirectangularSplitResolution);
+
+  // if images are processed one at a time, the rows of the split images are processed in parallel instead
+  #pragma omp parallel for num_threads(nbThreads) schedule(dynamic) if(nbThreads > 1)
+  for(int i = 0; i < static_cast<int>(imagePaths.size()); ++i)
+  {
+    const std::string& imagePath = imagePaths.at(i);
+    bool hasCorrectPath = true;
+
+    try
     {
-      hasCorrectPath = splitDualFisheye(imagePath, outputFolder, dualFisheyeSplitPreset);
+      if(splitMode == "equirectangular")
+      {
+        if(equirectangularDemoMode)
+          hasCorrectPath = splitEquirectangularDemo(imagePath, outputFolder, equirectangularNbSplits, equirectangularSplitResolution);
+        else
+          hasCorrectPath = splitEquirectangular(imagePath, outputFolder, remapCache);
+      }
+      else if(splitMode == "dualfisheye")
+      {
+        hasCorrectPath = splitDualFisheye(imagePath, outputFolder, dualFisheyeSplitPreset);
+      }
+      else //exif
+      {
+        ALICEVISION_LOG_ERROR("Exif mode not implemented yet !");
+      }
     }
-    else //exif
+    catch(const std::exception& e)
     {
-      ALICEVISION_LOG_ERROR("Exif mode not implemented yet !");
+      ALICEVISION_LOG_ERROR("Failed to split '" << imagePath << "': " << e.what());
+      hasCorrectPath = false;
     }
 
     if(!hasCorrectPath)
+    {
+      #pragma omp critical(split360BadPaths)
       badPaths.push_back(imagePath);
+    }
   }
 
   if(!badPaths.empty())
   {
     ALICEVISION_LOG_ERROR("Error: Can't open image file(s) below");
-    for(const std::string& imagePath : imagePaths)
+    for(const std::string& imagePath : badPaths)
        ALICEVISION_LOG_ERROR("\t - " << imagePath);
+    return EXIT_FAILURE;
   }
 
   return EXIT_SUCCESS;
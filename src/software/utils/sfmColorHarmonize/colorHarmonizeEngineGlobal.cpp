@@ -27,6 +27,8 @@
 #include <aliceVision/colorHarmonization/CommonDataByPair_vldSegment.hpp>
 // color harmonization solver
 #include <aliceVision/colorHarmonization/GainOffsetConstraintBuilder.hpp>
+#include <aliceVision/colorHarmonization/GainOffsetSolverIRLS.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <dependencies/vectorGraphics/svgDrawer.hpp>
 
@@ -60,8 +62,12 @@ ColorHarmonizationEngineGlobal::ColorHarmonizationEngineGlobal(
     const string& outputDirectory,
     const std::vector<feature::EImageDescriberType>& descTypes,
     int selectionMethod,
-    int imgRef)
-  : _sfmDataFilename(sfmDataFilename)
+    int imgRef,
+    EHarmonizationSolver solver,
+    int histogramDownscale)
+  : _solver(solver)
+  , _histogramDownscale(histogramDownscale)
+  , _sfmDataFilename(sfmDataFilename)
   , _featuresFolders(featuresFolders)
   , _matchesFolders(matchesFolders)
   , _outputDirectory(outputDirectory)
@@ -186,189 +192,91 @@ bool ColorHarmonizationEngineGlobal::Process()
   std::cout << "\n Remaining cameras after CC filter : \n"
     << map_cameraIndexTocameraNode.size() << " from a total of " << _fileNames.size() << std::endl;
 
-  size_t bin      = 256;
-  double minvalue = 0.0;
-  double maxvalue = 255.0;
-
   // For each edge computes the selection masks and histograms (for the RGB channels)
   std::vector<relativeColorHistogramEdge> map_relativeHistograms[3];
-  map_relativeHistograms[0].resize(_pairwiseMatches.size());
-  map_relativeHistograms[1].resize(_pairwiseMatches.size());
-  map_relativeHistograms[2].resize(_pairwiseMatches.size());
-
-  for (size_t i = 0; i < _pairwiseMatches.size(); ++i)
+  for(int channelIndex = 0; channelIndex < 3; ++channelIndex)
   {
-    matching::PairwiseMatches::const_iterator iter = _pairwiseMatches.begin();
-    std::advance(iter, i);
-
-    const size_t viewI = iter->first.first;
-    const size_t viewJ = iter->first.second;
-
-    //
-    const MatchesPerDescType& matchesPerDesc = iter->second;
-
-    //-- Edges names:
-    std::pair< std::string, std::string > p_imaNames;
-    p_imaNames = make_pair( _fileNames[ viewI ], _fileNames[ viewJ ] );
-    std::cout << "Current edge : "
-      << fs::path(p_imaNames.first).filename().string() << "\t"
-      << fs::path(p_imaNames.second).filename().string() << std::endl;
-
-    //-- Compute the masks from the data selection:
-    Image< unsigned char > maskI ( _imageSize[ viewI ].first, _imageSize[ viewI ].second );
-    Image< unsigned char > maskJ ( _imageSize[ viewJ ].first, _imageSize[ viewJ ].second );
-
-    switch(_selectionMethod)
+    map_relativeHistograms[channelIndex].resize(_pairwiseMatches.size());
+    std::size_t i = 0;
+    for(const auto& matchesPerViewIt : _pairwiseMatches)
     {
-      case eHistogramHarmonizeFullFrame:
-      {
-        colorHarmonization::CommonDataByPair_fullFrame  dataSelector(
-          p_imaNames.first,
-          p_imaNames.second);
-        dataSelector.computeMask( maskI, maskJ );
-      }
-      break;
-      case eHistogramHarmonizeMatchedPoints:
-      {
-        int circleSize = 10;
-        colorHarmonization::CommonDataByPair_matchedPoints dataSelector(
-          p_imaNames.first,
-          p_imaNames.second,
-          matchesPerDesc,
-          _regionsPerView.getRegionsPerDesc(viewI),
-          _regionsPerView.getRegionsPerDesc(viewJ),
-          circleSize);
-        dataSelector.computeMask( maskI, maskJ );
-      }
-      break;
-      case eHistogramHarmonizeVLDSegment:
-      {
-        maskI.fill(0);
-        maskJ.fill(0);
-
-        for(const auto& matchesIt: matchesPerDesc)
-        {
-          const feature::EImageDescriberType descType = matchesIt.first;
-          const IndMatches& matches = matchesIt.second;
-          colorHarmonization::CommonDataByPair_vldSegment dataSelector(
-            p_imaNames.first,
-            p_imaNames.second,
-            matches,
-            _regionsPerView.getRegions(viewI, descType).Features(),
-            _regionsPerView.getRegions(viewJ, descType).Features());
-
-          dataSelector.computeMask( maskI, maskJ );
-        }
-      }
-      break;
-      default:
-        std::cout << "Selection method unsupported" << std::endl;
-        return false;
-    }
-
-    //-- Export the masks
-    bool bExportMask = false;
-    if (bExportMask)
-    {
-      string sEdge = _fileNames[ viewI ] + "_" + _fileNames[ viewJ ];
-      sEdge = (fs::path(_outputDirectory) / sEdge ).string();
-
-      if( !fs::exists(sEdge) )
-        fs::create_directory(sEdge);
-
-      string out_filename_I = "00_mask_I.png";
-      out_filename_I = (fs::path(sEdge) / out_filename_I).string();
-
-      string out_filename_J = "00_mask_J.png";
-      out_filename_J = (fs::path(sEdge) / out_filename_J).string();
-      writeImage(out_filename_I, maskI, image::EImageColorSpace::AUTO);
-      writeImage(out_filename_J, maskJ, image::EImageColorSpace::AUTO);
+      map_relativeHistograms[channelIndex][i].I = map_cameraNodeToCameraIndex[matchesPerViewIt.first.first];
+      map_relativeHistograms[channelIndex][i].J = map_cameraNodeToCameraIndex[matchesPerViewIt.first.second];
+      ++i;
     }
+  }
 
-    //-- Compute the histograms
-    Image< RGBColor > imageI, imageJ;
-    readImage(p_imaNames.first, imageI, image::EImageColorSpace::LINEAR);
-    readImage(p_imaNames.second, imageJ, image::EImageColorSpace::LINEAR);
+  aliceVision::system::Timer histogramTimer;
 
-    Histogram< double > histoI( minvalue, maxvalue, bin);
-    Histogram< double > histoJ( minvalue, maxvalue, bin);
-
-    int channelIndex = 0; // RED channel
-    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeR = map_relativeHistograms[channelIndex][i];
-    edgeR = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
-      histoI.GetHist(), histoJ.GetHist());
-
-    histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
-    channelIndex = 1; // GREEN channel
-    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeG = map_relativeHistograms[channelIndex][i];
-    edgeG = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
-      histoI.GetHist(), histoJ.GetHist());
-
-    histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
-    channelIndex = 2; // BLUE channel
-    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeB = map_relativeHistograms[channelIndex][i];
-    edgeB = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
-      histoI.GetHist(), histoJ.GetHist());
+  if(_selectionMethod == eHistogramHarmonizeVLDSegment)
+  {
+    // the KVLD masks depend on both images of a pair
+    computePairHistograms(map_relativeHistograms);
+  }
+  else
+  {
+    // the masks only depend on the image and its matched features:
+    // each image is read once and gives the histograms of all its edges
+    computeImageHistograms(map_relativeHistograms);
   }
 
-  std::cout << "\n -- \n SOLVE for color consistency with linear programming\n --" << std::endl;
+  std::cout << "\n Histograms of " << _pairwiseMatches.size() << " edges computed in (s): " << histogramTimer.elapsed() << std::endl;
+
   //-- Solve for the gains and offsets:
   std::vector<size_t> vec_indexToFix;
   vec_indexToFix.push_back(map_cameraNodeToCameraIndex[_imgRef]);
 
   using namespace aliceVision::linearProgramming;
 
-  std::vector<double> vec_solution_r(_fileNames.size() * 2 + 1);
-  std::vector<double> vec_solution_g(_fileNames.size() * 2 + 1);
-  std::vector<double> vec_solution_b(_fileNames.size() * 2 + 1);
+  std::vector<double> vec_solution[3];
 
   aliceVision::system::Timer timer;
 
-  #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_MOSEK)
-  typedef MOSEKSolver SOLVER_LP_T;
-  #else
-  typedef OSI_CISolverWrapper SOLVER_LP_T;
-  #endif
-  // Red channel
-  {
-    SOLVER_LP_T lpSolver(vec_solution_r.size());
-
-    GainOffsetConstraintBuilder cstBuilder(map_relativeHistograms[0], vec_indexToFix);
-    LPConstraintsSparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_r);
-  }
-  // Green channel
+  if(_solver == eHarmonizeSolverIRLS)
   {
-    SOLVER_LP_T lpSolver(vec_solution_g.size());
-
-    GainOffsetConstraintBuilder cstBuilder(map_relativeHistograms[1], vec_indexToFix);
-    LPConstraintsSparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_g);
+    std::cout << "\n -- \n SOLVE for color consistency with iteratively reweighted least squares\n --" << std::endl;
+
+    const std::size_t nbImages = map_cameraIndexTocameraNode.size();
+    bool solved[3];
+
+    #pragma omp parallel for
+    for(int channelIndex = 0; channelIndex < 3; ++channelIndex)
+      solved[channelIndex] = solveGainOffsetIRLS(nbImages, map_relativeHistograms[channelIndex], vec_indexToFix, vec_solution[channelIndex]);
+
+    if(!solved[0] || !solved[1] || !solved[2])
+    {
+      std::cout << "Cannot solve the color consistency" << std::endl;
+      return false;
+    }
   }
-  // Blue channel
+  else
   {
-    SOLVER_LP_T lpSolver(vec_solution_b.size());
-
-    GainOffsetConstraintBuilder cstBuilder(map_relativeHistograms[2], vec_indexToFix);
-    LPConstraintsSparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_b);
+    std::cout << "\n -- \n SOLVE for color consistency with linear programming\n --" << std::endl;
+
+    #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_MOSEK)
+    typedef MOSEKSolver SOLVER_LP_T;
+    #else
+    typedef OSI_CISolverWrapper SOLVER_LP_T;
+    #endif
+
+    for(int channelIndex = 0; channelIndex < 3; ++channelIndex)
+    {
+      vec_solution[channelIndex].resize(_fileNames.size() * 2 + 1);
+      SOLVER_LP_T lpSolver(vec_solution[channelIndex].size());
+
+      GainOffsetConstraintBuilder cstBuilder(map_relativeHistograms[channelIndex], vec_indexToFix);
+      LPConstraintsSparse constraint;
+      cstBuilder.Build(constraint);
+      lpSolver.setup(constraint);
+      lpSolver.solve();
+      lpSolver.getSolution(vec_solution[channelIndex]);
+    }
   }
 
+  const std::vector<double>& vec_solution_r = vec_solution[0];
+  const std::vector<double>& vec_solution_g = vec_solution[1];
+  const std::vector<double>& vec_solution_b = vec_solution[2];
+
   std::cout << std::endl
     << " ColorHarmonization solving on a graph with: " << _pairwiseMatches.size() << " edges took (s): "
     << timer.elapsed() << std::endl
@@ -438,6 +346,199 @@ bool ColorHarmonizationEngineGlobal::Process()
   return true;
 }
 
+/**
+ * @brief Compute the RGB histograms of the masked pixels of an image
+ * @param[in] image The image
+ * @param[in] mask The mask, at the sampling resolution
+ * @param[in] step The sampling step in pixels, one pixel out of step in each direction
+ * @param[out] histograms The histogram of each channel
+ */
+void computeSampledHistograms(const Image<RGBColor>& image,
+                              const Image<unsigned char>& mask,
+                              int step,
+                              std::vector<std::size_t> histograms[3])
+{
+  const size_t bin = 256;
+  const double minvalue = 0.0;
+  const double maxvalue = 255.0;
+
+  Histogram<double> histos[3] = {Histogram<double>(minvalue, maxvalue, bin),
+                                 Histogram<double>(minvalue, maxvalue, bin),
+                                 Histogram<double>(minvalue, maxvalue, bin)};
+
+  for(int j = 0; j < mask.Height(); ++j)
+  {
+    for(int i = 0; i < mask.Width(); ++i)
+    {
+      if(mask(j, i) == 0)
+        continue;
+
+      const RGBColor& color = image(j * step, i * step);
+      for(int channelIndex = 0; channelIndex < 3; ++channelIndex)
+        histos[channelIndex].Add(color(channelIndex));
+    }
+  }
+
+  for(int channelIndex = 0; channelIndex < 3; ++channelIndex)
+    histograms[channelIndex] = histos[channelIndex].GetHist();
+}
+
+void ColorHarmonizationEngineGlobal::computeImageHistograms(std::vector<relativeColorHistogramEdge> relativeHistograms[3]) const
+{
+  const int circleSize = 10;
+  const int step = std::max(1, _histogramDownscale);
+
+  // edges of each image, with the side of the image in the edge (true for I, false for J)
+  std::map<IndexT, std::vector<std::pair<std::size_t, bool> > > edgesPerImage;
+  std::vector<matching::PairwiseMatches::const_iterator> pairs;
+  pairs.reserve(_pairwiseMatches.size());
+
+  for(matching::PairwiseMatches::const_iterator iter = _pairwiseMatches.begin(); iter != _pairwiseMatches.end(); ++iter)
+  {
+    edgesPerImage[iter->first.first].emplace_back(pairs.size(), true);
+    edgesPerImage[iter->first.second].emplace_back(pairs.size(), false);
+    pairs.push_back(iter);
+  }
+
+  std::vector<IndexT> viewIds;
+  viewIds.reserve(edgesPerImage.size());
+  for(const auto& edgesPerImageIt : edgesPerImage)
+    viewIds.push_back(edgesPerImageIt.first);
+
+  boost::progress_display progressBar(viewIds.size(), std::cout, "\nCompute the histograms per image\n");
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int v = 0; v < static_cast<int>(viewIds.size()); ++v)
+  {
+    const IndexT viewId = viewIds[v];
+
+    Image<RGBColor> image;
+    readImage(_fileNames[viewId], image, image::EImageColorSpace::LINEAR);
+
+    // mask at the sampling resolution
+    Image<unsigned char> mask((image.Width() + step - 1) / step, (image.Height() + step - 1) / step);
+
+    // the full frame histograms are shared by all the edges of the image
+    std::vector<std::size_t> fullFrameHistograms[3];
+    if(_selectionMethod == eHistogramHarmonizeFullFrame)
+    {
+      mask.fill(image::WHITE);
+      computeSampledHistograms(image, mask, step, fullFrameHistograms);
+    }
+
+    for(const std::pair<std::size_t, bool>& edge : edgesPerImage.at(viewId))
+    {
+      const std::size_t edgeIndex = edge.first;
+      const bool isImageI = edge.second;
+
+      std::vector<std::size_t> histograms[3];
+
+      if(_selectionMethod == eHistogramHarmonizeFullFrame)
+      {
+        for(int channelIndex = 0; channelIndex < 3; ++channelIndex)
+          histograms[channelIndex] = fullFrameHistograms[channelIndex];
+      }
+      else
+      {
+        // matched points: a disk around each feature of this image matched in the edge
+        mask.fill(0);
+        const feature::MapRegionsPerDesc& regionsPerDesc = _regionsPerView.getRegionsPerDesc(viewId);
+
+        for(const auto& matchesPerDescIt : pairs[edgeIndex]->second)
+        {
+          const std::vector<feature::PointFeature>& features = regionsPerDesc.at(matchesPerDescIt.first)->Features();
+
+          for(const IndMatch& match : matchesPerDescIt.second)
+          {
+            const feature::PointFeature& feature = features.at(isImageI ? match._i : match._j);
+            FilledCircle(static_cast<int>(feature.x() / step), static_cast<int>(feature.y() / step),
+                         std::max(1, circleSize / step), static_cast<unsigned char>(255), &mask);
+          }
+        }
+        computeSampledHistograms(image, mask, step, histograms);
+      }
+
+      for(int channelIndex = 0; channelIndex < 3; ++channelIndex)
+      {
+        relativeColorHistogramEdge& relativeHistogram = relativeHistograms[channelIndex][edgeIndex];
+        (isImageI ? relativeHistogram.histoI : relativeHistogram.histoJ).swap(histograms[channelIndex]);
+      }
+    }
+
+    #pragma omp critical
+    {
+      ++progressBar;
+    }
+  }
+}
+
+void ColorHarmonizationEngineGlobal::computePairHistograms(std::vector<relativeColorHistogramEdge> relativeHistograms[3]) const
+{
+  const size_t bin = 256;
+  const double minvalue = 0.0;
+  const double maxvalue = 255.0;
+
+  std::vector<matching::PairwiseMatches::const_iterator> pairs;
+  pairs.reserve(_pairwiseMatches.size());
+  for(matching::PairwiseMatches::const_iterator iter = _pairwiseMatches.begin(); iter != _pairwiseMatches.end(); ++iter)
+    pairs.push_back(iter);
+
+  boost::progress_display progressBar(pairs.size(), std::cout, "\nCompute the histograms per edge\n");
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < static_cast<int>(pairs.size()); ++i)
+  {
+    const size_t viewI = pairs[i]->first.first;
+    const size_t viewJ = pairs[i]->first.second;
+
+    const MatchesPerDescType& matchesPerDesc = pairs[i]->second;
+
+    //-- Edges names:
+    const std::pair< std::string, std::string > p_imaNames = make_pair( _fileNames[ viewI ], _fileNames[ viewJ ] );
+
+    //-- Compute the masks from the data selection:
+    Image< unsigned char > maskI ( _imageSize[ viewI ].first, _imageSize[ viewI ].second );
+    Image< unsigned char > maskJ ( _imageSize[ viewJ ].first, _imageSize[ viewJ ].second );
+
+    maskI.fill(0);
+    maskJ.fill(0);
+
+    for(const auto& matchesIt: matchesPerDesc)
+    {
+      const feature::EImageDescriberType descType = matchesIt.first;
+      const IndMatches& matches = matchesIt.second;
+      colorHarmonization::CommonDataByPair_vldSegment dataSelector(
+        p_imaNames.first,
+        p_imaNames.second,
+        matches,
+        _regionsPerView.getRegions(viewI, descType).Features(),
+        _regionsPerView.getRegions(viewJ, descType).Features());
+
+      dataSelector.computeMask( maskI, maskJ );
+    }
+
+    //-- Compute the histograms
+    Image< RGBColor > imageI, imageJ;
+    readImage(p_imaNames.first, imageI, image::EImageColorSpace::LINEAR);
+    readImage(p_imaNames.second, imageJ, image::EImageColorSpace::LINEAR);
+
+    for(int channelIndex = 0; channelIndex < 3; ++channelIndex)
+    {
+      Histogram< double > histoI( minvalue, maxvalue, bin);
+      Histogram< double > histoJ( minvalue, maxvalue, bin);
+      colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
+      colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
+      relativeHistograms[channelIndex][i].histoI = histoI.GetHist();
+      relativeHistograms[channelIndex][i].histoJ = histoJ.GetHist();
+    }
+
+    #pragma omp critical
+    {
+      ++progressBar;
+    }
+  }
+}
+
 bool ColorHarmonizationEngineGlobal::ReadInputData()
 {
   if(!fs::is_directory( _outputDirectory))
@@ -501,67 +602,40 @@ bool ColorHarmonizationEngineGlobal::CleanGraph()
   // Save the graph before cleaning:
   graph::exportToGraphvizData((fs::path(_outputDirectory) / "initialGraph").string(), putativeGraph.g);
 
-  const int connectedComponentCount = lemon::countConnectedComponents(putativeGraph.g);
+  const graph::CsrGraph csrGraph(getImagePairs(_pairwiseMatches));
+
+  std::vector<IndexT> labels;
+  const std::size_t connectedComponentCount = csrGraph.connectedComponents(labels);
   std::cout << "\n"
     << "ColorHarmonizationEngineGlobal::CleanGraph() :: => connected Component cardinal: "
     << connectedComponentCount << std::endl;
 
   if (connectedComponentCount > 1)  // If more than one CC, keep the largest
   {
-    // Search the largest CC index
-    const std::map<IndexT, std::set<lemon::ListGraph::Node> > map_subgraphs =
-      aliceVision::graph::exportGraphToMapSubgraphs<lemon::ListGraph, IndexT>(putativeGraph.g);
-    size_t count = std::numeric_limits<size_t>::min();
-    std::map<IndexT, std::set<lemon::ListGraph::Node> >::const_iterator iterLargestCC = map_subgraphs.end();
-    for(std::map<IndexT, std::set<lemon::ListGraph::Node> >::const_iterator iter = map_subgraphs.begin();
-        iter != map_subgraphs.end(); ++iter)
+    // Components are labeled by decreasing size, the largest one has label 0
+    std::vector<std::size_t> componentSizes(connectedComponentCount, 0);
+    for(const IndexT label : labels)
+      ++componentSizes[label];
+    for(const std::size_t size : componentSizes)
+      std::cout << "Connected component of size : " << size << std::endl;
+
+    //-- Remove all pairs that are not in the largest CC
+    for(matching::PairwiseMatches::iterator iterM = _pairwiseMatches.begin(); iterM != _pairwiseMatches.end();)
     {
-      if (iter->second.size() > count)  {
-        count = iter->second.size();
-        iterLargestCC = iter;
-      }
-      std::cout << "Connected component of size : " << iter->second.size() << std::endl;
-    }
-
-    //-- Remove all nodes that are not listed in the largest CC
-    for(std::map<IndexT, std::set<lemon::ListGraph::Node> >::const_iterator iter = map_subgraphs.begin();
-        iter != map_subgraphs.end(); ++iter)
-    {
-      if (iter == iterLargestCC) // Skip this CC since it's the one we want to keep
-        continue;
-
-      const std::set<lemon::ListGraph::Node> & ccSet = iter->second;
-      for (std::set<lemon::ListGraph::Node>::const_iterator iter2 = ccSet.begin();
-        iter2 != ccSet.end(); ++iter2)
-      {
-        // Remove all outgoing edges
-        for (lemon::ListGraph::OutArcIt e(putativeGraph.g, *iter2); e!=INVALID; ++e)
-        {
-          putativeGraph.g.erase(e);
-          const IndexT Idu = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.target(e)];
-          const IndexT Idv = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.source(e)];
-          matching::PairwiseMatches::iterator iterM = _pairwiseMatches.find(std::make_pair(Idu,Idv));
-          if( iterM != _pairwiseMatches.end())
-          {
-            _pairwiseMatches.erase(iterM);
-          }
-          else // Try to find the opposite directed edge
-          {
-            iterM = _pairwiseMatches.find(std::make_pair(Idv,Idu));
-            if( iterM != _pairwiseMatches.end())
-              _pairwiseMatches.erase(iterM);
-          }
-        }
-      }
+      if(labels[csrGraph.nodeIndex(iterM->first.first)] != 0)
+        iterM = _pairwiseMatches.erase(iterM);
+      else
+        ++iterM;
     }
   }
 
   // Save the graph after cleaning:
-  graph::exportToGraphvizData((fs::path(_outputDirectory) / "cleanedGraph").string(), putativeGraph.g);
+  const graph::indexedGraph cleanedGraph(getImagePairs(_pairwiseMatches));
+  graph::exportToGraphvizData((fs::path(_outputDirectory) / "cleanedGraph").string(), cleanedGraph.g);
 
   std::cout << "\n"
-    << "Cardinal of nodes: " << lemon::countNodes(putativeGraph.g) << "\n"
-    << "Cardinal of edges: " << lemon::countEdges(putativeGraph.g) << std::endl
+    << "Cardinal of nodes: " << lemon::countNodes(cleanedGraph.g) << "\n"
+    << "Cardinal of edges: " << lemon::countEdges(cleanedGraph.g) << std::endl
     << std::endl;
 
   return true;
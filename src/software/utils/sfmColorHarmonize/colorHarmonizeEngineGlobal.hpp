@@ -11,6 +11,7 @@
 #include <aliceVision/feature/feature.hpp>
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/track/Track.hpp>
+#include <aliceVision/colorHarmonization/GainOffsetConstraintBuilder.hpp>
 
 #include <memory>
 
@@ -23,6 +24,12 @@ enum EHistogramSelectionMethod
     eHistogramHarmonizeVLDSegment    = 2,
 };
 
+enum EHarmonizationSolver
+{
+    eHarmonizeSolverLinearProgramming = 0,
+    eHarmonizeSolverIRLS              = 1,
+};
+
 /**
  * @brief The ColorHarmonizationEngineGlobal class
  *
@@ -41,7 +48,9 @@ public:
     const std::string& outputDirectory,
     const std::vector<feature::EImageDescriberType>& descTypes,
     int selectionMethod = -1,
-    int imgRef = -1);
+    int imgRef = -1,
+    EHarmonizationSolver solver = eHarmonizeSolverLinearProgramming,
+    int histogramDownscale = 1);
 
   ~ColorHarmonizationEngineGlobal();
 
@@ -51,6 +60,10 @@ private:
 
   EHistogramSelectionMethod _selectionMethod;
   int _imgRef;
+  /// gain/offset solver: L-infinity linear program or sparse IRLS
+  EHarmonizationSolver _solver;
+  /// histograms are computed on one pixel out of histogramDownscale in each direction (full frame and matched points)
+  int _histogramDownscale;
 
   // Input data
 
@@ -77,6 +90,12 @@ private:
 
   /// Read input data (point correspondences)
   bool ReadInputData();
+
+  /// Compute the edges histograms reading each image once (full frame and matched points selections)
+  void computeImageHistograms(std::vector<lInfinity::relativeColorHistogramEdge> relativeHistograms[3]) const;
+
+  /// Compute the edges histograms pair by pair (VLD segment selection)
+  void computePairHistograms(std::vector<lInfinity::relativeColorHistogramEdge> relativeHistograms[3]) const;
 };
 
 } // namespace aliceVision